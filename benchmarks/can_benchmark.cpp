@@ -0,0 +1,237 @@
+// SocketCAN receive benchmark on a virtual bus
+//
+// Usage: can_benchmark [device] [seconds] [unrelated_per_relevant]
+// Needs a vcan interface:
+//   sudo modprobe vcan && sudo ip link add dev vcan0 type vcan && sudo ip link set up vcan0
+//
+// A sender thread floods the bus with unrelated IDs, interleaving one speed
+// or yaw-rate frame every N frames. Two receivers are compared over the
+// same traffic:
+//   read()        unfiltered socket, poll + one read() per frame, ID switch
+//   epoll+mmsg    CanVehicleReader: CAN_RAW_FILTER, epoll, recvmmsg batches
+// and the relevant frames/s, syscalls and receiver CPU% are reported.
+
+#include "can_vehicle_reader.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include <net/if.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace nav;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const uint32_t SPEED_ID = 0x200;
+const uint32_t YAW_RATE_ID = 0x201;
+
+double threadCpuSeconds() {
+    struct rusage usage;
+    getrusage(RUSAGE_THREAD, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+           usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+double processCpuSeconds() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+           usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+int openRawSocket(const char* device) {
+    const int fd = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+    if (fd < 0) {
+        return -1;
+    }
+    struct ifreq ifr;
+    std::memset(&ifr, 0, sizeof(ifr));
+    std::strncpy(ifr.ifr_name, device, IFNAMSIZ - 1);
+    struct sockaddr_can addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.can_family = AF_CAN;
+    if (ioctl(fd, SIOCGIFINDEX, &ifr) < 0 ||
+        (addr.can_ifindex = ifr.ifr_ifindex, bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0)) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+struct Flood {
+    std::atomic<bool> running{true};
+    std::atomic<uint64_t> sent{0};
+    std::atomic<uint64_t> relevant{0};
+    double cpu_seconds = 0.0;
+};
+
+void floodBus(int fd, int ratio, Flood& flood) {
+    const double cpu_start = threadCpuSeconds();
+    struct can_frame frame;
+    std::memset(&frame, 0, sizeof(frame));
+    frame.can_dlc = 8;
+    uint64_t n = 0;
+    while (flood.running.load(std::memory_order_relaxed)) {
+        const bool relevant = (n % static_cast<uint64_t>(ratio + 1)) == 0;
+        frame.can_id = relevant ? ((n / (ratio + 1)) % 2 ? YAW_RATE_ID : SPEED_ID) : 0x100 + (n % 0xFF);
+        frame.data[0] = static_cast<uint8_t>(n >> 8);
+        frame.data[1] = static_cast<uint8_t>(n);
+        if (::write(fd, &frame, sizeof(frame)) == sizeof(frame)) {
+            flood.sent.fetch_add(1, std::memory_order_relaxed);
+            if (relevant) {
+                flood.relevant.fetch_add(1, std::memory_order_relaxed);
+            }
+            ++n;
+        } else {
+            std::this_thread::yield();  // ENOBUFS: tx queue full
+        }
+    }
+    flood.cpu_seconds = threadCpuSeconds() - cpu_start;
+}
+
+struct Result {
+    uint64_t relevant_sent;
+    uint64_t received;
+    uint64_t syscalls;
+    double seconds;
+    double cpu_seconds;
+};
+
+// Baseline: every frame on the bus costs a read()
+Result runReadPerFrame(const char* device, int ratio, double seconds) {
+    Result result = {};
+    const int rx = openRawSocket(device);
+    const int tx = openRawSocket(device);
+    if (rx < 0 || tx < 0) {
+        return result;
+    }
+
+    Flood flood;
+    std::atomic<bool> receiving(true);
+    std::thread receiver([&]() {
+        const double cpu_start = threadCpuSeconds();
+        struct pollfd pfd = {rx, POLLIN, 0};
+        struct can_frame frame;
+        VehicleData data;
+        while (receiving.load(std::memory_order_relaxed)) {
+            ++result.syscalls;
+            if (::poll(&pfd, 1, 50) <= 0) {
+                continue;
+            }
+            ++result.syscalls;
+            if (::read(rx, &frame, sizeof(frame)) != sizeof(frame)) {
+                continue;
+            }
+            switch (frame.can_id) {
+                case SPEED_ID:
+                    data.speed_kmh = ((frame.data[0] << 8) | frame.data[1]) * 0.1;
+                    ++result.received;
+                    break;
+                case YAW_RATE_ID:
+                    data.yaw_rate = static_cast<int16_t>((frame.data[0] << 8) | frame.data[1]) * 0.1;
+                    ++result.received;
+                    break;
+                default:
+                    break;
+            }
+        }
+        result.cpu_seconds = threadCpuSeconds() - cpu_start;
+    });
+
+    const auto start = Clock::now();
+    std::thread sender(floodBus, tx, ratio, std::ref(flood));
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    flood.running = false;
+    sender.join();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    receiving = false;
+    receiver.join();
+
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    result.relevant_sent = flood.relevant.load();
+    ::close(rx);
+    ::close(tx);
+    return result;
+}
+
+Result runFilteredBatch(const char* device, int ratio, double seconds) {
+    Result result = {};
+    CanVehicleReader reader;
+    const int tx = openRawSocket(device);
+    if (!reader.open(device) || tx < 0 || !reader.start()) {
+        return result;
+    }
+
+    Flood flood;
+    const double cpu_start = processCpuSeconds();
+    const double main_cpu_start = threadCpuSeconds();
+    const auto start = Clock::now();
+    std::thread sender(floodBus, tx, ratio, std::ref(flood));
+
+    // Consumer polls at 100 Hz like a fusion loop would
+    VehicleData sample;
+    const auto end = start + std::chrono::duration<double>(seconds);
+    while (Clock::now() < end) {
+        while (reader.popSample(sample)) {
+            ++result.received;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    flood.running = false;
+    sender.join();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    while (reader.popSample(sample)) {
+        ++result.received;
+    }
+    const double main_cpu = threadCpuSeconds() - main_cpu_start;
+    reader.stop();
+
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    result.relevant_sent = flood.relevant.load();
+    // Reader thread = whole process minus sender and consumer
+    result.cpu_seconds = processCpuSeconds() - cpu_start - flood.cpu_seconds - main_cpu;
+    result.syscalls = reader.stats().wakeups.load() + reader.stats().batches.load();
+    ::close(tx);
+    return result;
+}
+
+void printRow(const char* name, const Result& r) {
+    std::printf("%-14s %12.0f %10llu/%-10llu %12.0f %8.1f\n", name,
+                r.seconds > 0 ? r.received / r.seconds : 0.0,
+                static_cast<unsigned long long>(r.received), static_cast<unsigned long long>(r.relevant_sent),
+                r.seconds > 0 ? r.syscalls / r.seconds : 0.0,
+                r.seconds > 0 ? 100.0 * r.cpu_seconds / r.seconds : 0.0);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const char* device = argc > 1 ? argv[1] : "vcan0";
+    const double seconds = argc > 2 ? std::atof(argv[2]) : 5.0;
+    const int ratio = argc > 3 ? std::atoi(argv[3]) : 100;
+
+    const int probe = openRawSocket(device);
+    if (probe < 0) {
+        std::fprintf(stderr, "cannot open %s (create it with: ip link add dev %s type vcan)\n", device, device);
+        return 1;
+    }
+    ::close(probe);
+
+    std::printf("%s: %d unrelated frames per relevant frame, %.1f s per run\n", device, ratio, seconds);
+    std::printf("%-14s %12s %21s %12s %8s\n", "receiver", "relevant/s", "received/sent", "syscalls/s", "CPU %");
+    printRow("read()", runReadPerFrame(device, ratio, seconds));
+    printRow("epoll+mmsg", runFilteredBatch(device, ratio, seconds));
+    return 0;
+}
@@ -0,0 +1,113 @@
+// Contraction Hierarchies benchmark: CH query vs plain Dijkstra
+//
+// Usage: ch_benchmark [grid_side] [queries] [seed]
+// Default grid is 200 x 200 (40k nodes) so preprocessing stays in seconds.
+// Uniform grids have no natural road hierarchy and are close to the worst
+// case for contraction; real networks need fewer shortcuts per node.
+// Both algorithms answer the same random query set; costs are cross-checked.
+
+#include "astar_router.h"
+#include "contraction_hierarchy.h"
+#include "synthetic_grid.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace nav;
+
+namespace {
+
+// Path cost under the metric, summed over original arcs
+uint64_t pathCost(const RoadGraph& graph, const std::vector<uint32_t>& path, RouteMetric metric) {
+    uint64_t cost = 0;
+    for (size_t i = 1; i < path.size(); ++i) {
+        uint32_t best = 0xFFFFFFFFu;
+        for (uint32_t arc = graph.firstArc(path[i - 1]); arc < graph.endArc(path[i - 1]); ++arc) {
+            if (graph.arcHead(arc) == path[i]) {
+                const uint32_t c = metric == RouteMetric::DISTANCE ? graph.arcLength(arc) : graph.arcTravelTimeMs(arc);
+                best = std::min(best, c);
+            }
+        }
+        cost += best;
+    }
+    return cost;
+}
+
+void printRow(const char* name, const std::vector<double>& times, double settled) {
+    std::printf("%-22s %12.0f %10.3f %10.3f\n", name, settled,
+                bench::percentile(times, 0.50), bench::percentile(times, 0.99));
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const int side = argc > 1 ? std::atoi(argv[1]) : 200;
+    const int query_count = argc > 2 ? std::atoi(argv[2]) : 200;
+    const uint32_t seed = argc > 3 ? static_cast<uint32_t>(std::atoi(argv[3])) : 42;
+
+    std::vector<MapNode> nodes;
+    std::vector<MapEdge> edges;
+    bench::buildGrid(side, seed, nodes, edges);
+
+    auto graph = std::make_shared<RoadGraph>();
+    graph->build(nodes, edges);
+    std::printf("Graph: %u nodes, %u arcs\n", graph->nodeCount(), graph->arcCount());
+
+    std::mt19937 rng(seed + 1);
+    std::uniform_int_distribution<uint32_t> pick(0, graph->nodeCount() - 1);
+    std::vector<std::pair<uint32_t, uint32_t>> queries;
+    for (int i = 0; i < query_count; ++i) {
+        queries.emplace_back(pick(rng), pick(rng));
+    }
+
+    AStarRouter dijkstra;
+    dijkstra.setGraph(graph);
+
+    for (RouteMetric metric : {RouteMetric::TRAVEL_TIME, RouteMetric::DISTANCE}) {
+        const char* metric_name = metric == RouteMetric::DISTANCE ? "distance" : "time";
+
+        auto ch = std::make_shared<ContractionHierarchy>();
+        ch->build(*graph, metric);
+        std::printf("\nCH/%s: preprocessing %.1f s, %u shortcuts, %u up + %u down arcs (%.1f MB)\n",
+                    metric_name, ch->buildStats().build_time_ms / 1000.0, ch->buildStats().shortcuts,
+                    ch->upArcCount(), ch->downArcCount(), ch->memoryBytes() / 1048576.0);
+
+        CHRouter router;
+        router.setHierarchy(graph, ch);
+
+        std::vector<double> dijkstra_times, ch_times;
+        double dijkstra_settled = 0.0, ch_settled = 0.0;
+        int mismatches = 0;
+        std::vector<uint32_t> dijkstra_path, ch_path;
+        for (const auto& q : queries) {
+            const bool dijkstra_found = dijkstra.findPath(q.first, q.second, metric, false, dijkstra_path);
+            dijkstra_times.push_back(dijkstra.lastQueryStats().query_time_ms);
+            dijkstra_settled += dijkstra.lastQueryStats().settled_nodes;
+
+            const bool ch_found = router.findPath(q.first, q.second, ch_path);
+            ch_times.push_back(router.lastQueryStats().query_time_ms);
+            ch_settled += router.lastQueryStats().settled_nodes;
+
+            // Unpacked CH path must be a real path with the optimal cost
+            if (dijkstra_found != ch_found ||
+                (ch_found && (ch_path.front() != q.first || ch_path.back() != q.second ||
+                              pathCost(*graph, ch_path, metric) != pathCost(*graph, dijkstra_path, metric)))) {
+                ++mismatches;
+            }
+        }
+
+        std::printf("%-22s %12s %10s %10s\n", "algorithm", "settled", "p50 ms", "p99 ms");
+        const double n = queries.empty() ? 1.0 : static_cast<double>(queries.size());
+        printRow("dijkstra", dijkstra_times, dijkstra_settled / n);
+        printRow("ch", ch_times, ch_settled / n);
+        std::printf("cost mismatches: %d / %zu\n", mismatches, queries.size());
+        if (mismatches > 0) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,174 @@
+// GPS + CAN dead-reckoning fusion benchmark on a synthetic drive
+//
+// Usage: fusion_benchmark [seconds] [outage_seconds]
+// A car weaves along at 10-20 m/s. CAN reports wheel speed (2% scale error)
+// and yaw rate (0.5 deg/s gyro bias) at 100 Hz; GPS reports position with
+// 3 m noise at 10 Hz and drops out for a stretch in the middle. Reports the
+// position error of raw GPS vs the fused 10 Hz output, the error at the end
+// of the outage (pure dead reckoning), and filter updates per second.
+
+#include "position_filter.h"
+#include "synthetic_grid.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace nav;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const uint64_t START_MS = 1700000000000ull;
+const double ORIGIN_LAT = 21.028511;
+const double ORIGIN_LON = 105.804817;
+const double METERS_PER_DEG = 6371000.0 * M_PI / 180.0;
+
+struct Event {
+    bool is_gps;
+    VehicleData vehicle;
+    GpsData gps;
+};
+
+struct Truth {
+    uint64_t time_ms;
+    Point position;
+};
+
+Point toPoint(double east, double north) {
+    return Point(ORIGIN_LAT + north / METERS_PER_DEG,
+                 ORIGIN_LON + east / (METERS_PER_DEG * std::cos(ORIGIN_LAT * M_PI / 180.0)));
+}
+
+// Builds the sensor stream in time order plus 10 Hz ground truth
+void simulateDrive(double seconds, double outage_start, double outage_end,
+                   std::vector<Event>& events, std::vector<Truth>& truth, std::vector<double>& gps_errors) {
+    std::mt19937 rng(42);
+    std::normal_distribution<double> unit(0.0, 1.0);
+
+    const double wheel_scale = 1.02;
+    const double gyro_bias_dps = 0.5;
+
+    double east = 0.0, north = 0.0, heading = 0.3;
+    const int steps = static_cast<int>(seconds * 1000.0);
+    for (int ms = 0; ms <= steps; ++ms) {
+        const double t = ms / 1000.0;
+        const double speed = 15.0 + 5.0 * std::sin(2.0 * M_PI * t / 60.0);
+        const double yaw_dps = 8.0 * std::sin(2.0 * M_PI * t / 25.0);
+
+        if (ms % 10 == 0) {
+            Event e;
+            e.is_gps = false;
+            e.vehicle.speed_kmh = (speed * wheel_scale + 0.1 * unit(rng)) * 3.6;
+            e.vehicle.yaw_rate = yaw_dps + gyro_bias_dps + 0.3 * unit(rng);
+            e.vehicle.timestamp_ms = START_MS + ms;
+            events.push_back(e);
+        }
+        if (ms % 100 == 0) {
+            truth.push_back(Truth{START_MS + ms, toPoint(east, north)});
+            if (t < outage_start || t >= outage_end) {
+                Event e;
+                e.is_gps = true;
+                e.gps.position = toPoint(east + 3.0 * unit(rng), north + 3.0 * unit(rng));
+                e.gps.speed_kmh = (speed + 0.2 * unit(rng)) * 3.6;
+                double course = heading * 180.0 / M_PI + 2.0 * unit(rng);
+                e.gps.course_degrees = std::fmod(course + 360.0, 360.0);
+                e.gps.hdop = 1.0;
+                e.gps.satellites_used = 9;
+                e.gps.valid = true;
+                e.gps.timestamp_ms = START_MS + ms;
+                events.push_back(e);
+                gps_errors.push_back(e.gps.position.distanceTo(truth.back().position));
+            }
+        }
+
+        east += speed * 0.001 * std::sin(heading);
+        north += speed * 0.001 * std::cos(heading);
+        heading += yaw_dps * M_PI / 180.0 * 0.001;
+    }
+}
+
+double rms(const std::vector<double>& values) {
+    double sum = 0.0;
+    for (double v : values) {
+        sum += v * v;
+    }
+    return values.empty() ? 0.0 : std::sqrt(sum / values.size());
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const double seconds = argc > 1 ? std::atof(argv[1]) : 300.0;
+    const double outage = argc > 2 ? std::atof(argv[2]) : 10.0;
+    const double outage_start = seconds / 2.0;
+    const double outage_end = outage_start + outage;
+
+    std::vector<Event> events;
+    std::vector<Truth> truth;
+    std::vector<double> gps_errors;
+    simulateDrive(seconds, outage_start, outage_end, events, truth, gps_errors);
+
+    // Accuracy: replay once, sampling the 10 Hz output just before each truth tick is passed
+    PositionFilter filter;
+    std::vector<double> fused_errors;
+    std::vector<double> dr_errors;
+    int dr_samples = 0;
+    size_t next_truth = 1;
+    for (const Event& e : events) {
+        const uint64_t time_ms = e.is_gps ? e.gps.timestamp_ms : e.vehicle.timestamp_ms;
+        while (next_truth < truth.size() && truth[next_truth].time_ms <= time_ms) {
+            const FusedPosition fused = filter.estimate(truth[next_truth].time_ms);
+            if (fused.valid) {
+                const double error = fused.position.distanceTo(truth[next_truth].position);
+                const double t = (truth[next_truth].time_ms - START_MS) / 1000.0;
+                if (t >= outage_start && t < outage_end) {
+                    dr_errors.push_back(error);
+                    dr_samples += fused.mode == PositioningMode::DEAD_RECKONING;
+                } else if (t > 5.0) {
+                    fused_errors.push_back(error);   // Skip convergence
+                }
+            }
+            ++next_truth;
+        }
+        if (e.is_gps) {
+            filter.correct(e.gps);
+        } else {
+            filter.predict(e.vehicle);
+        }
+    }
+
+    // Throughput: replay the whole stream repeatedly
+    const int repeats = 20;
+    uint64_t updates = 0;
+    const auto start = Clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        PositionFilter bench_filter;
+        for (const Event& e : events) {
+            if (e.is_gps) {
+                bench_filter.correct(e.gps);
+            } else {
+                bench_filter.predict(e.vehicle);
+            }
+        }
+        updates += bench_filter.predictCount() + bench_filter.correctCount();
+    }
+    const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::printf("%.0f s drive, %zu CAN + %zu GPS samples, GPS outage %.0f-%.0f s\n", seconds,
+                static_cast<size_t>(filter.predictCount()), static_cast<size_t>(filter.correctCount()),
+                outage_start, outage_end);
+    std::printf("%-24s %10s %10s %10s\n", "position error (m)", "rms", "p95", "max");
+    std::printf("%-24s %10.2f %10.2f %10.2f\n", "raw GPS", rms(gps_errors),
+                bench::percentile(gps_errors, 0.95), bench::percentile(gps_errors, 1.0));
+    std::printf("%-24s %10.2f %10.2f %10.2f\n", "fused 10 Hz", rms(fused_errors),
+                bench::percentile(fused_errors, 0.95), bench::percentile(fused_errors, 1.0));
+    std::printf("%-24s %10.2f %10.2f %10.2f\n", "dead reckoning (outage)", rms(dr_errors),
+                bench::percentile(dr_errors, 0.95), bench::percentile(dr_errors, 1.0));
+    std::printf("outage samples in DR mode: %d/%zu\n", dr_samples, dr_errors.size());
+    std::printf("filter updates: %.1f M/s (%.0f ns each)\n", updates / elapsed / 1e6, elapsed * 1e9 / updates);
+    return 0;
+}
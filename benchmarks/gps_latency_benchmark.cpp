@@ -0,0 +1,166 @@
+// Serial GPS ingestion benchmark over a pty pair (no hardware needed)
+//
+// Usage: gps_latency_benchmark [epochs]
+// The master side plays a 10 Hz receiver: each epoch is written as one
+// burst (GSV, GSA, RMC, GGA), every 4th epoch is split into two partial
+// writes, and every epoch carries line noise and a corrupted sentence.
+// GpsSerialReader reads the slave side; latency is measured from the last
+// byte written to the consumer popping the epoch's fix after being woken by
+// the reader's notifier. The reader publishes one fix per epoch, so fixes
+// should equal epochs.
+
+#include "gps_serial_reader.h"
+#include "synthetic_grid.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace nav;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::string withChecksum(const std::string& body) {
+    uint8_t checksum = 0;
+    for (size_t i = 1; i < body.size(); ++i) {
+        checksum ^= static_cast<uint8_t>(body[i]);
+    }
+    char tail[8];
+    std::snprintf(tail, sizeof(tail), "*%02X\r\n", checksum);
+    return body + tail;
+}
+
+std::string epochBurst(int epoch) {
+    char lat[32];
+    std::snprintf(lat, sizeof(lat), "%010.5f", 2101.71066 + (epoch % 1000) * 0.0001);
+    // 10 Hz UTC time from 12:35:19.00, wrapping at midnight
+    const int time_cs = (4531900 + epoch * 10) % 8640000;
+    char utc[16];
+    std::snprintf(utc, sizeof(utc), "%02d%02d%02d.%02d", time_cs / 360000, time_cs / 6000 % 60, time_cs / 100 % 60,
+                  time_cs % 100);
+
+    std::string burst;
+    burst += withChecksum("$GPGSV,2,1,07,04,41,288,45,05,17,044,38,09,64,101,47,12,29,212,41");
+    burst += withChecksum("$GPGSV,2,2,07,16,20,131,39,20,55,253,46,24,08,320,33");
+    burst += std::string("\x00\xff garbage", 10);                  // Line noise
+    burst += "$GNGSA,A,3,04,05,09,12,16,20,24,,,,,,1.4,0.8,1.1*00\r\n";  // Bad checksum
+    burst += withChecksum("$GNRMC," + std::string(utc) + ",A," + std::string(lat) + ",N,10548.28902,E,22.4,84.4,230394,,,A");
+    burst += withChecksum("$GNGGA," + std::string(utc) + "," + std::string(lat) + ",N,10548.28902,E,1,12,0.8,12.0,M,-28.0,M,,");
+    return burst;
+}
+
+bool writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        const ssize_t n = ::write(fd, data, size);
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const int epochs = argc > 1 ? std::atoi(argv[1]) : 2000;
+
+    const int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+        std::fprintf(stderr, "cannot create pty pair\n");
+        return 1;
+    }
+    const std::string slave = ptsname(master);
+
+    GpsSerialReader reader;
+    if (!reader.open(slave, 9600)) {
+        std::fprintf(stderr, "open failed: %s\n", reader.lastError().c_str());
+        return 1;
+    }
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool pending = false;
+    reader.setNotifier([&]() {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending = true;
+        wake.notify_one();
+    });
+    reader.start();
+
+    std::vector<double> latencies_us;
+    latencies_us.reserve(epochs);
+    int lost = 0;
+    GpsData fix;
+    const auto run_start = Clock::now();
+
+    for (int e = 0; e < epochs; ++e) {
+        const std::string burst = epochBurst(e);
+        bool ok;
+        if (e % 4 == 3) {
+            // Split mid-sentence to exercise partial reads
+            const size_t half = burst.size() / 2;
+            ok = writeAll(master, burst.data(), half);
+            std::this_thread::sleep_for(std::chrono::microseconds(500));
+            ok = ok && writeAll(master, burst.data() + half, burst.size() - half);
+        } else {
+            ok = writeAll(master, burst.data(), burst.size());
+        }
+        if (!ok) {
+            std::fprintf(stderr, "pty write failed\n");
+            return 1;
+        }
+        const auto written = Clock::now();
+
+        // RMC and GGA make up one fix
+        int received = 0;
+        while (received < 1) {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (!wake.wait_for(lock, std::chrono::milliseconds(500), [&]() { return pending; })) {
+                break;
+            }
+            pending = false;
+            lock.unlock();
+            while (reader.popFix(fix)) {
+                ++received;
+            }
+        }
+        if (received < 1) {
+            ++lost;
+            continue;
+        }
+        latencies_us.push_back(std::chrono::duration<double, std::micro>(Clock::now() - written).count());
+    }
+
+    const double seconds = std::chrono::duration<double>(Clock::now() - run_start).count();
+    reader.stop();
+    ::close(master);
+
+    const GpsReaderStats& stats = reader.stats();
+    std::printf("pty %s, %d epochs in %.2f s\n", slave.c_str(), epochs, seconds);
+    std::printf("bytes %llu, sentences %llu, rejected %llu, fixes %llu, dropped %llu, read errors %llu\n",
+                static_cast<unsigned long long>(stats.bytes.load()),
+                static_cast<unsigned long long>(stats.sentences.load()),
+                static_cast<unsigned long long>(stats.rejected_sentences.load()),
+                static_cast<unsigned long long>(stats.fixes.load()),
+                static_cast<unsigned long long>(stats.dropped_fixes.load()),
+                static_cast<unsigned long long>(stats.read_errors.load()));
+    std::printf("last fix: %.6f, %.6f  %.1f km/h  sats %u/%u\n", fix.position.latitude, fix.position.longitude,
+                fix.speed_kmh, fix.satellites_used, fix.satellites_in_view);
+    std::printf("%-22s %10s %10s %10s\n", "latency (us)", "p50", "p99", "max");
+    std::printf("%-22s %10.1f %10.1f %10.1f\n", "write -> pop",
+                bench::percentile(latencies_us, 0.50), bench::percentile(latencies_us, 0.99),
+                bench::percentile(latencies_us, 1.0));
+    std::printf("lost epochs: %d\n", lost);
+
+    return lost == 0 && stats.fixes.load() == static_cast<uint64_t>(epochs) ? 0 : 1;
+}
@@ -0,0 +1,164 @@
+// Segment index and HMM map matching benchmark on a synthetic street grid
+//
+// Usage: map_matching_benchmark [grid_side] [fixes] [gps_sigma_m]
+// Times candidate-within-radius queries, then drives a random route through
+// the grid at 15 m/s, sampling noisy 10 Hz fixes, and compares how often
+// plain nearest-segment snapping, the online HMM and the HMM smoothed over
+// its window pick the road actually driven.
+
+#include "map_matcher.h"
+#include "nav_utils.h"
+#include "road_graph.h"
+#include "synthetic_grid.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace nav;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Fix {
+    Point gps;
+    double heading_deg;
+    uint32_t from;   // Dense nodes of the road being driven
+    uint32_t to;
+};
+
+bool sameRoad(const SegmentIndex& index, uint32_t segment, uint32_t a, uint32_t b) {
+    const uint32_t s = index.segmentFrom(segment);
+    const uint32_t t = index.segmentTo(segment);
+    return (s == a && t == b) || (s == b && t == a);
+}
+
+// Random walk along arcs (no U-turns), sampled every 1.5 m (15 m/s at 10 Hz)
+std::vector<Fix> driveRoute(const RoadGraph& graph, int fixes, double sigma, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> noise(0.0, sigma);
+    std::normal_distribution<double> heading_noise(0.0, 5.0);
+
+    std::vector<Fix> out;
+    out.reserve(fixes);
+    uint32_t prev = RoadGraph::INVALID_NODE;
+    uint32_t u = static_cast<uint32_t>(rng() % graph.nodeCount());
+    double carry = 0.0;
+    while (static_cast<int>(out.size()) < fixes) {
+        // Next arc, avoiding going straight back
+        uint32_t choices[16];
+        int n = 0;
+        for (uint32_t a = graph.firstArc(u); a < graph.endArc(u) && n < 16; ++a) {
+            if (graph.arcHead(a) != prev || graph.outDegree(u) == 1) {
+                choices[n++] = graph.arcHead(a);
+            }
+        }
+        if (n == 0) {
+            prev = RoadGraph::INVALID_NODE;
+            u = static_cast<uint32_t>(rng() % graph.nodeCount());
+            continue;
+        }
+        const uint32_t v = choices[rng() % n];
+        const Point a = graph.position(u);
+        const Point b = graph.position(v);
+        const double length = a.distanceTo(b);
+        const double bearing = NavUtils::calculateBearing(a, b);
+
+        double along = carry;
+        for (; along < length && static_cast<int>(out.size()) < fixes; along += 1.5) {
+            const Point truth = NavUtils::projectPoint(a, bearing, along);
+            Fix fix;
+            fix.gps = NavUtils::projectPoint(NavUtils::projectPoint(truth, 0.0, noise(rng)), 90.0, noise(rng));
+            fix.heading_deg = NavUtils::normalizeAngle(bearing + heading_noise(rng));
+            fix.from = u;
+            fix.to = v;
+            out.push_back(fix);
+        }
+        carry = along - length;
+        prev = u;
+        u = v;
+    }
+    return out;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const int side = argc > 1 ? std::atoi(argv[1]) : 300;
+    const int fix_count = argc > 2 ? std::atoi(argv[2]) : 20000;
+    const double sigma = argc > 3 ? std::atof(argv[3]) : 8.0;
+
+    std::vector<MapNode> nodes;
+    std::vector<MapEdge> edges;
+    bench::buildGrid(side, 7, nodes, edges);
+    RoadGraph graph;
+    graph.build(nodes, edges);
+
+    auto index = std::make_shared<SegmentIndex>();
+    const auto build_start = Clock::now();
+    index->build(graph);
+    const double build_ms = std::chrono::duration<double, std::milli>(Clock::now() - build_start).count();
+    std::printf("%d x %d grid: %u segments, index %.1f MB, built in %.1f ms\n", side, side,
+                index->segmentCount(), index->memoryBytes() / 1e6, build_ms);
+
+    // Radius queries at random points
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<uint32_t> pick(0, graph.nodeCount() - 1);
+    std::uniform_real_distribution<double> offset(-0.0005, 0.0005);
+    std::vector<double> query_us;
+    SegmentCandidate candidates[MapMatcher::MAX_CANDIDATES];
+    long found = 0;
+    for (int i = 0; i < 100000; ++i) {
+        const Point p = graph.position(pick(rng));
+        const Point q(p.latitude + offset(rng), p.longitude + offset(rng));
+        const auto start = Clock::now();
+        found += index->findSegments(q, 40.0, candidates, MapMatcher::MAX_CANDIDATES);
+        query_us.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+    }
+    std::printf("radius 40 m query: p50 %.2f us, p99 %.2f us, %.1f candidates avg\n",
+                bench::percentile(query_us, 0.50), bench::percentile(query_us, 0.99), found / 100000.0);
+
+    // Matching accuracy on a noisy drive
+    const std::vector<Fix> fixes = driveRoute(graph, fix_count, sigma, 3);
+    MapMatcher matcher(index);
+    const int window = matcher.config().window;
+    int snap_ok = 0, hmm_ok = 0, smooth_ok = 0, smooth_total = 0, matched = 0;
+    std::vector<double> match_us;
+    match_us.reserve(fixes.size());
+    uint32_t path[MapMatcher::MAX_WINDOW];
+    for (size_t i = 0; i < fixes.size(); ++i) {
+        const Fix& fix = fixes[i];
+        SegmentCandidate nearest;
+        if (index->findNearest(fix.gps, 40.0, nearest) && sameRoad(*index, nearest.segment, fix.from, fix.to)) {
+            ++snap_ok;
+        }
+
+        const auto start = Clock::now();
+        const MatchResult result = matcher.match(fix.gps, fix.heading_deg, 54.0);
+        match_us.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+        if (!result.matched) {
+            continue;
+        }
+        ++matched;
+        hmm_ok += sameRoad(*index, result.segment, fix.from, fix.to);
+
+        // Oldest layer of a full window: decided with window - 1 fixes of hindsight
+        if (matcher.decodeWindow(path, window) == window) {
+            const Fix& old = fixes[i - (window - 1)];
+            smooth_ok += sameRoad(*index, path[0], old.from, old.to);
+            ++smooth_total;
+        }
+    }
+
+    const double n = static_cast<double>(fixes.size());
+    std::printf("%zu fixes, GPS sigma %.1f m, %d matched\n", fixes.size(), sigma, matched);
+    std::printf("%-28s %8.1f %%\n", "nearest segment", 100.0 * snap_ok / n);
+    std::printf("%-28s %8.1f %%\n", "HMM online", 100.0 * hmm_ok / n);
+    std::printf("%-28s %8.1f %%\n", "HMM smoothed (window)", smooth_total ? 100.0 * smooth_ok / smooth_total : 0.0);
+    std::printf("match step: p50 %.2f us, p99 %.2f us\n",
+                bench::percentile(match_us, 0.50), bench::percentile(match_us, 0.99));
+    return 0;
+}
@@ -0,0 +1,406 @@
+// Map rendering benchmark: per-phase frame times of MapWidget
+//
+// Usage: map_render_benchmark [steps] [--frame-stats]
+// Shows a 1920x1080 MapWidget on the offscreen QPA platform (unless
+// QT_QPA_PLATFORM says otherwise) and replays scripted sequences over
+// routes of 10, 1k and 100k points:
+//
+//   pan        the centre moves 40x20 px per step at zoom 15
+//   zoom       zoom levels 11 to 18 and back, centred on the route
+//   position   the vehicle drives along the route at zoom 16, followed
+//
+// After each step the benchmark waits for the render worker to deliver a
+// frame for the new view, then repaints the widget. Render worker phases
+// (map, grid, route) are recorded for every completed frame, GUI thread
+// phases (waypoints, markers, overlays) for every repaint; p50/p99 in ms.
+// --frame-stats also draws the frame time overlay, so its cost shows up
+// under overlays.
+//
+// Each route then gets a fling: mouse events drag the map and let go while
+// it moves, and the kinetic pan runs until it stops. For every event loop
+// pass that repaints while it glides (a tick, or a frame from the worker)
+// the GUI thread work and the time since the last repaint are recorded.
+// The summary checks the position updates' paint p99 against 2 ms and the
+// glide's work p99 against the 16 ms tick budget.
+
+#include "map_widget.h"
+#include "synthetic_grid.h"
+#include "tile_key.h"
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QMouseEvent>
+#include <QThread>
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace nav;
+
+namespace {
+
+const Point CENTER(21.0285, 105.8542);
+const int VIEW_WIDTH = 1920;
+const int VIEW_HEIGHT = 1080;
+const double ROUTE_LENGTH_M = 15000.0;
+const double METERS_PER_DEGREE = 6371000.0 * M_PI / 180.0;
+const qint64 FRAME_TIMEOUT_MS = 10000;
+const qint64 SETTLE_MS = 300;
+
+// Per position update, and per kinetic pan tick (60 fps)
+const double POSITION_TARGET_MS = 2.0;
+const double KINETIC_TICK_BUDGET_MS = 16.0;
+
+// Fling: moves of FLING_STEP this far apart, then release while moving
+const int FLING_MOVES = 6;
+const unsigned long FLING_MOVE_MS = 8;
+const QPoint FLING_STEP(-40, -20);
+
+enum class Sequence { Pan, Zoom, Position };
+
+const char* sequenceName(Sequence sequence) {
+    switch (sequence) {
+    case Sequence::Pan: return "pan";
+    case Sequence::Zoom: return "zoom";
+    case Sequence::Position: return "position";
+    }
+    return "";
+}
+
+struct Samples {
+    std::vector<double> map;
+    std::vector<double> grid;
+    std::vector<double> route;
+    std::vector<double> render;
+    std::vector<double> waypoints;
+    std::vector<double> markers;
+    std::vector<double> overlays;
+    std::vector<double> paint;
+};
+
+struct FlingSamples {
+    std::vector<double> work;                                    // Event loop pass with a repaint
+    std::vector<double> interval;                                // Since the previous repaint
+};
+
+// Counts paint events reaching the widget
+class PaintCounter : public QObject {
+public:
+    int paints = 0;
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override {
+        if (event->type() == QEvent::Paint) {
+            ++paints;
+        }
+        return QObject::eventFilter(watched, event);
+    }
+};
+
+// Winding route of count points over ROUTE_LENGTH_M, kept inside the map image
+std::vector<Point> makeRoute(size_t count) {
+    std::vector<Point> route;
+    route.reserve(count);
+    const double step_m = ROUTE_LENGTH_M / (count - 1);
+    const double lon_scale = std::cos(CENTER.latitude * M_PI / 180.0);
+    uint32_t state = 12345;
+    double heading = 0.3;
+    Point p(CENTER.latitude - 0.03, CENTER.longitude - 0.04);
+    for (size_t i = 0; i < count; ++i) {
+        route.push_back(p);
+        state = state * 1664525u + 1013904223u;
+        heading += ((state >> 8) / 16777216.0 - 0.5) * 0.6;
+        Point next(p.latitude + std::cos(heading) * step_m / METERS_PER_DEGREE,
+                   p.longitude + std::sin(heading) * step_m / (METERS_PER_DEGREE * lon_scale));
+        if (std::fabs(next.latitude - CENTER.latitude) > 0.07 || std::fabs(next.longitude - CENTER.longitude) > 0.08) {
+            heading += M_PI;                                     // Turn back towards the centre
+            next = Point(p.latitude + std::cos(heading) * step_m / METERS_PER_DEGREE,
+                         p.longitude + std::sin(heading) * step_m / (METERS_PER_DEGREE * lon_scale));
+        }
+        p = next;
+    }
+    return route;
+}
+
+// Point at fraction t (0..1) of the route by index, and the heading there
+Point alongRoute(const std::vector<Point>& route, double t, double& heading) {
+    const double position = t * (route.size() - 1);
+    const size_t i = std::min(static_cast<size_t>(position), route.size() - 2);
+    const double f = position - i;
+    const Point& a = route[i];
+    const Point& b = route[i + 1];
+    heading = std::atan2((b.longitude - a.longitude) * std::cos(a.latitude * M_PI / 180.0),
+                         b.latitude - a.latitude) * 180.0 / M_PI;
+    return Point(a.latitude + (b.latitude - a.latitude) * f, a.longitude + (b.longitude - a.longitude) * f);
+}
+
+Point panned(const Point& center, int zoom, double dx, double dy) {
+    double px, py;
+    mercatorPixel(center, zoom, px, py);
+    return mercatorPoint(px + dx, py + dy, zoom);
+}
+
+// Runs the event loop until the worker has delivered a frame for the current view
+bool waitForFrame(MapWidget& widget) {
+    QElapsedTimer timer;
+    timer.start();
+    widget.update();
+    while (!widget.isFrameCurrent()) {
+        if (timer.elapsed() > FRAME_TIMEOUT_MS) {
+            return false;
+        }
+        QCoreApplication::processEvents();
+        QThread::usleep(100);
+    }
+    return true;
+}
+
+// Lets basemap tiles still decoding arrive, so sequences start from a warm cache
+void settle(MapWidget& widget) {
+    QElapsedTimer timer;
+    timer.start();
+    while (timer.elapsed() < SETTLE_MS) {
+        QCoreApplication::processEvents();
+        QThread::msleep(1);
+    }
+    waitForFrame(widget);
+}
+
+void sendMouse(MapWidget& widget, QEvent::Type type, const QPoint& pos, Qt::MouseButton button,
+               Qt::MouseButtons buttons) {
+    QMouseEvent event(type, QPointF(pos), button, buttons, Qt::NoModifier);
+    QCoreApplication::sendEvent(&widget, &event);
+}
+
+// Drags from the centre, lets go while moving and records every repaint until the map stops;
+// false if it did not glide or did not stop in time
+bool fling(MapWidget& widget, const PaintCounter& counter, FlingSamples& samples) {
+    QPoint pos(VIEW_WIDTH / 2, VIEW_HEIGHT / 2);
+    sendMouse(widget, QEvent::MouseButtonPress, pos, Qt::LeftButton, Qt::LeftButton);
+    for (int i = 0; i < FLING_MOVES; ++i) {
+        QThread::msleep(FLING_MOVE_MS);
+        pos += FLING_STEP;
+        sendMouse(widget, QEvent::MouseMove, pos, Qt::NoButton, Qt::LeftButton);
+    }
+    sendMouse(widget, QEvent::MouseButtonRelease, pos, Qt::LeftButton, Qt::NoButton);
+    if (!widget.isPanning()) {
+        return false;
+    }
+
+    QElapsedTimer clock;
+    clock.start();
+    qint64 lastPaintNs = -1;
+    while (widget.isPanning()) {
+        if (clock.elapsed() > FRAME_TIMEOUT_MS) {
+            return false;
+        }
+        const int paints = counter.paints;
+        const qint64 before = clock.nsecsElapsed();
+        QCoreApplication::processEvents();
+        const qint64 after = clock.nsecsElapsed();
+        if (counter.paints != paints) {
+            samples.work.push_back((after - before) / 1e6);
+            if (lastPaintNs >= 0) {
+                samples.interval.push_back((before - lastPaintNs) / 1e6);
+            }
+            lastPaintNs = before;
+        }
+        QThread::usleep(100);
+    }
+    return true;
+}
+
+size_t countOver(const std::vector<double>& values, double limit) {
+    return static_cast<size_t>(std::count_if(values.begin(), values.end(), [limit](double v) { return v > limit; }));
+}
+
+void printPhase(const std::vector<double>& values) {
+    std::printf(" %6.2f/%-7.2f", bench::percentile(values, 0.50), bench::percentile(values, 0.99));
+}
+
+void usage(const char* program) {
+    std::fprintf(stderr, "usage: %s [steps] [--frame-stats]\n  steps  per sequence, at least 2 (default 60)\n",
+                 program);
+}
+
+// Whole decimal number of at least 2, nothing else
+bool parseSteps(const char* text, int& steps) {
+    char* end = nullptr;
+    errno = 0;
+    const long value = std::strtol(text, &end, 10);
+    if (end == text || *end != '\0' || errno == ERANGE || value < 2 || value > INT_MAX) {
+        return false;
+    }
+    steps = static_cast<int>(value);
+    return true;
+}
+
+void discardDebug(QtMsgType type, const QMessageLogContext&, const QString& message) {
+    if (type != QtDebugMsg && type != QtInfoMsg) {
+        std::fprintf(stderr, "%s\n", qPrintable(message));
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int steps = 60;
+    bool frame_stats = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--frame-stats") == 0) {
+            frame_stats = true;
+        } else if (std::strcmp(argv[i], "--help") == 0 || std::strcmp(argv[i], "-h") == 0) {
+            usage(argv[0]);
+            return 0;
+        } else if (!parseSteps(argv[i], steps)) {
+            std::fprintf(stderr, "invalid argument: %s\n", argv[i]);
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    qInstallMessageHandler(discardDebug);                        // The widget logs every paint
+    QApplication app(argc, argv);
+    app.setApplicationName("map_render_benchmark");              // Keeps the HMI's settings apart
+    app.setOrganizationName("Navigation Systems Ltd");
+
+    MapWidget widget;
+    widget.resize(VIEW_WIDTH, VIEW_HEIGHT);
+    widget.setMapStyle(MapWidget::SATELLITE);
+    widget.setShowFrameStats(frame_stats);
+    widget.show();
+    PaintCounter paintCounter;
+    widget.installEventFilter(&paintCounter);
+
+    Samples* current = nullptr;
+    QObject::connect(&widget, &MapWidget::frameRendered, [&widget, &current](double) {
+        if (current) {
+            const MapWidget::FrameTimings& t = widget.lastFrameTimings();
+            current->map.push_back(t.mapMs);
+            current->grid.push_back(t.gridMs);
+            current->route.push_back(t.routeMs);
+            current->render.push_back(t.renderMs);
+        }
+    });
+
+    // Qt version and platform first: baselines are only comparable between equal ones
+    std::printf("Qt %s, %dx%d, %d steps per sequence, %s platform; p50/p99 ms\n", qVersion(), VIEW_WIDTH,
+                VIEW_HEIGHT, steps, qPrintable(QGuiApplication::platformName()));
+    std::printf("%8s %-9s %7s %14s %14s %14s %14s %14s %14s %14s %14s\n", "points", "sequence", "frames", "map",
+                "grid", "route", "render", "waypoints", "markers", "overlays", "paint");
+
+    const size_t sizes[] = {10, 1000, 100000};
+    const Sequence sequences[] = {Sequence::Pan, Sequence::Zoom, Sequence::Position};
+    std::vector<Samples> positionSamples;
+    std::vector<FlingSamples> flingSamples;
+    for (size_t size : sizes) {
+        const std::vector<Point> route = makeRoute(size);
+        widget.setRoute(route);
+        widget.setStartPoint(route.front());
+        widget.setEndPoint(route.back());
+
+        for (Sequence sequence : sequences) {
+            double heading = 0.0;
+            const Point middle = alongRoute(route, 0.5, heading);
+            widget.setZoomLevel(sequence == Sequence::Position ? 16 : 15);
+            widget.centerMap(middle.latitude, middle.longitude);
+            widget.setCurrentPosition(route.front(), 0.0);
+            settle(widget);
+
+            Samples samples;
+            current = &samples;
+            for (int step = 0; step < steps; ++step) {
+                switch (sequence) {
+                case Sequence::Pan: {
+                    const Point center = panned(Point(widget.centerLatitude(), widget.centerLongitude()),
+                                                widget.zoomLevel(), 40.0, 20.0);
+                    widget.centerMap(center.latitude, center.longitude);
+                    break;
+                }
+                case Sequence::Zoom: {
+                    const int phase = step % 14;                 // 11..18..11
+                    widget.setZoomLevel(11 + (phase <= 7 ? phase : 14 - phase));
+                    break;
+                }
+                case Sequence::Position: {
+                    const Point position = alongRoute(route, static_cast<double>(step) / (steps - 1), heading);
+                    widget.setCurrentPosition(position, heading);
+                    widget.centerMap(position.latitude, position.longitude);
+                    break;
+                }
+                }
+                if (!waitForFrame(widget)) {
+                    std::fprintf(stderr, "no frame within %lld ms\n", static_cast<long long>(FRAME_TIMEOUT_MS));
+                    return 1;
+                }
+                widget.repaint();
+                const MapWidget::FrameTimings& t = widget.lastFrameTimings();
+                samples.waypoints.push_back(t.waypointsMs);
+                samples.markers.push_back(t.markersMs);
+                samples.overlays.push_back(t.overlaysMs);
+                samples.paint.push_back(t.paintMs);
+            }
+            current = nullptr;
+
+            std::printf("%8zu %-9s %7zu", size, sequenceName(sequence), samples.render.size());
+            printPhase(samples.map);
+            printPhase(samples.grid);
+            printPhase(samples.route);
+            printPhase(samples.render);
+            printPhase(samples.waypoints);
+            printPhase(samples.markers);
+            printPhase(samples.overlays);
+            printPhase(samples.paint);
+            std::printf("\n");
+            if (sequence == Sequence::Position) {
+                positionSamples.push_back(samples);
+            }
+        }
+
+        // Fling from the middle of the route at zoom 15
+        double heading = 0.0;
+        const Point middle = alongRoute(route, 0.5, heading);
+        widget.setZoomLevel(15);
+        widget.centerMap(middle.latitude, middle.longitude);
+        settle(widget);
+        FlingSamples samples;
+        if (!fling(widget, paintCounter, samples)) {
+            std::fprintf(stderr, "fling did not glide and stop within %lld ms\n",
+                         static_cast<long long>(FRAME_TIMEOUT_MS));
+            return 1;
+        }
+        flingSamples.push_back(samples);
+    }
+
+    std::printf("\nkinetic pan after a fling; GUI work per repaint and repaint interval, p50/p99 ms\n");
+    std::printf("%8s %7s %14s %14s %10s\n", "points", "repaints", "work", "interval", "work>16ms");
+    for (size_t i = 0; i < flingSamples.size(); ++i) {
+        const FlingSamples& samples = flingSamples[i];
+        std::printf("%8zu %7zu", sizes[i], samples.work.size());
+        printPhase(samples.work);
+        printPhase(samples.interval);
+        std::printf(" %10zu\n", countOver(samples.work, KINETIC_TICK_BUDGET_MS));
+    }
+
+    std::printf("\ntargets at %dx%d\n", VIEW_WIDTH, VIEW_HEIGHT);
+    for (size_t i = 0; i < positionSamples.size(); ++i) {
+        const Samples& samples = positionSamples[i];
+        const double paint = bench::percentile(samples.paint, 0.99);
+        std::printf("  position update, %6zu points: paint p99 %.2f ms, markers p99 %.2f ms - %s (< %.0f ms)\n",
+                    sizes[i], paint, bench::percentile(samples.markers, 0.99),
+                    paint < POSITION_TARGET_MS ? "met" : "MISSED", POSITION_TARGET_MS);
+    }
+    for (size_t i = 0; i < flingSamples.size(); ++i) {
+        const double work = bench::percentile(flingSamples[i].work, 0.99);
+        std::printf("  kinetic pan tick, %6zu points: work p99 %.2f ms - %s (< %.0f ms)\n", sizes[i], work,
+                    work < KINETIC_TICK_BUDGET_MS ? "met" : "MISSED", KINETIC_TICK_BUDGET_MS);
+    }
+    return 0;
+}
@@ -0,0 +1,117 @@
+// NMEA parser benchmark: sentences per second and heap allocations
+//
+// Usage: nmea_benchmark [epochs]
+// Each epoch is one 10 Hz fix of a GPS + GLONASS + Galileo receiver
+// (RMC, VTG, GGA, one GSA per system and the GSV groups), 14 sentences.
+// operator new is counted so the run also checks that parsing allocates
+// nothing.
+
+#include "nav_utils.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::atomic<uint64_t> g_allocations(0);
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+using namespace nav;
+
+namespace {
+
+// Append "*hh\r\n" to a sentence body starting with '$'
+std::string withChecksum(const std::string& sentence) {
+    uint8_t checksum = 0;
+    for (size_t i = 1; i < sentence.size(); ++i) {
+        checksum ^= static_cast<uint8_t>(sentence[i]);
+    }
+    char tail[8];
+    std::snprintf(tail, sizeof(tail), "*%02X\r\n", checksum);
+    return sentence + tail;
+}
+
+std::vector<std::string> epochSentences() {
+    const char* bodies[] = {
+        "$GNRMC,123519.00,A,4807.03812,N,01131.00032,E,22.4,84.4,230394,003.1,W,A",
+        "$GNVTG,84.4,T,81.3,M,22.4,N,41.5,K,A",
+        "$GNGGA,123519.00,4807.03812,N,01131.00032,E,1,18,0.8,545.4,M,46.9,M,,",
+        "$GNGSA,A,3,04,05,09,12,16,20,24,25,29,,,,1.4,0.8,1.1,1",
+        "$GNGSA,A,3,65,66,72,79,81,,,,,,,,1.4,0.8,1.1,2",
+        "$GNGSA,A,3,03,05,13,24,,,,,,,,,1.4,0.8,1.1,3",
+        "$GPGSV,3,1,11,04,41,288,45,05,17,044,38,09,64,101,47,12,29,212,41,1",
+        "$GPGSV,3,2,11,16,20,131,39,20,55,253,46,24,08,320,33,25,33,057,42,1",
+        "$GPGSV,3,3,11,29,72,183,48,31,03,009,,32,12,272,31,1",
+        "$GLGSV,2,1,07,65,30,061,40,66,74,346,45,72,39,275,43,79,11,031,35,1",
+        "$GLGSV,2,2,07,81,48,142,44,82,05,196,,88,17,323,30,1",
+        "$GAGSV,2,1,06,03,52,090,44,05,27,170,40,13,60,300,46,24,19,048,37,7",
+        "$GAGSV,2,2,06,26,09,230,,31,35,012,41,7",
+        "$GPTXT,01,01,02,ANTSTATUS=OK",
+    };
+
+    std::vector<std::string> sentences;
+    for (const char* body : bodies) {
+        sentences.push_back(withChecksum(body));
+    }
+    return sentences;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const int epochs = argc > 1 ? std::atoi(argv[1]) : 200000;
+
+    const std::vector<std::string> sentences = epochSentences();
+
+    // Sanity pass over one epoch
+    GpsData check;
+    size_t accepted = 0;
+    for (const std::string& s : sentences) {
+        accepted += NmeaParser::parseNmeaSentence(s, check) ? 1 : 0;
+    }
+    std::printf("Epoch: %zu sentences, %zu accepted (TXT is skipped)\n", sentences.size(), accepted);
+    std::printf("Fix: %.6f, %.6f  %.1f km/h  %.1f deg  used %u  in view %u  mode %uD  pdop %.1f\n",
+                check.position.latitude, check.position.longitude, check.speed_kmh, check.course_degrees,
+                check.satellites_used, check.satellites_in_view, check.fix_mode, check.pdop);
+
+    GpsData gps;
+    size_t parsed = 0;
+    const uint64_t allocations_before = g_allocations.load();
+    const auto start = std::chrono::steady_clock::now();
+    for (int e = 0; e < epochs; ++e) {
+        for (const std::string& s : sentences) {
+            parsed += NmeaParser::parseNmeaSentence(s, gps) ? 1 : 0;
+        }
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const uint64_t allocations = g_allocations.load() - allocations_before;
+
+    const double total = static_cast<double>(epochs) * sentences.size();
+    std::printf("%-22s %14s %12s %14s\n", "parser", "sentences/s", "ns/sentence", "allocs/sentence");
+    std::printf("%-22s %14.0f %12.1f %14.3f\n", "string_view", total / seconds,
+                seconds * 1e9 / total, allocations / total);
+    std::printf("accepted %zu of %.0f\n", parsed, total);
+
+    return allocations == 0 ? 0 : 1;
+}
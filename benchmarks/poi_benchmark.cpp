@@ -0,0 +1,161 @@
+// POI proximity query benchmark: linear scan vs PoiSpatialIndex
+//
+// Usage: poi_benchmark [poi_count] [queries]
+// POIs are spread over Vietnam, 80% clustered around cities, in 12
+// categories. The linear scan reproduces the old findPOINearLocation
+// (haversine per POI, then a sort whose comparator recomputes haversines).
+// Index results are checked against a brute-force scan.
+
+#include "poi_spatial_index.h"
+#include "synthetic_grid.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace nav;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const int CATEGORY_COUNT = 12;
+
+std::vector<PoiLocation> generatePois(size_t count, uint32_t seed) {
+    const Point cities[] = {
+        Point(21.0285, 105.8048), Point(10.8231, 106.6297), Point(16.0544, 108.2022),
+        Point(20.8449, 106.6881), Point(10.0452, 105.7469), Point(12.2388, 109.1967),
+        Point(16.4637, 107.5909), Point(18.6796, 105.6813), Point(11.9404, 108.4583),
+    };
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> spread(0.0, 0.08);
+    std::uniform_real_distribution<double> lat(8.6, 23.4);
+    std::uniform_real_distribution<double> lon(102.1, 109.5);
+
+    std::vector<PoiLocation> pois;
+    pois.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        const uint16_t category = static_cast<uint16_t>(rng() % CATEGORY_COUNT);
+        if (rng() % 5 != 0) {
+            const Point& city = cities[rng() % 9];
+            pois.emplace_back(city.latitude + spread(rng), city.longitude + spread(rng), category);
+        } else {
+            pois.emplace_back(lat(rng), lon(rng), category);
+        }
+    }
+    return pois;
+}
+
+// Old findPOINearLocation
+size_t linearRadius(const std::vector<PoiLocation>& pois, const Point& center, double radius, uint16_t category,
+                    std::vector<uint32_t>& out) {
+    out.clear();
+    for (uint32_t i = 0; i < pois.size(); ++i) {
+        const Point p(pois[i].latitude, pois[i].longitude);
+        if (center.distanceTo(p) <= radius &&
+            (category == PoiSpatialIndex::ANY_CATEGORY || pois[i].category == category)) {
+            out.push_back(i);
+        }
+    }
+    std::sort(out.begin(), out.end(), [&](uint32_t a, uint32_t b) {
+        return center.distanceTo(Point(pois[a].latitude, pois[a].longitude)) <
+               center.distanceTo(Point(pois[b].latitude, pois[b].longitude));
+    });
+    return out.size();
+}
+
+struct Timing {
+    std::vector<double> us;
+    size_t results = 0;
+
+    void print(const char* name) const {
+        std::printf("%-34s %10.1f %10.1f %12.1f\n", name, bench::percentile(us, 0.50), bench::percentile(us, 0.99),
+                    us.empty() ? 0.0 : static_cast<double>(results) / us.size());
+    }
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const size_t count = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 1000000;
+    const int queries = argc > 2 ? std::atoi(argv[2]) : 200;
+
+    const std::vector<PoiLocation> pois = generatePois(count, 11);
+    PoiSpatialIndex index;
+    const auto build_start = Clock::now();
+    index.build(pois);
+    const double build_ms = std::chrono::duration<double, std::milli>(Clock::now() - build_start).count();
+    std::printf("%zu POIs, index %.1f MB, built in %.1f ms\n", count, index.memoryBytes() / 1e6, build_ms);
+
+    // Queries near POIs (where users are), with a few hundred metres of offset
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<double> offset(-0.005, 0.005);
+    std::vector<Point> centers;
+    for (int i = 0; i < queries; ++i) {
+        const PoiLocation& p = pois[rng() % pois.size()];
+        centers.emplace_back(p.latitude + offset(rng), p.longitude + offset(rng));
+    }
+
+    Timing linear_1km, index_1km, index_5km_cat, knn10, knn10_cat;
+    std::vector<uint32_t> linear_hits;
+    std::vector<PoiHit> hits;
+    int radius_mismatch = 0, knn_mismatch = 0;
+    for (int q = 0; q < queries; ++q) {
+        const Point& c = centers[q];
+        const uint16_t category = static_cast<uint16_t>(q % CATEGORY_COUNT);
+
+        auto start = Clock::now();
+        linear_1km.results += linearRadius(pois, c, 1000.0, PoiSpatialIndex::ANY_CATEGORY, linear_hits);
+        linear_1km.us.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+
+        hits.clear();
+        start = Clock::now();
+        index_1km.results += index.findWithinRadius(c, 1000.0, PoiSpatialIndex::ANY_CATEGORY, hits);
+        index_1km.us.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+        // Equirectangular vs haversine may disagree within a few mm of the edge
+        if (hits.size() + 1 < linear_hits.size() || hits.size() > linear_hits.size() + 1) {
+            ++radius_mismatch;
+        }
+
+        hits.clear();
+        start = Clock::now();
+        index_5km_cat.results += index.findWithinRadius(c, 5000.0, category, hits);
+        index_5km_cat.us.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+
+        hits.clear();
+        start = Clock::now();
+        knn10.results += index.findNearest(c, 10, PoiSpatialIndex::ANY_CATEGORY, 50000.0, hits);
+        knn10.us.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+
+        hits.clear();
+        start = Clock::now();
+        knn10_cat.results += index.findNearest(c, 10, category, 50000.0, hits);
+        knn10_cat.us.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+
+        // Brute-force check of the filtered k-nearest distances
+        std::vector<double> brute;
+        for (const PoiLocation& p : pois) {
+            if (p.category == category) {
+                brute.push_back(c.distanceTo(Point(p.latitude, p.longitude)));
+            }
+        }
+        std::partial_sort(brute.begin(), brute.begin() + std::min<size_t>(10, brute.size()), brute.end());
+        for (size_t i = 0; i < hits.size(); ++i) {
+            if (std::abs(hits[i].distance_m - brute[i]) > 0.01 * brute[i] + 0.5) {
+                ++knn_mismatch;
+                break;
+            }
+        }
+    }
+
+    std::printf("%-34s %10s %10s %12s\n", "query (us)", "p50", "p99", "results");
+    linear_1km.print("linear scan, 1 km");
+    index_1km.print("index, 1 km");
+    index_5km_cat.print("index, 5 km, one category");
+    knn10.print("index, 10 nearest");
+    knn10_cat.print("index, 10 nearest, one category");
+    std::printf("mismatches: radius %d, k-nearest %d\n", radius_mismatch, knn_mismatch);
+    return radius_mismatch == 0 && knn_mismatch == 0 ? 0 : 1;
+}
@@ -0,0 +1,184 @@
+// POI database startup benchmark: JSON import vs mapped snapshot
+//
+// Usage: poi_load_benchmark [poi_count] [work_dir]
+// Writes a poi_database.json with poi_count entries, then runs each startup
+// path in its own child process so that its peak RSS is measured alone:
+//   - first boot: stream the JSON into a snapshot, then map it
+//   - later boots: map the snapshot and read every record
+//   - later boots plus the spatial and text indexes POIService builds
+//   - for reference, the JSON parsed into a vector of strings (what
+//     keeping the whole database on the heap costs)
+
+#include "poi_database.h"
+#include "poi_spatial_index.h"
+#include "poi_text_index.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace nav;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char* const CATEGORIES[] = {
+    "restaurant", "cafe", "hotel", "gas_station", "hospital", "bank", "supermarket", "school", "attraction", "parking",
+};
+
+const char* const WORDS[] = {
+    "Phở", "Bún", "Chả", "Cơm", "Bánh", "Hải", "Sản", "Hương", "Liên", "Gia", "Truyền", "Thống", "Ngon",
+    "Việt", "Nam", "Hà", "Nội", "Sài", "Gòn", "Đà", "Nẵng", "Huế", "Hồng", "Đức", "Minh", "Tâm", "Phúc",
+    "Lộc", "An", "Bình", "Hòa", "Thành", "Công", "Quang", "Trung", "Tây", "Đông", "Bắc", "Xuân", "Mai",
+};
+const size_t WORD_COUNT = sizeof(WORDS) / sizeof(WORDS[0]);
+
+bool writeJson(const std::string& path, size_t count) {
+    std::FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) {
+        return false;
+    }
+    std::mt19937 rng(21);
+    std::uniform_real_distribution<double> lat(8.6, 23.4);
+    std::uniform_real_distribution<double> lon(102.1, 109.5);
+    std::fputs("[\n", f);
+    for (size_t i = 0; i < count; ++i) {
+        std::string name = WORDS[rng() % WORD_COUNT];
+        name += ' ';
+        name += WORDS[rng() % WORD_COUNT];
+        if (rng() % 10 == 0) {
+            name += " \\\"" + std::to_string(rng() % 100) + "\\\"";   // Escaped quotes
+        }
+        std::fprintf(f,
+                     "  {\n    \"id\": %zu,\n    \"name\": \"%s\",\n    \"category\": \"%s\",\n"
+                     "    \"latitude\": %.6f,\n    \"longitude\": %.6f,\n    \"address\": \"%u %s, %s\"\n  }%s\n",
+                     i + 1, name.c_str(), CATEGORIES[rng() % 10], lat(rng), lon(rng), static_cast<unsigned>(1 + rng() % 500),
+                     WORDS[rng() % WORD_COUNT], WORDS[rng() % WORD_COUNT], i + 1 < count ? "," : "");
+    }
+    std::fputs("]\n", f);
+    return std::fclose(f) == 0;
+}
+
+double msSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Runs stage in a child; prints its time, result and peak RSS
+void runStage(const char* name, const std::function<bool(double& ms, size_t& pois)>& stage) {
+    std::fflush(stdout);
+    const pid_t pid = fork();
+    if (pid == 0) {
+        double ms = 0.0;
+        size_t pois = 0;
+        const bool ok = stage(ms, pois);
+        std::printf("%-36s %10.0f %10zu", name, ms, pois);
+        std::fflush(stdout);
+        _exit(ok ? 0 : 1);
+    }
+    int status = 0;
+    struct rusage usage;
+    wait4(pid, &status, 0, &usage);
+    std::printf(" %10.1f%s\n", usage.ru_maxrss / 1024.0, WIFEXITED(status) && WEXITSTATUS(status) == 0 ? "" : "  FAILED");
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const size_t count = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 1000000;
+    const std::string dir = argc > 2 ? argv[2] : "/tmp";
+    const std::string json_path = dir + "/poi_load_benchmark.json";
+    const std::string snapshot_path = json_path + ".snap";
+
+    if (!writeJson(json_path, count)) {
+        std::fprintf(stderr, "cannot write %s\n", json_path.c_str());
+        return 1;
+    }
+    std::remove(snapshot_path.c_str());
+    struct stat st;
+    stat(json_path.c_str(), &st);
+    std::printf("%zu POIs, JSON %.1f MB\n", count, st.st_size / 1e6);
+    std::printf("%-36s %10s %10s %10s\n", "startup", "ms", "POIs", "peak MB");
+
+    runStage("JSON to heap (reference)", [&](double& ms, size_t& pois) {
+        const auto start = Clock::now();
+        std::vector<PoiJsonRecord> records;
+        PoiJsonReader reader;
+        const bool ok = reader.read(json_path, [&](const PoiJsonRecord& r) { records.push_back(r); });
+        ms = msSince(start);
+        pois = records.size();
+        return ok;
+    });
+
+    runStage("first boot: JSON to snapshot, map", [&](double& ms, size_t& pois) {
+        const auto start = Clock::now();
+        std::string error;
+        if (!PoiSnapshotWriter::convert(json_path, snapshot_path, &error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return false;
+        }
+        PoiSnapshot snapshot;
+        const bool ok = snapshot.open(snapshot_path) && snapshot.isCurrent(json_path);
+        ms = msSince(start);
+        pois = snapshot.poiCount();
+        return ok;
+    });
+
+    runStage("later boot: map snapshot", [&](double& ms, size_t& pois) {
+        const auto start = Clock::now();
+        PoiSnapshot snapshot;
+        const bool ok = snapshot.open(snapshot_path) && snapshot.isCurrent(json_path);
+        ms = msSince(start);
+        pois = snapshot.poiCount();
+        return ok;
+    });
+
+    runStage("later boot: map, read every POI", [&](double& ms, size_t& pois) {
+        const auto start = Clock::now();
+        PoiSnapshot snapshot;
+        if (!snapshot.open(snapshot_path)) {
+            return false;
+        }
+        uint64_t checksum = 0;
+        for (uint32_t i = 0; i < snapshot.poiCount(); ++i) {
+            checksum += snapshot.record(i).poi_id + static_cast<unsigned char>(snapshot.name(i)[0]);
+        }
+        ms = msSince(start);
+        pois = snapshot.poiCount();
+        return checksum != 0;
+    });
+
+    runStage("later boot: map, build indexes", [&](double& ms, size_t& pois) {
+        const auto start = Clock::now();
+        PoiSnapshot snapshot;
+        if (!snapshot.open(snapshot_path)) {
+            return false;
+        }
+        std::vector<PoiLocation> locations;
+        std::vector<TextDocument> documents;
+        locations.reserve(snapshot.poiCount());
+        documents.reserve(snapshot.poiCount());
+        for (uint32_t i = 0; i < snapshot.poiCount(); ++i) {
+            const PoiSnapshotRecord& r = snapshot.record(i);
+            locations.emplace_back(r.lat_e7 / 1e7, r.lon_e7 / 1e7, r.category);
+            documents.emplace_back(snapshot.name(i), snapshot.category(r.category));
+        }
+        PoiSpatialIndex spatial;
+        PoiTextIndex text;
+        const bool ok = spatial.build(locations) && text.build(documents);
+        ms = msSince(start);
+        pois = snapshot.poiCount();
+        return ok;
+    });
+
+    std::remove(json_path.c_str());
+    std::remove(snapshot_path.c_str());
+    return 0;
+}
@@ -0,0 +1,164 @@
+// POI text search benchmark: per-keystroke search over a national POI set
+//
+// Usage: poi_search_benchmark [poi_count] [typed_names]
+// Names are built from Vietnamese words with diacritics. Each typed name is
+// entered one character at a time and searched after every keystroke,
+// like a search-as-you-type box. The baseline reproduces the old
+// searchPOI: lower-case copies of every name and category, then a
+// substring test, per keystroke.
+
+#include "poi_text_index.h"
+#include "synthetic_grid.h"
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace nav;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char* const CATEGORIES[] = {
+    "Nhà hàng", "Khách sạn", "Cà phê", "Trạm xăng", "Bệnh viện", "Ngân hàng", "Siêu thị", "Trường học",
+};
+
+const char* const WORDS[] = {
+    "Phở", "Bún", "Chả", "Cơm", "Bánh", "Mì", "Gà", "Vịt", "Hải", "Sản", "Hương", "Liên", "Gia", "Truyền",
+    "Thống", "Ngon", "Việt", "Nam", "Hà", "Nội", "Sài", "Gòn", "Đà", "Nẵng", "Huế", "Hồng", "Đức", "Minh",
+    "Tâm", "Phúc", "Lộc", "Thọ", "An", "Bình", "Hòa", "Thành", "Công", "Quang", "Trung", "Tây", "Đông",
+    "Bắc", "Xuân", "Thu", "Hạ", "Mai", "Lan", "Cúc", "Trúc", "Sen", "Ngọc", "Kim", "Vàng", "Bạc", "Long",
+    "Phượng", "Rồng", "Tiên", "Sơn", "Thủy", "Petrolimex", "Vinmart", "Coopmart", "Vietcombank", "Techcombank",
+};
+const size_t WORD_COUNT = sizeof(WORDS) / sizeof(WORDS[0]);
+
+struct PoiText {
+    std::string name;
+    std::string category;
+};
+
+std::vector<PoiText> generatePois(size_t count, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::vector<PoiText> pois(count);
+    for (PoiText& poi : pois) {
+        poi.category = CATEGORIES[rng() % 8];
+        const int words = 2 + static_cast<int>(rng() % 3);
+        for (int w = 0; w < words; ++w) {
+            if (w > 0) {
+                poi.name += ' ';
+            }
+            poi.name += WORDS[rng() % WORD_COUNT];
+        }
+        if (rng() % 4 == 0) {
+            poi.name += ' ' + std::to_string(1 + rng() % 200);
+        }
+    }
+    return pois;
+}
+
+std::string asciiLower(const std::string& text) {
+    std::string lower(text);
+    for (char& c : lower) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return lower;
+}
+
+// Old searchPOI: two lower-cased copies per POI per query
+size_t linearSearch(const std::vector<PoiText>& pois, const std::string& query) {
+    const std::string needle = asciiLower(query);
+    size_t found = 0;
+    for (const PoiText& poi : pois) {
+        if (asciiLower(poi.name).find(needle) != std::string::npos ||
+            asciiLower(poi.category).find(needle) != std::string::npos) {
+            ++found;
+        }
+    }
+    return found;
+}
+
+// Prefixes of text ending on UTF-8 character boundaries
+std::vector<std::string> keystrokes(const std::string& text) {
+    std::vector<std::string> out;
+    for (size_t i = 1; i <= text.size(); ++i) {
+        if (i == text.size() || (static_cast<unsigned char>(text[i]) & 0xC0) != 0x80) {
+            out.push_back(text.substr(0, i));
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const size_t count = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 1000000;
+    const int typed = argc > 2 ? std::atoi(argv[2]) : 50;
+
+    const std::vector<PoiText> pois = generatePois(count, 3);
+    std::vector<TextDocument> docs;
+    docs.reserve(pois.size());
+    for (const PoiText& poi : pois) {
+        docs.emplace_back(poi.name, poi.category);
+    }
+
+    PoiTextIndex index;
+    const auto build_start = Clock::now();
+    index.build(docs);
+    const double build_ms = std::chrono::duration<double, std::milli>(Clock::now() - build_start).count();
+    std::printf("%zu POIs, %u terms, index %.1f MB, built in %.0f ms\n", count, index.termCount(),
+                index.memoryBytes() / 1e6, build_ms);
+
+    // Folding check: unaccented, differently cased input finds the accented name
+    std::vector<TextHit> hits;
+    const std::string& sample = pois[count / 2].name;
+    std::string folded;
+    PoiTextIndex::foldText(sample, folded);
+    index.search(asciiLower(folded), 1000000, hits);
+    bool found_sample = false;
+    for (const TextHit& hit : hits) {
+        found_sample = found_sample || hit.doc == count / 2;
+    }
+    std::printf("'%s' as '%s': %s (%zu hits)\n", sample.c_str(), folded.c_str(), found_sample ? "found" : "MISSING",
+                hits.size());
+
+    // Type names one character at a time
+    std::mt19937 rng(9);
+    std::vector<double> index_us;
+    std::vector<double> linear_us;
+    for (int n = 0; n < typed; ++n) {
+        const PoiText& target = pois[rng() % pois.size()];
+        const std::vector<std::string> keys = keystrokes(target.name);
+        for (size_t i = 0; i < keys.size(); ++i) {
+            hits.clear();
+            const auto start = Clock::now();
+            index.search(keys[i], 20, hits);
+            index_us.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+
+            // The baseline is slow; sample it on the first few names
+            if (n < 3) {
+                const auto linear_start = Clock::now();
+                linearSearch(pois, keys[i]);
+                linear_us.push_back(std::chrono::duration<double, std::micro>(Clock::now() - linear_start).count());
+            }
+        }
+    }
+
+    std::vector<std::string> completions;
+    index.complete("Ph", 5, completions);
+    std::printf("complete('Ph'):");
+    for (const std::string& c : completions) {
+        std::printf(" %s", c.c_str());
+    }
+    std::printf("\n");
+
+    std::printf("%-26s %10s %10s %10s %10s\n", "per keystroke (ms)", "p50", "p99", "max", "queries");
+    std::printf("%-26s %10.3f %10.3f %10.3f %10zu\n", "linear lower+contains", bench::percentile(linear_us, 0.5) / 1e3,
+                bench::percentile(linear_us, 0.99) / 1e3, bench::percentile(linear_us, 1.0) / 1e3, linear_us.size());
+    std::printf("%-26s %10.3f %10.3f %10.3f %10zu\n", "inverted index, top 20", bench::percentile(index_us, 0.5) / 1e3,
+                bench::percentile(index_us, 0.99) / 1e3, bench::percentile(index_us, 1.0) / 1e3, index_us.size());
+    return found_sample ? 0 : 1;
+}
@@ -0,0 +1,84 @@
+// Routing benchmark: A* vs Dijkstra on a synthetic city-sized grid
+//
+// Usage: routing_benchmark [grid_side] [queries] [seed]
+// Default grid is 1000 x 1000 (1M nodes), roughly the size of a large city.
+
+#include "astar_router.h"
+#include "synthetic_grid.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace nav;
+
+namespace {
+
+struct Summary {
+    double p50_ms;
+    double p99_ms;
+    double mean_settled;
+};
+
+Summary runQueries(AStarRouter& router, const std::vector<std::pair<uint32_t, uint32_t>>& queries,
+                   bool use_heuristic, RouteMetric metric) {
+    std::vector<double> times;
+    times.reserve(queries.size());
+    double settled = 0.0;
+    std::vector<uint32_t> path;
+
+    for (const auto& q : queries) {
+        router.findPath(q.first, q.second, metric, use_heuristic, path);
+        times.push_back(router.lastQueryStats().query_time_ms);
+        settled += router.lastQueryStats().settled_nodes;
+    }
+
+    Summary s;
+    s.p50_ms = bench::percentile(times, 0.50);
+    s.p99_ms = bench::percentile(times, 0.99);
+    s.mean_settled = queries.empty() ? 0.0 : settled / queries.size();
+    return s;
+}
+
+void printRow(const char* name, const Summary& s) {
+    std::printf("%-22s %12.0f %10.3f %10.3f\n", name, s.mean_settled, s.p50_ms, s.p99_ms);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const int side = argc > 1 ? std::atoi(argv[1]) : 1000;
+    const int query_count = argc > 2 ? std::atoi(argv[2]) : 100;
+    const uint32_t seed = argc > 3 ? static_cast<uint32_t>(std::atoi(argv[3])) : 42;
+
+    std::vector<MapNode> nodes;
+    std::vector<MapEdge> edges;
+    bench::buildGrid(side, seed, nodes, edges);
+
+    AStarRouter router;
+    const auto build_start = std::chrono::steady_clock::now();
+    router.build(nodes, edges);
+    const double build_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - build_start).count();
+
+    std::printf("Graph: %zu nodes, %zu arcs (build %.1f ms, %.1f MB CSR vs %.1f MB MapNode/MapEdge)\n",
+                router.nodeCount(), router.arcCount(), build_ms,
+                router.graph()->memoryBytes() / 1048576.0,
+                (nodes.size() * sizeof(MapNode) + edges.size() * sizeof(MapEdge)) / 1048576.0);
+
+    std::mt19937 rng(seed + 1);
+    std::uniform_int_distribution<uint32_t> pick(0, static_cast<uint32_t>(router.nodeCount() - 1));
+    std::vector<std::pair<uint32_t, uint32_t>> queries;
+    for (int i = 0; i < query_count; ++i) {
+        queries.emplace_back(pick(rng), pick(rng));
+    }
+
+    std::printf("%-22s %12s %10s %10s\n", "algorithm", "settled", "p50 ms", "p99 ms");
+    printRow("dijkstra/distance", runQueries(router, queries, false, RouteMetric::DISTANCE));
+    printRow("astar/distance", runQueries(router, queries, true, RouteMetric::DISTANCE));
+    printRow("dijkstra/time", runQueries(router, queries, false, RouteMetric::TRAVEL_TIME));
+    printRow("astar/time", runQueries(router, queries, true, RouteMetric::TRAVEL_TIME));
+
+    return 0;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+// Shared helpers for the benchmark programs
+
+#include "nav_types.h"
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace nav {
+namespace bench {
+
+// Jittered side x side street grid around Hanoi (~100 m spacing) with
+// random speed limits, detours and 5% one-way streets
+inline void buildGrid(int side, uint32_t seed, std::vector<MapNode>& nodes, std::vector<MapEdge>& edges) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> jitter(-0.2, 0.2);
+    std::uniform_real_distribution<double> detour(1.0, 1.3);
+    const uint8_t speeds[] = {30, 40, 50, 60, 80};
+
+    const double step = 0.0009;
+    const double base_lat = 20.6;
+    const double base_lon = 105.4;
+
+    nodes.clear();
+    edges.clear();
+    nodes.reserve(static_cast<size_t>(side) * side);
+    for (int r = 0; r < side; ++r) {
+        for (int c = 0; c < side; ++c) {
+            const uint32_t id = static_cast<uint32_t>(r * side + c + 1);
+            nodes.emplace_back(id, Point(base_lat + (r + jitter(rng)) * step,
+                                         base_lon + (c + jitter(rng)) * step));
+        }
+    }
+
+    edges.reserve(static_cast<size_t>(side) * side * 2);
+    auto connect = [&](uint32_t a, uint32_t b) {
+        MapEdge e;
+        e.from_node = a;
+        e.to_node = b;
+        e.length_meters = nodes[a - 1].position.distanceTo(nodes[b - 1].position) * detour(rng);
+        e.speed_limit = speeds[rng() % 5];
+        e.flags = (rng() % 20 == 0) ? EDGE_FLAG_ONE_WAY : 0;
+        edges.push_back(e);
+    };
+    for (int r = 0; r < side; ++r) {
+        for (int c = 0; c < side; ++c) {
+            const uint32_t id = static_cast<uint32_t>(r * side + c + 1);
+            if (c + 1 < side) connect(id, id + 1);
+            if (r + 1 < side) connect(id, id + side);
+        }
+    }
+}
+
+inline double percentile(std::vector<double> values, double p) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    const size_t idx = std::min(values.size() - 1, static_cast<size_t>(p * (values.size() - 1) + 0.5));
+    return values[idx];
+}
+
+} // namespace bench
+} // namespace nav
@@ -0,0 +1,155 @@
+// Tile pack benchmark: serving tiles from the mapped pack vs decoding them
+//
+// Usage: tile_pack_benchmark [tiles] [tile_kb] [work_dir]
+// Appends tiles of tile_kb bytes to a fresh pack (the first run), then
+// reopens it the way the map service does on a later run and reads every
+// tile through find(), both from the page cache and after dropping the
+// file's pages with posix_fadvise (close to a cold start after reboot).
+// Compaction of a pack in which a quarter of the tiles were rewritten is
+// timed last.
+
+#include "tile_pack.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace nav;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const int ZOOM = 16;
+const uint32_t ORIGIN_X = 52000;
+const uint32_t ORIGIN_Y = 28000;
+
+// Stand-in for decoding a tile, the cost a pack hit avoids
+void decodeTile(const TileKey& key, std::vector<uint8_t>& data) {
+    uint32_t state = static_cast<uint32_t>(key.pack() * 0x9E3779B97F4A7C15ull >> 32) | 1;
+    for (int pass = 0; pass < 4; ++pass) {
+        for (size_t i = 0; i < data.size(); ++i) {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            data[i] = static_cast<uint8_t>(data[i] + (state >> 24));
+        }
+    }
+}
+
+double msSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+TileKey tileAt(size_t i, size_t side) {
+    return TileKey(ZOOM, ORIGIN_X + static_cast<uint32_t>(i % side), ORIGIN_Y + static_cast<uint32_t>(i / side));
+}
+
+void dropPageCache(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        fdatasync(fd);
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        ::close(fd);
+    }
+}
+
+// Opens the pack and sums one byte per page of every tile; prints the times
+bool readAll(const char* name, const std::string& path, size_t count, size_t side) {
+    const auto start = Clock::now();
+    TilePack pack;
+    if (!pack.open(path)) {
+        std::fprintf(stderr, "%s\n", pack.lastError().c_str());
+        return false;
+    }
+    const double open_ms = msSince(start);
+    uint64_t checksum = 0;
+    size_t found = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const uint8_t* data = nullptr;
+        uint32_t size = 0;
+        if (pack.find(tileAt(i, side), data, size)) {
+            for (uint32_t b = 0; b < size; b += 4096) {
+                checksum += data[b];
+            }
+            ++found;
+        }
+    }
+    const double total_ms = msSince(start);
+    std::printf("%-30s %10.2f %10.1f %10.3f %8zu%s\n", name, open_ms, total_ms, total_ms / count, found,
+                checksum == 0 ? " (zero checksum)" : "");
+    return found == count;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const size_t count = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 5000;
+    const size_t tile_bytes = (argc > 2 ? static_cast<size_t>(std::atol(argv[2])) : 24) * 1024;
+    const std::string dir = argc > 3 ? argv[3] : "/tmp";
+    const std::string path = dir + "/tile_pack_benchmark.pack";
+    size_t side = 1;
+    while (side * side < count) {
+        ++side;
+    }
+
+    std::remove(path.c_str());
+    std::vector<uint8_t> data(tile_bytes);
+    double decode_ms = 0.0;
+    double append_ms = 0.0;
+    {
+        TilePack pack;
+        if (!pack.open(path)) {
+            std::fprintf(stderr, "%s\n", pack.lastError().c_str());
+            return 1;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            const TileKey key = tileAt(i, side);
+            auto start = Clock::now();
+            decodeTile(key, data);
+            decode_ms += msSince(start);
+            start = Clock::now();
+            if (!pack.append(key, data.data(), static_cast<uint32_t>(data.size()))) {
+                std::fprintf(stderr, "%s\n", pack.lastError().c_str());
+                return 1;
+            }
+            append_ms += msSince(start);
+        }
+        std::printf("%zu tiles of %zu KB, pack %.1f MB\n", count, tile_bytes / 1024, pack.fileSize() / 1e6);
+    }
+
+    std::printf("%-30s %10s %10s %10s %8s\n", "path", "open ms", "total ms", "ms/tile", "tiles");
+    std::printf("%-30s %10s %10.1f %10.3f %8zu\n", "decode (first run)", "-", decode_ms, decode_ms / count, count);
+    std::printf("%-30s %10s %10.1f %10.3f %8zu\n", "append to pack (first run)", "-", append_ms, append_ms / count,
+                count);
+    readAll("pack, warm page cache", path, count, side);
+    dropPageCache(path);
+    readAll("pack, pages dropped", path, count, side);
+
+    // Rewrite a quarter of the tiles, then compact the log into the index
+    {
+        TilePack pack;
+        pack.open(path);
+        for (size_t i = 0; i < count; i += 4) {
+            pack.append(tileAt(i, side), data.data(), static_cast<uint32_t>(data.size()));
+        }
+        std::printf("after rewriting 1/4: %.1f MB, %.1f MB stale\n", pack.fileSize() / 1e6, pack.staleBytes() / 1e6);
+    }
+    readAll("pack with log, warm", path, count, side);
+    const auto start = Clock::now();
+    std::string error;
+    if (!TilePack::compact(path, path, &error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    std::printf("compaction: %.1f ms\n", msSince(start));
+    readAll("compacted, warm", path, count, side);
+    dropPageCache(path);
+    readAll("compacted, pages dropped", path, count, side);
+
+    std::remove(path.c_str());
+    return 0;
+}
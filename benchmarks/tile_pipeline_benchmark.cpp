@@ -0,0 +1,232 @@
+// Tile loading benchmark: prioritised worker pool vs one tile per timer tick
+//
+// Usage: tile_pipeline_benchmark [threads] [radius_km] [zoom]
+// Requests every tile within radius_km of Hanoi (as preloadTilesForArea
+// does) and hands results to a consumer thread standing in for the GUI
+// thread. Reports when the centre tile, the visible 1280x720 viewport and
+// the whole area arrive, against the old 100 ms timer that loaded one tile
+// per tick in request order. A second run moves the viewport away while
+// loading to show queued tiles being dropped.
+
+#include "tile_loader.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+using namespace nav;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const Point CENTER(21.0285, 105.8542);
+const int VIEW_WIDTH = 1280;
+const int VIEW_HEIGHT = 720;
+const double OLD_TICK_MS = 100.0;
+const double METERS_PER_DEGREE = 6371000.0 * M_PI / 180.0;
+const BoundingBox WORLD(-90.0, -180.0, 90.0, 180.0);
+
+// Stand-in for decoding a 256x256 RGBA tile
+bool decodeTile(const TileKey& key, std::vector<uint8_t>& data) {
+    data.resize(TileKey::TILE_SIZE * TileKey::TILE_SIZE * 4);
+    uint32_t state = static_cast<uint32_t>(key.pack() * 0x9E3779B97F4A7C15ull >> 32) | 1;
+    for (int pass = 0; pass < 4; ++pass) {
+        for (size_t i = 0; i < data.size(); ++i) {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            data[i] = static_cast<uint8_t>(data[i] + (state >> 24));
+        }
+    }
+    return true;
+}
+
+double msSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+BoundingBox boxAround(const Point& center, double radius_m) {
+    const double dlat = radius_m / METERS_PER_DEGREE;
+    const double dlon = dlat / std::cos(center.latitude * M_PI / 180.0);
+    return BoundingBox(center.latitude - dlat, center.longitude - dlon, center.latitude + dlat, center.longitude + dlon);
+}
+
+TileRange viewportRange(const Point& center, int zoom) {
+    double px, py;
+    mercatorPixel(center, zoom, px, py);
+    const Point north_west = mercatorPoint(px - VIEW_WIDTH / 2.0, py - VIEW_HEIGHT / 2.0, zoom);
+    const Point south_east = mercatorPoint(px + VIEW_WIDTH / 2.0, py + VIEW_HEIGHT / 2.0, zoom);
+    return TileRange::covering(
+        BoundingBox(south_east.latitude, north_west.longitude, north_west.latitude, south_east.longitude), zoom);
+}
+
+// Stand-in for the GUI thread: drains one batch per notification
+class Consumer {
+public:
+    void notify() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++signals_;
+        wake_.notify_one();
+    }
+
+    // Takes batches until every key in wanted has arrived; returns the batch count
+    size_t drain(TileLoader& loader, const std::vector<TileKey>& wanted, const TileKey& center,
+                 const TileRange& visible, Clock::time_point start, double times[3]) {
+        std::unordered_set<uint64_t> missing;
+        size_t visible_missing = 0;
+        for (const TileKey& key : wanted) {
+            missing.insert(key.pack());
+            visible_missing += visible.contains(key) ? 1 : 0;
+        }
+        size_t batches = 0;
+        std::vector<TileResult> results;
+        while (!missing.empty()) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [this]() { return signals_ > 0; });
+                signals_ = 0;
+            }
+            results.clear();
+            if (loader.takeResults(results) == 0) {
+                continue;
+            }
+            ++batches;
+            for (const TileResult& result : results) {
+                if (missing.erase(result.key.pack()) == 0) {
+                    continue;
+                }
+                if (result.key == center) {
+                    times[0] = msSince(start);
+                }
+                if (visible.contains(result.key) && --visible_missing == 0) {
+                    times[1] = msSince(start);
+                }
+            }
+        }
+        times[2] = msSince(start);
+        return batches;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    int signals_ = 0;
+};
+
+void report(const char* name, const double times[3], size_t batches) {
+    std::printf("%-34s %10.1f %10.1f %10.1f %8zu\n", name, times[0], times[1], times[2], batches);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const unsigned threads = argc > 1 ? static_cast<unsigned>(std::atoi(argv[1])) : 0;
+    const double radius_km = argc > 2 ? std::atof(argv[2]) : 10.0;
+    const int zoom = argc > 3 ? std::atoi(argv[3]) : 16;
+
+    std::vector<TileKey> keys;
+    TileRange::around(CENTER, radius_km * 1000.0, zoom).keys(keys);
+    const TileKey center = TileKey::fromPoint(CENTER, zoom);
+    const TileRange visible = viewportRange(CENTER, zoom);
+
+    // Decode cost, and the old pipeline: one tile per 100 ms tick in request order
+    std::vector<uint8_t> data;
+    const auto decode_start = Clock::now();
+    const size_t samples = std::min<size_t>(keys.size(), 200);
+    for (size_t i = 0; i < samples; ++i) {
+        decodeTile(keys[i], data);
+    }
+    const double decode_ms = msSince(decode_start) / samples;
+    double old_times[3] = {0.0, 0.0, 0.0};
+    size_t last_visible = 0;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        if (keys[i] == center) {
+            old_times[0] = (i + 1) * (OLD_TICK_MS + decode_ms);
+        }
+        if (visible.contains(keys[i])) {
+            last_visible = i;
+        }
+    }
+    old_times[1] = (last_visible + 1) * (OLD_TICK_MS + decode_ms);
+    old_times[2] = keys.size() * (OLD_TICK_MS + decode_ms);
+
+    std::printf("%zu tiles within %.1f km at z%d, %zu visible, decode %.2f ms/tile\n", keys.size(), radius_km, zoom,
+                visible.count(), decode_ms);
+    std::printf("%-34s %10s %10s %10s %8s\n", "pipeline", "centre ms", "visible ms", "all ms", "batches");
+    report("timer, 1 tile/100 ms (computed)", old_times, keys.size());
+
+    for (int prioritised = 0; prioritised < 2; ++prioritised) {
+        Consumer consumer;
+        TileLoader loader;
+        loader.setNotifier([&consumer]() { consumer.notify(); });
+        loader.start(decodeTile, threads);
+        if (prioritised) {
+            loader.setViewport(CENTER, WORLD);
+        }
+        const auto start = Clock::now();
+        for (const TileKey& key : keys) {
+            loader.request(key);
+        }
+        double times[3] = {0.0, 0.0, 0.0};
+        const size_t batches = consumer.drain(loader, keys, center, visible, start, times);
+        char name[64];
+        std::snprintf(name, sizeof(name), "pool x%u, %s", loader.threadCount(),
+                      prioritised ? "nearest first" : "no viewport");
+        report(name, times, batches);
+        loader.stop();
+    }
+
+    // Pan 15 km east once a fifth of the area has loaded; queued tiles left behind are dropped
+    {
+        const Point moved(CENTER.latitude, CENTER.longitude + 15000.0 / (METERS_PER_DEGREE * std::cos(CENTER.latitude * M_PI / 180.0)));
+        const double radius_m = radius_km * 1000.0;
+
+        Consumer consumer;
+        TileLoader loader;
+        loader.setNotifier([&consumer]() { consumer.notify(); });
+        loader.start(decodeTile, threads);
+        loader.setViewport(CENTER, WORLD);
+        for (const TileKey& key : keys) {
+            loader.request(key);
+        }
+        while (loader.stats().loaded.load() < keys.size() / 5) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        const auto start = Clock::now();
+        loader.setViewport(moved, boxAround(moved, radius_m));
+        // What the GUI already has stays cached; request the rest of the new area
+        std::vector<TileResult> cached;
+        loader.takeResults(cached);
+        std::unordered_set<uint64_t> have;
+        for (const TileResult& result : cached) {
+            have.insert(result.key.pack());
+        }
+        std::vector<TileKey> area, wanted;
+        TileRange::around(moved, radius_m, zoom).keys(area);
+        for (const TileKey& key : area) {
+            if (have.count(key.pack()) == 0) {
+                loader.request(key);
+                wanted.push_back(key);
+            }
+        }
+        double times[3] = {0.0, 0.0, 0.0};
+        const size_t batches = consumer.drain(loader, wanted, TileKey::fromPoint(moved, zoom),
+                                              viewportRange(moved, zoom), start, times);
+        report("pool, after 15 km pan", times, batches);
+        const TileLoaderStats& stats = loader.stats();
+        std::printf("pan: %zu tiles already loaded, %llu dropped, %llu already queued, %llu decoded in total\n",
+                    cached.size(), static_cast<unsigned long long>(stats.dropped.load()),
+                    static_cast<unsigned long long>(stats.duplicates.load()),
+                    static_cast<unsigned long long>(stats.loaded.load()));
+        loader.stop();
+    }
+    return 0;
+}
@@ -0,0 +1,298 @@
+// Tile prefetch benchmark: viewport tile misses during a simulated drive
+//
+// Usage: tile_prefetch_benchmark [tiles_per_s] [route_km] [zoom]
+// Drives a winding route out of Hanoi at several speeds with 10 Hz position
+// updates and a north-up 1280x720 viewport centred on the vehicle. Tiles
+// come from a model of the tile loader: two workers serving the pending
+// tile nearest the vehicle first, at tiles_per_s between them. Every update
+// requests the visible tiles that are missing (what the map widget does);
+// the strategies differ in what else they request:
+//
+//   on demand           nothing (before: nothing called the preload)
+//   area preload        preloadTilesForArea(position, 2 km) every 1 km
+//   heading prefetch    TilePrefetcher without a route
+//   route prefetch      TilePrefetcher following the route
+//
+// A miss is a visible tile that is not loaded at an update, and a blank
+// update one with any miss; the viewport at the start is loaded beforehand.
+// Wasted tiles were loaded but never shown.
+
+#include "nav_utils.h"
+#include "tile_prefetcher.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <unordered_set>
+#include <vector>
+
+using namespace nav;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const Point START(21.0285, 105.8542);
+const int VIEW_WIDTH = 1280;
+const int VIEW_HEIGHT = 720;
+const uint64_t TICK_MS = 100;
+const int WORKERS = 2;
+const double AREA_PRELOAD_RADIUS_M = 2000.0;
+const double AREA_PRELOAD_EVERY_M = 1000.0;
+
+enum class Strategy { OnDemand, AreaPreload, Heading, Route };
+
+const char* strategyName(Strategy strategy) {
+    switch (strategy) {
+    case Strategy::OnDemand: return "on demand";
+    case Strategy::AreaPreload: return "area preload";
+    case Strategy::Heading: return "heading prefetch";
+    case Strategy::Route: return "route prefetch";
+    }
+    return "";
+}
+
+// Blocks of 150-900 m; mostly straight on, otherwise a turn at a junction
+std::vector<Point> makeRoute(double length_m) {
+    std::vector<Point> shape{START};
+    uint32_t state = 12345;
+    auto next = [&state]() {
+        state = state * 1664525u + 1013904223u;
+        return (state >> 8) / 16777216.0;
+    };
+    double heading = 45.0;
+    double driven = 0.0;
+    while (driven < length_m) {
+        const double block = 150.0 + next() * 750.0;
+        const double r = next();
+        if (r < 0.25) {
+            heading += 90.0;
+        } else if (r < 0.5) {
+            heading -= 90.0;
+        } else {
+            heading += (next() - 0.5) * 20.0;
+        }
+        heading = NavUtils::normalizeAngle(heading);
+        shape.push_back(NavUtils::projectPoint(shape.back(), heading, block));
+        driven += block;
+    }
+    return shape;
+}
+
+// Vehicle position along the route shape
+struct Vehicle {
+    const std::vector<Point>& shape;
+    std::vector<double> distance;
+    size_t segment = 0;
+
+    explicit Vehicle(const std::vector<Point>& route) : shape(route), distance(route.size(), 0.0) {
+        for (size_t i = 1; i < shape.size(); ++i) {
+            distance[i] = distance[i - 1] + NavUtils::haversineDistance(shape[i - 1], shape[i]);
+        }
+    }
+
+    double length() const { return distance.back(); }
+
+    Point at(double s, double& heading) {
+        while (segment + 2 < shape.size() && distance[segment + 1] < s) {
+            ++segment;
+        }
+        const double t = (s - distance[segment]) / (distance[segment + 1] - distance[segment]);
+        heading = NavUtils::calculateBearing(shape[segment], shape[segment + 1]);
+        return Point(shape[segment].latitude + (shape[segment + 1].latitude - shape[segment].latitude) * t,
+                     shape[segment].longitude + (shape[segment + 1].longitude - shape[segment].longitude) * t);
+    }
+};
+
+void visibleTiles(const Point& center, int zoom, std::vector<TileKey>& out) {
+    double px, py;
+    mercatorPixel(center, zoom, px, py);
+    const uint32_t x0 = static_cast<uint32_t>((px - VIEW_WIDTH / 2) / TileKey::TILE_SIZE);
+    const uint32_t x1 = static_cast<uint32_t>((px + VIEW_WIDTH / 2) / TileKey::TILE_SIZE);
+    const uint32_t y0 = static_cast<uint32_t>((py - VIEW_HEIGHT / 2) / TileKey::TILE_SIZE);
+    const uint32_t y1 = static_cast<uint32_t>((py + VIEW_HEIGHT / 2) / TileKey::TILE_SIZE);
+    out.clear();
+    for (uint32_t y = y0; y <= y1; ++y) {
+        for (uint32_t x = x0; x <= x1; ++x) {
+            out.emplace_back(zoom, x, y);
+        }
+    }
+}
+
+// Loader model: workers take the pending tile nearest the vehicle
+class LoaderModel {
+public:
+    explicit LoaderModel(double tiles_per_s) : tile_ms_(WORKERS * 1000.0 / tiles_per_s), workers_(WORKERS) {}
+
+    bool known(uint64_t key) const { return loaded_.count(key) || pending_.count(key) || running_.count(key); }
+    bool loaded(uint64_t key) const { return loaded_.count(key) != 0; }
+    const std::unordered_set<uint64_t>& loadedTiles() const { return loaded_; }
+
+    void request(const TileKey& key) {
+        if (!known(key.pack())) {
+            pending_.insert(key.pack());
+        }
+    }
+    void preload(const TileKey& key) { loaded_.insert(key.pack()); }
+
+    void advance(double now_ms, const Point& focus, int zoom) {
+        double fx, fy;
+        mercatorPixel(focus, zoom, fx, fy);
+        fx /= TileKey::TILE_SIZE;
+        fy /= TileKey::TILE_SIZE;
+        for (Worker& worker : workers_) {
+            // Hand over a finished tile and start the next one
+            while (true) {
+                if (worker.busy) {
+                    if (worker.done_ms > now_ms) {
+                        break;
+                    }
+                    loaded_.insert(worker.key);
+                    running_.erase(worker.key);
+                    worker.busy = false;
+                }
+                if (pending_.empty()) {
+                    break;
+                }
+                auto best = pending_.begin();
+                double best_d = 1e300;
+                for (auto it = pending_.begin(); it != pending_.end(); ++it) {
+                    const TileKey key = TileKey::unpack(*it);
+                    const double dx = key.x + 0.5 - fx;
+                    const double dy = key.y + 0.5 - fy;
+                    const double d = dx * dx + dy * dy;
+                    if (d < best_d) {
+                        best_d = d;
+                        best = it;
+                    }
+                }
+                worker.key = *best;
+                worker.busy = true;
+                worker.done_ms = now_ms + tile_ms_;
+                running_.insert(*best);
+                pending_.erase(best);
+            }
+        }
+    }
+
+private:
+    struct Worker {
+        bool busy = false;
+        uint64_t key = 0;
+        double done_ms = 0.0;
+    };
+
+    double tile_ms_;
+    std::vector<Worker> workers_;
+    std::unordered_set<uint64_t> pending_;
+    std::unordered_set<uint64_t> running_;
+    std::unordered_set<uint64_t> loaded_;
+};
+
+struct Result {
+    uint64_t visible = 0;
+    uint64_t missed = 0;
+    uint64_t updates = 0;
+    uint64_t blank_updates = 0;
+    size_t loaded = 0;
+    size_t wasted = 0;
+    uint64_t prefetched = 0;
+    uint64_t throttled = 0;
+    double update_us = 0.0;
+};
+
+Result drive(const std::vector<Point>& route, Strategy strategy, double speed_kmh, double tiles_per_s, int zoom) {
+    Vehicle vehicle(route);
+    LoaderModel loader(tiles_per_s);
+    TilePrefetchSettings settings;
+    settings.zoom = zoom;
+    TilePrefetcher prefetcher(settings);
+    // Ground size of the viewport at the start latitude
+    const double meters_per_pixel = 2.0 * M_PI * 6371000.0 * std::cos(START.latitude * M_PI / 180.0) /
+                                    (TileKey::TILE_SIZE * TileKey::tilesPerSide(zoom));
+    prefetcher.setViewSize(VIEW_WIDTH * meters_per_pixel, VIEW_HEIGHT * meters_per_pixel);
+    if (strategy == Strategy::Route) {
+        prefetcher.setRoute(route);
+    }
+
+    Result result;
+    std::unordered_set<uint64_t> shown;
+    std::vector<TileKey> visible;
+    std::vector<TileKey> wanted;
+    visibleTiles(START, zoom, visible);
+    for (const TileKey& key : visible) {
+        loader.preload(key);
+    }
+
+    const double step_m = speed_kmh / 3.6 * TICK_MS / 1000.0;
+    double next_area_m = 0.0;
+    uint64_t now_ms = 1000;
+    for (double s = 0.0; s < vehicle.length(); s += step_m, now_ms += TICK_MS) {
+        double heading = 0.0;
+        const Point position = vehicle.at(s, heading);
+
+        wanted.clear();
+        const auto start = Clock::now();
+        if (strategy == Strategy::Heading || strategy == Strategy::Route) {
+            prefetcher.update(position, heading, speed_kmh, now_ms, wanted);
+        } else if (strategy == Strategy::AreaPreload && s >= next_area_m) {
+            TileRange::around(position, AREA_PRELOAD_RADIUS_M, zoom).keys(wanted);
+            next_area_m = s + AREA_PRELOAD_EVERY_M;
+        }
+        result.update_us += std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+        // The map widget asks for what is on screen, then the prefetch follows
+        visibleTiles(position, zoom, visible);
+        bool blank = false;
+        for (const TileKey& key : visible) {
+            shown.insert(key.pack());
+            ++result.visible;
+            if (!loader.loaded(key.pack())) {
+                ++result.missed;
+                blank = true;
+                loader.request(key);
+            }
+        }
+        for (const TileKey& key : wanted) {
+            loader.request(key);
+        }
+        result.blank_updates += blank ? 1 : 0;
+        ++result.updates;
+        loader.advance(static_cast<double>(now_ms), position, zoom);
+    }
+
+    result.loaded = loader.loadedTiles().size();
+    for (uint64_t key : loader.loadedTiles()) {
+        result.wasted += shown.count(key) ? 0 : 1;
+    }
+    result.prefetched = prefetcher.stats().requested;
+    result.throttled = prefetcher.stats().throttled;
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const double tiles_per_s = argc > 1 ? std::atof(argv[1]) : 8.0;
+    const double route_km = argc > 2 ? std::atof(argv[2]) : 40.0;
+    const int zoom = argc > 3 ? std::atoi(argv[3]) : 16;
+
+    const std::vector<Point> route = makeRoute(route_km * 1000.0);
+    std::printf("route %.1f km, %zu points, zoom %d, loader %.1f tiles/s, %d ms updates\n", route_km, route.size(),
+                zoom, tiles_per_s, static_cast<int>(TICK_MS));
+    std::printf("%6s %-18s %9s %10s %8s %8s %10s %10s %10s\n", "km/h", "strategy", "miss %", "blank %", "loaded",
+                "wasted", "prefetched", "throttled", "us/update");
+    const double speeds[] = {30.0, 60.0, 100.0};
+    const Strategy strategies[] = {Strategy::OnDemand, Strategy::AreaPreload, Strategy::Heading, Strategy::Route};
+    for (double speed : speeds) {
+        for (Strategy strategy : strategies) {
+            const Result r = drive(route, strategy, speed, tiles_per_s, zoom);
+            std::printf("%6.0f %-18s %9.2f %10.2f %8zu %8zu %10llu %10llu %10.2f\n", speed, strategyName(strategy),
+                        100.0 * r.missed / r.visible, 100.0 * r.blank_updates / r.updates, r.loaded, r.wasted,
+                        static_cast<unsigned long long>(r.prefetched),
+                        static_cast<unsigned long long>(r.throttled), r.update_us / r.updates);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace nav {
+
+/**
+ * @brief Read-only view of a contiguous array (owned vector or mapped file)
+ *
+ * Lets containers point either at their own std::vector storage or directly
+ * into a memory-mapped file without copying. The view does not own memory;
+ * the owner must outlive it.
+ */
+template<typename T>
+class ArrayView {
+public:
+    ArrayView() : data_(nullptr), size_(0) {}
+    ArrayView(const T* data, size_t size) : data_(data), size_(size) {}
+    ArrayView(const std::vector<T>& v) : data_(v.data()), size_(v.size()) {}
+
+    const T& operator[](size_t i) const { return data_[i]; }
+    const T* data() const { return data_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    const T* begin() const { return data_; }
+    const T* end() const { return data_ + size_; }
+    size_t byteSize() const { return size_ * sizeof(T); }
+
+private:
+    const T* data_;
+    size_t size_;
+};
+
+} // namespace nav
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "nav_types.h"
+#include "indexed_heap.h"
+#include "road_graph.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace nav {
+
+// Edge cost used by the route search
+enum class RouteMetric : uint8_t {
+    DISTANCE = 0,    // Metres
+    TRAVEL_TIME = 1  // Milliseconds at the edge speed limit
+};
+
+// Counters for the most recent query (used for benchmarking)
+struct RouteQueryStats {
+    uint32_t settled_nodes;
+    uint32_t relaxed_edges;
+    double query_time_ms;
+
+    RouteQueryStats() : settled_nodes(0), relaxed_edges(0), query_time_ms(0.0) {}
+};
+
+/**
+ * @brief A* point-to-point router over a RoadGraph
+ *
+ * The graph is shared read-only, so several routers and other services can
+ * walk the same CSR arrays. All per-query state (tentative costs, parents,
+ * the indexed heap) lives in flat arrays sized to the node count and is
+ * reused between queries; a visit stamp avoids clearing the arrays before
+ * each search. The heuristic is the haversine
+ * distance to the target (divided by the fastest speed in the graph for the
+ * travel-time metric), which never overestimates, so paths are optimal.
+ *
+ * Not thread-safe: one router instance serves one query at a time. A
+ * search can be abandoned from another thread through the cancel flag.
+ */
+class AStarRouter {
+public:
+    static constexpr uint32_t INVALID_NODE = 0xFFFFFFFFu;
+    static constexpr uint32_t INFINITE_COST = 0xFFFFFFFFu;
+
+    AStarRouter();
+
+    // Route over an existing graph (may be shared with other readers)
+    void setGraph(std::shared_ptr<const RoadGraph> graph);
+    std::shared_ptr<const RoadGraph> graph() const { return graph_; }
+
+    // Convenience: build a new RoadGraph from MapNode/MapEdge and use it
+    bool build(const std::vector<MapNode>& nodes, const std::vector<MapEdge>& edges);
+    void clear();
+
+    size_t nodeCount() const { return graph_ ? graph_->nodeCount() : 0; }
+    size_t arcCount() const { return graph_ ? graph_->arcCount() : 0; }
+    bool empty() const { return nodeCount() == 0; }
+
+    // Dense index of the graph node closest to a point, or INVALID_NODE
+    uint32_t findNearestNode(const Point& point) const;
+
+    // Original MapNode id / position of a dense index
+    uint32_t nodeId(uint32_t index) const { return graph_->nodeId(index); }
+    Point nodePosition(uint32_t index) const { return graph_->position(index); }
+
+    // Shortest path between dense indices. With use_heuristic=false this is
+    // plain Dijkstra. Returns false if target is unreachable.
+    bool findPath(uint32_t source, uint32_t target, RouteMetric metric,
+                  bool use_heuristic, std::vector<uint32_t>& path);
+
+    // Snap start/end to the graph, search and fill a Route with MapNode ids
+    bool calculateRoute(const Point& start, const Point& end, RouteMetric metric, Route& route,
+                        bool use_heuristic = true);
+
+    // Sum length (m) and travel time (s) along a path of dense indices
+    void measurePath(const std::vector<uint32_t>& path, double& length_m, double& time_s) const;
+
+    const RouteQueryStats& lastQueryStats() const { return stats_; }
+
+    // Polled every few hundred settled nodes; a set flag ends the search
+    // with no path. The flag must outlive the queries that use it.
+    void setCancelFlag(const std::atomic<bool>* flag) { cancel_flag_ = flag; }
+
+private:
+    static constexpr uint32_t CANCEL_CHECK_MASK = 0xFF;
+
+    uint32_t arcCost(uint32_t arc, RouteMetric metric) const {
+        return metric == RouteMetric::DISTANCE ? graph_->arcLength(arc) : graph_->arcTravelTimeMs(arc);
+    }
+    uint32_t heuristic(uint32_t node, uint32_t target, RouteMetric metric) const;
+    void beginQuery();
+
+    std::shared_ptr<const RoadGraph> graph_;
+    std::vector<float> cos_lat_;  // Per node, for the haversine heuristic
+    double max_speed_mps_;
+
+    // Per-query scratch, reused across queries
+    IndexedDaryHeap<uint32_t, 4> heap_;
+    std::vector<uint32_t> cost_;
+    std::vector<uint32_t> parent_;
+    std::vector<uint32_t> visit_stamp_;
+    uint32_t current_stamp_;
+    RouteQueryStats stats_;
+    const std::atomic<bool>* cancel_flag_;
+};
+
+} // namespace nav
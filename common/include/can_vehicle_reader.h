@@ -0,0 +1,84 @@
+#pragma once
+
+#include "nav_types.h"
+#include "nav_utils.h"
+#include "spsc_queue.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+
+namespace nav {
+
+// Reader counters (updated by the reader thread, safe to read anywhere)
+struct CanReaderStats {
+    std::atomic<uint64_t> wakeups;         // epoll_wait returns with the socket readable
+    std::atomic<uint64_t> batches;         // receiveFrames calls that returned frames
+    std::atomic<uint64_t> frames;          // Frames received (all pass the kernel filter)
+    std::atomic<uint64_t> samples;         // VehicleData pushed to the queue
+    std::atomic<uint64_t> dropped_samples; // Queue full
+    std::atomic<uint64_t> read_errors;
+
+    CanReaderStats() : wakeups(0), batches(0), frames(0), samples(0), dropped_samples(0), read_errors(0) {}
+};
+
+/**
+ * @brief Vehicle CAN ingestion on an epoll-driven reader thread
+ *
+ * Sleeps in epoll_wait on the filtered CAN socket plus an eventfd used to
+ * stop it, then drains the socket in recvmmsg batches. Every decoded speed
+ * or yaw-rate frame updates one VehicleData (stamped with the frame's kernel
+ * receive time), and a copy is pushed to a lock-free SPSC queue; the
+ * notifier runs on the reader thread after each batch that pushed samples.
+ *
+ * Linux only (epoll/eventfd); start() fails elsewhere and callers can poll
+ * CanInterface::readVehicleData instead.
+ */
+class CanVehicleReader {
+public:
+    static constexpr size_t QUEUE_CAPACITY = 256;
+    using SampleQueue = SpscQueue<VehicleData, QUEUE_CAPACITY>;
+
+    CanVehicleReader();
+    ~CanVehicleReader();
+    CanVehicleReader(const CanVehicleReader&) = delete;
+    CanVehicleReader& operator=(const CanVehicleReader&) = delete;
+
+    bool open(const std::string& can_device);
+    void close();
+    bool isOpen() const { return can_.isConnected(); }
+    bool hasKernelTimestamps() const { return can_.hasKernelTimestamps(); }
+
+    // Called on the reader thread after a batch; set before start()
+    void setNotifier(std::function<void()> notifier) { notifier_ = std::move(notifier); }
+
+    bool start();
+    void stop();
+    bool isRunning() const { return running_.load(std::memory_order_acquire); }
+
+    // Consumer side
+    bool popSample(VehicleData& sample) { return queue_.tryPop(sample); }
+
+    const CanReaderStats& stats() const { return stats_; }
+
+private:
+    void run();
+    void drainSocket();
+
+    CanInterface can_;
+    int epoll_fd_;
+    int stop_fd_;
+
+    std::thread thread_;
+    std::atomic<bool> running_;
+    std::function<void()> notifier_;
+
+    // Reader thread only
+    VehicleData state_;
+
+    SampleQueue queue_;
+    CanReaderStats stats_;
+};
+
+} // namespace nav
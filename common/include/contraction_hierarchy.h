@@ -0,0 +1,186 @@
+#pragma once
+
+#include "array_view.h"
+#include "astar_router.h"
+#include "road_graph.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace nav {
+
+class MapFile;
+class MapFileWriter;
+
+// Preprocessing counters
+struct CHBuildStats {
+    uint32_t shortcuts;
+    uint32_t witness_searches;
+    double build_time_ms;
+
+    CHBuildStats() : shortcuts(0), witness_searches(0), build_time_ms(0.0) {}
+};
+
+/**
+ * @brief Contraction Hierarchy over a RoadGraph for one metric
+ *
+ * Nodes are contracted one at a time in order of importance (edge
+ * difference plus contracted neighbours, updated lazily). Contracting v
+ * adds a shortcut u -> w for each pair of neighbours whose shortest path
+ * runs through v, unless a bounded witness search finds an equally short
+ * path around it. The result keeps only "upward" arcs:
+ *
+ *   up(v)    arcs v -> w with rank(w) > rank(v)   (forward search)
+ *   down(v)  arcs u -> v with rank(u) > rank(v)   (backward search, head = u)
+ *
+ * Each arc records the contracted middle node of its shortcut (or
+ * INVALID_NODE for an original road arc), so a path is unpacked by
+ * recursively expanding shortcuts at their middle nodes.
+ *
+ * Like RoadGraph, the arrays are either built in memory or attached in place
+ * from the CH sections of a memory-mapped map file.
+ */
+class ContractionHierarchy {
+public:
+    static constexpr uint32_t INVALID_NODE = RoadGraph::INVALID_NODE;
+
+    ContractionHierarchy();
+    ContractionHierarchy(const ContractionHierarchy&) = delete;
+    ContractionHierarchy& operator=(const ContractionHierarchy&) = delete;
+
+    // Contract the graph (offline / map install time). Slow and superlinear on
+    // grid-like networks: about 9 s (time) and 30 s (distance) for the 40k
+    // node grid of ch_benchmark, so minutes or more for a regional map
+    bool build(const RoadGraph& graph, RouteMetric metric);
+
+    // Use the CH sections of an open map file for the given metric
+    bool attach(std::shared_ptr<const MapFile> file, RouteMetric metric);
+
+    void clear();
+
+    bool empty() const { return rank_.empty(); }
+    RouteMetric metric() const { return metric_; }
+    uint32_t nodeCount() const { return static_cast<uint32_t>(rank_.size()); }
+    uint32_t rank(uint32_t node) const { return rank_[node]; }
+
+    // Upward arcs out of a node
+    uint32_t upBegin(uint32_t node) const { return up_first_[node]; }
+    uint32_t upEnd(uint32_t node) const { return up_first_[node + 1]; }
+    uint32_t upHead(uint32_t arc) const { return up_head_[arc]; }
+    uint32_t upCost(uint32_t arc) const { return up_cost_[arc]; }
+    uint32_t upMiddle(uint32_t arc) const { return up_middle_[arc]; }
+
+    // Arcs into a node from higher-ranked nodes (head is the tail node)
+    uint32_t downBegin(uint32_t node) const { return down_first_[node]; }
+    uint32_t downEnd(uint32_t node) const { return down_first_[node + 1]; }
+    uint32_t downHead(uint32_t arc) const { return down_head_[arc]; }
+    uint32_t downCost(uint32_t arc) const { return down_cost_[arc]; }
+    uint32_t downMiddle(uint32_t arc) const { return down_middle_[arc]; }
+
+    uint32_t upArcCount() const { return static_cast<uint32_t>(up_head_.size()); }
+    uint32_t downArcCount() const { return static_cast<uint32_t>(down_head_.size()); }
+
+    // Append the nodes of arc from -> to (excluding 'from') after expanding shortcuts
+    void unpackArc(uint32_t from, uint32_t to, uint32_t middle, std::vector<uint32_t>& path) const;
+
+    const CHBuildStats& buildStats() const { return build_stats_; }
+
+    // Heap bytes owned by the hierarchy (zero when mapped)
+    size_t memoryBytes() const;
+
+private:
+    friend class MapFileWriter;
+
+    struct Storage {
+        std::vector<uint32_t> rank;
+        std::vector<uint32_t> up_first;
+        std::vector<uint32_t> up_head;
+        std::vector<uint32_t> up_cost;
+        std::vector<uint32_t> up_middle;
+        std::vector<uint32_t> down_first;
+        std::vector<uint32_t> down_head;
+        std::vector<uint32_t> down_cost;
+        std::vector<uint32_t> down_middle;
+    };
+
+    void bindStorage();
+
+    // Middle node of the arc from -> to (one of them is 'at', the lower rank)
+    uint32_t findMiddle(uint32_t from, uint32_t to) const;
+
+    RouteMetric metric_;
+
+    ArrayView<uint32_t> rank_;
+    ArrayView<uint32_t> up_first_;
+    ArrayView<uint32_t> up_head_;
+    ArrayView<uint32_t> up_cost_;
+    ArrayView<uint32_t> up_middle_;
+    ArrayView<uint32_t> down_first_;
+    ArrayView<uint32_t> down_head_;
+    ArrayView<uint32_t> down_cost_;
+    ArrayView<uint32_t> down_middle_;
+
+    CHBuildStats build_stats_;
+
+    std::unique_ptr<Storage> storage_;
+    std::shared_ptr<const MapFile> file_;
+};
+
+/**
+ * @brief Bidirectional upward query over a ContractionHierarchy
+ *
+ * Forward search from the source over up() arcs, backward search from the
+ * target over down() arcs, alternating by smallest key; a direction stops
+ * once its queue minimum reaches the best meeting cost. Nodes reached
+ * sub-optimally are pruned with stall-on-demand. Scratch state is reused
+ * between queries as in AStarRouter; not thread-safe.
+ */
+class CHRouter {
+public:
+    static constexpr uint32_t INVALID_NODE = RoadGraph::INVALID_NODE;
+    static constexpr uint32_t INFINITE_COST = 0xFFFFFFFFu;
+
+    CHRouter();
+
+    // The hierarchy must have been built over this graph
+    void setHierarchy(std::shared_ptr<const RoadGraph> graph, std::shared_ptr<const ContractionHierarchy> ch);
+    std::shared_ptr<const ContractionHierarchy> hierarchy() const { return ch_; }
+    bool empty() const { return !ch_ || ch_->empty(); }
+    RouteMetric metric() const { return ch_ ? ch_->metric() : RouteMetric::TRAVEL_TIME; }
+
+    // Shortest path between dense indices, shortcuts fully unpacked
+    bool findPath(uint32_t source, uint32_t target, std::vector<uint32_t>& path);
+
+    // Cost of the shortest path (metres or ms), or INFINITE_COST
+    uint32_t lastCost() const { return best_cost_; }
+
+    // Snap start/end to the graph, search and fill a Route with MapNode ids
+    bool calculateRoute(const Point& start, const Point& end, Route& route);
+
+    const RouteQueryStats& lastQueryStats() const { return stats_; }
+
+private:
+    struct Side {
+        IndexedDaryHeap<uint32_t, 4> heap;
+        std::vector<uint32_t> cost;
+        std::vector<uint32_t> parent;
+        std::vector<uint32_t> parent_middle;
+        std::vector<uint32_t> stamp;
+    };
+
+    void resetSide(Side& side, uint32_t n);
+    bool reached(const Side& side, uint32_t node) const { return side.stamp[node] == current_stamp_; }
+    void settle(Side& side, const Side& other, bool forward);
+
+    std::shared_ptr<const RoadGraph> graph_;
+    std::shared_ptr<const ContractionHierarchy> ch_;
+
+    Side forward_;
+    Side backward_;
+    uint32_t current_stamp_;
+    uint32_t best_cost_;
+    uint32_t meeting_node_;
+    RouteQueryStats stats_;
+};
+
+} // namespace nav
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "nav_types.h"
+#include "nmea_framer.h"
+#include "spsc_queue.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+
+namespace nav {
+
+// Reader counters (updated by the reader thread, safe to read anywhere)
+struct GpsReaderStats {
+    std::atomic<uint64_t> bytes;
+    std::atomic<uint64_t> sentences;
+    std::atomic<uint64_t> rejected_sentences;  // Bad checksum, unknown type or no fix
+    std::atomic<uint64_t> fixes;               // GpsData pushed to the queue, one per epoch
+    std::atomic<uint64_t> dropped_fixes;       // Queue full
+    std::atomic<uint64_t> read_errors;
+
+    GpsReaderStats() : bytes(0), sentences(0), rejected_sentences(0), fixes(0), dropped_fixes(0), read_errors(0) {}
+};
+
+/**
+ * @brief Serial GPS ingestion on a dedicated reader thread
+ *
+ * Opens the receiver's tty raw and non-blocking, poll()s it and reads
+ * straight into an NmeaFramer ring. Each framed sentence is parsed into one
+ * GpsData that accumulates the epoch. An epoch is the set of RMC/GGA
+ * sentences with the same UTC time; once all the position sentences the
+ * receiver sends are in, or the next epoch starts first, one copy is pushed
+ * to a lock-free SPSC queue for the consumer. The
+ * optional notifier runs on the reader thread after a push so the consumer
+ * can schedule a drain (e.g. a queued call into the Qt thread).
+ *
+ * Works on any tty, including the slave side of a pty pair for testing.
+ * POSIX only (Linux, QNX); open() fails elsewhere.
+ */
+class GpsSerialReader {
+public:
+    static constexpr size_t QUEUE_CAPACITY = 64;
+    using FixQueue = SpscQueue<GpsData, QUEUE_CAPACITY>;
+
+    GpsSerialReader();
+    ~GpsSerialReader();
+    GpsSerialReader(const GpsSerialReader&) = delete;
+    GpsSerialReader& operator=(const GpsSerialReader&) = delete;
+
+    // Configure the tty (8N1, raw, no flow control); false with lastError() set
+    bool open(const std::string& device, int baud_rate);
+    void close();
+    bool isOpen() const { return fd_ >= 0; }
+
+    // Called on the reader thread after each push; set before start()
+    void setNotifier(std::function<void()> notifier) { notifier_ = std::move(notifier); }
+
+    bool start();
+    void stop();
+    bool isRunning() const { return running_.load(std::memory_order_acquire); }
+
+    // Consumer side
+    bool popFix(GpsData& fix) { return queue_.tryPop(fix); }
+
+    const GpsReaderStats& stats() const { return stats_; }
+    const std::string& lastError() const { return error_; }
+
+private:
+    void run();
+    void processSentences();
+    void publish();
+
+    int fd_;
+    std::string device_;
+    std::string error_;
+
+    std::thread thread_;
+    std::atomic<bool> running_;
+    std::function<void()> notifier_;
+
+    // Reader thread only
+    NmeaFramer framer_;
+    GpsData epoch_;
+    int32_t epoch_time_ms_;       // UTC time of the epoch in epoch_, -1 if none
+    uint8_t epoch_seen_;          // Position sentences seen this epoch
+    uint8_t epoch_expected_;      // Position sentences the receiver has sent so far
+    bool epoch_published_;
+
+    FixQueue queue_;
+    GpsReaderStats stats_;
+};
+
+} // namespace nav
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace nav {
+
+/**
+ * @brief Indexed d-ary min-heap keyed by dense element ids
+ *
+ * Element ids must be in [0, capacity). The position of every element is
+ * tracked in a flat array so decreaseKey() is O(log_d n) without searching.
+ * The heap is meant to be allocated once per graph and reused across
+ * queries: clear() only touches the elements that are still queued.
+ */
+template<typename Key, unsigned Arity = 4>
+class IndexedDaryHeap {
+    static_assert(Arity >= 2, "Heap arity must be at least 2");
+
+public:
+    static constexpr uint32_t NOT_IN_HEAP = std::numeric_limits<uint32_t>::max();
+
+    explicit IndexedDaryHeap(size_t capacity = 0) {
+        resize(capacity);
+    }
+
+    // Change the id range; drops all queued elements
+    void resize(size_t capacity) {
+        heap_.clear();
+        heap_.reserve(capacity);
+        position_.assign(capacity, NOT_IN_HEAP);
+    }
+
+    size_t capacity() const { return position_.size(); }
+    size_t size() const { return heap_.size(); }
+    bool empty() const { return heap_.empty(); }
+
+    bool contains(uint32_t id) const {
+        return position_[id] != NOT_IN_HEAP;
+    }
+
+    Key key(uint32_t id) const {
+        return heap_[position_[id]].key;
+    }
+
+    uint32_t minId() const { return heap_.front().id; }
+    Key minKey() const { return heap_.front().key; }
+
+    void push(uint32_t id, Key key) {
+        const uint32_t pos = static_cast<uint32_t>(heap_.size());
+        heap_.push_back(Entry{key, id});
+        position_[id] = pos;
+        siftUp(pos);
+    }
+
+    // Lower the key of a queued element; larger keys are ignored
+    void decreaseKey(uint32_t id, Key key) {
+        const uint32_t pos = position_[id];
+        if (key < heap_[pos].key) {
+            heap_[pos].key = key;
+            siftUp(pos);
+        }
+    }
+
+    // Insert or decrease; returns true if the element's key changed
+    bool pushOrDecrease(uint32_t id, Key key) {
+        const uint32_t pos = position_[id];
+        if (pos == NOT_IN_HEAP) {
+            push(id, key);
+            return true;
+        }
+        if (key < heap_[pos].key) {
+            heap_[pos].key = key;
+            siftUp(pos);
+            return true;
+        }
+        return false;
+    }
+
+    // Set the key of a queued element in either direction
+    void updateKey(uint32_t id, Key key) {
+        const uint32_t pos = position_[id];
+        const Key old = heap_[pos].key;
+        heap_[pos].key = key;
+        if (key < old) {
+            siftUp(pos);
+        } else {
+            siftDown(pos);
+        }
+    }
+
+    uint32_t popMin() {
+        const uint32_t top = heap_.front().id;
+        position_[top] = NOT_IN_HEAP;
+
+        const Entry last = heap_.back();
+        heap_.pop_back();
+        if (!heap_.empty()) {
+            heap_[0] = last;
+            position_[last.id] = 0;
+            siftDown(0);
+        }
+        return top;
+    }
+
+    // Remove all queued elements in O(size), leaving capacity untouched
+    void clear() {
+        for (const Entry& e : heap_) {
+            position_[e.id] = NOT_IN_HEAP;
+        }
+        heap_.clear();
+    }
+
+private:
+    struct Entry {
+        Key key;
+        uint32_t id;
+    };
+
+    void siftUp(uint32_t pos) {
+        const Entry moving = heap_[pos];
+        while (pos > 0) {
+            const uint32_t parent = (pos - 1) / Arity;
+            if (!(moving.key < heap_[parent].key)) {
+                break;
+            }
+            heap_[pos] = heap_[parent];
+            position_[heap_[pos].id] = pos;
+            pos = parent;
+        }
+        heap_[pos] = moving;
+        position_[moving.id] = pos;
+    }
+
+    void siftDown(uint32_t pos) {
+        const Entry moving = heap_[pos];
+        const uint32_t count = static_cast<uint32_t>(heap_.size());
+        for (;;) {
+            const uint32_t first = pos * Arity + 1;
+            if (first >= count) {
+                break;
+            }
+            const uint32_t last = (first + Arity < count) ? first + Arity : count;
+            uint32_t best = first;
+            for (uint32_t c = first + 1; c < last; ++c) {
+                if (heap_[c].key < heap_[best].key) {
+                    best = c;
+                }
+            }
+            if (!(heap_[best].key < moving.key)) {
+                break;
+            }
+            heap_[pos] = heap_[best];
+            position_[heap_[pos].id] = pos;
+            pos = best;
+        }
+        heap_[pos] = moving;
+        position_[moving.id] = pos;
+    }
+
+    std::vector<Entry> heap_;
+    std::vector<uint32_t> position_;
+};
+
+} // namespace nav
@@ -0,0 +1,212 @@
+#pragma once
+
+#include "nav_types.h"
+#include "array_view.h"
+#include "road_graph.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace nav {
+
+class ContractionHierarchy;
+
+/*
+ * Binary map container (map.data)
+ *
+ * Layout (little-endian, all sections page aligned):
+ *
+ *   page 0      MapFileHeader: magic, version, counts, grid parameters,
+ *               section table and a CRC32 over the header itself
+ *   page 1..    one section per array, each starting on a page boundary
+ *
+ * Optional sections hold contraction hierarchies (see contraction_hierarchy.h).
+ * Sections are stored in exactly the in-memory layout used by RoadGraph,
+ * so opening a file is an mmap plus a header check: no parsing, no copies,
+ * and cold pages are only read from flash when a query touches them.
+ * Per-section CRC32s are recorded for offline verification (verify()).
+ */
+
+constexpr char MAP_FILE_MAGIC[8] = {'N', 'A', 'V', 'M', 'A', 'P', '\r', '\n'};
+constexpr uint32_t MAP_FILE_VERSION = 1;
+constexpr uint32_t MAP_FILE_PAGE_SIZE = 4096;
+constexpr uint32_t MAP_FILE_MAX_SECTIONS = 32;
+
+enum class MapSectionType : uint32_t {
+    NONE = 0,
+
+    // Graph
+    ARC_FIRST_OUT = 1,
+    ARC_HEAD = 2,
+    ARC_LENGTH = 3,
+    ARC_SPEED = 4,
+    ARC_FLAGS = 5,
+
+    // Coordinates and node ids
+    NODE_IDS = 10,
+    NODE_LAT_E7 = 11,
+    NODE_LON_E7 = 12,
+    NODE_ID_INDEX = 13,
+
+    // Spatial index over nodes
+    GRID_CELL_FIRST = 20,
+    GRID_CELL_NODES = 21,
+
+    // Points of interest
+    POI_RECORDS = 30,
+    POI_STRINGS = 31,
+
+    // Contraction hierarchy, travel-time metric
+    CH_TIME_RANK = 40,
+    CH_TIME_UP_FIRST = 41,
+    CH_TIME_UP_HEAD = 42,
+    CH_TIME_UP_COST = 43,
+    CH_TIME_UP_MIDDLE = 44,
+    CH_TIME_DOWN_FIRST = 45,
+    CH_TIME_DOWN_HEAD = 46,
+    CH_TIME_DOWN_COST = 47,
+    CH_TIME_DOWN_MIDDLE = 48,
+
+    // Contraction hierarchy, distance metric (same layout)
+    CH_DISTANCE_RANK = 50,
+    CH_DISTANCE_UP_FIRST = 51,
+    CH_DISTANCE_UP_HEAD = 52,
+    CH_DISTANCE_UP_COST = 53,
+    CH_DISTANCE_UP_MIDDLE = 54,
+    CH_DISTANCE_DOWN_FIRST = 55,
+    CH_DISTANCE_DOWN_HEAD = 56,
+    CH_DISTANCE_DOWN_COST = 57,
+    CH_DISTANCE_DOWN_MIDDLE = 58
+};
+
+struct MapFileSection {
+    uint32_t type;          // MapSectionType
+    uint32_t element_size;  // Bytes per element
+    uint64_t offset;        // From start of file, page aligned
+    uint64_t size;          // Bytes
+    uint32_t crc32;         // Of the section payload
+    uint32_t reserved;
+};
+
+struct MapFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t page_size;
+    uint32_t section_count;
+    uint64_t file_size;
+
+    uint32_t node_count;
+    uint32_t arc_count;
+    uint32_t poi_count;
+    uint8_t max_speed_kmh;
+    uint8_t reserved0[3];
+
+    RoadGraph::GridInfo grid;
+
+    uint32_t header_crc32;  // CRC32 of the header with this field zeroed
+    uint32_t reserved1;
+
+    MapFileSection sections[MAP_FILE_MAX_SECTIONS];
+};
+
+static_assert(sizeof(MapFileHeader) <= MAP_FILE_PAGE_SIZE, "Map file header must fit in one page");
+
+// Fixed-size POI record; strings live in POI_STRINGS (NUL terminated UTF-8)
+struct MapFilePoi {
+    uint64_t poi_id;
+    int32_t lat_e7;
+    int32_t lon_e7;
+    uint32_t name_offset;
+    uint32_t category_offset;
+    uint32_t address_offset;
+    uint32_t reserved;
+};
+
+// POI as fed to the compiler
+struct MapPoiInput {
+    uint64_t poi_id;
+    Point position;
+    std::string name;
+    std::string category;
+    std::string address;
+
+    MapPoiInput() : poi_id(0) {}
+};
+
+/**
+ * @brief Read-only, memory-mapped view of a map.data file
+ *
+ * open() maps the file and validates only the header page (magic, version,
+ * header CRC, section bounds), so it costs O(1) regardless of file size.
+ */
+class MapFile {
+public:
+    MapFile();
+    ~MapFile();
+    MapFile(const MapFile&) = delete;
+    MapFile& operator=(const MapFile&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return data_ != nullptr; }
+
+    const std::string& lastError() const { return error_; }
+    const std::string& path() const { return path_; }
+    size_t fileSize() const { return size_; }
+
+    const MapFileHeader& header() const { return *reinterpret_cast<const MapFileHeader*>(data_); }
+
+    // Section lookup; nullptr if absent
+    const MapFileSection* section(MapSectionType type) const;
+
+    // Typed view of a section; empty if absent or element size mismatches
+    template<typename T>
+    ArrayView<T> array(MapSectionType type) const {
+        const MapFileSection* s = section(type);
+        if (!s || s->element_size != sizeof(T)) {
+            return ArrayView<T>();
+        }
+        return ArrayView<T>(reinterpret_cast<const T*>(data_ + s->offset),
+                            static_cast<size_t>(s->size / sizeof(T)));
+    }
+
+    // Full payload CRC check (reads every page; offline/diagnostic use)
+    bool verify() const;
+
+    // POIs
+    uint32_t poiCount() const;
+    const MapFilePoi& poi(uint32_t index) const;
+    const char* poiString(uint32_t offset) const;
+
+    static uint32_t crc32(const void* data, size_t size, uint32_t crc = 0);
+
+private:
+    bool validateHeader();
+
+    const uint8_t* data_;
+    size_t size_;
+    std::string path_;
+    std::string error_;
+
+    // Mapping handle (POSIX) or heap copy (platforms without mmap)
+    int fd_;
+    std::vector<uint8_t> fallback_;
+    ArrayView<MapFilePoi> pois_;
+    ArrayView<char> poi_strings_;
+};
+
+/**
+ * @brief Writes map.data files (used by nav_map_compiler)
+ *
+ * Hierarchies are optional and must have been built over the same graph.
+ */
+class MapFileWriter {
+public:
+    static bool write(const std::string& path, const RoadGraph& graph,
+                      const std::vector<MapPoiInput>& pois,
+                      const std::vector<const ContractionHierarchy*>& hierarchies = {},
+                      std::string* error = nullptr);
+};
+
+} // namespace nav
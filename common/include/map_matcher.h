@@ -0,0 +1,87 @@
+#pragma once
+
+#include "segment_index.h"
+#include <cstdint>
+#include <memory>
+
+namespace nav {
+
+struct MapMatcherConfig {
+    double search_radius_m;        // Candidate segments within this distance of a fix
+    double gps_sigma_m;            // Emission: position noise
+    double transition_beta_m;      // Transition: tolerated route vs straight-line difference
+    double heading_sigma_deg;      // Emission: heading vs segment direction
+    double min_heading_speed_kmh;  // Heading is ignored below this speed
+    int window;                    // Lattice layers kept for decodeWindow (<= MAX_WINDOW)
+
+    MapMatcherConfig()
+        : search_radius_m(40.0), gps_sigma_m(5.0), transition_beta_m(15.0), heading_sigma_deg(15.0),
+          min_heading_speed_kmh(10.0), window(8) {}
+};
+
+struct MatchResult {
+    bool matched;
+    Point position;        // On the road, or the input point when unmatched
+    uint32_t segment;
+    uint32_t from_node;    // Dense RoadGraph nodes, in the direction of travel
+    uint32_t to_node;
+    double distance_m;     // Input point to the road
+    double bearing_deg;    // Road direction of travel
+
+    MatchResult() : matched(false), segment(0), from_node(0), to_node(0), distance_m(0.0), bearing_deg(0.0) {}
+};
+
+/**
+ * @brief Online HMM map matcher over a SegmentIndex
+ *
+ * Each fix is a lattice layer whose states are the nearby segments
+ * (at most MAX_CANDIDATES). Emission scores the distance to the segment
+ * and, when moving, the heading against the segment direction; transition
+ * scores how far the along-road distance between consecutive candidates
+ * departs from the straight-line distance between the fixes (Newson &
+ * Krumm). Along-road distance is exact along one segment or across a
+ * shared node; anything further away is penalised as a detour.
+ *
+ * match() runs one Viterbi step and returns the best state of the newest
+ * layer. The last `window` layers are kept in a fixed ring so that
+ * decodeWindow() can backtrack the smoothed path. A fix with no candidate
+ * breaks the chain and matching restarts at the next one.
+ */
+class MapMatcher {
+public:
+    static constexpr int MAX_CANDIDATES = 8;
+    static constexpr int MAX_WINDOW = 16;
+
+    explicit MapMatcher(std::shared_ptr<const SegmentIndex> index,
+                        const MapMatcherConfig& config = MapMatcherConfig());
+
+    void reset();
+
+    MatchResult match(const Point& point, double heading_deg, double speed_kmh);
+
+    // Most likely segments of the kept layers, oldest first; returns the count
+    int decodeWindow(uint32_t* segments, int max_segments) const;
+
+    const MapMatcherConfig& config() const { return config_; }
+
+private:
+    struct Layer {
+        Point fix;
+        SegmentCandidate candidates[MAX_CANDIDATES];
+        double score[MAX_CANDIDATES];   // Log probability, best = 0
+        int8_t back[MAX_CANDIDATES];    // Best predecessor in the previous layer
+        int count;
+    };
+
+    double emission(const SegmentCandidate& candidate, double heading_deg, bool use_heading) const;
+    double routeDistance(const SegmentCandidate& a, const SegmentCandidate& b) const;
+
+    std::shared_ptr<const SegmentIndex> index_;
+    MapMatcherConfig config_;
+
+    Layer layers_[MAX_WINDOW];
+    int newest_;   // Ring position of the newest layer
+    int depth_;    // Layers in the current chain (<= window)
+};
+
+} // namespace nav
@@ -189,7 +189,8 @@ enum class RoutingRequestType : uint32_t {
 
 enum class RoutingAlgorithm : uint32_t {
     ASTAR = 1,
-    DIJKSTRA = 2
+    DIJKSTRA = 2,
+    CONTRACTION_HIERARCHY = 3  // Needs a preprocessed hierarchy; falls back to A*
 };
 
 enum class RoutingCriteria : uint32_t {
@@ -79,11 +79,18 @@ struct GpsData {
     double course_degrees;     // Course over ground
     uint8_t satellites_used;   // Number of satellites used
     double hdop;              // Horizontal dilution of precision
+    double pdop;              // Position dilution of precision (GSA)
+    double vdop;              // Vertical dilution of precision (GSA)
+    uint8_t fix_mode;         // GSA: 1 = no fix, 2 = 2D, 3 = 3D
+    uint8_t satellites_in_view;     // Sum of the per-constellation GSV counts
+    uint8_t satellites_in_view_by_talker[4];  // GP, GL, GA, GN
     bool valid;               // GPS fix validity
     uint64_t timestamp_ms;    // Timestamp in milliseconds
+    int32_t utc_time_ms;      // Fix time of day (UTC) from RMC/GGA, -1 if absent
     
     GpsData() : speed_kmh(0.0), course_degrees(0.0), satellites_used(0), 
-                hdop(99.9), valid(false), timestamp_ms(0) {}
+                hdop(99.9), pdop(99.9), vdop(99.9), fix_mode(1), satellites_in_view(0),
+                satellites_in_view_by_talker{0, 0, 0, 0}, valid(false), timestamp_ms(0), utc_time_ms(-1) {}
 };
 
 // Map node structure
@@ -97,6 +104,10 @@ struct MapNode {
         : id(id), position(pos), node_type(type) {}
 };
 
+// MapEdge::flags bits
+constexpr uint16_t EDGE_FLAG_ONE_WAY = 0x0001;  // Traversable only from_node -> to_node
+constexpr uint16_t EDGE_FLAG_TOLL    = 0x0002;
+
 // Map edge structure
 struct MapEdge {
     uint32_t from_node;
@@ -1,12 +1,16 @@
 #pragma once
 
 #include "nav_types.h"
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
 
 namespace nav {
 
+class SegmentIndex;
+
 // Utility functions
 class NavUtils {
 public:
@@ -43,28 +47,76 @@ public:
     // Convert turn type to string
     static std::string turnTypeToString(TurnType turn);
     
-    // Map matching - snap GPS point to nearest road
-    static Point snapToRoad(const Point& gps_point, const std::vector<MapEdge>& nearby_edges);
+    // Map matching - project GPS point onto the nearest road segment within
+    // max_distance_m (unchanged if there is none). Stateless; MapMatcher
+    // tracks the road over a sequence of fixes.
+    static Point snapToRoad(const Point& gps_point, const SegmentIndex& roads, double max_distance_m = 50.0);
+    
+    // Locate navigation.conf ($NAV_CONFIG, ./config, ../config, ../etc); empty if not found
+    static std::string locateConfigFile();
 };
 
-// NMEA parser for GPS data
+// NMEA 0183 parser for GPS data
+//
+// Works in place on the sentence text: fields are string_views into it and
+// numbers are read with std::from_chars, so a sentence is parsed without
+// heap allocation. Sentences from the GP, GL, GA and GN talkers are
+// dispatched through a table on their ID (RMC, GGA, VTG, GSA, GSV); each
+// updates only the GpsData fields it carries, so one GpsData accumulates a
+// whole fix epoch.
 class NmeaParser {
 public:
-    // Parse NMEA sentence and extract GPS data
-    static bool parseNmeaSentence(const std::string& sentence, GpsData& gps_data);
+    static constexpr size_t MAX_FIELDS = 24;
+
+    // Parse NMEA sentence and extract GPS data (trailing CR/LF is ignored)
+    static bool parseNmeaSentence(std::string_view sentence, GpsData& gps_data);
     
 private:
-    static bool parseGPRMC(const std::string& sentence, GpsData& gps_data);
-    static bool parseGPGGA(const std::string& sentence, GpsData& gps_data);
-    static std::vector<std::string> splitString(const std::string& str, char delimiter);
-    static double parseCoordinate(const std::string& coord_str, char direction);
-    static uint8_t calculateChecksum(const std::string& sentence);
-    static bool validateChecksum(const std::string& sentence);
+    struct Fields {
+        std::string_view value[MAX_FIELDS];
+        size_t count;
+    };
+    using Handler = bool (*)(const Fields& fields, size_t talker, GpsData& gps_data);
+
+    struct SentenceHandler {
+        char id[4];
+        Handler handler;
+    };
+    static const SentenceHandler HANDLERS[];
+
+    static bool parseRMC(const Fields& fields, size_t talker, GpsData& gps_data);
+    static bool parseGGA(const Fields& fields, size_t talker, GpsData& gps_data);
+    static bool parseVTG(const Fields& fields, size_t talker, GpsData& gps_data);
+    static bool parseGSA(const Fields& fields, size_t talker, GpsData& gps_data);
+    static bool parseGSV(const Fields& fields, size_t talker, GpsData& gps_data);
+
+    static size_t talkerIndex(std::string_view talker);
+    static bool splitFields(std::string_view body, Fields& fields);
+    static bool parseDouble(std::string_view field, double& value);
+    static bool parseInt(std::string_view field, int& value);
+    static bool parseCoordinate(std::string_view coord, std::string_view direction, double& degrees);
+    static bool parseTime(std::string_view field, int32_t& time_ms);
+    static uint8_t calculateChecksum(std::string_view body);
+    static bool validateChecksum(std::string_view sentence, std::string_view& body);
+};
+
+// One received CAN frame with its kernel receive timestamp
+struct CanRxFrame {
+    uint32_t can_id;
+    uint8_t dlc;
+    uint8_t data[8];
+    uint64_t timestamp_ns;   // Kernel receive time (CLOCK_REALTIME), 0 if unavailable
 };
 
 // CAN bus interface
+//
+// On Linux the raw socket is bound with CAN_RAW_FILTER to the IDs we decode,
+// so unrelated bus traffic never reaches user space, and frames are received
+// in batches with recvmmsg() carrying SO_TIMESTAMPING receive times.
 class CanInterface {
 public:
+    static constexpr int MAX_BATCH = 32;
+
     CanInterface();
     ~CanInterface();
     
@@ -74,18 +126,32 @@ public:
     // Close CAN interface
     void close();
     
-    // Read vehicle data from CAN bus
+    // Read vehicle data from CAN bus (all pending frames, non-blocking)
     bool readVehicleData(VehicleData& vehicle_data);
     
+    // Receive up to max_frames pending frames with one syscall; returns the
+    // count, 0 if none are pending, -1 on error
+    int receiveFrames(CanRxFrame* frames, int max_frames);
+    
+    // Apply a speed or yaw-rate frame; false for IDs we do not decode
+    static bool decodeVehicleFrame(const CanRxFrame& frame, VehicleData& vehicle_data);
+    
     // Send guidance data to instrument cluster
     bool sendGuidanceData(const GuidanceInstruction& instruction);
     
     // Check if CAN interface is connected
     bool isConnected() const { return can_socket_ >= 0; }
     
+    // Socket for epoll/poll based readers (-1 when closed)
+    int fileDescriptor() const { return can_socket_; }
+    
+    // True when frames carry kernel receive timestamps
+    bool hasKernelTimestamps() const { return timestamps_enabled_; }
+    
 private:
     int can_socket_;
     bool is_initialized_;
+    bool timestamps_enabled_;
     
     // CAN message IDs (these would be vehicle-specific)
     static constexpr uint32_t VEHICLE_SPEED_MSG_ID = 0x200;
@@ -93,14 +159,29 @@ private:
     static constexpr uint32_t GUIDANCE_MSG_ID = 0x300;
 };
 
+// Cache counters; get() and find() count hits and misses, peek() does not
+struct CacheStats {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+
+    CacheStats() : hits(0), misses(0), evictions(0) {}
+};
+
 // LRU Cache template for map tiles
+//
+// capacity bounds the summed cost of the entries: a count when every put()
+// uses the default cost of 1, or bytes when callers pass each value's size.
+// Pinned entries and the one just put are skipped by eviction, so the cache
+// may run over budget while they alone exceed it.
 template<typename Key, typename Value>
 class LRUCache {
 public:
-    explicit LRUCache(size_t capacity) : capacity_(capacity), head_(nullptr), tail_(nullptr) {
+    explicit LRUCache(size_t capacity)
+        : capacity_(capacity), total_cost_(0), head_(nullptr), tail_(nullptr) {
         // Create dummy head and tail nodes
-        head_ = new CacheNode(Key{}, Value{});
-        tail_ = new CacheNode(Key{}, Value{});
+        head_ = new CacheNode(Key{}, Value{}, 0);
+        tail_ = new CacheNode(Key{}, Value{}, 0);
         head_->next = tail_;
         tail_->prev = head_;
     }
@@ -111,42 +192,96 @@ public:
         delete tail_;
     }
     
+    LRUCache(const LRUCache&) = delete;
+    LRUCache& operator=(const LRUCache&) = delete;
+    
     bool get(const Key& key, Value& value) {
-        auto it = cache_map_.find(key);
-        if (it != cache_map_.end()) {
-            CacheNode* node = it->second;
-            value = node->value;
-            moveToHead(node);
+        Value* found = find(key);
+        if (found) {
+            value = *found;
             return true;
         }
         return false;
     }
     
-    void put(const Key& key, const Value& value) {
+    // Marks the entry most recently used; nullptr if absent
+    Value* find(const Key& key) {
+        auto it = cache_map_.find(key);
+        if (it == cache_map_.end()) {
+            ++stats_.misses;
+            return nullptr;
+        }
+        ++stats_.hits;
+        moveToHead(it->second);
+        return &it->second->value;
+    }
+    
+    // Lookup that leaves recency and counters alone
+    const Value* peek(const Key& key) const {
+        auto it = cache_map_.find(key);
+        return it != cache_map_.end() ? &it->second->value : nullptr;
+    }
+    
+    bool contains(const Key& key) const { return cache_map_.count(key) != 0; }
+    
+    void put(const Key& key, const Value& value, size_t cost = 1) {
         auto it = cache_map_.find(key);
         if (it != cache_map_.end()) {
             // Update existing node
             CacheNode* node = it->second;
             node->value = value;
+            total_cost_ = total_cost_ - node->cost + cost;
+            node->cost = cost;
             moveToHead(node);
         } else {
             // Create new node
-            CacheNode* node = new CacheNode(key, value);
+            CacheNode* node = new CacheNode(key, value, cost);
             cache_map_[key] = node;
+            total_cost_ += cost;
             
             // Add to head
             node->next = head_->next;
             node->prev = head_;
             head_->next->prev = node;
             head_->next = node;
-            
-            // Check capacity
-            if (cache_map_.size() > capacity_) {
-                CacheNode* tail_node = removeTail();
-                cache_map_.erase(tail_node->key);
-                delete tail_node;
-            }
         }
+        evictToCapacity(head_->next);
+    }
+    
+    bool erase(const Key& key) {
+        auto it = cache_map_.find(key);
+        if (it == cache_map_.end()) {
+            return false;
+        }
+        CacheNode* node = it->second;
+        removeNode(node);
+        total_cost_ -= node->cost;
+        cache_map_.erase(it);
+        delete node;
+        return true;
+    }
+    
+    // Pinned entries are never evicted; false if absent
+    bool setPinned(const Key& key, bool pinned) {
+        auto it = cache_map_.find(key);
+        if (it == cache_map_.end()) {
+            return false;
+        }
+        it->second->pinned = pinned;
+        if (!pinned) {
+            evictToCapacity();
+        }
+        return true;
+    }
+    
+    bool isPinned(const Key& key) const {
+        auto it = cache_map_.find(key);
+        return it != cache_map_.end() && it->second->pinned;
+    }
+    
+    void setCapacity(size_t capacity) {
+        capacity_ = capacity;
+        evictToCapacity();
     }
     
     void clear() {
@@ -156,18 +291,33 @@ public:
         cache_map_.clear();
         head_->next = tail_;
         tail_->prev = head_;
+        total_cost_ = 0;
+    }
+    
+    // Visits entries from most to least recently used: f(key, value)
+    template<typename Visitor>
+    void forEach(Visitor&& f) const {
+        for (const CacheNode* node = head_->next; node != tail_; node = node->next) {
+            f(node->key, node->value);
+        }
     }
     
     size_t size() const { return cache_map_.size(); }
+    size_t capacity() const { return capacity_; }
+    size_t cost() const { return total_cost_; }
+    const CacheStats& stats() const { return stats_; }
     
 private:
     struct CacheNode {
         Key key;
         Value value;
+        size_t cost;
+        bool pinned;
         CacheNode* prev;
         CacheNode* next;
         
-        CacheNode(const Key& k, const Value& v) : key(k), value(v), prev(nullptr), next(nullptr) {}
+        CacheNode(const Key& k, const Value& v, size_t c)
+            : key(k), value(v), cost(c), pinned(false), prev(nullptr), next(nullptr) {}
     };
     
     void moveToHead(CacheNode* node) {
@@ -184,16 +334,28 @@ private:
         node->next->prev = node->prev;
     }
     
-    CacheNode* removeTail() {
-        CacheNode* last_node = tail_->prev;
-        removeNode(last_node);
-        return last_node;
+    // Drops unpinned entries other than keep from the tail until within capacity
+    void evictToCapacity(const CacheNode* keep = nullptr) {
+        CacheNode* node = tail_->prev;
+        while (total_cost_ > capacity_ && node != head_) {
+            CacheNode* prev = node->prev;
+            if (!node->pinned && node != keep) {
+                removeNode(node);
+                total_cost_ -= node->cost;
+                cache_map_.erase(node->key);
+                delete node;
+                ++stats_.evictions;
+            }
+            node = prev;
+        }
     }
     
     size_t capacity_;
+    size_t total_cost_;
     CacheNode* head_;
     CacheNode* tail_;
     std::unordered_map<Key, CacheNode*> cache_map_;
+    CacheStats stats_;
 };
 
 } // namespace nav
\ No newline at end of file
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace nav {
+
+// Framing counters since the last reset()
+struct NmeaFramerStats {
+    uint64_t bytes;             // Bytes committed to the ring
+    uint64_t sentences;         // Complete sentences returned
+    uint64_t discarded_bytes;   // Noise between sentences and dropped partial sentences
+    uint64_t overflows;         // Sentences longer than MAX_SENTENCE
+    uint64_t ring_full;         // Writes that did not fit
+
+    NmeaFramerStats() : bytes(0), sentences(0), discarded_bytes(0), overflows(0), ring_full(0) {}
+};
+
+/**
+ * @brief Incremental NMEA 0183 sentence framer over a fixed byte ring
+ *
+ * The serial reader read()s straight into the ring (writePointer() /
+ * commitWrite()) and pulls complete sentences with nextSentence(). A
+ * sentence runs from '$' (or '!') to CR or LF; bytes before the start
+ * character are skipped, and a sentence that is cut short by a new '$',
+ * contains control characters or outgrows MAX_SENTENCE is dropped, so the
+ * framer resynchronises on line noise and partial reads. Checksums are left
+ * to NmeaParser. No allocation after construction; single-threaded.
+ */
+class NmeaFramer {
+public:
+    static constexpr size_t RING_SIZE = 4096;     // Power of two
+    static constexpr size_t MAX_SENTENCE = 128;   // NMEA allows 82, leave room for proprietary
+
+    NmeaFramer();
+
+    void reset();
+
+    // Contiguous free space in the ring (0 when full); commit what was written
+    char* writePointer(size_t& space);
+    void commitWrite(size_t count);
+
+    // Copy bytes in; returns how many fit
+    size_t write(const char* data, size_t count);
+
+    // Next complete sentence without CR/LF. The view points into an internal
+    // buffer and stays valid until the next call.
+    bool nextSentence(std::string_view& sentence);
+
+    size_t buffered() const { return write_pos_ - read_pos_; }
+    const NmeaFramerStats& stats() const { return stats_; }
+
+private:
+    static constexpr size_t RING_MASK = RING_SIZE - 1;
+    static_assert((RING_SIZE & RING_MASK) == 0, "RING_SIZE must be a power of two");
+
+    void dropSentence();
+
+    char ring_[RING_SIZE];
+    size_t read_pos_;     // Monotonic; index with & RING_MASK
+    size_t write_pos_;
+
+    char line_[MAX_SENTENCE];
+    size_t line_length_;
+    bool in_sentence_;
+
+    NmeaFramerStats stats_;
+};
+
+} // namespace nav
@@ -0,0 +1,158 @@
+#pragma once
+
+#include "array_view.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace nav {
+
+/*
+ * POI snapshot (poi_database.json -> *.snap)
+ *
+ * Layout (little-endian):
+ *
+ *   PoiSnapshotHeader   magic, version, counts, section offsets, the size and
+ *                       mtime of the JSON it was built from, header CRC32
+ *   strings             NUL-terminated UTF-8; offset 0 is the empty string
+ *   records             PoiSnapshotRecord[poi_count], 8-byte aligned
+ *   categories          uint32_t[category_count], string offsets
+ *
+ * Categories are interned: records carry a 16-bit id. Opening a snapshot is
+ * an mmap plus a header check, like map.data.
+ */
+
+constexpr char POI_SNAPSHOT_MAGIC[8] = {'N', 'A', 'V', 'P', 'O', 'I', '\r', '\n'};
+constexpr uint32_t POI_SNAPSHOT_VERSION = 1;
+constexpr uint32_t POI_SNAPSHOT_MAX_CATEGORIES = 0xFFFF;
+
+struct PoiSnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t poi_count;
+    uint32_t category_count;
+
+    uint64_t source_size;   // JSON file the snapshot was built from
+    int64_t source_mtime;
+
+    uint64_t strings_offset;
+    uint64_t strings_size;
+    uint64_t records_offset;
+    uint64_t categories_offset;
+    uint64_t file_size;
+
+    uint32_t header_crc32;  // CRC32 of the header with this field zeroed
+    uint32_t reserved;
+};
+
+struct PoiSnapshotRecord {
+    uint64_t poi_id;
+    int32_t lat_e7;
+    int32_t lon_e7;
+    uint32_t name_offset;
+    uint32_t address_offset;
+    uint16_t category;
+    uint16_t reserved0;
+    uint32_t reserved1;
+};
+
+static_assert(sizeof(PoiSnapshotHeader) % 8 == 0, "Records follow the header 8-byte aligned");
+static_assert(sizeof(PoiSnapshotRecord) == 32, "Snapshot record layout is fixed");
+
+// One POI object as parsed from JSON
+struct PoiJsonRecord {
+    uint64_t id;
+    double latitude;
+    double longitude;
+    std::string name;
+    std::string category;
+    std::string address;
+
+    PoiJsonRecord() : id(0), latitude(0.0), longitude(0.0) {}
+};
+
+/**
+ * @brief Streaming reader for poi_database.json
+ *
+ * The file is a top-level array of flat objects (id, name, category,
+ * latitude, longitude, address; other keys are skipped). It is read in
+ * fixed-size chunks and each object is handed to the visitor as soon as it
+ * closes, so memory does not grow with the file. Objects without a name or
+ * coordinates are counted in skipped().
+ */
+class PoiJsonReader {
+public:
+    using Visitor = std::function<void(const PoiJsonRecord&)>;
+
+    PoiJsonReader();
+
+    bool read(const std::string& path, const Visitor& visit);
+
+    const std::string& lastError() const { return error_; }
+    size_t skipped() const { return skipped_; }
+
+private:
+    std::string error_;
+    size_t skipped_;
+};
+
+/**
+ * @brief Read-only, memory-mapped view of a POI snapshot
+ */
+class PoiSnapshot {
+public:
+    PoiSnapshot();
+    ~PoiSnapshot();
+    PoiSnapshot(const PoiSnapshot&) = delete;
+    PoiSnapshot& operator=(const PoiSnapshot&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return data_ != nullptr; }
+
+    // False if the JSON exists and differs in size or mtime from the one snapshotted
+    bool isCurrent(const std::string& source_path) const;
+
+    const std::string& lastError() const { return error_; }
+    size_t fileSize() const { return size_; }
+
+    uint32_t poiCount() const { return static_cast<uint32_t>(records_.size()); }
+    uint32_t categoryCount() const { return static_cast<uint32_t>(categories_.size()); }
+
+    const PoiSnapshotRecord& record(uint32_t index) const { return records_[index]; }
+    const char* string(uint32_t offset) const { return offset < strings_.size() ? strings_.data() + offset : ""; }
+    const char* name(uint32_t index) const { return string(records_[index].name_offset); }
+    const char* address(uint32_t index) const { return string(records_[index].address_offset); }
+    const char* category(uint16_t id) const { return id < categories_.size() ? string(categories_[id]) : ""; }
+
+private:
+    const PoiSnapshotHeader& header() const { return *reinterpret_cast<const PoiSnapshotHeader*>(data_); }
+    bool validateHeader();
+
+    const uint8_t* data_;
+    size_t size_;
+    std::string error_;
+
+    // Mapping handle (POSIX) or heap copy (platforms without mmap)
+    int fd_;
+    std::vector<uint8_t> fallback_;
+    ArrayView<PoiSnapshotRecord> records_;
+    ArrayView<uint32_t> categories_;
+    ArrayView<char> strings_;
+};
+
+/**
+ * @brief Converts poi_database.json into a snapshot
+ *
+ * Strings are streamed straight to the output and records to a side file
+ * appended at the end, so only the category table is held in memory.
+ */
+class PoiSnapshotWriter {
+public:
+    static bool convert(const std::string& json_path, const std::string& snapshot_path,
+                        std::string* error = nullptr, size_t* poi_count = nullptr);
+};
+
+} // namespace nav
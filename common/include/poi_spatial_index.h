@@ -0,0 +1,90 @@
+#pragma once
+
+#include "nav_types.h"
+#include <cstdint>
+#include <vector>
+
+namespace nav {
+
+// Location and interned category of one POI; its index in the input vector
+// is the id the spatial index reports
+struct PoiLocation {
+    double latitude;
+    double longitude;
+    uint16_t category;
+
+    PoiLocation() : latitude(0.0), longitude(0.0), category(0) {}
+    PoiLocation(double lat, double lon, uint16_t cat) : latitude(lat), longitude(lon), category(cat) {}
+};
+
+struct PoiHit {
+    uint32_t poi;          // Index into the vector given to build()
+    double distance_m;
+
+    PoiHit() : poi(0), distance_m(0.0) {}
+    PoiHit(uint32_t p, double d) : poi(p), distance_m(d) {}
+};
+
+/**
+ * @brief Uniform grid over POI coordinates with radius and k-nearest queries
+ *
+ * Entries are stored sorted by cell (coordinates as 1e-7 degree fixed
+ * point, category, POI index in parallel arrays), so a query streams
+ * through a few contiguous runs. Distances are equirectangular around the
+ * query latitude: no trigonometry per POI, and well under 0.1% error at
+ * POI search radii.
+ *
+ * Each cell keeps a bitmask of the categories it holds (ids >= 63 share the
+ * last bit), so a category-filtered query skips cells without a match
+ * before touching their entries. k-nearest uses a bounded max-heap and
+ * widens the search ring by ring until the next ring cannot beat the
+ * current k-th distance.
+ */
+class PoiSpatialIndex {
+public:
+    static constexpr uint16_t ANY_CATEGORY = 0xFFFF;
+
+    PoiSpatialIndex();
+
+    bool build(const std::vector<PoiLocation>& pois);
+    void clear();
+
+    bool empty() const { return poi_.empty(); }
+    uint32_t size() const { return static_cast<uint32_t>(poi_.size()); }
+
+    // POIs within radius_m, nearest first; returns the count appended to out
+    size_t findWithinRadius(const Point& center, double radius_m, uint16_t category,
+                            std::vector<PoiHit>& out) const;
+
+    // Up to k POIs nearest to center (within max_radius_m), nearest first
+    size_t findNearest(const Point& center, size_t k, uint16_t category, double max_radius_m,
+                       std::vector<PoiHit>& out) const;
+
+    size_t memoryBytes() const;
+
+private:
+    static uint64_t categoryBit(uint16_t category) {
+        return 1ull << (category < 63 ? category : 63);
+    }
+
+    uint32_t cellRow(int32_t lat_e7) const;
+    uint32_t cellCol(int32_t lon_e7) const;
+
+    // Entries in cell order
+    std::vector<int32_t> lat_e7_;
+    std::vector<int32_t> lon_e7_;
+    std::vector<uint16_t> category_;
+    std::vector<uint32_t> poi_;
+
+    // Grid: entries of cell c are [cell_first_[c], cell_first_[c + 1])
+    int32_t min_lat_e7_;
+    int32_t min_lon_e7_;
+    int32_t cell_lat_e7_;
+    int32_t cell_lon_e7_;
+    uint32_t rows_;
+    uint32_t cols_;
+    std::vector<uint32_t> cell_first_;
+    std::vector<uint64_t> cell_categories_;
+};
+
+} // namespace nav
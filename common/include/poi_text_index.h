@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace nav {
+
+// Text fields of one POI; its index in the input vector is the document id
+struct TextDocument {
+    std::string_view name;
+    std::string_view category;
+
+    TextDocument() {}
+    TextDocument(std::string_view n, std::string_view c) : name(n), category(c) {}
+};
+
+struct TextHit {
+    uint32_t doc;
+    float score;
+
+    TextHit() : doc(0), score(0.0f) {}
+    TextHit(uint32_t d, float s) : doc(d), score(s) {}
+};
+
+/**
+ * @brief Inverted index over POI names and categories for search-as-you-type
+ *
+ * Text is folded before tokenising: case, Latin-1 and Vietnamese diacritics
+ * (precomposed or combining) map to plain ASCII, so "Phở Gia Truyền",
+ * "PHO gia truyen" and "pho GIA TRUYỀN" index and query identically.
+ *
+ * The term dictionary is sorted, so the terms starting with a prefix form a
+ * contiguous id range, found by binary search; this is what a prefix trie
+ * would give, without per-node allocation. Each term has a posting list
+ * and each document keeps its term ids with field flags.
+ *
+ * Every query token is a prefix. A query walks the postings of the token
+ * with the fewest of them, drops candidates missing from the documents of
+ * the next rarest token (a bitmap, or a sorted list when those are few),
+ * and checks the rest against every token's range, so the cost follows the
+ * rare tokens, not the database size. Hits are ranked (exact term over
+ * prefix, name over category, first name word, shorter names) and the best
+ * k kept in a bounded heap.
+ *
+ * Each posting list is split by field class and sorted by name length, so
+ * scores only fall along a segment: once its bound cannot beat the k-th
+ * hit the rest of it is skipped. The first keystrokes, whose prefixes cover
+ * much of the dictionary, touch little more than k postings per term.
+ */
+class PoiTextIndex {
+public:
+    static constexpr size_t MAX_QUERY_TOKENS = 8;
+    static constexpr size_t MAX_TOKEN_LENGTH = 32;
+
+    PoiTextIndex();
+
+    bool build(const std::vector<TextDocument>& docs);
+    void clear();
+
+    bool empty() const { return doc_name_tokens_.empty(); }
+    uint32_t termCount() const { return static_cast<uint32_t>(term_offset_.empty() ? 0 : term_offset_.size() - 1); }
+
+    // Best k documents matching every token of the query, best first
+    size_t search(std::string_view query, size_t k, std::vector<TextHit>& out) const;
+
+    // Up to k indexed terms starting with the folded prefix, most frequent first
+    size_t complete(std::string_view prefix, size_t k, std::vector<std::string>& out) const;
+
+    size_t memoryBytes() const;
+
+    // Lower-case ASCII folding of UTF-8 text; separators become spaces
+    static void foldText(std::string_view text, std::string& out);
+
+private:
+    enum : uint8_t { FIELD_NAME = 0x01, FIELD_CATEGORY = 0x02, FIELD_FIRST_WORD = 0x04 };
+    static constexpr uint32_t FIELD_CLASSES = 3;
+
+    struct TermRange {
+        uint32_t first;
+        uint32_t last;     // Exclusive
+        uint32_t exact;    // Term equal to the token, or INVALID_TERM
+    };
+    static constexpr uint32_t INVALID_TERM = 0xFFFFFFFFu;
+
+    std::string_view term(uint32_t id) const {
+        return std::string_view(term_chars_.data() + term_offset_[id], term_offset_[id + 1] - term_offset_[id]);
+    }
+    uint32_t postingCount(const TermRange& range) const {
+        return posting_first_[range.last * FIELD_CLASSES] - posting_first_[range.first * FIELD_CLASSES];
+    }
+    TermRange prefixRange(std::string_view prefix) const;
+    // Score of one matched token; its field class (first name word, name, category) orders the postings
+    static float tokenScore(uint8_t fields, bool exact);
+    static uint32_t fieldClass(uint8_t fields);
+    void searchRanges(const TermRange* ranges, size_t count, size_t k, std::vector<TextHit>& heap) const;
+
+    // Term dictionary, sorted
+    std::vector<char> term_chars_;
+    std::vector<uint32_t> term_offset_;
+
+    // Postings: segment s = term * FIELD_CLASSES + class -> [posting_first_[s], posting_first_[s + 1]),
+    // each sorted by name length, then doc
+    std::vector<uint32_t> posting_first_;
+    std::vector<uint32_t> posting_doc_;
+
+    // Forward index: doc d -> [doc_term_first_[d], doc_term_first_[d + 1])
+    std::vector<uint32_t> doc_term_first_;
+    std::vector<uint32_t> doc_terms_;
+    std::vector<uint8_t> doc_term_fields_;
+    std::vector<uint8_t> doc_name_tokens_;
+};
+
+} // namespace nav
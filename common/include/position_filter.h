@@ -0,0 +1,129 @@
+#pragma once
+
+#include "nav_types.h"
+#include <cstdint>
+
+namespace nav {
+
+// Source of the current position (values match PositionUpdateMsg::positioning_mode)
+enum class PositioningMode : uint8_t {
+    GPS = 0,
+    DEAD_RECKONING = 1
+};
+
+// Filter output at a given time
+struct FusedPosition {
+    Point position;
+    double heading_degrees;
+    double speed_kmh;
+    double position_sigma_m;   // 1-sigma horizontal uncertainty
+    PositioningMode mode;
+    bool valid;                // False before the first fix or after the DR timeout
+    uint64_t timestamp_ms;
+
+    FusedPosition() : heading_degrees(0.0), speed_kmh(0.0), position_sigma_m(0.0),
+                      mode(PositioningMode::GPS), valid(false), timestamp_ms(0) {}
+};
+
+// Noise model and timeouts (defaults suit a passenger car with a consumer receiver)
+struct PositionFilterConfig {
+    uint32_t gps_timeout_ms;            // No valid fix for this long: dead reckoning
+    uint32_t dead_reckoning_timeout_ms; // Dead reckoning for this long: estimate invalid
+    double gps_uere_m;                  // Range error; position sigma = uere * HDOP
+    double gps_course_sigma_deg;
+    double gps_speed_sigma_mps;
+    double min_course_speed_mps;        // GPS course is noise below this speed
+    double speed_sigma_mps;             // Wheel speed noise
+    double yaw_rate_sigma_dps;          // Gyro noise
+    double yaw_bias_walk_dps;           // Gyro bias random walk per sqrt(s)
+    double speed_scale_walk;            // Wheel scale random walk per sqrt(s)
+
+    PositionFilterConfig()
+        : gps_timeout_ms(5000), dead_reckoning_timeout_ms(10000), gps_uere_m(3.0),
+          gps_course_sigma_deg(3.0), gps_speed_sigma_mps(0.3), min_course_speed_mps(3.0),
+          speed_sigma_mps(0.2), yaw_rate_sigma_dps(0.5), yaw_bias_walk_dps(0.01),
+          speed_scale_walk(0.0005) {}
+};
+
+/**
+ * @brief Extended Kalman filter fusing GPS fixes with CAN speed and yaw rate
+ *
+ * State, in a local east/north plane anchored at the first fix:
+ *
+ *   x = [east m, north m, heading rad, gyro bias rad/s, wheel speed scale]
+ *
+ * CAN samples drive the prediction (unicycle model with the wheel speed and
+ * the bias-corrected yaw rate as inputs), so it runs at the CAN rate. GPS
+ * fixes correct position, and course and speed when moving, one scalar
+ * measurement at a time, which avoids any matrix inversion. Everything is a
+ * fixed-size array member: no allocation, ~100 flops per predict.
+ *
+ * Without a fix for gps_timeout_ms the estimate continues as pure dead
+ * reckoning; after dead_reckoning_timeout_ms more it is flagged invalid.
+ * If no CAN data arrives, GPS speed stands in for the wheel speed.
+ */
+class PositionFilter {
+public:
+    static constexpr int STATE_SIZE = 5;
+
+    explicit PositionFilter(const PositionFilterConfig& config = PositionFilterConfig());
+
+    void reset();
+    bool initialized() const { return initialized_; }
+    const PositionFilterConfig& config() const { return config_; }
+
+    // Propagate to the sample time with its speed and yaw rate
+    void predict(const VehicleData& vehicle);
+
+    // Correct with a fix; the first valid fix initialises the filter. A fix
+    // whose UTC time is not after the last one's is ignored as stale
+    void correct(const GpsData& gps);
+
+    // Estimate extrapolated to time_ms (state is not modified)
+    FusedPosition estimate(uint64_t time_ms) const;
+
+    PositioningMode mode(uint64_t time_ms) const;
+
+    uint64_t predictCount() const { return predict_count_; }
+    uint64_t correctCount() const { return correct_count_; }
+    uint64_t staleFixCount() const { return stale_fix_count_; }
+
+private:
+    enum { EAST = 0, NORTH = 1, HEADING = 2, YAW_BIAS = 3, SPEED_SCALE = 4 };
+
+    void initialize(const GpsData& gps);
+    void propagate(double dt);
+    // Scalar update with measurement row h; residual already formed (wrapped for angles)
+    void update(const double (&h)[STATE_SIZE], double residual, double variance);
+    void reanchor();
+
+    void toLocal(const Point& point, double& east, double& north) const;
+    Point toGeodetic(double east, double north) const;
+
+    PositionFilterConfig config_;
+
+    bool initialized_;
+    double x_[STATE_SIZE];
+    double P_[STATE_SIZE][STATE_SIZE];
+
+    // Tangent-plane anchor
+    double anchor_lat_;
+    double anchor_lon_;
+    double meters_per_deg_lat_;
+    double meters_per_deg_lon_;
+    double altitude_;
+
+    // Latest inputs and their times
+    double speed_mps_;
+    double yaw_rate_rps_;
+    uint64_t state_time_ms_;
+    uint64_t last_can_ms_;
+    uint64_t last_fix_ms_;
+    int32_t last_fix_utc_ms_;
+
+    uint64_t predict_count_;
+    uint64_t correct_count_;
+    uint64_t stale_fix_count_;
+};
+
+} // namespace nav
@@ -0,0 +1,176 @@
+#pragma once
+
+#include "nav_types.h"
+#include "array_view.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace nav {
+
+class MapFile;
+class MapFileWriter;
+
+/**
+ * @brief Road network in compressed-sparse-row (CSR) form
+ *
+ * The outgoing arcs of node v are [firstArc(v), endArc(v)). Arc data is
+ * kept in parallel arrays (head, length, speed, flags) so a relaxation
+ * loop touches 10 bytes per arc instead of a 24-byte MapEdge, and
+ * bidirectional MapEdges become two arcs without duplicating node data.
+ *
+ * Nodes are renumbered along a Hilbert curve over their coordinates, so
+ * nodes that are close on the ground are close in memory and a search
+ * frontier stays within a few cache lines/pages. nodeId() maps back to
+ * the original MapNode id. Coordinates are stored as 1e-7 degree fixed
+ * point. A uniform grid over the nodes answers nearest-node and box
+ * queries without scanning the whole graph.
+ *
+ * The arrays are either built in memory (build()) or point straight into
+ * a memory-mapped map file (attach()), in which case nothing is copied and
+ * pages are faulted in on first access.
+ */
+class RoadGraph {
+public:
+    static constexpr uint32_t INVALID_NODE = 0xFFFFFFFFu;
+    static constexpr uint8_t DEFAULT_SPEED_KMH = 50;
+    static constexpr double COORD_SCALE = 1e7;
+
+    // Uniform grid over node coordinates (E7 units)
+    struct GridInfo {
+        int32_t min_lat_e7;
+        int32_t min_lon_e7;
+        int32_t cell_lat_e7;
+        int32_t cell_lon_e7;
+        uint32_t rows;
+        uint32_t cols;
+
+        GridInfo() : min_lat_e7(0), min_lon_e7(0), cell_lat_e7(1), cell_lon_e7(1), rows(0), cols(0) {}
+    };
+
+    // Entry of the id lookup table, sorted by MapNode id
+    struct IdIndexEntry {
+        uint32_t map_node_id;
+        uint32_t node;
+    };
+
+    RoadGraph();
+    RoadGraph(const RoadGraph&) = delete;
+    RoadGraph& operator=(const RoadGraph&) = delete;
+    RoadGraph(RoadGraph&&) = default;
+    RoadGraph& operator=(RoadGraph&&) = default;
+
+    // Build from MapNode/MapEdge lists. Edges referencing unknown node ids
+    // are skipped; edges without EDGE_FLAG_ONE_WAY become two arcs.
+    bool build(const std::vector<MapNode>& nodes, const std::vector<MapEdge>& edges);
+
+    // Use the graph sections of an open map file in place (zero-copy)
+    bool attach(std::shared_ptr<const MapFile> file);
+
+    void clear();
+
+    uint32_t nodeCount() const { return static_cast<uint32_t>(node_ids_.size()); }
+    uint32_t arcCount() const { return static_cast<uint32_t>(head_.size()); }
+    bool empty() const { return node_ids_.empty(); }
+
+    // Arc range of a node
+    uint32_t firstArc(uint32_t node) const { return first_out_[node]; }
+    uint32_t endArc(uint32_t node) const { return first_out_[node + 1]; }
+    uint32_t outDegree(uint32_t node) const { return first_out_[node + 1] - first_out_[node]; }
+
+    // Arc attributes
+    uint32_t arcHead(uint32_t arc) const { return head_[arc]; }
+    uint32_t arcLength(uint32_t arc) const { return length_m_[arc]; }   // Metres, >= 1
+    uint8_t arcSpeed(uint32_t arc) const { return speed_kmh_[arc]; }    // km/h, > 0
+    uint8_t arcFlags(uint32_t arc) const { return flags_[arc]; }        // Low byte of MapEdge::flags
+
+    // Travel time at the arc speed limit, rounded up to whole milliseconds
+    uint32_t arcTravelTimeMs(uint32_t arc) const {
+        const uint64_t speed = speed_kmh_[arc];
+        return static_cast<uint32_t>((static_cast<uint64_t>(length_m_[arc]) * 3600u + speed - 1) / speed);
+    }
+
+    // Arc from -> to, or INVALID_NODE if none (shortest one if parallel)
+    uint32_t findArc(uint32_t from, uint32_t to) const;
+
+    // Node attributes
+    uint32_t nodeId(uint32_t node) const { return node_ids_[node]; }
+    int32_t latitudeE7(uint32_t node) const { return lat_e7_[node]; }
+    int32_t longitudeE7(uint32_t node) const { return lon_e7_[node]; }
+    double latitude(uint32_t node) const { return lat_e7_[node] / COORD_SCALE; }
+    double longitude(uint32_t node) const { return lon_e7_[node] / COORD_SCALE; }
+    Point position(uint32_t node) const { return Point(latitude(node), longitude(node)); }
+
+    // Dense index of a MapNode id (binary search), or INVALID_NODE
+    uint32_t findNode(uint32_t map_node_id) const;
+
+    // Dense index of the node closest to a point, or INVALID_NODE
+    uint32_t findNearestNode(const Point& point) const;
+
+    // Dense indices of all nodes inside a bounding box
+    void findNodesInBox(const BoundingBox& box, std::vector<uint32_t>& nodes) const;
+
+    // Sum length (m) and travel time (s) along a path of dense indices
+    void measurePath(const std::vector<uint32_t>& path, double& length_m, double& time_s) const;
+
+    // Fill a Route (MapNode ids, length, time) from a path of dense indices.
+    // Paths longer than Route::MAX_NODES are sampled evenly, keeping both ends.
+    void fillRoute(const std::vector<uint32_t>& path, Route& route) const;
+
+    // Fastest speed limit in the graph (km/h), for admissible heuristics
+    uint8_t maxSpeedKmh() const { return max_speed_kmh_; }
+
+    const GridInfo& gridInfo() const { return grid_; }
+
+    // Heap bytes owned by the graph (zero for a mapped graph)
+    size_t memoryBytes() const;
+
+private:
+    friend class MapFileWriter;
+
+    struct Storage {
+        std::vector<uint32_t> first_out;
+        std::vector<uint32_t> head;
+        std::vector<uint32_t> length_m;
+        std::vector<uint8_t> speed_kmh;
+        std::vector<uint8_t> flags;
+        std::vector<uint32_t> node_ids;
+        std::vector<int32_t> lat_e7;
+        std::vector<int32_t> lon_e7;
+        std::vector<IdIndexEntry> id_index;
+        std::vector<uint32_t> cell_first;
+        std::vector<uint32_t> cell_nodes;
+    };
+
+    void buildGrid();
+    void bindStorage();
+    uint32_t cellRow(int32_t lat_e7) const;
+    uint32_t cellCol(int32_t lon_e7) const;
+
+    // CSR arrays
+    ArrayView<uint32_t> first_out_;  // nodeCount() + 1
+    ArrayView<uint32_t> head_;
+    ArrayView<uint32_t> length_m_;
+    ArrayView<uint8_t> speed_kmh_;
+    ArrayView<uint8_t> flags_;
+
+    // Node arrays
+    ArrayView<uint32_t> node_ids_;
+    ArrayView<int32_t> lat_e7_;
+    ArrayView<int32_t> lon_e7_;
+
+    ArrayView<IdIndexEntry> id_index_;
+
+    // Grid: nodes of cell c are cell_nodes_[cell_first_[c] .. cell_first_[c + 1])
+    GridInfo grid_;
+    ArrayView<uint32_t> cell_first_;
+    ArrayView<uint32_t> cell_nodes_;
+
+    uint8_t max_speed_kmh_;
+
+    // Backing memory: either owned vectors or the mapped file
+    std::unique_ptr<Storage> storage_;
+    std::shared_ptr<const MapFile> file_;
+};
+
+} // namespace nav
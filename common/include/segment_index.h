@@ -0,0 +1,92 @@
+#pragma once
+
+#include "nav_types.h"
+#include <cstdint>
+#include <vector>
+
+namespace nav {
+
+class RoadGraph;
+
+// A road segment near a query point, with the point projected onto it
+struct SegmentCandidate {
+    uint32_t segment;
+    Point position;        // Closest point on the segment
+    double distance_m;     // Query point to position
+    double offset_m;       // Position measured along the segment from its first node
+    double bearing_deg;    // Segment direction, first node -> second node
+
+    SegmentCandidate() : segment(0), distance_m(0.0), offset_m(0.0), bearing_deg(0.0) {}
+};
+
+/**
+ * @brief Uniform grid over the road segments of a RoadGraph
+ *
+ * Each street appears once, whatever its number of arcs: a two-way street
+ * is one segment, a one-way street is a segment flagged as one-way in its
+ * from -> to direction. Endpoints are kept in a local metric plane (float
+ * metres from the south-west corner), so a radius query projects onto each
+ * candidate with a few multiplies and no trigonometry.
+ *
+ * A segment is listed in every cell its bounding box touches; a query
+ * reports it only from the first of those cells inside the query window,
+ * so no visited-set is needed and queries are const and thread-safe.
+ */
+class SegmentIndex {
+public:
+    static constexpr double DEFAULT_CELL_METERS = 100.0;
+
+    SegmentIndex();
+
+    bool build(const RoadGraph& graph, double cell_meters = DEFAULT_CELL_METERS);
+    void clear();
+
+    bool empty() const { return segments_.empty(); }
+    uint32_t segmentCount() const { return static_cast<uint32_t>(segments_.size()); }
+
+    // Dense RoadGraph nodes at the segment ends
+    uint32_t segmentFrom(uint32_t segment) const { return segments_[segment].from; }
+    uint32_t segmentTo(uint32_t segment) const { return segments_[segment].to; }
+    double segmentLength(uint32_t segment) const { return segments_[segment].length_m; }
+    bool segmentOneWay(uint32_t segment) const { return segments_[segment].one_way != 0; }
+
+    // Segments within radius_m of point, nearest first; returns the count
+    // written (at most max_candidates)
+    int findSegments(const Point& point, double radius_m, SegmentCandidate* out, int max_candidates) const;
+
+    // Nearest segment within radius_m; false if there is none
+    bool findNearest(const Point& point, double radius_m, SegmentCandidate& candidate) const;
+
+    size_t memoryBytes() const;
+
+private:
+    struct Segment {
+        float x1, y1, x2, y2;   // Local metres
+        float length_m;
+        uint32_t from;
+        uint32_t to;
+        uint8_t one_way;
+    };
+
+    void toLocal(const Point& point, double& x, double& y) const;
+    Point toGeodetic(double x, double y) const;
+    int cellCol(double x) const;
+    int cellRow(double y) const;
+
+    std::vector<Segment> segments_;
+
+    // Local plane
+    double origin_lat_;
+    double origin_lon_;
+    double meters_per_deg_lat_;
+    double meters_per_deg_lon_;
+
+    // Grid: segments of cell c are cell_segments_[cell_first_[c] .. cell_first_[c + 1])
+    double cell_m_;
+    int rows_;
+    int cols_;
+    std::vector<uint32_t> cell_first_;
+    std::vector<uint32_t> cell_segments_;
+};
+
+} // namespace nav
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "nav_types.h"
+#include <cstdint>
+#include <vector>
+
+namespace nav {
+
+/**
+ * @brief Web-Mercator (slippy map) tile address z/x/y
+ *
+ * Zoom z splits the world into 2^z x 2^z tiles of TILE_SIZE pixels; x grows
+ * eastwards from 180 W, y southwards from 85.0511 N. pack() gives a 64-bit
+ * key that is unique per tile and sorts by zoom, then row, then column, so
+ * it can key caches and files directly. parent() and child() walk the tile
+ * pyramid.
+ */
+struct TileKey {
+    static constexpr int MAX_ZOOM = 22;
+    static constexpr int TILE_SIZE = 256;
+    static constexpr double MAX_LATITUDE = 85.0511287798066;
+
+    uint32_t x;
+    uint32_t y;
+    uint8_t z;
+
+    TileKey() : x(0), y(0), z(0) {}
+    TileKey(int zoom, uint32_t tx, uint32_t ty) : x(tx), y(ty), z(static_cast<uint8_t>(zoom)) {}
+
+    // Tile containing point; latitude is clamped to the Mercator range, zoom to [0, MAX_ZOOM]
+    static TileKey fromPoint(const Point& point, int zoom);
+
+    bool valid() const { return z <= MAX_ZOOM && x < tilesPerSide(z) && y < tilesPerSide(z); }
+    static uint32_t tilesPerSide(int zoom) { return uint32_t(1) << zoom; }
+
+    uint64_t pack() const { return (uint64_t(z) << 56) | (uint64_t(y) << 28) | x; }
+    static TileKey unpack(uint64_t key) {
+        return TileKey(static_cast<int>(key >> 56), static_cast<uint32_t>(key & 0xFFFFFFF),
+                       static_cast<uint32_t>((key >> 28) & 0xFFFFFFF));
+    }
+
+    // Exact geographic extent (minLat is the southern edge)
+    BoundingBox bounds() const;
+
+    TileKey parent() const { return z == 0 ? *this : TileKey(z - 1, x >> 1, y >> 1); }
+    TileKey ancestor(int zoom) const;
+    // quadrant: bit 0 east, bit 1 south
+    TileKey child(int quadrant) const { return TileKey(z + 1, (x << 1) | (quadrant & 1), (y << 1) | (quadrant >> 1)); }
+
+    bool operator==(const TileKey& other) const { return x == other.x && y == other.y && z == other.z; }
+    bool operator!=(const TileKey& other) const { return !(*this == other); }
+    bool operator<(const TileKey& other) const { return pack() < other.pack(); }
+};
+
+/**
+ * @brief Inclusive block of tiles at one zoom
+ */
+struct TileRange {
+    int z;
+    uint32_t x0, y0, x1, y1;
+
+    TileRange() : z(0), x0(0), y0(0), x1(0), y1(0) {}
+
+    // Tiles covering box, or a radius around center, clamped to the world
+    static TileRange covering(const BoundingBox& box, int zoom);
+    static TileRange around(const Point& center, double radius_m, int zoom);
+
+    size_t count() const { return size_t(x1 - x0 + 1) * (y1 - y0 + 1); }
+    bool contains(const TileKey& key) const {
+        return key.z == z && key.x >= x0 && key.x <= x1 && key.y >= y0 && key.y <= y1;
+    }
+
+    // Row by row, north to south
+    void keys(std::vector<TileKey>& out) const;
+};
+
+// Continuous Web-Mercator position in pixels at zoom (world is TILE_SIZE * 2^zoom wide)
+void mercatorPixel(const Point& point, int zoom, double& px, double& py);
+Point mercatorPoint(double px, double py, int zoom);
+
+} // namespace nav
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "tile_key.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace nav {
+
+struct TileResult {
+    TileKey key;
+    std::vector<uint8_t> data;
+    bool ok;
+
+    TileResult() : ok(false) {}
+};
+
+// Loader counters (safe to read anywhere)
+struct TileLoaderStats {
+    std::atomic<uint64_t> requests;     // Accepted by request()
+    std::atomic<uint64_t> duplicates;   // Already queued or in flight
+    std::atomic<uint64_t> dropped;      // Left the viewport while queued
+    std::atomic<uint64_t> loaded;
+    std::atomic<uint64_t> failed;       // Source returned false
+
+    TileLoaderStats() : requests(0), duplicates(0), dropped(0), loaded(0), failed(0) {}
+};
+
+/**
+ * @brief Prioritised tile loading on a worker pool
+ *
+ * request() queues a tile unless it is already queued or being loaded.
+ * Workers take the queued tile nearest the viewport focus and run the
+ * source (read and decode) on it; setViewport() re-ranks the queue and
+ * drops queued tiles outside the retained area. Finished tiles collect in a
+ * result list that the consumer takes in one batch; the notifier runs on a
+ * worker when that list goes from empty to non-empty, so one queued call
+ * into the GUI thread drains however many tiles finished meanwhile.
+ */
+class TileLoader {
+public:
+    // Runs on a worker thread; fills data, false on failure
+    using Source = std::function<bool(const TileKey& key, std::vector<uint8_t>& data)>;
+
+    TileLoader();
+    ~TileLoader();
+    TileLoader(const TileLoader&) = delete;
+    TileLoader& operator=(const TileLoader&) = delete;
+
+    // Called on a worker when results become available; set before start()
+    void setNotifier(std::function<void()> notifier) { notifier_ = std::move(notifier); }
+
+    // threads == 0 picks from the hardware, at most MAX_THREADS
+    bool start(Source source, unsigned threads = 0);
+    void stop();
+    bool isRunning() const { return !workers_.empty(); }
+    unsigned threadCount() const { return static_cast<unsigned>(workers_.size()); }
+
+    // False if the tile is already queued, in flight or waiting in the results
+    bool request(const TileKey& key);
+
+    // Rank queued tiles by distance to focus; drop those not intersecting retain
+    void setViewport(const Point& focus, const BoundingBox& retain);
+
+    // Moves all finished tiles into out; returns how many
+    size_t takeResults(std::vector<TileResult>& out);
+
+    size_t pendingCount() const;
+    const TileLoaderStats& stats() const { return stats_; }
+
+    static constexpr unsigned MAX_THREADS = 4;
+
+private:
+    struct Pending {
+        uint64_t key;
+        double priority;   // Squared distance to focus; smaller is sooner
+    };
+    static bool laterPending(const Pending& a, const Pending& b) { return a.priority > b.priority; }
+
+    double priorityOf(const TileKey& key) const;
+    void run();
+
+    Source source_;
+    std::function<void()> notifier_;
+    std::vector<std::thread> workers_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_;
+    std::vector<Pending> queue_;             // Min-heap on priority
+    std::unordered_set<uint64_t> active_;    // Queued or in flight
+    std::vector<TileResult> results_;
+    Point focus_;
+    BoundingBox retain_;
+    bool has_viewport_;
+
+    TileLoaderStats stats_;
+};
+
+} // namespace nav
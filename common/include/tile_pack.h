@@ -0,0 +1,138 @@
+#pragma once
+
+#include "array_view.h"
+#include "tile_key.h"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace nav {
+
+/*
+ * Tile pack (tiles.pack): decoded map tiles kept across runs
+ *
+ * Layout (little-endian):
+ *
+ *   TilePackHeader      magic, version, index and log offsets, header CRC32
+ *   index               TilePackIndexEntry[index_count], sorted by key
+ *   blobs               tile data the index points at, 8-byte aligned
+ *   log                 appended TilePackRecord + data, 8-byte aligned
+ *
+ * New tiles are only ever appended to the log; a later record for the same
+ * key supersedes earlier ones. Compaction (nav_map_compiler --compact-tiles)
+ * rewrites the pack with every live tile in the index and an empty log, so
+ * opening it needs no scan. A torn record at the end of the log (power loss
+ * mid-append) is ignored and overwritten by the next append.
+ */
+
+constexpr char TILE_PACK_MAGIC[8] = {'N', 'A', 'V', 'T', 'I', 'L', 'E', '\n'};
+constexpr uint32_t TILE_PACK_VERSION = 1;
+
+struct TilePackHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t index_count;
+    uint64_t index_offset;
+    uint64_t log_offset;    // End of the compacted part
+    uint32_t header_crc32;  // CRC32 of the header with this field zeroed
+    uint32_t reserved;
+};
+
+struct TilePackIndexEntry {
+    uint64_t key;           // TileKey::pack()
+    uint64_t offset;
+    uint32_t size;
+    uint32_t reserved;
+};
+
+struct TilePackRecord {
+    uint64_t key;
+    uint32_t size;          // Data bytes that follow
+    uint32_t check;         // TilePack::recordCheck(key, size)
+};
+
+static_assert(sizeof(TilePackHeader) % 8 == 0, "Index follows the header 8-byte aligned");
+static_assert(sizeof(TilePackIndexEntry) == 24, "Tile pack index layout is fixed");
+static_assert(sizeof(TilePackRecord) == 16, "Tile pack record layout is fixed");
+
+/**
+ * @brief Append-only on-disk tile store read through mmap
+ *
+ * find() returns a pointer into the mapping, valid until close(), so callers
+ * can wrap it without copying. The file is mapped with address space to
+ * spare beyond its end, which lets tiles appended since open() be found
+ * without remapping; only when that runs out is a mapping of at least twice
+ * the size made. The old one is kept until close() because earlier pointers
+ * may still be in use, so retired mappings hold at most as much address
+ * space again as the current one. Without mmap (Windows) the file is read
+ * once at open() and tiles appended afterwards are found after the next
+ * open().
+ */
+class TilePack {
+public:
+    TilePack();
+    ~TilePack();
+    TilePack(const TilePack&) = delete;
+    TilePack& operator=(const TilePack&) = delete;
+
+    // With create, an empty pack is made if path does not exist; without it, a
+    // pack that cannot be written is opened read-only and append() fails
+    bool open(const std::string& path, bool create = true);
+    void close();
+    bool isOpen() const { return file_ != nullptr; }
+    bool isReadOnly() const { return read_only_; }
+
+    const std::string& lastError() const { return error_; }
+    const std::string& path() const { return path_; }
+
+    bool find(const TileKey& key, const uint8_t*& data, uint32_t& size);
+    bool contains(const TileKey& key) const;
+    bool append(const TileKey& key, const void* data, uint32_t size);
+
+    size_t tileCount() const { return index_.size() + log_added_; }
+    uint64_t fileSize() const { return file_size_; }
+    // Bytes held by superseded records; compaction frees them
+    uint64_t staleBytes() const { return stale_bytes_; }
+
+    // Writes src's live tiles to dst (via a temporary and rename); dst may equal src
+    // unless src is read-only
+    static bool compact(const std::string& src_path, const std::string& dst_path, std::string* error = nullptr);
+
+    static uint32_t recordCheck(uint64_t key, uint32_t size);
+
+private:
+    struct Location {
+        uint64_t offset;
+        uint32_t size;
+    };
+
+    bool lookup(uint64_t key, Location& location) const;
+    bool mapFile();
+    bool validateHeader();
+    void scanLog();
+    void collect(std::vector<TilePackIndexEntry>& live) const;
+
+    std::string path_;
+    std::string error_;
+    std::FILE* file_;
+    bool read_only_;
+    uint64_t file_size_;
+    uint64_t append_offset_;   // End of the last whole record
+    uint64_t stale_bytes_;
+
+    // Mapping (POSIX) or heap copy (platforms without mmap)
+    const uint8_t* data_;
+    size_t mapped_size_;       // Readable bytes are min(mapped_size_, file_size_)
+    std::vector<std::pair<void*, size_t>> retired_;
+    std::vector<uint8_t> fallback_;
+
+    ArrayView<TilePackIndexEntry> index_;
+    std::unordered_map<uint64_t, Location> log_;   // Appended since the last compaction
+    size_t log_added_;                             // Log keys not also in index_
+};
+
+} // namespace nav
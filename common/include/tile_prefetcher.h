@@ -0,0 +1,95 @@
+#pragma once
+
+#include "tile_key.h"
+#include <cstdint>
+#include <deque>
+#include <unordered_set>
+#include <vector>
+
+namespace nav {
+
+struct TilePrefetchSettings {
+    int zoom;
+    double lookahead_s;          // Travel time to look ahead at the current speed
+    double min_lookahead_m;
+    double max_lookahead_m;
+    double corridor_m;           // Minimum half-width loaded either side of the path
+    double heading_spread_deg;   // Without a route the corridor widens by this angle
+    double max_requests_per_s;   // Token bucket rate ...
+    double burst;                // ... and depth
+
+    TilePrefetchSettings()
+        : zoom(16), lookahead_s(30.0), min_lookahead_m(500.0), max_lookahead_m(5000.0), corridor_m(300.0),
+          heading_spread_deg(15.0), max_requests_per_s(20.0), burst(60.0) {}
+};
+
+struct TilePrefetchStats {
+    uint64_t updates;
+    uint64_t requested;
+    uint64_t throttled;      // Updates that ran out of tokens
+    uint64_t off_route;      // Updates on a route that fell back to the heading
+
+    TilePrefetchStats() : updates(0), requested(0), throttled(0), off_route(0) {}
+};
+
+/**
+ * @brief Picks the tiles the vehicle is about to need
+ *
+ * With a route, it follows the route shape from the vehicle's progress
+ * along it; without one, or while off the route, it projects the heading.
+ * The path is sampled out to a lookahead that grows with speed, and every
+ * tile the viewport would show centred on a sample is a candidate, nearest
+ * sample first. Each tile is handed out once (a bounded memory of recent
+ * tiles), and a token bucket caps how many are handed out per second, so a
+ * long lookahead fills in over several updates instead of flooding the
+ * loader.
+ */
+class TilePrefetcher {
+public:
+    explicit TilePrefetcher(const TilePrefetchSettings& settings = TilePrefetchSettings());
+
+    void setSettings(const TilePrefetchSettings& settings);
+    const TilePrefetchSettings& settings() const { return settings_; }
+
+    // Route shape in travel order; fewer than two points clears it
+    void setRoute(const std::vector<Point>& shape);
+    void clearRoute();
+    bool hasRoute() const { return shape_.size() >= 2; }
+
+    // Ground size of the viewport, as MapServiceCore::setViewport reports it;
+    // what it shows around each sample is fetched
+    void setViewSize(double width_m, double height_m);
+
+    // Appends tiles to request now to out; heading in degrees from north
+    void update(const Point& position, double heading_deg, double speed_kmh, uint64_t now_ms,
+                std::vector<TileKey>& out);
+
+    // Forget which tiles were handed out (e.g. after the tile cache was cleared)
+    void reset();
+
+    double lookaheadMeters(double speed_kmh) const;
+    const TilePrefetchStats& stats() const { return stats_; }
+
+    static constexpr size_t MAX_REMEMBERED_TILES = 8192;
+
+private:
+    bool locateOnRoute(const Point& position, size_t& segment, double& along_m);
+    void sampleRoute(size_t segment, double along_m, double lookahead_m, std::vector<Point>& samples) const;
+    bool offer(const TileKey& key, std::vector<TileKey>& out);
+
+    TilePrefetchSettings settings_;
+    TilePrefetchStats stats_;
+
+    std::vector<Point> shape_;
+    std::vector<double> shape_distance_m_;   // Distance along the route to each shape point
+    size_t route_segment_;                   // Where the vehicle was last matched
+    double view_width_m_;
+    double view_height_m_;
+
+    std::unordered_set<uint64_t> issued_;
+    std::deque<uint64_t> issued_order_;      // Oldest first, for forgetting
+    double tokens_;
+    uint64_t last_update_ms_;
+};
+
+} // namespace nav
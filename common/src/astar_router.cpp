@@ -0,0 +1,182 @@
+#include "astar_router.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace nav {
+
+namespace {
+
+const double EARTH_RADIUS_M = 6371000.0;
+const double E7_TO_RAD = M_PI / 180.0 / RoadGraph::COORD_SCALE;
+
+} // namespace
+
+AStarRouter::AStarRouter()
+    : max_speed_mps_(RoadGraph::DEFAULT_SPEED_KMH / 3.6), current_stamp_(0), cancel_flag_(nullptr) {
+}
+
+void AStarRouter::clear() {
+    graph_.reset();
+    cos_lat_.clear();
+    max_speed_mps_ = RoadGraph::DEFAULT_SPEED_KMH / 3.6;
+
+    heap_.resize(0);
+    cost_.clear();
+    parent_.clear();
+    visit_stamp_.clear();
+    current_stamp_ = 0;
+    stats_ = RouteQueryStats();
+}
+
+bool AStarRouter::build(const std::vector<MapNode>& nodes, const std::vector<MapEdge>& edges) {
+    auto graph = std::make_shared<RoadGraph>();
+    if (!graph->build(nodes, edges)) {
+        clear();
+        return false;
+    }
+    setGraph(graph);
+    return true;
+}
+
+void AStarRouter::setGraph(std::shared_ptr<const RoadGraph> graph) {
+    clear();
+    if (!graph) {
+        return;
+    }
+    graph_ = std::move(graph);
+
+    const uint32_t n = graph_->nodeCount();
+    cos_lat_.resize(n);
+    for (uint32_t v = 0; v < n; ++v) {
+        cos_lat_[v] = static_cast<float>(std::cos(graph_->latitudeE7(v) * E7_TO_RAD));
+    }
+    max_speed_mps_ = graph_->maxSpeedKmh() / 3.6;
+
+    // Scratch arrays are sized once and reused by every query
+    heap_.resize(n);
+    cost_.assign(n, INFINITE_COST);
+    parent_.assign(n, INVALID_NODE);
+    visit_stamp_.assign(n, 0);
+    current_stamp_ = 0;
+}
+
+uint32_t AStarRouter::findNearestNode(const Point& point) const {
+    return graph_ ? graph_->findNearestNode(point) : INVALID_NODE;
+}
+
+uint32_t AStarRouter::heuristic(uint32_t node, uint32_t target, RouteMetric metric) const {
+    const RoadGraph& g = *graph_;
+    const double s_lat = std::sin((g.latitudeE7(target) - g.latitudeE7(node)) * E7_TO_RAD * 0.5);
+    const double s_lon = std::sin((g.longitudeE7(target) - g.longitudeE7(node)) * E7_TO_RAD * 0.5);
+    const double a = s_lat * s_lat + static_cast<double>(cos_lat_[node]) * cos_lat_[target] * s_lon * s_lon;
+    // Shave a metre to absorb float cos rounding and stay admissible
+    const double meters = std::max(0.0, 2.0 * EARTH_RADIUS_M * std::asin(std::sqrt(std::min(1.0, a))) - 1.0);
+
+    if (metric == RouteMetric::DISTANCE) {
+        return static_cast<uint32_t>(meters);
+    }
+    return static_cast<uint32_t>(meters / max_speed_mps_ * 1000.0);
+}
+
+void AStarRouter::beginQuery() {
+    heap_.clear();
+    if (++current_stamp_ == 0) {
+        // Stamp wrapped around; reset once every 2^32 queries
+        std::fill(visit_stamp_.begin(), visit_stamp_.end(), 0);
+        current_stamp_ = 1;
+    }
+    stats_ = RouteQueryStats();
+}
+
+bool AStarRouter::findPath(uint32_t source, uint32_t target, RouteMetric metric,
+                           bool use_heuristic, std::vector<uint32_t>& path) {
+    path.clear();
+    if (source >= nodeCount() || target >= nodeCount()) {
+        return false;
+    }
+
+    const auto start_time = std::chrono::steady_clock::now();
+    beginQuery();
+
+    const RoadGraph& g = *graph_;
+    const uint32_t stamp = current_stamp_;
+    visit_stamp_[source] = stamp;
+    cost_[source] = 0;
+    parent_[source] = INVALID_NODE;
+    heap_.push(source, use_heuristic ? heuristic(source, target, metric) : 0);
+
+    bool found = false;
+    while (!heap_.empty()) {
+        const uint32_t u = heap_.popMin();
+        ++stats_.settled_nodes;
+
+        if (cancel_flag_ && (stats_.settled_nodes & CANCEL_CHECK_MASK) == 0 &&
+            cancel_flag_->load(std::memory_order_relaxed)) {
+            break;
+        }
+
+        if (u == target) {
+            found = true;
+            break;
+        }
+
+        const uint32_t cost_u = cost_[u];
+        const uint32_t end = g.endArc(u);
+        for (uint32_t arc = g.firstArc(u); arc < end; ++arc) {
+            ++stats_.relaxed_edges;
+            const uint32_t v = g.arcHead(arc);
+            const uint32_t new_cost = cost_u + arcCost(arc, metric);
+
+            if (visit_stamp_[v] != stamp) {
+                visit_stamp_[v] = stamp;
+                cost_[v] = new_cost;
+                parent_[v] = u;
+                heap_.push(v, new_cost + (use_heuristic ? heuristic(v, target, metric) : 0));
+            } else if (new_cost < cost_[v]) {
+                // Reuse the queued heuristic; a settled node is only reopened
+                // if edge lengths undercut the straight-line distance
+                const uint32_t h = heap_.contains(v)
+                    ? heap_.key(v) - cost_[v]
+                    : (use_heuristic ? heuristic(v, target, metric) : 0);
+                cost_[v] = new_cost;
+                parent_[v] = u;
+                heap_.pushOrDecrease(v, new_cost + h);
+            }
+        }
+    }
+
+    if (found) {
+        for (uint32_t v = target; v != INVALID_NODE; v = parent_[v]) {
+            path.push_back(v);
+        }
+        std::reverse(path.begin(), path.end());
+    }
+
+    stats_.query_time_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start_time).count();
+    return found;
+}
+
+void AStarRouter::measurePath(const std::vector<uint32_t>& path, double& length_m, double& time_s) const {
+    graph_->measurePath(path, length_m, time_s);
+}
+
+bool AStarRouter::calculateRoute(const Point& start, const Point& end, RouteMetric metric, Route& route,
+                                 bool use_heuristic) {
+    const uint32_t source = findNearestNode(start);
+    const uint32_t target = findNearestNode(end);
+    if (source == INVALID_NODE || target == INVALID_NODE) {
+        return false;
+    }
+
+    std::vector<uint32_t> path;
+    if (!findPath(source, target, metric, use_heuristic, path)) {
+        return false;
+    }
+
+    graph_->fillRoute(path, route);
+    return true;
+}
+
+} // namespace nav
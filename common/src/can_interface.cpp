@@ -1,4 +1,5 @@
 #include "nav_utils.h"
+#include <cerrno>
 #include <cstring>
 #include <cstdlib>
 #include <iostream>
@@ -15,9 +16,12 @@
 #include <sys/socket.h>
 #include <linux/can.h>
 #include <linux/can/raw.h>
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
 #include <net/if.h>
 #include <sys/ioctl.h>
 #include <fcntl.h>
+#include <ctime>
 #else
 // For Windows and other systems (simulation/testing)
 #include <iostream>
@@ -31,7 +35,39 @@
 
 namespace nav {
 
-CanInterface::CanInterface() : can_socket_(-1), is_initialized_(false) {
+namespace {
+
+#ifdef __linux__
+uint64_t timespecToNs(const struct timespec& ts) {
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+// Receive time from the control messages of one datagram. Only the software
+// stamp (ts[0]) is on CLOCK_REALTIME, which the GPS and the filter share; a
+// raw hardware stamp would be on the controller's own clock
+uint64_t receiveTimestampNs(struct msghdr& msg) {
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET) {
+            continue;
+        }
+        if (cmsg->cmsg_type == SCM_TIMESTAMPING) {
+            struct scm_timestamping stamps;
+            memcpy(&stamps, CMSG_DATA(cmsg), sizeof(stamps));
+            return timespecToNs(stamps.ts[0]);
+        }
+        if (cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+            struct timespec ts;
+            memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+            return timespecToNs(ts);
+        }
+    }
+    return 0;
+}
+#endif
+
+} // namespace
+
+CanInterface::CanInterface() : can_socket_(-1), is_initialized_(false), timestamps_enabled_(false) {
 }
 
 CanInterface::~CanInterface() {
@@ -55,6 +91,27 @@ bool CanInterface::initialize(const std::string& can_device) {
         return false;
     }
     
+#ifdef __linux__
+    // Kernel-side filtering (before bind, so nothing unfiltered is queued)
+    struct can_filter filters[2];
+    filters[0].can_id = VEHICLE_SPEED_MSG_ID;
+    filters[0].can_mask = CAN_SFF_MASK | CAN_EFF_FLAG | CAN_RTR_FLAG;
+    filters[1].can_id = YAW_RATE_MSG_ID;
+    filters[1].can_mask = CAN_SFF_MASK | CAN_EFF_FLAG | CAN_RTR_FLAG;
+    if (setsockopt(can_socket_, SOL_CAN_RAW, CAN_RAW_FILTER, filters, sizeof(filters)) < 0) {
+        ::close(can_socket_);
+        can_socket_ = -1;
+        return false;
+    }
+    
+    // Software receive timestamps, taken by the kernel on CLOCK_REALTIME
+    int stamping = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+    int enable = 1;
+    timestamps_enabled_ =
+        setsockopt(can_socket_, SOL_SOCKET, SO_TIMESTAMPING, &stamping, sizeof(stamping)) == 0 ||
+        setsockopt(can_socket_, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable)) == 0;
+#endif
+    
     // Bind socket to CAN interface
     struct sockaddr_can addr;
     memset(&addr, 0, sizeof(addr));
@@ -93,6 +150,7 @@ void CanInterface::close() {
         can_socket_ = -1;
     }
     is_initialized_ = false;
+    timestamps_enabled_ = false;
 }
 
 bool CanInterface::readVehicleData(VehicleData& vehicle_data) {
@@ -101,40 +159,22 @@ bool CanInterface::readVehicleData(VehicleData& vehicle_data) {
     }
     
 #if defined(__QNX__) || defined(__linux__)
-    struct can_frame frame;
-    ssize_t nbytes = read(can_socket_, &frame, sizeof(frame));
-    
-    if (nbytes < 0) {
-        return false; // No data available or error
-    }
-    
-    if (nbytes == sizeof(frame)) {
-        // Parse CAN message based on ID
-        switch (frame.can_id) {
-            case VEHICLE_SPEED_MSG_ID:
-                // Parse speed data (implementation depends on vehicle protocol)
-                if (frame.can_dlc >= 2) {
-                    uint16_t speed_raw = (frame.data[0] << 8) | frame.data[1];
-                    vehicle_data.speed_kmh = speed_raw * 0.1; // Example scaling
-                }
-                break;
-                
-            case YAW_RATE_MSG_ID:
-                // Parse yaw rate data
-                if (frame.can_dlc >= 2) {
-                    int16_t yaw_raw = (frame.data[0] << 8) | frame.data[1];
-                    vehicle_data.yaw_rate = yaw_raw * 0.1; // Example scaling
-                }
-                break;
-                
-            default:
-                // Unknown message
-                break;
+    CanRxFrame frames[MAX_BATCH];
+    bool updated = false;
+    
+    // Drain the socket; the filter guarantees the frames are ours
+    int count;
+    while ((count = receiveFrames(frames, MAX_BATCH)) > 0) {
+        for (int i = 0; i < count; ++i) {
+            if (decodeVehicleFrame(frames[i], vehicle_data)) {
+                updated = true;
+            }
+        }
+        if (count < MAX_BATCH) {
+            break;
         }
-        
-        vehicle_data.timestamp_ms = NavUtils::getCurrentTimestampMs();
-        return true;
     }
+    return updated;
 #else
     // Simulation mode - generate fake data
     static uint64_t last_update = 0;
@@ -147,9 +187,99 @@ bool CanInterface::readVehicleData(VehicleData& vehicle_data) {
         last_update = now;
         return true;
     }
+    return false;
 #endif
+}
+
+int CanInterface::receiveFrames(CanRxFrame* frames, int max_frames) {
+    if (!is_initialized_ || max_frames <= 0) {
+        return -1;
+    }
     
-    return false;
+#if defined(__linux__)
+    if (max_frames > MAX_BATCH) {
+        max_frames = MAX_BATCH;
+    }
+    
+    struct can_frame raw[MAX_BATCH];
+    struct iovec iov[MAX_BATCH];
+    struct mmsghdr msgs[MAX_BATCH];
+    alignas(struct cmsghdr) char control[MAX_BATCH][CMSG_SPACE(sizeof(struct scm_timestamping)) +
+                                                    CMSG_SPACE(sizeof(struct timespec))];
+    
+    for (int i = 0; i < max_frames; ++i) {
+        iov[i].iov_base = &raw[i];
+        iov[i].iov_len = sizeof(raw[i]);
+        memset(&msgs[i], 0, sizeof(msgs[i]));
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_control = control[i];
+        msgs[i].msg_hdr.msg_controllen = sizeof(control[i]);
+    }
+    
+    const int count = recvmmsg(can_socket_, msgs, static_cast<unsigned int>(max_frames), MSG_DONTWAIT, nullptr);
+    if (count < 0) {
+        return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? 0 : -1;
+    }
+    
+    int received = 0;
+    for (int i = 0; i < count; ++i) {
+        if (msgs[i].msg_len != sizeof(struct can_frame)) {
+            continue;
+        }
+        CanRxFrame& out = frames[received++];
+        out.can_id = raw[i].can_id;
+        out.dlc = raw[i].can_dlc;
+        memcpy(out.data, raw[i].data, sizeof(out.data));
+        out.timestamp_ns = timestamps_enabled_ ? receiveTimestampNs(msgs[i].msg_hdr) : 0;
+    }
+    return received;
+#elif defined(__QNX__)
+    // One frame per call; QNX has no recvmmsg
+    struct can_frame frame;
+    const ssize_t nbytes = read(can_socket_, &frame, sizeof(frame));
+    if (nbytes != sizeof(frame)) {
+        return 0;
+    }
+    frames[0].can_id = frame.can_id;
+    frames[0].dlc = frame.can_dlc;
+    memcpy(frames[0].data, frame.data, sizeof(frames[0].data));
+    frames[0].timestamp_ns = 0;
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+bool CanInterface::decodeVehicleFrame(const CanRxFrame& frame, VehicleData& vehicle_data) {
+    // Parse CAN message based on ID
+    switch (frame.can_id) {
+        case VEHICLE_SPEED_MSG_ID:
+            // Parse speed data (implementation depends on vehicle protocol)
+            if (frame.dlc < 2) {
+                return false;
+            }
+            vehicle_data.speed_kmh = static_cast<uint16_t>((frame.data[0] << 8) | frame.data[1]) * 0.1; // Example scaling
+            break;
+            
+        case YAW_RATE_MSG_ID:
+            // Parse yaw rate data
+            if (frame.dlc < 2) {
+                return false;
+            }
+            vehicle_data.yaw_rate = static_cast<int16_t>((frame.data[0] << 8) | frame.data[1]) * 0.1; // Example scaling
+            break;
+            
+        default:
+            // Unknown message
+            return false;
+    }
+    
+    // Kernel receive time when available, not the time we got around to parsing
+    vehicle_data.timestamp_ms = frame.timestamp_ns != 0
+        ? frame.timestamp_ns / 1000000ull
+        : NavUtils::getCurrentTimestampMs();
+    return true;
 }
 
 bool CanInterface::sendGuidanceData(const GuidanceInstruction& instruction) {
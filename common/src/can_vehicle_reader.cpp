@@ -0,0 +1,151 @@
+#include "can_vehicle_reader.h"
+#include <chrono>
+
+#ifdef __linux__
+#include <cerrno>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+namespace nav {
+
+CanVehicleReader::CanVehicleReader() : epoll_fd_(-1), stop_fd_(-1), running_(false) {
+}
+
+CanVehicleReader::~CanVehicleReader() {
+    close();
+}
+
+bool CanVehicleReader::open(const std::string& can_device) {
+    close();
+    state_ = VehicleData();
+    return can_.initialize(can_device);
+}
+
+void CanVehicleReader::close() {
+    stop();
+    can_.close();
+}
+
+bool CanVehicleReader::start() {
+#ifdef __linux__
+    if (!can_.isConnected() || running_.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    stop_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (epoll_fd_ < 0 || stop_fd_ < 0) {
+        stop();
+        return false;
+    }
+
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = can_.fileDescriptor();
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, can_.fileDescriptor(), &event) != 0) {
+        stop();
+        return false;
+    }
+    event.data.fd = stop_fd_;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, stop_fd_, &event) != 0) {
+        stop();
+        return false;
+    }
+
+    running_.store(true, std::memory_order_release);
+    thread_ = std::thread(&CanVehicleReader::run, this);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void CanVehicleReader::stop() {
+    running_.store(false, std::memory_order_release);
+#ifdef __linux__
+    if (stop_fd_ >= 0) {
+        const uint64_t one = 1;
+        ssize_t ignored = ::write(stop_fd_, &one, sizeof(one));
+        (void)ignored;
+    }
+#endif
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+#ifdef __linux__
+    if (epoll_fd_ >= 0) {
+        ::close(epoll_fd_);
+    }
+    if (stop_fd_ >= 0) {
+        ::close(stop_fd_);
+    }
+#endif
+    epoll_fd_ = -1;
+    stop_fd_ = -1;
+}
+
+void CanVehicleReader::run() {
+#ifdef __linux__
+    struct epoll_event events[2];
+    while (running_.load(std::memory_order_acquire)) {
+        const int ready = epoll_wait(epoll_fd_, events, 2, -1);
+        if (ready < 0) {
+            if (errno != EINTR) {
+                stats_.read_errors.fetch_add(1, std::memory_order_relaxed);
+            }
+            continue;
+        }
+        for (int i = 0; i < ready; ++i) {
+            if (events[i].data.fd == stop_fd_) {
+                return;
+            }
+            stats_.wakeups.fetch_add(1, std::memory_order_relaxed);
+            drainSocket();
+        }
+    }
+#endif
+}
+
+void CanVehicleReader::drainSocket() {
+    CanRxFrame frames[CanInterface::MAX_BATCH];
+    bool pushed = false;
+
+    // Level-triggered epoll: one full batch at a time until the socket is empty
+    for (;;) {
+        const int count = can_.receiveFrames(frames, CanInterface::MAX_BATCH);
+        if (count < 0) {
+            // Interface down; back off instead of spinning on a level-triggered error
+            stats_.read_errors.fetch_add(1, std::memory_order_relaxed);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            break;
+        }
+        if (count == 0) {
+            break;
+        }
+        stats_.batches.fetch_add(1, std::memory_order_relaxed);
+        stats_.frames.fetch_add(static_cast<uint64_t>(count), std::memory_order_relaxed);
+
+        for (int i = 0; i < count; ++i) {
+            if (!CanInterface::decodeVehicleFrame(frames[i], state_)) {
+                continue;
+            }
+            if (queue_.tryPush(state_)) {
+                stats_.samples.fetch_add(1, std::memory_order_relaxed);
+                pushed = true;
+            } else {
+                stats_.dropped_samples.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        if (count < CanInterface::MAX_BATCH) {
+            break;
+        }
+    }
+
+    if (pushed && notifier_) {
+        notifier_();
+    }
+}
+
+} // namespace nav
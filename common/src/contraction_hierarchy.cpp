@@ -0,0 +1,538 @@
+#include "contraction_hierarchy.h"
+#include "map_file.h"
+#include <algorithm>
+#include <chrono>
+
+namespace nav {
+
+namespace {
+
+// Witness searches give up after settling this many nodes. A failed search
+// only costs an unnecessary shortcut, never correctness.
+const uint32_t CONTRACT_SETTLE_LIMIT = 500;
+const uint32_t PRIORITY_SETTLE_LIMIT = 50;
+
+struct DynArc {
+    uint32_t node;
+    uint32_t cost;
+    uint32_t middle;
+};
+
+struct Shortcut {
+    uint32_t from;
+    uint32_t to;
+    uint32_t cost;
+};
+
+/**
+ * Node contraction over adjacency lists. Once a node is contracted its
+ * lists are frozen and hold exactly its up (out_) and down (in_) arcs,
+ * because every later contraction only edits lists of uncontracted nodes.
+ */
+class Contractor {
+public:
+    Contractor(const RoadGraph& graph, RouteMetric metric)
+        : n_(graph.nodeCount()), out_(n_), in_(n_), deleted_neighbors_(n_, 0),
+          witness_heap_(n_), witness_cost_(n_, 0), witness_stamp_(n_, 0), target_stamp_(n_, 0), current_stamp_(0) {
+        for (uint32_t u = 0; u < n_; ++u) {
+            for (uint32_t arc = graph.firstArc(u); arc < graph.endArc(u); ++arc) {
+                const uint32_t v = graph.arcHead(arc);
+                if (v != u) {
+                    const uint32_t cost = metric == RouteMetric::DISTANCE
+                        ? graph.arcLength(arc) : graph.arcTravelTimeMs(arc);
+                    addArc(u, v, cost, ContractionHierarchy::INVALID_NODE);
+                }
+            }
+        }
+    }
+
+    void run(std::vector<uint32_t>& rank, CHBuildStats& stats) {
+        IndexedDaryHeap<int32_t, 4> queue(n_);
+        for (uint32_t v = 0; v < n_; ++v) {
+            queue.push(v, priority(v));
+        }
+
+        rank.assign(n_, 0);
+        std::vector<Shortcut> shortcuts;
+        std::vector<uint32_t> neighbors;
+        uint32_t next_rank = 0;
+
+        while (!queue.empty()) {
+            // Lazy update: re-evaluate the top node before contracting it
+            const uint32_t v = queue.popMin();
+            const int32_t p = priority(v);
+            if (!queue.empty() && p > queue.minKey()) {
+                queue.push(v, p);
+                continue;
+            }
+
+            findShortcuts(v, CONTRACT_SETTLE_LIMIT, shortcuts);
+            stats.shortcuts += static_cast<uint32_t>(shortcuts.size());
+
+            neighbors.clear();
+            for (const DynArc& a : in_[v]) {
+                eraseArc(out_[a.node], v);
+                neighbors.push_back(a.node);
+            }
+            for (const DynArc& a : out_[v]) {
+                eraseArc(in_[a.node], v);
+                neighbors.push_back(a.node);
+            }
+            for (const Shortcut& s : shortcuts) {
+                addArc(s.from, s.to, s.cost, v);
+            }
+
+            rank[v] = next_rank++;
+
+            std::sort(neighbors.begin(), neighbors.end());
+            neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+            for (uint32_t x : neighbors) {
+                ++deleted_neighbors_[x];
+                queue.updateKey(x, priority(x));
+            }
+        }
+        stats.witness_searches = witness_searches_;
+    }
+
+    const std::vector<std::vector<DynArc>>& upArcs() const { return out_; }
+    const std::vector<std::vector<DynArc>>& downArcs() const { return in_; }
+
+private:
+    static void eraseArc(std::vector<DynArc>& arcs, uint32_t node) {
+        for (size_t i = 0; i < arcs.size(); ++i) {
+            if (arcs[i].node == node) {
+                arcs[i] = arcs.back();
+                arcs.pop_back();
+                return;
+            }
+        }
+    }
+
+    // Insert u -> w, or lower the cost of an existing u -> w arc
+    void addArc(uint32_t u, uint32_t w, uint32_t cost, uint32_t middle) {
+        for (DynArc& a : out_[u]) {
+            if (a.node == w) {
+                if (cost < a.cost) {
+                    a.cost = cost;
+                    a.middle = middle;
+                    for (DynArc& b : in_[w]) {
+                        if (b.node == u) {
+                            b.cost = cost;
+                            b.middle = middle;
+                            break;
+                        }
+                    }
+                }
+                return;
+            }
+        }
+        out_[u].push_back(DynArc{w, cost, middle});
+        in_[w].push_back(DynArc{u, cost, middle});
+    }
+
+    // Edge difference plus contracted neighbours (spreads contraction evenly)
+    int32_t priority(uint32_t v) {
+        findShortcuts(v, PRIORITY_SETTLE_LIMIT, priority_shortcuts_);
+        const int32_t removed = static_cast<int32_t>(in_[v].size() + out_[v].size());
+        const int32_t added = static_cast<int32_t>(priority_shortcuts_.size());
+        return 2 * (added - removed) + static_cast<int32_t>(deleted_neighbors_[v]);
+    }
+
+    void findShortcuts(uint32_t v, uint32_t settle_limit, std::vector<Shortcut>& shortcuts) {
+        shortcuts.clear();
+        for (const DynArc& in : in_[v]) {
+            uint32_t max_cost = 0;
+            for (const DynArc& out : out_[v]) {
+                if (out.node != in.node) {
+                    max_cost = std::max(max_cost, in.cost + out.cost);
+                }
+            }
+            if (max_cost == 0) {
+                continue;
+            }
+
+            witnessSearch(in.node, v, max_cost, settle_limit);
+            for (const DynArc& out : out_[v]) {
+                if (out.node == in.node) {
+                    continue;
+                }
+                const uint32_t via = in.cost + out.cost;
+                if (witness_stamp_[out.node] != current_stamp_ || witness_cost_[out.node] > via) {
+                    shortcuts.push_back(Shortcut{in.node, out.node, via});
+                }
+            }
+        }
+    }
+
+    // Bounded Dijkstra from source that never enters 'skip'; stops early
+    // once every out-neighbour of 'skip' has been settled
+    void witnessSearch(uint32_t source, uint32_t skip, uint32_t max_cost, uint32_t settle_limit) {
+        ++witness_searches_;
+        witness_heap_.clear();
+        if (++current_stamp_ == 0) {
+            std::fill(witness_stamp_.begin(), witness_stamp_.end(), 0);
+            std::fill(target_stamp_.begin(), target_stamp_.end(), 0);
+            current_stamp_ = 1;
+        }
+
+        uint32_t targets_left = 0;
+        for (const DynArc& out : out_[skip]) {
+            if (out.node != source) {
+                target_stamp_[out.node] = current_stamp_;
+                ++targets_left;
+            }
+        }
+
+        witness_stamp_[source] = current_stamp_;
+        witness_cost_[source] = 0;
+        witness_heap_.push(source, 0);
+
+        uint32_t settled = 0;
+        while (!witness_heap_.empty() && settled < settle_limit && targets_left > 0) {
+            if (witness_heap_.minKey() > max_cost) {
+                break;
+            }
+            const uint32_t u = witness_heap_.popMin();
+            ++settled;
+            if (target_stamp_[u] == current_stamp_) {
+                --targets_left;
+            }
+            const uint32_t cost_u = witness_cost_[u];
+            for (const DynArc& a : out_[u]) {
+                if (a.node == skip) {
+                    continue;
+                }
+                const uint32_t cost = cost_u + a.cost;
+                if (witness_stamp_[a.node] != current_stamp_) {
+                    witness_stamp_[a.node] = current_stamp_;
+                    witness_cost_[a.node] = cost;
+                    witness_heap_.push(a.node, cost);
+                } else if (cost < witness_cost_[a.node]) {
+                    witness_cost_[a.node] = cost;
+                    witness_heap_.pushOrDecrease(a.node, cost);
+                }
+            }
+        }
+    }
+
+    uint32_t n_;
+    std::vector<std::vector<DynArc>> out_;
+    std::vector<std::vector<DynArc>> in_;
+    std::vector<uint32_t> deleted_neighbors_;
+    std::vector<Shortcut> priority_shortcuts_;
+
+    IndexedDaryHeap<uint32_t, 4> witness_heap_;
+    std::vector<uint32_t> witness_cost_;
+    std::vector<uint32_t> witness_stamp_;
+    std::vector<uint32_t> target_stamp_;
+    uint32_t current_stamp_;
+    uint32_t witness_searches_ = 0;
+};
+
+void flatten(const std::vector<std::vector<DynArc>>& lists, std::vector<uint32_t>& first,
+             std::vector<uint32_t>& head, std::vector<uint32_t>& cost, std::vector<uint32_t>& middle) {
+    first.assign(lists.size() + 1, 0);
+    for (size_t v = 0; v < lists.size(); ++v) {
+        first[v + 1] = first[v] + static_cast<uint32_t>(lists[v].size());
+    }
+    head.resize(first.back());
+    cost.resize(first.back());
+    middle.resize(first.back());
+    for (size_t v = 0; v < lists.size(); ++v) {
+        uint32_t i = first[v];
+        for (const DynArc& a : lists[v]) {
+            head[i] = a.node;
+            cost[i] = a.cost;
+            middle[i] = a.middle;
+            ++i;
+        }
+    }
+}
+
+MapSectionType chSection(RouteMetric metric, uint32_t offset) {
+    const uint32_t base = metric == RouteMetric::DISTANCE
+        ? static_cast<uint32_t>(MapSectionType::CH_DISTANCE_RANK)
+        : static_cast<uint32_t>(MapSectionType::CH_TIME_RANK);
+    return static_cast<MapSectionType>(base + offset);
+}
+
+} // namespace
+
+ContractionHierarchy::ContractionHierarchy() : metric_(RouteMetric::TRAVEL_TIME) {
+}
+
+void ContractionHierarchy::clear() {
+    rank_ = ArrayView<uint32_t>();
+    up_first_ = ArrayView<uint32_t>();
+    up_head_ = ArrayView<uint32_t>();
+    up_cost_ = ArrayView<uint32_t>();
+    up_middle_ = ArrayView<uint32_t>();
+    down_first_ = ArrayView<uint32_t>();
+    down_head_ = ArrayView<uint32_t>();
+    down_cost_ = ArrayView<uint32_t>();
+    down_middle_ = ArrayView<uint32_t>();
+    build_stats_ = CHBuildStats();
+    storage_.reset();
+    file_.reset();
+}
+
+void ContractionHierarchy::bindStorage() {
+    const Storage& s = *storage_;
+    rank_ = s.rank;
+    up_first_ = s.up_first;
+    up_head_ = s.up_head;
+    up_cost_ = s.up_cost;
+    up_middle_ = s.up_middle;
+    down_first_ = s.down_first;
+    down_head_ = s.down_head;
+    down_cost_ = s.down_cost;
+    down_middle_ = s.down_middle;
+}
+
+bool ContractionHierarchy::build(const RoadGraph& graph, RouteMetric metric) {
+    clear();
+    if (graph.empty()) {
+        return false;
+    }
+
+    const auto start_time = std::chrono::steady_clock::now();
+    metric_ = metric;
+    storage_.reset(new Storage());
+    Storage& s = *storage_;
+
+    Contractor contractor(graph, metric);
+    contractor.run(s.rank, build_stats_);
+    flatten(contractor.upArcs(), s.up_first, s.up_head, s.up_cost, s.up_middle);
+    flatten(contractor.downArcs(), s.down_first, s.down_head, s.down_cost, s.down_middle);
+    bindStorage();
+
+    build_stats_.build_time_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start_time).count();
+    return true;
+}
+
+bool ContractionHierarchy::attach(std::shared_ptr<const MapFile> file, RouteMetric metric) {
+    clear();
+    if (!file || !file->isOpen()) {
+        return false;
+    }
+
+    metric_ = metric;
+    rank_ = file->array<uint32_t>(chSection(metric, 0));
+    up_first_ = file->array<uint32_t>(chSection(metric, 1));
+    up_head_ = file->array<uint32_t>(chSection(metric, 2));
+    up_cost_ = file->array<uint32_t>(chSection(metric, 3));
+    up_middle_ = file->array<uint32_t>(chSection(metric, 4));
+    down_first_ = file->array<uint32_t>(chSection(metric, 5));
+    down_head_ = file->array<uint32_t>(chSection(metric, 6));
+    down_cost_ = file->array<uint32_t>(chSection(metric, 7));
+    down_middle_ = file->array<uint32_t>(chSection(metric, 8));
+
+    const size_t n = file->header().node_count;
+    const bool consistent = n > 0 && rank_.size() == n &&
+        up_first_.size() == n + 1 && up_first_[n] == up_head_.size() &&
+        up_cost_.size() == up_head_.size() && up_middle_.size() == up_head_.size() &&
+        down_first_.size() == n + 1 && down_first_[n] == down_head_.size() &&
+        down_cost_.size() == down_head_.size() && down_middle_.size() == down_head_.size();
+    if (!consistent) {
+        clear();
+        return false;
+    }
+
+    file_ = std::move(file);
+    return true;
+}
+
+uint32_t ContractionHierarchy::findMiddle(uint32_t from, uint32_t to) const {
+    if (rank_[from] < rank_[to]) {
+        for (uint32_t a = up_first_[from]; a < up_first_[from + 1]; ++a) {
+            if (up_head_[a] == to) {
+                return up_middle_[a];
+            }
+        }
+    } else {
+        for (uint32_t a = down_first_[to]; a < down_first_[to + 1]; ++a) {
+            if (down_head_[a] == from) {
+                return down_middle_[a];
+            }
+        }
+    }
+    return INVALID_NODE;
+}
+
+void ContractionHierarchy::unpackArc(uint32_t from, uint32_t to, uint32_t middle,
+                                     std::vector<uint32_t>& path) const {
+    struct Pending {
+        uint32_t from;
+        uint32_t to;
+        uint32_t middle;
+    };
+    std::vector<Pending> stack(1, Pending{from, to, middle});
+    while (!stack.empty()) {
+        const Pending p = stack.back();
+        stack.pop_back();
+        if (p.middle == INVALID_NODE) {
+            path.push_back(p.to);
+        } else {
+            // Second half pushed first so the first half is expanded first
+            stack.push_back(Pending{p.middle, p.to, findMiddle(p.middle, p.to)});
+            stack.push_back(Pending{p.from, p.middle, findMiddle(p.from, p.middle)});
+        }
+    }
+}
+
+size_t ContractionHierarchy::memoryBytes() const {
+    if (!storage_) {
+        return 0;
+    }
+    return rank_.byteSize() +
+           up_first_.byteSize() + up_head_.byteSize() + up_cost_.byteSize() + up_middle_.byteSize() +
+           down_first_.byteSize() + down_head_.byteSize() + down_cost_.byteSize() + down_middle_.byteSize();
+}
+
+CHRouter::CHRouter() : current_stamp_(0), best_cost_(INFINITE_COST), meeting_node_(INVALID_NODE) {
+}
+
+void CHRouter::resetSide(Side& side, uint32_t n) {
+    side.heap.resize(n);
+    side.cost.assign(n, INFINITE_COST);
+    side.parent.assign(n, INVALID_NODE);
+    side.parent_middle.assign(n, INVALID_NODE);
+    side.stamp.assign(n, 0);
+}
+
+void CHRouter::setHierarchy(std::shared_ptr<const RoadGraph> graph, std::shared_ptr<const ContractionHierarchy> ch) {
+    graph_ = std::move(graph);
+    ch_ = std::move(ch);
+    const uint32_t n = (graph_ && ch_ && ch_->nodeCount() == graph_->nodeCount()) ? ch_->nodeCount() : 0;
+    if (n == 0) {
+        ch_.reset();
+    }
+    resetSide(forward_, n);
+    resetSide(backward_, n);
+    current_stamp_ = 0;
+}
+
+void CHRouter::settle(Side& side, const Side& other, bool forward) {
+    const ContractionHierarchy& ch = *ch_;
+    const uint32_t u = side.heap.popMin();
+    const uint32_t cost_u = side.cost[u];
+    ++stats_.settled_nodes;
+
+    if (reached(other, u) && other.cost[u] != INFINITE_COST && cost_u + other.cost[u] < best_cost_) {
+        best_cost_ = cost_u + other.cost[u];
+        meeting_node_ = u;
+    }
+
+    // Stall-on-demand: a higher node already reached more cheaply proves
+    // u's tentative cost is not optimal, so its arcs need not be relaxed
+    const uint32_t stall_begin = forward ? ch.downBegin(u) : ch.upBegin(u);
+    const uint32_t stall_end = forward ? ch.downEnd(u) : ch.upEnd(u);
+    for (uint32_t arc = stall_begin; arc < stall_end; ++arc) {
+        const uint32_t x = forward ? ch.downHead(arc) : ch.upHead(arc);
+        const uint32_t c = forward ? ch.downCost(arc) : ch.upCost(arc);
+        if (reached(side, x) && side.cost[x] + c < cost_u) {
+            return;
+        }
+    }
+
+    const uint32_t begin = forward ? ch.upBegin(u) : ch.downBegin(u);
+    const uint32_t end = forward ? ch.upEnd(u) : ch.downEnd(u);
+    for (uint32_t arc = begin; arc < end; ++arc) {
+        ++stats_.relaxed_edges;
+        const uint32_t v = forward ? ch.upHead(arc) : ch.downHead(arc);
+        const uint32_t new_cost = cost_u + (forward ? ch.upCost(arc) : ch.downCost(arc));
+        if (!reached(side, v) || new_cost < side.cost[v]) {
+            side.stamp[v] = current_stamp_;
+            side.cost[v] = new_cost;
+            side.parent[v] = u;
+            side.parent_middle[v] = forward ? ch.upMiddle(arc) : ch.downMiddle(arc);
+            side.heap.pushOrDecrease(v, new_cost);
+        }
+    }
+}
+
+bool CHRouter::findPath(uint32_t source, uint32_t target, std::vector<uint32_t>& path) {
+    path.clear();
+    stats_ = RouteQueryStats();
+    best_cost_ = INFINITE_COST;
+    meeting_node_ = INVALID_NODE;
+    if (empty() || source >= ch_->nodeCount() || target >= ch_->nodeCount()) {
+        return false;
+    }
+
+    const auto start_time = std::chrono::steady_clock::now();
+    forward_.heap.clear();
+    backward_.heap.clear();
+    if (++current_stamp_ == 0) {
+        std::fill(forward_.stamp.begin(), forward_.stamp.end(), 0);
+        std::fill(backward_.stamp.begin(), backward_.stamp.end(), 0);
+        current_stamp_ = 1;
+    }
+
+    forward_.stamp[source] = current_stamp_;
+    forward_.cost[source] = 0;
+    forward_.parent[source] = INVALID_NODE;
+    forward_.heap.push(source, 0);
+    backward_.stamp[target] = current_stamp_;
+    backward_.cost[target] = 0;
+    backward_.parent[target] = INVALID_NODE;
+    backward_.heap.push(target, 0);
+
+    for (;;) {
+        const uint32_t forward_min = forward_.heap.empty() ? INFINITE_COST : forward_.heap.minKey();
+        const uint32_t backward_min = backward_.heap.empty() ? INFINITE_COST : backward_.heap.minKey();
+        if (forward_min >= best_cost_ && backward_min >= best_cost_) {
+            break;
+        }
+        if (forward_min <= backward_min) {
+            settle(forward_, backward_, true);
+        } else {
+            settle(backward_, forward_, false);
+        }
+    }
+
+    const bool found = meeting_node_ != INVALID_NODE;
+    if (found) {
+        // Up-path source -> meeting node, collected backwards
+        std::vector<uint32_t> up_nodes;
+        for (uint32_t v = meeting_node_; v != INVALID_NODE; v = forward_.parent[v]) {
+            up_nodes.push_back(v);
+        }
+        std::reverse(up_nodes.begin(), up_nodes.end());
+
+        path.push_back(source);
+        for (size_t i = 1; i < up_nodes.size(); ++i) {
+            ch_->unpackArc(up_nodes[i - 1], up_nodes[i], forward_.parent_middle[up_nodes[i]], path);
+        }
+        // Down-path meeting node -> target follows backward parents
+        for (uint32_t v = meeting_node_; v != target; v = backward_.parent[v]) {
+            ch_->unpackArc(v, backward_.parent[v], backward_.parent_middle[v], path);
+        }
+    }
+
+    stats_.query_time_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start_time).count();
+    return found;
+}
+
+bool CHRouter::calculateRoute(const Point& start, const Point& end, Route& route) {
+    if (empty()) {
+        return false;
+    }
+    const uint32_t source = graph_->findNearestNode(start);
+    const uint32_t target = graph_->findNearestNode(end);
+    if (source == INVALID_NODE || target == INVALID_NODE) {
+        return false;
+    }
+
+    std::vector<uint32_t> path;
+    if (!findPath(source, target, path)) {
+        return false;
+    }
+
+    graph_->fillRoute(path, route);
+    return true;
+}
+
+} // namespace nav
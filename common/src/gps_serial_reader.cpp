@@ -0,0 +1,254 @@
+#include "gps_serial_reader.h"
+#include "nav_utils.h"
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#if defined(__QNX__) || defined(__linux__)
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#define NAV_HAVE_TERMIOS 1
+#endif
+
+namespace nav {
+
+namespace {
+
+const int POLL_TIMEOUT_MS = 100;
+
+#ifdef NAV_HAVE_TERMIOS
+bool baudToSpeed(int baud_rate, speed_t& speed) {
+    switch (baud_rate) {
+        case 4800: speed = B4800; return true;
+        case 9600: speed = B9600; return true;
+        case 19200: speed = B19200; return true;
+        case 38400: speed = B38400; return true;
+        case 57600: speed = B57600; return true;
+        case 115200: speed = B115200; return true;
+#ifdef B230400
+        case 230400: speed = B230400; return true;
+#endif
+#ifdef B460800
+        case 460800: speed = B460800; return true;
+#endif
+#ifdef B921600
+        case 921600: speed = B921600; return true;
+#endif
+        default: return false;
+    }
+}
+#endif
+
+// Sentences that carry the position of an epoch, as GpsSerialReader epoch bits
+const uint8_t EPOCH_RMC = 0x01;
+const uint8_t EPOCH_GGA = 0x02;
+
+uint8_t positionSentence(std::string_view sentence) {
+    if (sentence.size() < 6) {
+        return 0;
+    }
+    const std::string_view id = sentence.substr(3, 3);
+    return id == "RMC" ? EPOCH_RMC : id == "GGA" ? EPOCH_GGA : 0;
+}
+
+} // namespace
+
+GpsSerialReader::GpsSerialReader()
+    : fd_(-1), running_(false), epoch_time_ms_(-1), epoch_seen_(0), epoch_expected_(0), epoch_published_(true) {
+}
+
+GpsSerialReader::~GpsSerialReader() {
+    close();
+}
+
+bool GpsSerialReader::open(const std::string& device, int baud_rate) {
+    close();
+    error_.clear();
+
+#ifdef NAV_HAVE_TERMIOS
+    speed_t speed;
+    if (!baudToSpeed(baud_rate, speed)) {
+        error_ = "unsupported baud rate " + std::to_string(baud_rate);
+        return false;
+    }
+
+    const int fd = ::open(device.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (fd < 0) {
+        error_ = "cannot open " + device + ": " + std::strerror(errno);
+        return false;
+    }
+
+    // Raw 8N1, no flow control, no echo or line editing
+    struct termios tio;
+    if (tcgetattr(fd, &tio) != 0) {
+        error_ = device + " is not a tty: " + std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cflag &= ~(CSTOPB | PARENB);
+#ifdef CRTSCTS
+    tio.c_cflag &= ~CRTSCTS;
+#endif
+    tio.c_iflag &= ~(IXON | IXOFF | IXANY);
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 0;
+    cfsetispeed(&tio, speed);
+    cfsetospeed(&tio, speed);
+    if (tcsetattr(fd, TCSANOW, &tio) != 0) {
+        error_ = "cannot configure " + device + ": " + std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+    tcflush(fd, TCIFLUSH);
+
+    fd_ = fd;
+    device_ = device;
+    framer_.reset();
+    epoch_ = GpsData();
+    epoch_time_ms_ = -1;
+    epoch_seen_ = 0;
+    epoch_expected_ = 0;
+    epoch_published_ = true;
+    return true;
+#else
+    (void)baud_rate;
+    error_ = "serial GPS not supported on this platform (" + device + ")";
+    return false;
+#endif
+}
+
+void GpsSerialReader::close() {
+    stop();
+#ifdef NAV_HAVE_TERMIOS
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+#endif
+    fd_ = -1;
+}
+
+bool GpsSerialReader::start() {
+    if (fd_ < 0 || running_.load(std::memory_order_acquire)) {
+        return false;
+    }
+    running_.store(true, std::memory_order_release);
+    thread_ = std::thread(&GpsSerialReader::run, this);
+    return true;
+}
+
+void GpsSerialReader::stop() {
+    running_.store(false, std::memory_order_release);
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void GpsSerialReader::run() {
+#ifdef NAV_HAVE_TERMIOS
+    struct pollfd pfd;
+    pfd.fd = fd_;
+    pfd.events = POLLIN;
+
+    // The poll timeout bounds how long stop() waits for the thread
+    while (running_.load(std::memory_order_acquire)) {
+        pfd.revents = 0;
+        const int ready = ::poll(&pfd, 1, POLL_TIMEOUT_MS);
+        if (ready < 0) {
+            if (errno != EINTR) {
+                stats_.read_errors.fetch_add(1, std::memory_order_relaxed);
+            }
+            continue;
+        }
+        if (ready == 0) {
+            continue;
+        }
+
+        if (pfd.revents & POLLIN) {
+            // Drain everything the driver has, in ring-sized pieces
+            for (;;) {
+                size_t space;
+                char* dest = framer_.writePointer(space);
+                if (space == 0) {
+                    processSentences();
+                    dest = framer_.writePointer(space);
+                }
+                const ssize_t n = ::read(fd_, dest, space);
+                if (n <= 0) {
+                    if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                        stats_.read_errors.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    break;
+                }
+                framer_.commitWrite(static_cast<size_t>(n));
+                stats_.bytes.fetch_add(static_cast<uint64_t>(n), std::memory_order_relaxed);
+                processSentences();
+            }
+        } else if (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) {
+            // Device unplugged or pty peer closed; back off instead of spinning
+            stats_.read_errors.fetch_add(1, std::memory_order_relaxed);
+            std::this_thread::sleep_for(std::chrono::milliseconds(POLL_TIMEOUT_MS));
+        }
+    }
+#endif
+}
+
+void GpsSerialReader::processSentences() {
+    std::string_view sentence;
+    while (framer_.nextSentence(sentence)) {
+        stats_.sentences.fetch_add(1, std::memory_order_relaxed);
+
+        const uint8_t position = positionSentence(sentence);
+        if (position == 0) {
+            if (!NmeaParser::parseNmeaSentence(sentence, epoch_)) {
+                stats_.rejected_sentences.fetch_add(1, std::memory_order_relaxed);
+            }
+            continue;
+        }
+
+        // Parse into a copy: if this sentence opens a new epoch, the
+        // previous one may still have to go out as it is
+        GpsData next = epoch_;
+        const bool parsed = NmeaParser::parseNmeaSentence(sentence, next);
+        if (!parsed) {
+            stats_.rejected_sentences.fetch_add(1, std::memory_order_relaxed);
+            epoch_ = next;                                      // Keeps the lost-fix flag
+            continue;
+        }
+
+        if (next.utc_time_ms < 0 || next.utc_time_ms != epoch_time_ms_) {
+            if (!epoch_published_) {
+                publish();                                      // Incomplete epoch, e.g. GGA lost
+            }
+            epoch_time_ms_ = next.utc_time_ms;
+            epoch_seen_ = 0;
+            epoch_published_ = false;
+        }
+        epoch_ = next;
+        epoch_seen_ |= position;
+        epoch_expected_ |= position;
+
+        // Out as soon as every position sentence the receiver sends is in,
+        // and only once; without a time each sentence is its own epoch
+        if (!epoch_published_ && (epoch_seen_ == epoch_expected_ || epoch_time_ms_ < 0)) {
+            publish();
+        }
+    }
+}
+
+void GpsSerialReader::publish() {
+    epoch_published_ = true;
+    if (queue_.tryPush(epoch_)) {
+        stats_.fixes.fetch_add(1, std::memory_order_relaxed);
+        if (notifier_) {
+            notifier_();
+        }
+    } else {
+        stats_.dropped_fixes.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+} // namespace nav
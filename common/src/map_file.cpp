@@ -0,0 +1,351 @@
+#include "map_file.h"
+#include "contraction_hierarchy.h"
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace nav {
+
+namespace {
+
+// CRC-32 (IEEE 802.3, reflected) lookup table
+const std::array<uint32_t, 256>& crcTable() {
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> t;
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+            }
+            t[i] = c;
+        }
+        return t;
+    }();
+    return table;
+}
+
+uint64_t alignToPage(uint64_t offset) {
+    return (offset + MAP_FILE_PAGE_SIZE - 1) / MAP_FILE_PAGE_SIZE * MAP_FILE_PAGE_SIZE;
+}
+
+uint32_t headerCrc(const MapFileHeader& header) {
+    MapFileHeader copy = header;
+    copy.header_crc32 = 0;
+    return MapFile::crc32(&copy, sizeof(copy));
+}
+
+} // namespace
+
+uint32_t MapFile::crc32(const void* data, size_t size, uint32_t crc) {
+    const std::array<uint32_t, 256>& table = crcTable();
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i) {
+        crc = table[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+MapFile::MapFile() : data_(nullptr), size_(0), fd_(-1) {
+}
+
+MapFile::~MapFile() {
+    close();
+}
+
+bool MapFile::open(const std::string& path) {
+    close();
+    path_ = path;
+    error_.clear();
+
+#ifdef _WIN32
+    // No mmap: read the whole file once
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        error_ = "cannot open " + path;
+        return false;
+    }
+    fallback_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    if (fallback_.size() < MAP_FILE_PAGE_SIZE) {
+        error_ = "file too small";
+        fallback_.clear();
+        return false;
+    }
+    data_ = fallback_.data();
+    size_ = fallback_.size();
+#else
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        error_ = "cannot open " + path;
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd_, &st) != 0 || st.st_size < static_cast<off_t>(MAP_FILE_PAGE_SIZE)) {
+        error_ = "file too small";
+        close();
+        return false;
+    }
+
+    void* mapped = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd_, 0);
+    if (mapped == MAP_FAILED) {
+        error_ = "mmap failed";
+        close();
+        return false;
+    }
+    data_ = static_cast<const uint8_t*>(mapped);
+    size_ = static_cast<size_t>(st.st_size);
+#endif
+
+    if (!validateHeader()) {
+        const std::string error = error_;
+        close();
+        error_ = error;
+        return false;
+    }
+
+    pois_ = array<MapFilePoi>(MapSectionType::POI_RECORDS);
+    poi_strings_ = array<char>(MapSectionType::POI_STRINGS);
+    return true;
+}
+
+void MapFile::close() {
+#ifndef _WIN32
+    if (data_) {
+        munmap(const_cast<uint8_t*>(data_), size_);
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+#endif
+    fd_ = -1;
+    fallback_.clear();
+    data_ = nullptr;
+    size_ = 0;
+    pois_ = ArrayView<MapFilePoi>();
+    poi_strings_ = ArrayView<char>();
+}
+
+bool MapFile::validateHeader() {
+    const MapFileHeader& h = header();
+    if (std::memcmp(h.magic, MAP_FILE_MAGIC, sizeof(MAP_FILE_MAGIC)) != 0) {
+        error_ = "not a map file";
+        return false;
+    }
+    if (h.version != MAP_FILE_VERSION || h.header_size != sizeof(MapFileHeader) ||
+        h.page_size != MAP_FILE_PAGE_SIZE) {
+        error_ = "unsupported map file version";
+        return false;
+    }
+    if (h.header_crc32 != headerCrc(h)) {
+        error_ = "header checksum mismatch";
+        return false;
+    }
+    if (h.file_size != size_ || h.section_count > MAP_FILE_MAX_SECTIONS) {
+        error_ = "truncated map file";
+        return false;
+    }
+
+    for (uint32_t i = 0; i < h.section_count; ++i) {
+        const MapFileSection& s = h.sections[i];
+        if (s.offset % MAP_FILE_PAGE_SIZE != 0 || s.offset > size_ || s.size > size_ - s.offset ||
+            s.element_size == 0 || s.size % s.element_size != 0) {
+            error_ = "invalid section table";
+            return false;
+        }
+    }
+
+    const ArrayView<char> strings = array<char>(MapSectionType::POI_STRINGS);
+    if (array<MapFilePoi>(MapSectionType::POI_RECORDS).size() != h.poi_count ||
+        (!strings.empty() && strings[strings.size() - 1] != '\0')) {
+        error_ = "invalid POI sections";
+        return false;
+    }
+    return true;
+}
+
+const MapFileSection* MapFile::section(MapSectionType type) const {
+    if (!data_) {
+        return nullptr;
+    }
+    const MapFileHeader& h = header();
+    for (uint32_t i = 0; i < h.section_count; ++i) {
+        if (h.sections[i].type == static_cast<uint32_t>(type)) {
+            return &h.sections[i];
+        }
+    }
+    return nullptr;
+}
+
+bool MapFile::verify() const {
+    if (!data_) {
+        return false;
+    }
+    const MapFileHeader& h = header();
+    for (uint32_t i = 0; i < h.section_count; ++i) {
+        const MapFileSection& s = h.sections[i];
+        if (crc32(data_ + s.offset, static_cast<size_t>(s.size)) != s.crc32) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint32_t MapFile::poiCount() const {
+    return static_cast<uint32_t>(pois_.size());
+}
+
+const MapFilePoi& MapFile::poi(uint32_t index) const {
+    return pois_[index];
+}
+
+const char* MapFile::poiString(uint32_t offset) const {
+    return offset < poi_strings_.size() ? poi_strings_.data() + offset : "";
+}
+
+bool MapFileWriter::write(const std::string& path, const RoadGraph& graph,
+                          const std::vector<MapPoiInput>& pois,
+                          const std::vector<const ContractionHierarchy*>& hierarchies, std::string* error) {
+    auto fail = [error](const std::string& message) {
+        if (error) {
+            *error = message;
+        }
+        return false;
+    };
+
+    if (graph.empty()) {
+        return fail("empty graph");
+    }
+    for (const ContractionHierarchy* ch : hierarchies) {
+        if (!ch || ch->nodeCount() != graph.nodeCount()) {
+            return fail("contraction hierarchy does not match graph");
+        }
+    }
+
+    // POI records and string pool (offset 0 is the empty string)
+    std::vector<MapFilePoi> records;
+    std::vector<char> strings(1, '\0');
+    auto addString = [&strings](const std::string& s) -> uint32_t {
+        if (s.empty()) {
+            return 0;
+        }
+        const uint32_t offset = static_cast<uint32_t>(strings.size());
+        strings.insert(strings.end(), s.begin(), s.end());
+        strings.push_back('\0');
+        return offset;
+    };
+    records.reserve(pois.size());
+    for (const MapPoiInput& p : pois) {
+        MapFilePoi r;
+        std::memset(&r, 0, sizeof(r));
+        r.poi_id = p.poi_id;
+        r.lat_e7 = static_cast<int32_t>(std::lround(p.position.latitude * RoadGraph::COORD_SCALE));
+        r.lon_e7 = static_cast<int32_t>(std::lround(p.position.longitude * RoadGraph::COORD_SCALE));
+        r.name_offset = addString(p.name);
+        r.category_offset = addString(p.category);
+        r.address_offset = addString(p.address);
+        records.push_back(r);
+    }
+
+    struct Payload {
+        MapSectionType type;
+        uint32_t element_size;
+        const void* data;
+        size_t size;
+    };
+    std::vector<Payload> payloads = {
+        {MapSectionType::ARC_FIRST_OUT, 4, graph.first_out_.data(), graph.first_out_.byteSize()},
+        {MapSectionType::ARC_HEAD, 4, graph.head_.data(), graph.head_.byteSize()},
+        {MapSectionType::ARC_LENGTH, 4, graph.length_m_.data(), graph.length_m_.byteSize()},
+        {MapSectionType::ARC_SPEED, 1, graph.speed_kmh_.data(), graph.speed_kmh_.byteSize()},
+        {MapSectionType::ARC_FLAGS, 1, graph.flags_.data(), graph.flags_.byteSize()},
+        {MapSectionType::NODE_IDS, 4, graph.node_ids_.data(), graph.node_ids_.byteSize()},
+        {MapSectionType::NODE_LAT_E7, 4, graph.lat_e7_.data(), graph.lat_e7_.byteSize()},
+        {MapSectionType::NODE_LON_E7, 4, graph.lon_e7_.data(), graph.lon_e7_.byteSize()},
+        {MapSectionType::NODE_ID_INDEX, sizeof(RoadGraph::IdIndexEntry), graph.id_index_.data(), graph.id_index_.byteSize()},
+        {MapSectionType::GRID_CELL_FIRST, 4, graph.cell_first_.data(), graph.cell_first_.byteSize()},
+        {MapSectionType::GRID_CELL_NODES, 4, graph.cell_nodes_.data(), graph.cell_nodes_.byteSize()},
+        {MapSectionType::POI_RECORDS, sizeof(MapFilePoi), records.data(), records.size() * sizeof(MapFilePoi)},
+        {MapSectionType::POI_STRINGS, 1, strings.data(), strings.size()},
+    };
+    for (const ContractionHierarchy* ch : hierarchies) {
+        const uint32_t base = static_cast<uint32_t>(ch->metric() == RouteMetric::DISTANCE
+            ? MapSectionType::CH_DISTANCE_RANK : MapSectionType::CH_TIME_RANK);
+        const ArrayView<uint32_t>* arrays[] = {
+            &ch->rank_, &ch->up_first_, &ch->up_head_, &ch->up_cost_, &ch->up_middle_,
+            &ch->down_first_, &ch->down_head_, &ch->down_cost_, &ch->down_middle_,
+        };
+        for (uint32_t i = 0; i < 9; ++i) {
+            payloads.push_back(Payload{static_cast<MapSectionType>(base + i), 4, arrays[i]->data(), arrays[i]->byteSize()});
+        }
+    }
+    if (payloads.size() > MAP_FILE_MAX_SECTIONS) {
+        return fail("too many sections");
+    }
+
+    MapFileHeader header = MapFileHeader();
+    std::memcpy(header.magic, MAP_FILE_MAGIC, sizeof(MAP_FILE_MAGIC));
+    header.version = MAP_FILE_VERSION;
+    header.header_size = sizeof(MapFileHeader);
+    header.page_size = MAP_FILE_PAGE_SIZE;
+    header.node_count = graph.nodeCount();
+    header.arc_count = graph.arcCount();
+    header.poi_count = static_cast<uint32_t>(records.size());
+    header.max_speed_kmh = graph.maxSpeedKmh();
+    header.grid = graph.gridInfo();
+
+    uint64_t offset = MAP_FILE_PAGE_SIZE;
+    for (const Payload& p : payloads) {
+        MapFileSection& s = header.sections[header.section_count++];
+        s.type = static_cast<uint32_t>(p.type);
+        s.element_size = p.element_size;
+        s.offset = offset;
+        s.size = p.size;
+        s.crc32 = MapFile::crc32(p.data, p.size);
+        offset = alignToPage(offset + p.size);
+    }
+    header.file_size = offset;
+    header.header_crc32 = headerCrc(header);
+
+    // Write to a temporary file and rename, so a crash never leaves a
+    // half-written map where the HMI expects one
+    const std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            return fail("cannot create " + tmp_path);
+        }
+
+        const std::vector<char> padding(MAP_FILE_PAGE_SIZE, '\0');
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(padding.data(), MAP_FILE_PAGE_SIZE - sizeof(header));
+        for (uint32_t i = 0; i < header.section_count; ++i) {
+            const MapFileSection& s = header.sections[i];
+            out.write(static_cast<const char*>(payloads[i].data), static_cast<std::streamsize>(s.size));
+            const uint64_t end = (i + 1 < header.section_count) ? header.sections[i + 1].offset : header.file_size;
+            out.write(padding.data(), static_cast<std::streamsize>(end - s.offset - s.size));
+        }
+        if (!out) {
+            return fail("write failed: " + tmp_path);
+        }
+    }
+
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        std::remove(tmp_path.c_str());
+        return fail("cannot rename to " + path);
+    }
+    return true;
+}
+
+} // namespace nav
@@ -0,0 +1,171 @@
+#include "map_matcher.h"
+#include <algorithm>
+#include <cmath>
+
+namespace nav {
+
+namespace {
+
+// Extra along-road distance assumed between segments that share no node
+const double DETOUR_PENALTY_M = 50.0;
+
+// Smallest angle between two directions, in [0, 180]
+double headingDifference(double a, double b) {
+    const double d = std::fabs(std::fmod(a - b + 540.0, 360.0) - 180.0);
+    return 180.0 - d;
+}
+
+} // namespace
+
+MapMatcher::MapMatcher(std::shared_ptr<const SegmentIndex> index, const MapMatcherConfig& config)
+    : index_(std::move(index)), config_(config), newest_(0), depth_(0) {
+    config_.window = std::min(MAX_WINDOW, std::max(1, config_.window));
+}
+
+void MapMatcher::reset() {
+    depth_ = 0;
+}
+
+double MapMatcher::emission(const SegmentCandidate& candidate, double heading_deg, bool use_heading) const {
+    const double d = candidate.distance_m / config_.gps_sigma_m;
+    double score = -0.5 * d * d;
+    if (use_heading) {
+        double diff = headingDifference(heading_deg, candidate.bearing_deg);
+        if (!index_->segmentOneWay(candidate.segment)) {
+            diff = std::min(diff, 180.0 - diff);
+        }
+        const double h = diff / config_.heading_sigma_deg;
+        score -= 0.5 * h * h;
+    }
+    return score;
+}
+
+double MapMatcher::routeDistance(const SegmentCandidate& a, const SegmentCandidate& b) const {
+    if (a.segment == b.segment) {
+        return std::fabs(b.offset_m - a.offset_m);
+    }
+
+    const SegmentIndex& index = *index_;
+    const uint32_t a_nodes[2] = {index.segmentFrom(a.segment), index.segmentTo(a.segment)};
+    const uint32_t b_nodes[2] = {index.segmentFrom(b.segment), index.segmentTo(b.segment)};
+    const double a_to_node[2] = {a.offset_m, index.segmentLength(a.segment) - a.offset_m};
+    const double node_to_b[2] = {b.offset_m, index.segmentLength(b.segment) - b.offset_m};
+    const bool a_one_way = index.segmentOneWay(a.segment);
+    const bool b_one_way = index.segmentOneWay(b.segment);
+
+    // Through a shared node; one-way segments are left at their end and entered at their start
+    double best = -1.0;
+    for (int i = 0; i < 2; ++i) {
+        if (a_one_way && i == 0) {
+            continue;
+        }
+        for (int j = 0; j < 2; ++j) {
+            if (b_one_way && j == 1) {
+                continue;
+            }
+            if (a_nodes[i] == b_nodes[j]) {
+                const double d = a_to_node[i] + node_to_b[j];
+                if (best < 0.0 || d < best) {
+                    best = d;
+                }
+            }
+        }
+    }
+    if (best >= 0.0) {
+        return best;
+    }
+    return a.position.distanceTo(b.position) + DETOUR_PENALTY_M;
+}
+
+MatchResult MapMatcher::match(const Point& point, double heading_deg, double speed_kmh) {
+    MatchResult result;
+    result.position = point;
+    if (!index_ || index_->empty()) {
+        return result;
+    }
+
+    const int slot = (newest_ + 1) % MAX_WINDOW;
+    Layer& layer = layers_[slot];
+    layer.fix = point;
+    layer.count = index_->findSegments(point, config_.search_radius_m, layer.candidates, MAX_CANDIDATES);
+    if (layer.count == 0) {
+        depth_ = 0;   // Off the map: break the chain
+        return result;
+    }
+
+    const bool use_heading = speed_kmh >= config_.min_heading_speed_kmh;
+    const Layer* prev = depth_ > 0 ? &layers_[newest_] : nullptr;
+    const double straight = prev ? prev->fix.distanceTo(point) : 0.0;
+
+    // Viterbi step
+    int best = 0;
+    for (int j = 0; j < layer.count; ++j) {
+        double score = emission(layer.candidates[j], heading_deg, use_heading);
+        int8_t back = -1;
+        if (prev) {
+            double best_prev = 0.0;
+            for (int i = 0; i < prev->count; ++i) {
+                const double route = routeDistance(prev->candidates[i], layer.candidates[j]);
+                const double s = prev->score[i] - std::fabs(route - straight) / config_.transition_beta_m;
+                if (back < 0 || s > best_prev) {
+                    best_prev = s;
+                    back = static_cast<int8_t>(i);
+                }
+            }
+            score += best_prev;
+        }
+        layer.score[j] = score;
+        layer.back[j] = back;
+        if (j == 0 || score > layer.score[best]) {
+            best = j;
+        }
+    }
+
+    // Normalise so scores stay bounded over long drives
+    const double top = layer.score[best];
+    for (int j = 0; j < layer.count; ++j) {
+        layer.score[j] -= top;
+    }
+    newest_ = slot;
+    depth_ = std::min(depth_ + 1, config_.window);
+
+    const SegmentCandidate& c = layer.candidates[best];
+    const uint32_t from = index_->segmentFrom(c.segment);
+    const uint32_t to = index_->segmentTo(c.segment);
+    const bool reverse = use_heading && !index_->segmentOneWay(c.segment) &&
+                         headingDifference(heading_deg, c.bearing_deg) > 90.0;
+    result.matched = true;
+    result.position = c.position;
+    result.position.altitude = point.altitude;
+    result.segment = c.segment;
+    result.from_node = reverse ? to : from;
+    result.to_node = reverse ? from : to;
+    result.distance_m = c.distance_m;
+    result.bearing_deg = reverse ? std::fmod(c.bearing_deg + 180.0, 360.0) : c.bearing_deg;
+    return result;
+}
+
+int MapMatcher::decodeWindow(uint32_t* segments, int max_segments) const {
+    const int n = std::min(depth_, max_segments);
+    if (n <= 0) {
+        return 0;
+    }
+
+    // Backtrack from the best state of the newest layer
+    int slot = newest_;
+    int state = 0;
+    for (int j = 1; j < layers_[slot].count; ++j) {
+        if (layers_[slot].score[j] > layers_[slot].score[state]) {
+            state = j;
+        }
+    }
+    for (int k = n - 1; k >= 0; --k) {
+        const Layer& layer = layers_[slot];
+        segments[k] = layer.candidates[state].segment;
+        state = layer.back[state];
+        slot = (slot + MAX_WINDOW - 1) % MAX_WINDOW;
+    }
+    return n;
+}
+
+} // namespace nav
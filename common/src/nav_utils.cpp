@@ -1,6 +1,9 @@
 #include "nav_utils.h"
+#include "segment_index.h"
 #include <cmath>
 #include <chrono>
+#include <cstdlib>
+#include <fstream>
 #include <sstream>
 #include <iomanip>
 
@@ -114,16 +117,35 @@ std::string NavUtils::turnTypeToString(TurnType turn) {
     }
 }
 
-Point NavUtils::snapToRoad(const Point& gps_point, const std::vector<MapEdge>& nearby_edges) {
-    // Simplified map matching - find closest edge and project point onto it
-    // In a real implementation, this would be much more sophisticated
-    if (nearby_edges.empty()) {
+Point NavUtils::snapToRoad(const Point& gps_point, const SegmentIndex& roads, double max_distance_m) {
+    SegmentCandidate nearest;
+    if (!roads.findNearest(gps_point, max_distance_m, nearest)) {
         return gps_point;
     }
+    Point snapped = nearest.position;
+    snapped.altitude = gps_point.altitude;
+    return snapped;
+}
+
+std::string NavUtils::locateConfigFile() {
+    if (const char* env = std::getenv("NAV_CONFIG")) {
+        if (std::ifstream(env).good()) {
+            return env;
+        }
+    }
     
-    // For now, just return the original point
-    // Real implementation would project the point onto the nearest road segment
-    return gps_point;
+    // Source tree layout first, then installed layout (bin/../etc)
+    const char* candidates[] = {
+        "config/navigation.conf",
+        "../config/navigation.conf",
+        "../etc/navigation.conf",
+    };
+    for (const char* path : candidates) {
+        if (std::ifstream(path).good()) {
+            return path;
+        }
+    }
+    return std::string();
 }
 
 } // namespace nav
\ No newline at end of file
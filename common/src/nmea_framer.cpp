@@ -0,0 +1,102 @@
+#include "nmea_framer.h"
+#include <algorithm>
+#include <cstring>
+
+namespace nav {
+
+NmeaFramer::NmeaFramer() {
+    reset();
+}
+
+void NmeaFramer::reset() {
+    read_pos_ = 0;
+    write_pos_ = 0;
+    line_length_ = 0;
+    in_sentence_ = false;
+    stats_ = NmeaFramerStats();
+}
+
+char* NmeaFramer::writePointer(size_t& space) {
+    const size_t offset = write_pos_ & RING_MASK;
+    // Free space up to the ring end, or up to the unread data if that comes first
+    space = std::min(RING_SIZE - buffered(), RING_SIZE - offset);
+    return ring_ + offset;
+}
+
+void NmeaFramer::commitWrite(size_t count) {
+    write_pos_ += count;
+    stats_.bytes += count;
+}
+
+size_t NmeaFramer::write(const char* data, size_t count) {
+    size_t written = 0;
+    while (written < count) {
+        size_t space;
+        char* dest = writePointer(space);
+        if (space == 0) {
+            ++stats_.ring_full;
+            break;
+        }
+        const size_t chunk = std::min(space, count - written);
+        std::memcpy(dest, data + written, chunk);
+        commitWrite(chunk);
+        written += chunk;
+    }
+    return written;
+}
+
+void NmeaFramer::dropSentence() {
+    stats_.discarded_bytes += line_length_;
+    line_length_ = 0;
+    in_sentence_ = false;
+}
+
+bool NmeaFramer::nextSentence(std::string_view& sentence) {
+    while (read_pos_ != write_pos_) {
+        const char c = ring_[read_pos_ & RING_MASK];
+        ++read_pos_;
+
+        if (c == '$' || c == '!') {
+            // A start character inside a sentence means the tail was lost
+            if (in_sentence_) {
+                dropSentence();
+            }
+            in_sentence_ = true;
+            line_[line_length_++] = c;
+            continue;
+        }
+
+        if (!in_sentence_) {
+            if (c != '\r' && c != '\n') {
+                ++stats_.discarded_bytes;
+            }
+            continue;
+        }
+
+        if (c == '\r' || c == '\n') {
+            sentence = std::string_view(line_, line_length_);
+            line_length_ = 0;
+            in_sentence_ = false;
+            ++stats_.sentences;
+            return true;
+        }
+
+        // Line noise (framing errors, wrong baud rate)
+        if (static_cast<unsigned char>(c) < 0x20 || static_cast<unsigned char>(c) > 0x7E) {
+            ++stats_.discarded_bytes;
+            dropSentence();
+            continue;
+        }
+
+        if (line_length_ == MAX_SENTENCE) {
+            ++stats_.overflows;
+            ++stats_.discarded_bytes;
+            dropSentence();
+            continue;
+        }
+        line_[line_length_++] = c;
+    }
+    return false;
+}
+
+} // namespace nav
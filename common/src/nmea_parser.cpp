@@ -1,189 +1,316 @@
 #include "nav_utils.h"
-#include <sstream>
-#include <algorithm>
-#include <cstdlib>
+#include <charconv>
 
 namespace nav {
 
-bool NmeaParser::parseNmeaSentence(const std::string& sentence, GpsData& gps_data) {
-    if (sentence.empty() || sentence[0] != '$') {
+namespace {
+
+// Talkers we accept, in GpsData::satellites_in_view_by_talker order
+const char* const TALKERS[] = {"GP", "GL", "GA", "GN"};
+const size_t TALKER_COUNT = sizeof(TALKERS) / sizeof(TALKERS[0]);
+
+const double KNOTS_TO_KMH = 1.852;
+
+} // namespace
+
+const NmeaParser::SentenceHandler NmeaParser::HANDLERS[] = {
+    {"RMC", &NmeaParser::parseRMC},
+    {"GGA", &NmeaParser::parseGGA},
+    {"VTG", &NmeaParser::parseVTG},
+    {"GSA", &NmeaParser::parseGSA},
+    {"GSV", &NmeaParser::parseGSV},
+};
+
+bool NmeaParser::parseNmeaSentence(std::string_view sentence, GpsData& gps_data) {
+    while (!sentence.empty() && (sentence.back() == '\r' || sentence.back() == '\n')) {
+        sentence.remove_suffix(1);
+    }
+    if (sentence.size() < 7 || sentence[0] != '$') {
         return false;
     }
-    
-    // Validate checksum
-    if (!validateChecksum(sentence)) {
+
+    // Validate checksum; body is the text between '$' and '*'
+    std::string_view body;
+    if (!validateChecksum(sentence, body)) {
         return false;
     }
-    
-    // Extract sentence type
-    size_t comma_pos = sentence.find(',');
-    if (comma_pos == std::string::npos) {
+
+    // Address field: 2-char talker + 3-char sentence ID
+    if (body.size() < 6 || body[5] != ',') {
+        return false;
+    }
+    const size_t talker = talkerIndex(body.substr(0, 2));
+    if (talker == TALKER_COUNT) {
         return false;
     }
-    
-    std::string sentence_type = sentence.substr(1, comma_pos - 1);
-    
-    if (sentence_type == "GPRMC") {
-        return parseGPRMC(sentence, gps_data);
-    } else if (sentence_type == "GPGGA") {
-        return parseGPGGA(sentence, gps_data);
+
+    const std::string_view id = body.substr(2, 3);
+    for (const SentenceHandler& entry : HANDLERS) {
+        if (id == entry.id) {
+            Fields fields;
+            if (!splitFields(body, fields)) {
+                return false;
+            }
+            return entry.handler(fields, talker, gps_data);
+        }
     }
-    
+
     return false;
 }
 
-bool NmeaParser::parseGPRMC(const std::string& sentence, GpsData& gps_data) {
-    // $GPRMC,time,status,lat,lat_dir,lon,lon_dir,speed,course,date,mag_var,mag_var_dir,checksum
-    auto fields = splitString(sentence, ',');
-    if (fields.size() < 12) {
+bool NmeaParser::parseRMC(const Fields& fields, size_t, GpsData& gps_data) {
+    // $GPRMC,time,status,lat,lat_dir,lon,lon_dir,speed,course,date,mag_var,mag_var_dir[,mode]*checksum
+    if (fields.count < 12) {
         return false;
     }
-    
+
     // Check status
-    if (fields[2] != "A") {
+    if (fields.value[2] != "A") {
         gps_data.valid = false;
         return false;
     }
-    
+
     gps_data.valid = true;
-    
-    // Parse latitude
-    if (!fields[3].empty() && !fields[4].empty()) {
-        gps_data.position.latitude = parseCoordinate(fields[3], fields[4][0]);
-    }
-    
-    // Parse longitude
-    if (!fields[5].empty() && !fields[6].empty()) {
-        gps_data.position.longitude = parseCoordinate(fields[5], fields[6][0]);
-    }
-    
+
+    parseCoordinate(fields.value[3], fields.value[4], gps_data.position.latitude);
+    parseCoordinate(fields.value[5], fields.value[6], gps_data.position.longitude);
+
     // Parse speed (knots to km/h)
-    if (!fields[7].empty()) {
-        double speed_knots = std::stod(fields[7]);
-        gps_data.speed_kmh = speed_knots * 1.852;
+    double speed_knots;
+    if (parseDouble(fields.value[7], speed_knots)) {
+        gps_data.speed_kmh = speed_knots * KNOTS_TO_KMH;
     }
-    
-    // Parse course
-    if (!fields[8].empty()) {
-        gps_data.course_degrees = std::stod(fields[8]);
+
+    parseDouble(fields.value[8], gps_data.course_degrees);
+
+    if (!parseTime(fields.value[1], gps_data.utc_time_ms)) {
+        gps_data.utc_time_ms = -1;
     }
-    
     gps_data.timestamp_ms = NavUtils::getCurrentTimestampMs();
-    
+
     return true;
 }
 
-bool NmeaParser::parseGPGGA(const std::string& sentence, GpsData& gps_data) {
-    // $GPGGA,time,lat,lat_dir,lon,lon_dir,quality,satellites,hdop,altitude,alt_unit,geoid_height,geoid_unit,dgps_time,dgps_id,checksum
-    auto fields = splitString(sentence, ',');
-    if (fields.size() < 15) {
+bool NmeaParser::parseGGA(const Fields& fields, size_t, GpsData& gps_data) {
+    // $GPGGA,time,lat,lat_dir,lon,lon_dir,quality,satellites,hdop,altitude,alt_unit,geoid_height,geoid_unit,dgps_time,dgps_id*checksum
+    if (fields.count < 15) {
         return false;
     }
-    
+
     // Check quality
-    if (fields[6].empty() || fields[6] == "0") {
+    if (fields.value[6].empty() || fields.value[6] == "0") {
         gps_data.valid = false;
         return false;
     }
-    
+
     gps_data.valid = true;
-    
-    // Parse latitude
-    if (!fields[2].empty() && !fields[3].empty()) {
-        gps_data.position.latitude = parseCoordinate(fields[2], fields[3][0]);
+
+    parseCoordinate(fields.value[2], fields.value[3], gps_data.position.latitude);
+    parseCoordinate(fields.value[4], fields.value[5], gps_data.position.longitude);
+
+    // Parse satellites
+    int satellites;
+    if (parseInt(fields.value[7], satellites)) {
+        gps_data.satellites_used = static_cast<uint8_t>(satellites);
     }
-    
-    // Parse longitude
-    if (!fields[4].empty() && !fields[5].empty()) {
-        gps_data.position.longitude = parseCoordinate(fields[4], fields[5][0]);
+
+    parseDouble(fields.value[8], gps_data.hdop);
+    parseDouble(fields.value[9], gps_data.position.altitude);
+
+    if (!parseTime(fields.value[1], gps_data.utc_time_ms)) {
+        gps_data.utc_time_ms = -1;
     }
-    
-    // Parse satellites
-    if (!fields[7].empty()) {
-        gps_data.satellites_used = static_cast<uint8_t>(std::stoi(fields[7]));
+    gps_data.timestamp_ms = NavUtils::getCurrentTimestampMs();
+
+    return true;
+}
+
+bool NmeaParser::parseVTG(const Fields& fields, size_t, GpsData& gps_data) {
+    // $GPVTG,course_true,T,course_mag,M,speed_knots,N,speed_kmh,K[,mode]*checksum
+    if (fields.count < 9) {
+        return false;
     }
-    
-    // Parse HDOP
-    if (!fields[8].empty()) {
-        gps_data.hdop = std::stod(fields[8]);
+
+    // NMEA 2.3+ mode indicator: N = data not valid
+    if (fields.count > 9 && fields.value[9] == "N") {
+        return false;
     }
-    
-    // Parse altitude
-    if (!fields[9].empty()) {
-        gps_data.position.altitude = std::stod(fields[9]);
+
+    parseDouble(fields.value[1], gps_data.course_degrees);
+
+    double speed;
+    if (parseDouble(fields.value[7], speed)) {
+        gps_data.speed_kmh = speed;
+    } else if (parseDouble(fields.value[5], speed)) {
+        gps_data.speed_kmh = speed * KNOTS_TO_KMH;
     }
-    
-    gps_data.timestamp_ms = NavUtils::getCurrentTimestampMs();
-    
+
     return true;
 }
 
-std::vector<std::string> NmeaParser::splitString(const std::string& str, char delimiter) {
-    std::vector<std::string> tokens;
-    std::stringstream ss(str);
-    std::string token;
-    
-    while (std::getline(ss, token, delimiter)) {
-        tokens.push_back(token);
+bool NmeaParser::parseGSA(const Fields& fields, size_t, GpsData& gps_data) {
+    // $GNGSA,mode,fix_type,sv1..sv12,pdop,hdop,vdop[,system_id]*checksum
+    // Multi-constellation receivers send one GSA per system, so the used
+    // satellite count is left to GGA
+    if (fields.count < 18) {
+        return false;
+    }
+
+    int fix_mode;
+    if (!parseInt(fields.value[2], fix_mode) || fix_mode < 1 || fix_mode > 3) {
+        return false;
     }
-    
-    return tokens;
+    gps_data.fix_mode = static_cast<uint8_t>(fix_mode);
+
+    parseDouble(fields.value[15], gps_data.pdop);
+    parseDouble(fields.value[16], gps_data.hdop);
+    parseDouble(fields.value[17], gps_data.vdop);
+
+    return fix_mode > 1;
 }
 
-double NmeaParser::parseCoordinate(const std::string& coord_str, char direction) {
-    if (coord_str.empty()) {
-        return 0.0;
+bool NmeaParser::parseGSV(const Fields& fields, size_t talker, GpsData& gps_data) {
+    // $GPGSV,message_count,message_number,satellites_in_view,{prn,elevation,azimuth,snr}x1..4[,signal_id]*checksum
+    if (fields.count < 4) {
+        return false;
+    }
+
+    int in_view;
+    if (!parseInt(fields.value[3], in_view) || in_view < 0 || in_view > 255) {
+        return false;
     }
-    
+
+    // Every message of the group repeats the count; keep one per constellation
+    gps_data.satellites_in_view_by_talker[talker] = static_cast<uint8_t>(in_view);
+
+    int total = 0;
+    for (size_t i = 0; i < TALKER_COUNT; ++i) {
+        total += gps_data.satellites_in_view_by_talker[i];
+    }
+    gps_data.satellites_in_view = static_cast<uint8_t>(total > 255 ? 255 : total);
+
+    return true;
+}
+
+size_t NmeaParser::talkerIndex(std::string_view talker) {
+    for (size_t i = 0; i < TALKER_COUNT; ++i) {
+        if (talker == TALKERS[i]) {
+            return i;
+        }
+    }
+    return TALKER_COUNT;
+}
+
+bool NmeaParser::splitFields(std::string_view body, Fields& fields) {
+    fields.count = 0;
+
+    size_t start = 0;
+    for (;;) {
+        if (fields.count == MAX_FIELDS) {
+            return false;
+        }
+        const size_t comma = body.find(',', start);
+        if (comma == std::string_view::npos) {
+            fields.value[fields.count++] = body.substr(start);
+            return true;
+        }
+        fields.value[fields.count++] = body.substr(start, comma - start);
+        start = comma + 1;
+    }
+}
+
+bool NmeaParser::parseDouble(std::string_view field, double& value) {
+    if (field.empty()) {
+        return false;
+    }
+
+    double parsed;
+    const auto result = std::from_chars(field.data(), field.data() + field.size(), parsed);
+    if (result.ec != std::errc()) {
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+bool NmeaParser::parseInt(std::string_view field, int& value) {
+    if (field.empty()) {
+        return false;
+    }
+
+    int parsed;
+    const auto result = std::from_chars(field.data(), field.data() + field.size(), parsed);
+    if (result.ec != std::errc()) {
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+bool NmeaParser::parseCoordinate(std::string_view coord, std::string_view direction, double& degrees) {
     // Format: DDMM.MMMMM (latitude) or DDDMM.MMMMM (longitude)
-    double coord = std::stod(coord_str);
-    
+    double value;
+    if (direction.empty() || !parseDouble(coord, value)) {
+        return false;
+    }
+
     // Extract degrees and minutes
-    int degrees = static_cast<int>(coord / 100);
-    double minutes = coord - (degrees * 100);
-    
+    const int whole_degrees = static_cast<int>(value / 100);
+    const double minutes = value - (whole_degrees * 100);
+
     // Convert to decimal degrees
-    double decimal_degrees = degrees + (minutes / 60.0);
-    
+    double decimal_degrees = whole_degrees + (minutes / 60.0);
+
     // Apply direction
-    if (direction == 'S' || direction == 'W') {
+    if (direction[0] == 'S' || direction[0] == 'W') {
         decimal_degrees = -decimal_degrees;
     }
-    
-    return decimal_degrees;
+
+    degrees = decimal_degrees;
+    return true;
 }
 
-uint8_t NmeaParser::calculateChecksum(const std::string& sentence) {
+bool NmeaParser::parseTime(std::string_view field, int32_t& time_ms) {
+    // Format: HHMMSS[.SSS]
+    int hours, minutes;
+    double seconds;
+    if (field.size() < 6 || !parseInt(field.substr(0, 2), hours) || !parseInt(field.substr(2, 2), minutes) ||
+        !parseDouble(field.substr(4), seconds)) {
+        return false;
+    }
+    if (hours < 0 || hours > 23 || minutes < 0 || minutes > 59 || seconds < 0.0 || seconds >= 61.0) {
+        return false;
+    }
+
+    time_ms = (hours * 3600 + minutes * 60) * 1000 + static_cast<int32_t>(seconds * 1000.0 + 0.5);
+    return true;
+}
+
+uint8_t NmeaParser::calculateChecksum(std::string_view body) {
     uint8_t checksum = 0;
-    
-    // Start after '$' and end before '*'
-    size_t start = 1;
-    size_t end = sentence.find('*');
-    if (end == std::string::npos) {
-        end = sentence.length();
-    }
-    
-    for (size_t i = start; i < end; ++i) {
-        checksum ^= static_cast<uint8_t>(sentence[i]);
-    }
-    
+    for (char c : body) {
+        checksum ^= static_cast<uint8_t>(c);
+    }
     return checksum;
 }
 
-bool NmeaParser::validateChecksum(const std::string& sentence) {
-    size_t star_pos = sentence.find('*');
-    if (star_pos == std::string::npos || star_pos + 3 > sentence.length()) {
+bool NmeaParser::validateChecksum(std::string_view sentence, std::string_view& body) {
+    const size_t star_pos = sentence.find('*');
+    if (star_pos == std::string_view::npos || star_pos + 3 > sentence.size()) {
         return false; // No checksum present
     }
-    
+
     // Extract checksum from sentence
-    std::string checksum_str = sentence.substr(star_pos + 1, 2);
-    uint8_t expected_checksum = static_cast<uint8_t>(std::stoi(checksum_str, nullptr, 16));
-    
-    // Calculate actual checksum
-    uint8_t actual_checksum = calculateChecksum(sentence);
-    
-    return actual_checksum == expected_checksum;
+    unsigned expected_checksum = 0;
+    const char* digits = sentence.data() + star_pos + 1;
+    const auto result = std::from_chars(digits, digits + 2, expected_checksum, 16);
+    if (result.ec != std::errc() || result.ptr != digits + 2) {
+        return false;
+    }
+
+    // Calculate actual checksum between '$' and '*'
+    body = sentence.substr(1, star_pos - 1);
+    return calculateChecksum(body) == expected_checksum;
 }
 
-} // namespace nav
\ No newline at end of file
+} // namespace nav
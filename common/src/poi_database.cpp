@@ -0,0 +1,620 @@
+#include "poi_database.h"
+#include "map_file.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace nav {
+
+namespace {
+
+const size_t READ_CHUNK_BYTES = 64 * 1024;
+const int MAX_JSON_DEPTH = 64;
+const double COORD_SCALE = 1e7;
+
+uint32_t headerCrc(const PoiSnapshotHeader& header) {
+    PoiSnapshotHeader copy = header;
+    copy.header_crc32 = 0;
+    return MapFile::crc32(&copy, sizeof(copy));
+}
+
+bool fileStamp(const std::string& path, uint64_t& size, int64_t& mtime) {
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0) {
+        return false;
+    }
+    size = static_cast<uint64_t>(st.st_size);
+    mtime = static_cast<int64_t>(st.st_mtime);
+    return true;
+}
+
+void appendUtf8(uint32_t cp, std::string& out) {
+    if (cp < 0x80) {
+        out.push_back(static_cast<char>(cp));
+    } else if (cp < 0x800) {
+        out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+        out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else {
+        out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+}
+
+// Buffered character source with just enough JSON lexing for flat objects
+class JsonStream {
+public:
+    explicit JsonStream(std::FILE* file) : file_(file), buffer_(READ_CHUNK_BYTES), pos_(0), end_(0), consumed_(0) {}
+
+    int peek() {
+        if (pos_ == end_ && !refill()) {
+            return -1;
+        }
+        return static_cast<unsigned char>(buffer_[pos_]);
+    }
+
+    int get() {
+        const int c = peek();
+        if (c >= 0) {
+            ++pos_;
+        }
+        return c;
+    }
+
+    uint64_t offset() const { return consumed_ + pos_; }
+
+    int skipSpace() {
+        int c = peek();
+        while (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+            ++pos_;
+            c = peek();
+        }
+        return c;
+    }
+
+    bool expect(char c) {
+        return skipSpace() == c && get() == c;
+    }
+
+    bool readString(std::string& out) {
+        out.clear();
+        if (get() != '"') {
+            return false;
+        }
+        for (;;) {
+            const int c = get();
+            if (c < 0) {
+                return false;
+            }
+            if (c == '"') {
+                return true;
+            }
+            if (c != '\\') {
+                out.push_back(static_cast<char>(c));
+                continue;
+            }
+            const int e = get();
+            switch (e) {
+                case '"': case '\\': case '/': out.push_back(static_cast<char>(e)); break;
+                case 'b': out.push_back('\b'); break;
+                case 'f': out.push_back('\f'); break;
+                case 'n': out.push_back('\n'); break;
+                case 'r': out.push_back('\r'); break;
+                case 't': out.push_back('\t'); break;
+                case 'u': {
+                    uint32_t cp;
+                    if (!readHex4(cp)) {
+                        return false;
+                    }
+                    // Surrogate pair
+                    if (cp >= 0xD800 && cp < 0xDC00 && peek() == '\\') {
+                        get();
+                        uint32_t low;
+                        if (get() != 'u' || !readHex4(low) || low < 0xDC00 || low > 0xDFFF) {
+                            return false;
+                        }
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    appendUtf8(cp, out);
+                    break;
+                }
+                default:
+                    return false;
+            }
+        }
+    }
+
+    // Raw number text, validated by the caller's conversion
+    bool readNumber(std::string& out) {
+        out.clear();
+        int c = peek();
+        while (c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E' || (c >= '0' && c <= '9')) {
+            out.push_back(static_cast<char>(get()));
+            c = peek();
+        }
+        return !out.empty();
+    }
+
+    bool skipValue(int depth, std::string& scratch) {
+        if (depth > MAX_JSON_DEPTH) {
+            return false;
+        }
+        const int c = skipSpace();
+        if (c == '"') {
+            return readString(scratch);
+        }
+        if (c == '{' || c == '[') {
+            const char close = c == '{' ? '}' : ']';
+            get();
+            if (skipSpace() == close) {
+                get();
+                return true;
+            }
+            for (;;) {
+                if (c == '{' && (skipSpace() != '"' || !readString(scratch) || !expect(':'))) {
+                    return false;
+                }
+                if (!skipValue(depth + 1, scratch)) {
+                    return false;
+                }
+                const int next = skipSpace();
+                get();
+                if (next == close) {
+                    return true;
+                }
+                if (next != ',') {
+                    return false;
+                }
+            }
+        }
+        if (c == '-' || (c >= '0' && c <= '9')) {
+            return readNumber(scratch);
+        }
+        return readLiteral("true") || readLiteral("false") || readLiteral("null");
+    }
+
+    bool readLiteral(const char* word) {
+        if (peek() != word[0]) {
+            return false;
+        }
+        for (const char* p = word; *p; ++p) {
+            if (get() != *p) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    bool refill() {
+        consumed_ += end_;
+        pos_ = 0;
+        end_ = std::fread(buffer_.data(), 1, buffer_.size(), file_);
+        return end_ > 0;
+    }
+
+    bool readHex4(uint32_t& cp) {
+        cp = 0;
+        for (int i = 0; i < 4; ++i) {
+            const int h = get();
+            cp <<= 4;
+            if (h >= '0' && h <= '9') {
+                cp |= static_cast<uint32_t>(h - '0');
+            } else if (h >= 'a' && h <= 'f') {
+                cp |= static_cast<uint32_t>(h - 'a' + 10);
+            } else if (h >= 'A' && h <= 'F') {
+                cp |= static_cast<uint32_t>(h - 'A' + 10);
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::FILE* file_;
+    std::vector<char> buffer_;
+    size_t pos_;
+    size_t end_;
+    uint64_t consumed_;
+};
+
+// One object into record; unknown keys and mistyped values are skipped
+bool readObject(JsonStream& in, PoiJsonRecord& record, bool& has_name, bool& has_position, std::string& key,
+                std::string& scratch) {
+    record.id = 0;
+    record.name.clear();
+    record.category.clear();
+    record.address.clear();
+    bool has_lat = false, has_lon = false;
+
+    if (!in.expect('{')) {
+        return false;
+    }
+    if (in.skipSpace() == '}') {
+        in.get();
+    } else {
+        for (;;) {
+            if (in.skipSpace() != '"' || !in.readString(key) || !in.expect(':')) {
+                return false;
+            }
+            const int c = in.skipSpace();
+            std::string* text = key == "name" ? &record.name
+                              : key == "category" ? &record.category
+                              : key == "address" ? &record.address : nullptr;
+            const bool number = c == '-' || (c >= '0' && c <= '9');
+            if (text && c == '"') {
+                if (!in.readString(*text)) {
+                    return false;
+                }
+            } else if (number && (key == "id" || key == "latitude" || key == "longitude")) {
+                if (!in.readNumber(scratch)) {
+                    return false;
+                }
+                char* end = nullptr;
+                if (key == "id") {
+                    record.id = std::strtoull(scratch.c_str(), &end, 10);
+                } else {
+                    const double value = std::strtod(scratch.c_str(), &end);
+                    (key == "latitude" ? record.latitude : record.longitude) = value;
+                    (key == "latitude" ? has_lat : has_lon) = std::isfinite(value);
+                }
+            } else if (!in.skipValue(1, scratch)) {
+                return false;
+            }
+
+            const int next = in.skipSpace();
+            in.get();
+            if (next == '}') {
+                break;
+            }
+            if (next != ',') {
+                return false;
+            }
+        }
+    }
+
+    has_name = !record.name.empty();
+    has_position = has_lat && has_lon && std::fabs(record.latitude) <= 90.0 && std::fabs(record.longitude) <= 180.0;
+    return true;
+}
+
+} // namespace
+
+PoiJsonReader::PoiJsonReader() : skipped_(0) {
+}
+
+bool PoiJsonReader::read(const std::string& path, const Visitor& visit) {
+    error_.clear();
+    skipped_ = 0;
+
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        error_ = "cannot open " + path;
+        return false;
+    }
+
+    JsonStream in(file);
+    PoiJsonRecord record;
+    std::string key, scratch;
+    bool ok = in.expect('[');
+    if (ok && in.skipSpace() == ']') {
+        in.get();
+    } else {
+        while (ok) {
+            bool has_name = false, has_position = false;
+            ok = readObject(in, record, has_name, has_position, key, scratch);
+            if (!ok) {
+                break;
+            }
+            if (has_name && has_position) {
+                visit(record);
+            } else {
+                ++skipped_;
+            }
+            const int next = in.skipSpace();
+            in.get();
+            if (next == ']') {
+                break;
+            }
+            ok = next == ',';
+        }
+    }
+    if (ok && in.skipSpace() >= 0) {
+        ok = false;   // Trailing content
+    }
+    if (!ok) {
+        error_ = "JSON syntax error at byte " + std::to_string(in.offset());
+    }
+    std::fclose(file);
+    return ok;
+}
+
+PoiSnapshot::PoiSnapshot() : data_(nullptr), size_(0), fd_(-1) {
+}
+
+PoiSnapshot::~PoiSnapshot() {
+    close();
+}
+
+bool PoiSnapshot::open(const std::string& path) {
+    close();
+    error_.clear();
+
+#ifdef _WIN32
+    // No mmap: read the whole file once
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        error_ = "cannot open " + path;
+        return false;
+    }
+    fallback_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    if (fallback_.size() < sizeof(PoiSnapshotHeader)) {
+        error_ = "file too small";
+        fallback_.clear();
+        return false;
+    }
+    data_ = fallback_.data();
+    size_ = fallback_.size();
+#else
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        error_ = "cannot open " + path;
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd_, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(PoiSnapshotHeader))) {
+        error_ = "file too small";
+        close();
+        return false;
+    }
+
+    void* mapped = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd_, 0);
+    if (mapped == MAP_FAILED) {
+        error_ = "mmap failed";
+        close();
+        return false;
+    }
+    data_ = static_cast<const uint8_t*>(mapped);
+    size_ = static_cast<size_t>(st.st_size);
+#endif
+
+    if (!validateHeader()) {
+        const std::string error = error_;
+        close();
+        error_ = error;
+        return false;
+    }
+
+    const PoiSnapshotHeader& h = header();
+    strings_ = ArrayView<char>(reinterpret_cast<const char*>(data_ + h.strings_offset), h.strings_size);
+    records_ = ArrayView<PoiSnapshotRecord>(reinterpret_cast<const PoiSnapshotRecord*>(data_ + h.records_offset),
+                                            h.poi_count);
+    categories_ = ArrayView<uint32_t>(reinterpret_cast<const uint32_t*>(data_ + h.categories_offset),
+                                      h.category_count);
+    return true;
+}
+
+void PoiSnapshot::close() {
+#ifndef _WIN32
+    if (data_) {
+        munmap(const_cast<uint8_t*>(data_), size_);
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+#endif
+    fd_ = -1;
+    fallback_.clear();
+    data_ = nullptr;
+    size_ = 0;
+    records_ = ArrayView<PoiSnapshotRecord>();
+    categories_ = ArrayView<uint32_t>();
+    strings_ = ArrayView<char>();
+}
+
+bool PoiSnapshot::validateHeader() {
+    const PoiSnapshotHeader& h = header();
+    if (std::memcmp(h.magic, POI_SNAPSHOT_MAGIC, sizeof(POI_SNAPSHOT_MAGIC)) != 0) {
+        error_ = "not a POI snapshot";
+        return false;
+    }
+    if (h.version != POI_SNAPSHOT_VERSION || h.header_size != sizeof(PoiSnapshotHeader)) {
+        error_ = "unsupported POI snapshot version";
+        return false;
+    }
+    if (h.header_crc32 != headerCrc(h)) {
+        error_ = "header checksum mismatch";
+        return false;
+    }
+    if (h.file_size != size_) {
+        error_ = "truncated POI snapshot";
+        return false;
+    }
+
+    // Sections in order, inside the file, records aligned
+    const uint64_t records_size = static_cast<uint64_t>(h.poi_count) * sizeof(PoiSnapshotRecord);
+    const uint64_t categories_size = static_cast<uint64_t>(h.category_count) * sizeof(uint32_t);
+    if (h.strings_offset != sizeof(PoiSnapshotHeader) || h.strings_size == 0 ||
+        h.records_offset < h.strings_offset + h.strings_size || h.records_offset % 8 != 0 ||
+        h.categories_offset != h.records_offset + records_size || h.categories_offset + categories_size != size_) {
+        error_ = "invalid section table";
+        return false;
+    }
+    if (data_[h.strings_offset + h.strings_size - 1] != '\0') {
+        error_ = "unterminated string table";
+        return false;
+    }
+    return true;
+}
+
+bool PoiSnapshot::isCurrent(const std::string& source_path) const {
+    uint64_t size;
+    int64_t mtime;
+    if (!isOpen()) {
+        return false;
+    }
+    if (!fileStamp(source_path, size, mtime)) {
+        return true;   // Snapshot deployed without its source
+    }
+    return header().source_size == size && header().source_mtime == mtime;
+}
+
+bool PoiSnapshotWriter::convert(const std::string& json_path, const std::string& snapshot_path, std::string* error,
+                                size_t* poi_count) {
+    auto fail = [error](const std::string& message) {
+        if (error) {
+            *error = message;
+        }
+        return false;
+    };
+
+    PoiSnapshotHeader header = PoiSnapshotHeader();
+    if (!fileStamp(json_path, header.source_size, header.source_mtime)) {
+        return fail("cannot open " + json_path);
+    }
+
+    // Strings go straight into the snapshot; records to a side file, appended once their count is known
+    const std::string tmp_path = snapshot_path + ".tmp";
+    const std::string records_path = snapshot_path + ".records.tmp";
+    std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+    std::ofstream records_out(records_path, std::ios::binary | std::ios::trunc);
+    if (!out || !records_out) {
+        std::remove(records_path.c_str());
+        return fail("cannot create " + tmp_path);
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.put('\0');
+
+    uint64_t strings_size = 1;
+    bool overflow = false;
+    auto addString = [&](const std::string& s) -> uint32_t {
+        if (s.empty() || overflow) {
+            return 0;
+        }
+        if (strings_size + s.size() + 1 > UINT32_MAX) {
+            overflow = true;
+            return 0;
+        }
+        const uint32_t offset = static_cast<uint32_t>(strings_size);
+        out.write(s.data(), static_cast<std::streamsize>(s.size()));
+        out.put('\0');
+        strings_size += s.size() + 1;
+        return offset;
+    };
+
+    std::unordered_map<std::string, uint16_t> category_ids;
+    std::vector<uint32_t> category_offsets;
+    uint32_t count = 0;
+    PoiJsonReader reader;
+    const bool parsed = reader.read(json_path, [&](const PoiJsonRecord& poi) {
+        auto it = category_ids.find(poi.category);
+        if (it == category_ids.end()) {
+            if (category_offsets.size() >= POI_SNAPSHOT_MAX_CATEGORIES) {
+                overflow = true;
+                return;
+            }
+            it = category_ids.emplace(poi.category, static_cast<uint16_t>(category_offsets.size())).first;
+            category_offsets.push_back(addString(poi.category));
+        }
+
+        PoiSnapshotRecord r;
+        std::memset(&r, 0, sizeof(r));
+        r.poi_id = poi.id;
+        r.lat_e7 = static_cast<int32_t>(std::lround(poi.latitude * COORD_SCALE));
+        r.lon_e7 = static_cast<int32_t>(std::lround(poi.longitude * COORD_SCALE));
+        r.name_offset = addString(poi.name);
+        r.address_offset = addString(poi.address);
+        r.category = it->second;
+        records_out.write(reinterpret_cast<const char*>(&r), sizeof(r));
+        ++count;
+    });
+    records_out.close();
+
+    auto abandon = [&](const std::string& message) {
+        out.close();
+        std::remove(tmp_path.c_str());
+        std::remove(records_path.c_str());
+        return fail(message);
+    };
+    if (!parsed) {
+        return abandon(reader.lastError());
+    }
+    if (overflow) {
+        return abandon("too many categories or strings");
+    }
+    if (!records_out || !out) {
+        return abandon("write failed: " + (records_out ? tmp_path : records_path));
+    }
+
+    // Records, 8-byte aligned, then the category table
+    header.strings_offset = sizeof(PoiSnapshotHeader);
+    header.strings_size = strings_size;
+    uint64_t offset = header.strings_offset + strings_size;
+    while (offset % 8 != 0) {
+        out.put('\0');
+        ++offset;
+    }
+    header.records_offset = offset;
+    {
+        std::ifstream records_in(records_path, std::ios::binary);
+        std::vector<char> chunk(READ_CHUNK_BYTES);
+        uint64_t copied = 0;
+        while (records_in) {
+            records_in.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+            out.write(chunk.data(), records_in.gcount());
+            copied += static_cast<uint64_t>(records_in.gcount());
+        }
+        if (records_in.bad() || copied != static_cast<uint64_t>(count) * sizeof(PoiSnapshotRecord)) {
+            return abandon("cannot read back " + records_path);
+        }
+    }
+    std::remove(records_path.c_str());
+    header.categories_offset = header.records_offset + static_cast<uint64_t>(count) * sizeof(PoiSnapshotRecord);
+    out.write(reinterpret_cast<const char*>(category_offsets.data()),
+              static_cast<std::streamsize>(category_offsets.size() * sizeof(uint32_t)));
+
+    std::memcpy(header.magic, POI_SNAPSHOT_MAGIC, sizeof(POI_SNAPSHOT_MAGIC));
+    header.version = POI_SNAPSHOT_VERSION;
+    header.header_size = sizeof(PoiSnapshotHeader);
+    header.poi_count = count;
+    header.category_count = static_cast<uint32_t>(category_offsets.size());
+    header.file_size = header.categories_offset + category_offsets.size() * sizeof(uint32_t);
+    header.header_crc32 = headerCrc(header);
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.close();
+    if (!out) {
+        std::remove(tmp_path.c_str());
+        return fail("write failed: " + tmp_path);
+    }
+
+    // Rename, so a crash never leaves a half-written snapshot behind
+    if (std::rename(tmp_path.c_str(), snapshot_path.c_str()) != 0) {
+        std::remove(tmp_path.c_str());
+        return fail("cannot rename to " + snapshot_path);
+    }
+    if (poi_count) {
+        *poi_count = count;
+    }
+    return true;
+}
+
+} // namespace nav
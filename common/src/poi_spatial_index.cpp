@@ -0,0 +1,237 @@
+#include "poi_spatial_index.h"
+#include <algorithm>
+#include <cmath>
+
+namespace nav {
+
+namespace {
+
+// Average number of POIs per grid cell
+const uint32_t GRID_POIS_PER_CELL = 4;
+
+// Metres per 1e-7 degree of latitude
+const double METERS_PER_E7 = 6371000.0 * M_PI / 180.0 / 1e7;
+
+int32_t toE7(double degrees) {
+    return static_cast<int32_t>(std::lround(degrees * 1e7));
+}
+
+bool closerHit(const PoiHit& a, const PoiHit& b) {
+    return a.distance_m < b.distance_m;
+}
+
+} // namespace
+
+PoiSpatialIndex::PoiSpatialIndex()
+    : min_lat_e7_(0), min_lon_e7_(0), cell_lat_e7_(1), cell_lon_e7_(1), rows_(0), cols_(0) {
+}
+
+void PoiSpatialIndex::clear() {
+    lat_e7_.clear();
+    lon_e7_.clear();
+    category_.clear();
+    poi_.clear();
+    cell_first_.clear();
+    cell_categories_.clear();
+    rows_ = 0;
+    cols_ = 0;
+}
+
+bool PoiSpatialIndex::build(const std::vector<PoiLocation>& pois) {
+    clear();
+    const uint32_t n = static_cast<uint32_t>(pois.size());
+    if (n == 0) {
+        return false;
+    }
+
+    std::vector<int32_t> lat(n), lon(n);
+    for (uint32_t i = 0; i < n; ++i) {
+        lat[i] = toE7(pois[i].latitude);
+        lon[i] = toE7(pois[i].longitude);
+    }
+    const auto lat_range = std::minmax_element(lat.begin(), lat.end());
+    const auto lon_range = std::minmax_element(lon.begin(), lon.end());
+    const int32_t min_lat = *lat_range.first, max_lat = *lat_range.second;
+    const int32_t min_lon = *lon_range.first, max_lon = *lon_range.second;
+
+    // Pick rows/cols so cells are roughly square on the ground
+    const double lat_span = std::max<double>(1.0, static_cast<double>(max_lat) - min_lat);
+    const double lon_span = std::max<double>(1.0, static_cast<double>(max_lon) - min_lon);
+    const double cos_lat = std::cos((static_cast<double>(min_lat) + max_lat) * 0.5 / 1e7 * M_PI / 180.0);
+    const uint32_t cells = std::max<uint32_t>(1, n / GRID_POIS_PER_CELL);
+    const double aspect = std::max(lon_span * cos_lat, 1.0) / lat_span;
+    cols_ = std::min<uint32_t>(cells, std::max<uint32_t>(1,
+        static_cast<uint32_t>(std::lround(std::sqrt(cells * aspect)))));
+    rows_ = std::max<uint32_t>(1, (cells + cols_ - 1) / cols_);
+    min_lat_e7_ = min_lat;
+    min_lon_e7_ = min_lon;
+    cell_lat_e7_ = static_cast<int32_t>(lat_span / rows_) + 1;
+    cell_lon_e7_ = static_cast<int32_t>(lon_span / cols_) + 1;
+
+    // Counting sort by cell
+    const size_t cell_count = static_cast<size_t>(rows_) * cols_;
+    std::vector<uint32_t> cell_of(n);
+    cell_first_.assign(cell_count + 1, 0);
+    cell_categories_.assign(cell_count, 0);
+    for (uint32_t i = 0; i < n; ++i) {
+        cell_of[i] = cellRow(lat[i]) * cols_ + cellCol(lon[i]);
+        ++cell_first_[cell_of[i] + 1];
+        cell_categories_[cell_of[i]] |= categoryBit(pois[i].category);
+    }
+    for (size_t c = 1; c < cell_first_.size(); ++c) {
+        cell_first_[c] += cell_first_[c - 1];
+    }
+
+    lat_e7_.resize(n);
+    lon_e7_.resize(n);
+    category_.resize(n);
+    poi_.resize(n);
+    std::vector<uint32_t> fill(cell_first_.begin(), cell_first_.end() - 1);
+    for (uint32_t i = 0; i < n; ++i) {
+        const uint32_t slot = fill[cell_of[i]]++;
+        lat_e7_[slot] = lat[i];
+        lon_e7_[slot] = lon[i];
+        category_[slot] = pois[i].category;
+        poi_[slot] = i;
+    }
+    return true;
+}
+
+size_t PoiSpatialIndex::findWithinRadius(const Point& center, double radius_m, uint16_t category,
+                                         std::vector<PoiHit>& out) const {
+    if (poi_.empty() || radius_m < 0.0) {
+        return 0;
+    }
+
+    const int32_t qlat = toE7(center.latitude);
+    const int32_t qlon = toE7(center.longitude);
+    const double cos_lat = std::cos(center.latitude * M_PI / 180.0);
+    const double lat_scale = METERS_PER_E7;
+    const double lon_scale = METERS_PER_E7 * cos_lat;
+    const double radius2 = radius_m * radius_m;
+    const bool any = category == ANY_CATEGORY;
+    const uint64_t bit = categoryBit(category);
+
+    const double dlat = radius_m / lat_scale;
+    const double dlon = radius_m / std::max(lon_scale, 1e-9);
+    const uint32_t r0 = cellRow(static_cast<int32_t>(std::max(-9e8, qlat - dlat)));
+    const uint32_t r1 = cellRow(static_cast<int32_t>(std::min(9e8, qlat + dlat)));
+    const uint32_t c0 = cellCol(static_cast<int32_t>(std::max(-1.8e9, qlon - dlon)));
+    const uint32_t c1 = cellCol(static_cast<int32_t>(std::min(1.8e9, qlon + dlon)));
+
+    const size_t first = out.size();
+    for (uint32_t r = r0; r <= r1; ++r) {
+        for (uint32_t c = c0; c <= c1; ++c) {
+            const size_t cell = static_cast<size_t>(r) * cols_ + c;
+            if (!any && !(cell_categories_[cell] & bit)) {
+                continue;
+            }
+            for (uint32_t i = cell_first_[cell]; i < cell_first_[cell + 1]; ++i) {
+                if (!any && category_[i] != category) {
+                    continue;
+                }
+                const double dy = (lat_e7_[i] - qlat) * lat_scale;
+                const double dx = (lon_e7_[i] - qlon) * lon_scale;
+                const double d2 = dx * dx + dy * dy;
+                if (d2 <= radius2) {
+                    out.emplace_back(poi_[i], std::sqrt(d2));
+                }
+            }
+        }
+    }
+    std::sort(out.begin() + first, out.end(), closerHit);
+    return out.size() - first;
+}
+
+size_t PoiSpatialIndex::findNearest(const Point& center, size_t k, uint16_t category, double max_radius_m,
+                                    std::vector<PoiHit>& out) const {
+    if (poi_.empty() || k == 0) {
+        return 0;
+    }
+
+    const int32_t qlat = toE7(center.latitude);
+    const int32_t qlon = toE7(center.longitude);
+    const double cos_lat = std::cos(center.latitude * M_PI / 180.0);
+    const double lat_scale = METERS_PER_E7;
+    const double lon_scale = METERS_PER_E7 * cos_lat;
+    const double min_cell_m = std::min(cell_lat_e7_ * lat_scale, cell_lon_e7_ * lon_scale);
+    const double max_radius2 = max_radius_m * max_radius_m;
+    const bool any = category == ANY_CATEGORY;
+    const uint64_t bit = categoryBit(category);
+
+    const int64_t row = cellRow(qlat);
+    const int64_t col = cellCol(qlon);
+    const int64_t max_ring = std::max<int64_t>(std::max<int64_t>(row, rows_ - 1 - row),
+                                               std::max<int64_t>(col, cols_ - 1 - col));
+
+    // Max-heap on squared distance holding the k best so far
+    std::vector<PoiHit> heap;
+    heap.reserve(k);
+    for (int64_t ring = 0; ring <= max_ring; ++ring) {
+        // Visit the cells on the border of the (2 ring + 1) square
+        for (int64_t r = row - ring; r <= row + ring; ++r) {
+            if (r < 0 || r >= rows_) {
+                continue;
+            }
+            const bool edge_row = (r == row - ring || r == row + ring);
+            for (int64_t c = col - ring; c <= col + ring; c += edge_row ? 1 : 2 * ring) {
+                if (c < 0 || c >= cols_) {
+                    continue;
+                }
+                const size_t cell = static_cast<size_t>(r) * cols_ + c;
+                if (!any && !(cell_categories_[cell] & bit)) {
+                    continue;
+                }
+                for (uint32_t i = cell_first_[cell]; i < cell_first_[cell + 1]; ++i) {
+                    if (!any && category_[i] != category) {
+                        continue;
+                    }
+                    const double dy = (lat_e7_[i] - qlat) * lat_scale;
+                    const double dx = (lon_e7_[i] - qlon) * lon_scale;
+                    const double d2 = dx * dx + dy * dy;
+                    if (d2 > max_radius2) {
+                        continue;
+                    }
+                    if (heap.size() < k) {
+                        heap.emplace_back(poi_[i], d2);
+                        std::push_heap(heap.begin(), heap.end(), closerHit);
+                    } else if (d2 < heap.front().distance_m) {
+                        std::pop_heap(heap.begin(), heap.end(), closerHit);
+                        heap.back() = PoiHit(poi_[i], d2);
+                        std::push_heap(heap.begin(), heap.end(), closerHit);
+                    }
+                }
+            }
+        }
+
+        // Cells outside this ring are at least ring cell widths away
+        const double bound = ring * min_cell_m;
+        if (bound > max_radius_m || (heap.size() == k && heap.front().distance_m <= bound * bound)) {
+            break;
+        }
+    }
+
+    std::sort_heap(heap.begin(), heap.end(), closerHit);
+    for (const PoiHit& hit : heap) {
+        out.emplace_back(hit.poi, std::sqrt(hit.distance_m));
+    }
+    return heap.size();
+}
+
+size_t PoiSpatialIndex::memoryBytes() const {
+    return lat_e7_.capacity() * sizeof(int32_t) + lon_e7_.capacity() * sizeof(int32_t) +
+           category_.capacity() * sizeof(uint16_t) + poi_.capacity() * sizeof(uint32_t) +
+           cell_first_.capacity() * sizeof(uint32_t) + cell_categories_.capacity() * sizeof(uint64_t);
+}
+
+uint32_t PoiSpatialIndex::cellRow(int32_t lat_e7) const {
+    const int64_t r = (static_cast<int64_t>(lat_e7) - min_lat_e7_) / cell_lat_e7_;
+    return static_cast<uint32_t>(std::min<int64_t>(std::max<int64_t>(r, 0), rows_ - 1));
+}
+
+uint32_t PoiSpatialIndex::cellCol(int32_t lon_e7) const {
+    const int64_t c = (static_cast<int64_t>(lon_e7) - min_lon_e7_) / cell_lon_e7_;
+    return static_cast<uint32_t>(std::min<int64_t>(std::max<int64_t>(c, 0), cols_ - 1));
+}
+
+} // namespace nav
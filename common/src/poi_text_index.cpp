@@ -0,0 +1,500 @@
+#include "poi_text_index.h"
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+
+namespace nav {
+
+namespace {
+
+// Folding of U+00C0..U+00FF; '_' marks a separator (multiplication/division signs)
+const char LATIN1_FOLD[] =
+    "aaaaaaaceeeeiiiidnooooo_ouuuuyts"
+    "aaaaaaaceeeeiiiidnooooo_ouuuuyty";
+static_assert(sizeof(LATIN1_FOLD) == 64 + 1, "one entry per code point");
+
+// Folding of U+0100..U+017F (includes Vietnamese Ă ă Đ đ Ĩ ĩ Ũ ũ)
+const char LATIN_EXT_A_FOLD[] =
+    "aaaaaa" "cccccccc" "dddd" "eeeeeeeeee" "gggggggg" "hhhh" "iiiiiiiiii" "ii" "jj" "kkk"
+    "llllllllll" "nnnnnnnnn" "oooooo" "oo" "rrrrrr" "ssssssss" "tttttt" "uuuuuuuuuuuu" "ww" "yyy"
+    "zzzzzz" "s";
+static_assert(sizeof(LATIN_EXT_A_FOLD) == 128 + 1, "one entry per code point");
+
+const char KEEP = 1;   // Not Latin: keep the UTF-8 bytes
+const char DROP = 2;   // Combining mark: emit nothing
+
+// ASCII letter for a code point, ' ' for a separator, or KEEP / DROP
+char foldCodePoint(uint32_t cp) {
+    if (cp < 0x80) {
+        if ((cp >= 'a' && cp <= 'z') || (cp >= '0' && cp <= '9')) {
+            return static_cast<char>(cp);
+        }
+        if (cp >= 'A' && cp <= 'Z') {
+            return static_cast<char>(cp - 'A' + 'a');
+        }
+        return ' ';
+    }
+    if (cp >= 0xC0 && cp <= 0xFF) {
+        const char c = LATIN1_FOLD[cp - 0xC0];
+        return c == '_' ? ' ' : c;
+    }
+    if (cp >= 0x100 && cp <= 0x17F) {
+        return LATIN_EXT_A_FOLD[cp - 0x100];
+    }
+    if (cp == 0x1A0 || cp == 0x1A1) {
+        return 'o';   // Ơ ơ
+    }
+    if (cp == 0x1AF || cp == 0x1B0) {
+        return 'u';   // Ư ư
+    }
+    if (cp >= 0x300 && cp <= 0x36F) {
+        return DROP;
+    }
+    // Vietnamese block of Latin Extended Additional
+    if (cp >= 0x1EA0 && cp <= 0x1EB7) return 'a';
+    if (cp >= 0x1EB8 && cp <= 0x1EC7) return 'e';
+    if (cp >= 0x1EC8 && cp <= 0x1ECB) return 'i';
+    if (cp >= 0x1ECC && cp <= 0x1EE3) return 'o';
+    if (cp >= 0x1EE4 && cp <= 0x1EF1) return 'u';
+    if (cp >= 0x1EF2 && cp <= 0x1EF9) return 'y';
+    // General punctuation and spaces
+    if (cp <= 0xBF || (cp >= 0x2000 && cp <= 0x206F) || cp == 0x3000) {
+        return ' ';
+    }
+    return KEEP;
+}
+
+// Split folded text on spaces, truncating long tokens
+template <typename Visitor>
+void forEachToken(std::string_view folded, size_t max_length, Visitor visit) {
+    size_t i = 0;
+    while (i < folded.size()) {
+        while (i < folded.size() && folded[i] == ' ') {
+            ++i;
+        }
+        const size_t start = i;
+        while (i < folded.size() && folded[i] != ' ') {
+            ++i;
+        }
+        if (i > start) {
+            visit(folded.substr(start, std::min(i - start, max_length)));
+        }
+    }
+}
+
+struct RawPosting {
+    uint32_t term;
+    uint32_t doc;
+    uint8_t fields;
+};
+
+float lengthPenalty(uint8_t name_tokens) {
+    return 0.05f * name_tokens;
+}
+
+bool betterHit(const TextHit& a, const TextHit& b) {
+    return a.score > b.score || (a.score == b.score && a.doc < b.doc);
+}
+
+} // namespace
+
+PoiTextIndex::PoiTextIndex() {
+}
+
+void PoiTextIndex::clear() {
+    term_chars_.clear();
+    term_offset_.clear();
+    posting_first_.clear();
+    posting_doc_.clear();
+    doc_term_first_.clear();
+    doc_terms_.clear();
+    doc_term_fields_.clear();
+    doc_name_tokens_.clear();
+}
+
+void PoiTextIndex::foldText(std::string_view text, std::string& out) {
+    out.clear();
+    out.reserve(text.size());
+    size_t i = 0;
+    while (i < text.size()) {
+        const uint8_t lead = static_cast<uint8_t>(text[i]);
+        size_t length = 1;
+        uint32_t cp = lead;
+        if (lead >= 0xF0 && lead <= 0xF4) {
+            length = 4;
+            cp = lead & 0x07;
+        } else if (lead >= 0xE0) {
+            length = 3;
+            cp = lead & 0x0F;
+        } else if (lead >= 0xC2 && lead < 0xE0) {
+            length = 2;
+            cp = lead & 0x1F;
+        } else if (lead >= 0x80) {
+            out.push_back(' ');   // Stray continuation or invalid lead byte
+            ++i;
+            continue;
+        }
+        if (i + length > text.size()) {
+            break;
+        }
+        bool valid = true;
+        for (size_t k = 1; k < length; ++k) {
+            const uint8_t byte = static_cast<uint8_t>(text[i + k]);
+            valid = valid && (byte & 0xC0) == 0x80;
+            cp = (cp << 6) | (byte & 0x3F);
+        }
+        if (!valid) {
+            out.push_back(' ');
+            ++i;
+            continue;
+        }
+
+        const char folded = foldCodePoint(cp);
+        if (folded == KEEP) {
+            out.append(text.data() + i, length);
+        } else if (folded != DROP) {
+            out.push_back(folded);
+        }
+        i += length;
+    }
+}
+
+bool PoiTextIndex::build(const std::vector<TextDocument>& docs) {
+    clear();
+    if (docs.empty()) {
+        return false;
+    }
+
+    // Tokenise everything with provisional term ids
+    std::unordered_map<std::string, uint32_t> ids;
+    std::vector<std::string> terms;
+    std::vector<RawPosting> raw;
+    raw.reserve(docs.size() * 4);
+    doc_name_tokens_.resize(docs.size());
+    std::string folded;
+
+    auto addToken = [&](std::string_view token, uint32_t doc, uint8_t fields) {
+        auto it = ids.find(std::string(token));
+        if (it == ids.end()) {
+            it = ids.emplace(std::string(token), static_cast<uint32_t>(terms.size())).first;
+            terms.emplace_back(token);
+        }
+        raw.push_back(RawPosting{it->second, doc, fields});
+    };
+
+    for (uint32_t d = 0; d < docs.size(); ++d) {
+        const size_t doc_start = raw.size();
+        uint32_t position = 0;
+        foldText(docs[d].name, folded);
+        forEachToken(folded, MAX_TOKEN_LENGTH, [&](std::string_view token) {
+            addToken(token, d, position == 0 ? FIELD_NAME | FIELD_FIRST_WORD : FIELD_NAME);
+            ++position;
+        });
+        doc_name_tokens_[d] = static_cast<uint8_t>(std::min<uint32_t>(position, 255));
+        foldText(docs[d].category, folded);
+        forEachToken(folded, MAX_TOKEN_LENGTH, [&](std::string_view token) {
+            addToken(token, d, FIELD_CATEGORY);
+        });
+
+        // One posting per (term, doc), fields merged
+        std::sort(raw.begin() + doc_start, raw.end(),
+                  [](const RawPosting& a, const RawPosting& b) { return a.term < b.term; });
+        size_t out = doc_start;
+        for (size_t i = doc_start; i < raw.size(); ++i) {
+            if (out > doc_start && raw[out - 1].term == raw[i].term) {
+                raw[out - 1].fields |= raw[i].fields;
+            } else {
+                raw[out++] = raw[i];
+            }
+        }
+        raw.resize(out);
+    }
+
+    // Sorted dictionary; rank[] maps provisional ids to final ones
+    std::vector<uint32_t> order(terms.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return terms[a] < terms[b]; });
+    std::vector<uint32_t> rank(terms.size());
+    term_offset_.reserve(terms.size() + 1);
+    term_offset_.push_back(0);
+    for (uint32_t i = 0; i < order.size(); ++i) {
+        rank[order[i]] = i;
+        const std::string& t = terms[order[i]];
+        term_chars_.insert(term_chars_.end(), t.begin(), t.end());
+        term_offset_.push_back(static_cast<uint32_t>(term_chars_.size()));
+    }
+
+    // Postings (CSR), one segment per term and field class, shorter names first
+    posting_first_.assign(terms.size() * FIELD_CLASSES + 1, 0);
+    for (RawPosting& p : raw) {
+        p.term = rank[p.term];
+        ++posting_first_[p.term * FIELD_CLASSES + fieldClass(p.fields) + 1];
+    }
+    for (size_t s = 1; s < posting_first_.size(); ++s) {
+        posting_first_[s] += posting_first_[s - 1];
+    }
+    posting_doc_.resize(raw.size());
+    std::vector<uint32_t> fill(posting_first_.begin(), posting_first_.end() - 1);
+    for (const RawPosting& p : raw) {
+        posting_doc_[fill[p.term * FIELD_CLASSES + fieldClass(p.fields)]++] = p.doc;
+    }
+    for (size_t s = 0; s + 1 < posting_first_.size(); ++s) {
+        std::stable_sort(posting_doc_.begin() + posting_first_[s], posting_doc_.begin() + posting_first_[s + 1],
+                         [this](uint32_t a, uint32_t b) { return doc_name_tokens_[a] < doc_name_tokens_[b]; });
+    }
+
+    // Forward index, in the order raw is already in (by doc)
+    doc_term_first_.assign(docs.size() + 1, 0);
+    doc_terms_.resize(raw.size());
+    doc_term_fields_.resize(raw.size());
+    for (size_t i = 0; i < raw.size(); ++i) {
+        ++doc_term_first_[raw[i].doc + 1];
+        doc_terms_[i] = raw[i].term;
+        doc_term_fields_[i] = raw[i].fields;
+    }
+    for (size_t d = 1; d < doc_term_first_.size(); ++d) {
+        doc_term_first_[d] += doc_term_first_[d - 1];
+    }
+    return true;
+}
+
+PoiTextIndex::TermRange PoiTextIndex::prefixRange(std::string_view prefix) const {
+    TermRange range = {0, 0, INVALID_TERM};
+    uint32_t lo = 0, hi = termCount();
+    while (lo < hi) {
+        const uint32_t mid = lo + (hi - lo) / 2;
+        if (term(mid) < prefix) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    range.first = lo;
+
+    hi = termCount();
+    while (lo < hi) {
+        const uint32_t mid = lo + (hi - lo) / 2;
+        if (term(mid).substr(0, prefix.size()) == prefix) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    range.last = lo;
+    if (range.first < range.last && term(range.first).size() == prefix.size()) {
+        range.exact = range.first;
+    }
+    return range;
+}
+
+size_t PoiTextIndex::search(std::string_view query, size_t k, std::vector<TextHit>& out) const {
+    if (empty() || k == 0) {
+        return 0;
+    }
+
+    std::string folded;
+    foldText(query, folded);
+    TermRange ranges[MAX_QUERY_TOKENS];
+    size_t token_count = 0;
+    bool missing = false;
+    forEachToken(folded, MAX_TOKEN_LENGTH, [&](std::string_view token) {
+        if (token_count < MAX_QUERY_TOKENS) {
+            ranges[token_count] = prefixRange(token);
+            missing = missing || ranges[token_count].first == ranges[token_count].last;
+            ++token_count;
+        }
+    });
+    if (token_count == 0 || missing) {
+        return 0;
+    }
+
+    std::vector<TextHit> heap;
+    heap.reserve(k);
+    searchRanges(ranges, token_count, k, heap);
+    std::sort_heap(heap.begin(), heap.end(), betterHit);
+    out.insert(out.end(), heap.begin(), heap.end());
+    return heap.size();
+}
+
+float PoiTextIndex::tokenScore(uint8_t fields, bool exact) {
+    float s = exact ? 2.0f : 1.0f;
+    s *= (fields & FIELD_NAME) ? 1.0f : 0.5f;
+    s += (fields & FIELD_FIRST_WORD) ? 0.5f : 0.0f;
+    return s;
+}
+
+uint32_t PoiTextIndex::fieldClass(uint8_t fields) {
+    if (fields & FIELD_FIRST_WORD) {
+        return 0;
+    }
+    return (fields & FIELD_NAME) ? 1 : 2;
+}
+
+void PoiTextIndex::searchRanges(const TermRange* ranges, size_t count, size_t k, std::vector<TextHit>& heap) const {
+    static const uint8_t CLASS_FIELDS[FIELD_CLASSES] = {FIELD_NAME | FIELD_FIRST_WORD, FIELD_NAME, FIELD_CATEGORY};
+
+    // Drive from the token with the fewest postings; the others add at most their best score
+    size_t driver = 0;
+    for (size_t i = 1; i < count; ++i) {
+        if (postingCount(ranges[i]) < postingCount(ranges[driver])) {
+            driver = i;
+        }
+    }
+    const TermRange& drive = ranges[driver];
+
+    // Documents matching the next rarest token, so most driver postings are rejected without a lookup:
+    // a bitmap when it has a posting per 64 documents (a bitmap word), else its documents sorted, so
+    // building the filter costs no more than walking those postings either way
+    std::vector<uint64_t> filter;
+    std::vector<uint32_t> filter_docs;
+    if (count > 1) {
+        size_t second = driver == 0 ? 1 : 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (i != driver && postingCount(ranges[i]) < postingCount(ranges[second])) {
+                second = i;
+            }
+        }
+        const uint32_t begin = posting_first_[ranges[second].first * FIELD_CLASSES];
+        const uint32_t end = posting_first_[ranges[second].last * FIELD_CLASSES];
+        if (size_t(end - begin) * 64 >= doc_name_tokens_.size()) {
+            filter.assign((doc_name_tokens_.size() + 63) / 64, 0);
+            for (uint32_t p = begin; p < end; ++p) {
+                filter[posting_doc_[p] >> 6] |= uint64_t(1) << (posting_doc_[p] & 63);
+            }
+        } else {
+            filter_docs.assign(posting_doc_.begin() + begin, posting_doc_.begin() + end);
+            std::sort(filter_docs.begin(), filter_docs.end());
+        }
+    }
+    auto filtered = [&](uint32_t doc) {
+        if (!filter.empty()) {
+            return !(filter[doc >> 6] & (uint64_t(1) << (doc & 63)));
+        }
+        return count > 1 && !std::binary_search(filter_docs.begin(), filter_docs.end(), doc);
+    };
+
+    // The other tokens score at most a name match each, plus the first word bonus for those that can
+    // match the document's one first word: all of them if their ranges overlap, else one
+    const float bonus = tokenScore(FIELD_NAME | FIELD_FIRST_WORD, false) - tokenScore(FIELD_NAME, false);
+    float others_max = 0.0f;
+    bool overlap = false;
+    for (size_t i = 0; i < count; ++i) {
+        if (i == driver) {
+            continue;
+        }
+        others_max += tokenScore(FIELD_NAME, ranges[i].exact != INVALID_TERM);
+        for (size_t j = i + 1; j < count; ++j) {
+            overlap = overlap || (j != driver && ranges[i].first < ranges[j].last && ranges[j].first < ranges[i].last);
+        }
+    }
+    const float others_bonus = count < 2 ? 0.0f : overlap ? bonus * (count - 1) : bonus;
+
+    // Min-heap of the best k (front = worst kept)
+    for (uint32_t t = drive.first; t < drive.last; ++t) {
+        // When t is the first word, only tokens whose range holds t get the bonus
+        float first_word_bonus = 0.0f;
+        for (size_t i = 0; i < count; ++i) {
+            first_word_bonus += (i != driver && t >= ranges[i].first && t < ranges[i].last) ? bonus : 0.0f;
+        }
+        for (uint32_t c = 0; c < FIELD_CLASSES; ++c) {
+            const float segment_max =
+                tokenScore(CLASS_FIELDS[c], t == drive.exact) + others_max + (c == 0 ? first_word_bonus : others_bonus);
+            const uint32_t segment = t * FIELD_CLASSES + c;
+            for (uint32_t p = posting_first_[segment]; p < posting_first_[segment + 1]; ++p) {
+                const uint32_t doc = posting_doc_[p];
+                if (filtered(doc)) {
+                    continue;
+                }
+
+                // The segment is sorted by length, then doc: nothing further down can enter the heap
+                if (heap.size() == k &&
+                    !betterHit(TextHit(doc, segment_max - lengthPenalty(doc_name_tokens_[doc])), heap.front())) {
+                    break;
+                }
+
+                const uint32_t begin = doc_term_first_[doc];
+                const uint32_t end = doc_term_first_[doc + 1];
+
+                // Visit a document once, from its best driver term (the segment its bound came from)
+                bool elsewhere = false;
+                for (uint32_t j = begin; j < end && !elsewhere && drive.last - drive.first > 1; ++j) {
+                    const uint32_t id = doc_terms_[j];
+                    if (id != t && id >= drive.first && id < drive.last) {
+                        const uint32_t other = fieldClass(doc_term_fields_[j]);
+                        elsewhere = other < c || (other == c && id < t);
+                    }
+                }
+                if (elsewhere) {
+                    continue;
+                }
+
+                float score = 0.0f;
+                bool matched = true;
+                for (size_t i = 0; i < count && matched; ++i) {
+                    float best = 0.0f;
+                    for (uint32_t j = begin; j < end; ++j) {
+                        const uint32_t id = doc_terms_[j];
+                        if (id >= ranges[i].first && id < ranges[i].last) {
+                            best = std::max(best, tokenScore(doc_term_fields_[j], id == ranges[i].exact));
+                        }
+                    }
+                    matched = best > 0.0f;
+                    score += best;
+                }
+                if (!matched) {
+                    continue;
+                }
+                score -= lengthPenalty(doc_name_tokens_[doc]);
+
+                const TextHit hit(doc, score);
+                if (heap.size() < k) {
+                    heap.push_back(hit);
+                    std::push_heap(heap.begin(), heap.end(), betterHit);
+                } else if (betterHit(hit, heap.front())) {
+                    std::pop_heap(heap.begin(), heap.end(), betterHit);
+                    heap.back() = hit;
+                    std::push_heap(heap.begin(), heap.end(), betterHit);
+                }
+            }
+        }
+    }
+}
+
+size_t PoiTextIndex::complete(std::string_view prefix, size_t k, std::vector<std::string>& out) const {
+    if (empty() || k == 0) {
+        return 0;
+    }
+
+    // Complete the last word of the input
+    std::string folded;
+    foldText(prefix, folded);
+    std::string_view last;
+    forEachToken(folded, MAX_TOKEN_LENGTH, [&](std::string_view token) { last = token; });
+    if (last.empty()) {
+        return 0;
+    }
+    const TermRange range = prefixRange(last);
+
+    std::vector<uint32_t> candidates(range.last - range.first);
+    std::iota(candidates.begin(), candidates.end(), range.first);
+    auto moreFrequent = [this](uint32_t a, uint32_t b) {
+        const uint32_t fa = posting_first_[(a + 1) * FIELD_CLASSES] - posting_first_[a * FIELD_CLASSES];
+        const uint32_t fb = posting_first_[(b + 1) * FIELD_CLASSES] - posting_first_[b * FIELD_CLASSES];
+        return fa > fb || (fa == fb && a < b);
+    };
+    const size_t n = std::min(k, candidates.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + n, candidates.end(), moreFrequent);
+    for (size_t i = 0; i < n; ++i) {
+        out.emplace_back(term(candidates[i]));
+    }
+    return n;
+}
+
+size_t PoiTextIndex::memoryBytes() const {
+    return term_chars_.capacity() + term_offset_.capacity() * sizeof(uint32_t) +
+           (posting_first_.capacity() + posting_doc_.capacity()) * sizeof(uint32_t) +
+           (doc_term_first_.capacity() + doc_terms_.capacity()) * sizeof(uint32_t) +
+           doc_term_fields_.capacity() + doc_name_tokens_.capacity();
+}
+
+} // namespace nav
@@ -0,0 +1,358 @@
+#include "position_filter.h"
+#include <cmath>
+
+namespace nav {
+
+namespace {
+
+const double EARTH_RADIUS_M = 6371000.0;
+const double DEG_TO_RAD = M_PI / 180.0;
+const double TWO_PI = 2.0 * M_PI;
+
+// Longest single prediction step; longer gaps are integrated in pieces
+const double MAX_STEP_S = 0.1;
+// CAN input older than this is considered lost
+const uint64_t CAN_STALE_MS = 500;
+// Yaw-rate noise when heading is only held by GPS course (no gyro)
+const double NO_GYRO_YAW_SIGMA_DPS = 10.0;
+// Re-anchor the tangent plane before the flat-earth error grows
+const double REANCHOR_DISTANCE_M = 10000.0;
+// GpsData::utc_time_ms wraps at midnight
+const int32_t DAY_MS = 24 * 3600 * 1000;
+
+// True if UTC time of day a is after b, across midnight; unknown times pass
+bool isNewerFix(int32_t a, int32_t b) {
+    if (a < 0 || b < 0) {
+        return true;
+    }
+    const int32_t ahead = (a - b + DAY_MS) % DAY_MS;
+    return ahead > 0 && ahead < DAY_MS / 2;
+}
+
+double wrapAngle(double angle) {
+    angle = std::fmod(angle, TWO_PI);
+    if (angle < 0.0) {
+        angle += TWO_PI;
+    }
+    return angle;
+}
+
+// Difference a - b in (-pi, pi]
+double angleDifference(double a, double b) {
+    double d = std::fmod(a - b, TWO_PI);
+    if (d > M_PI) {
+        d -= TWO_PI;
+    } else if (d <= -M_PI) {
+        d += TWO_PI;
+    }
+    return d;
+}
+
+} // namespace
+
+PositionFilter::PositionFilter(const PositionFilterConfig& config) : config_(config) {
+    reset();
+}
+
+void PositionFilter::reset() {
+    initialized_ = false;
+    for (int i = 0; i < STATE_SIZE; ++i) {
+        x_[i] = 0.0;
+        for (int j = 0; j < STATE_SIZE; ++j) {
+            P_[i][j] = 0.0;
+        }
+    }
+    x_[SPEED_SCALE] = 1.0;
+
+    anchor_lat_ = 0.0;
+    anchor_lon_ = 0.0;
+    meters_per_deg_lat_ = EARTH_RADIUS_M * DEG_TO_RAD;
+    meters_per_deg_lon_ = meters_per_deg_lat_;
+    altitude_ = 0.0;
+
+    speed_mps_ = 0.0;
+    yaw_rate_rps_ = 0.0;
+    state_time_ms_ = 0;
+    last_can_ms_ = 0;
+    last_fix_ms_ = 0;
+    last_fix_utc_ms_ = -1;
+
+    predict_count_ = 0;
+    correct_count_ = 0;
+    stale_fix_count_ = 0;
+}
+
+void PositionFilter::initialize(const GpsData& gps) {
+    anchor_lat_ = gps.position.latitude;
+    anchor_lon_ = gps.position.longitude;
+    meters_per_deg_lat_ = EARTH_RADIUS_M * DEG_TO_RAD;
+    meters_per_deg_lon_ = meters_per_deg_lat_ * std::cos(anchor_lat_ * DEG_TO_RAD);
+    altitude_ = gps.position.altitude;
+
+    const double gps_speed = gps.speed_kmh / 3.6;
+    const bool has_course = gps_speed >= config_.min_course_speed_mps;
+    const double position_sigma = config_.gps_uere_m * gps.hdop;
+    const double course_sigma = config_.gps_course_sigma_deg * DEG_TO_RAD;
+
+    x_[EAST] = 0.0;
+    x_[NORTH] = 0.0;
+    x_[HEADING] = has_course ? wrapAngle(gps.course_degrees * DEG_TO_RAD) : 0.0;
+    x_[YAW_BIAS] = 0.0;
+    x_[SPEED_SCALE] = 1.0;
+
+    for (int i = 0; i < STATE_SIZE; ++i) {
+        for (int j = 0; j < STATE_SIZE; ++j) {
+            P_[i][j] = 0.0;
+        }
+    }
+    P_[EAST][EAST] = position_sigma * position_sigma;
+    P_[NORTH][NORTH] = position_sigma * position_sigma;
+    P_[HEADING][HEADING] = has_course ? course_sigma * course_sigma : M_PI * M_PI;
+    P_[YAW_BIAS][YAW_BIAS] = std::pow(0.5 * DEG_TO_RAD, 2);
+    P_[SPEED_SCALE][SPEED_SCALE] = 0.02 * 0.02;
+
+    state_time_ms_ = gps.timestamp_ms;
+    last_fix_ms_ = gps.timestamp_ms;
+    last_fix_utc_ms_ = gps.utc_time_ms;
+    initialized_ = true;
+}
+
+void PositionFilter::propagate(double dt) {
+    const bool have_can = last_can_ms_ != 0 && state_time_ms_ <= last_can_ms_ + CAN_STALE_MS;
+    const double v = speed_mps_;
+    const double scale = x_[SPEED_SCALE];
+    const double omega = have_can ? yaw_rate_rps_ - x_[YAW_BIAS] : 0.0;
+
+    // Unicycle model, integrated at the mid-step heading
+    const double mid = x_[HEADING] + 0.5 * omega * dt;
+    const double s = std::sin(mid);
+    const double c = std::cos(mid);
+    const double d = scale * v * dt;
+
+    x_[EAST] += d * s;
+    x_[NORTH] += d * c;
+    x_[HEADING] = wrapAngle(x_[HEADING] + omega * dt);
+
+    // Jacobian F = I + dF (only the non-zero off-diagonal terms)
+    double F[STATE_SIZE][STATE_SIZE] = {};
+    for (int i = 0; i < STATE_SIZE; ++i) {
+        F[i][i] = 1.0;
+    }
+    F[EAST][HEADING] = d * c;
+    F[EAST][YAW_BIAS] = -0.5 * dt * d * c;
+    F[EAST][SPEED_SCALE] = v * dt * s;
+    F[NORTH][HEADING] = -d * s;
+    F[NORTH][YAW_BIAS] = 0.5 * dt * d * s;
+    F[NORTH][SPEED_SCALE] = v * dt * c;
+    F[HEADING][YAW_BIAS] = have_can ? -dt : 0.0;
+
+    // P = F P F^T
+    double FP[STATE_SIZE][STATE_SIZE];
+    for (int i = 0; i < STATE_SIZE; ++i) {
+        for (int j = 0; j < STATE_SIZE; ++j) {
+            double sum = 0.0;
+            for (int k = 0; k < STATE_SIZE; ++k) {
+                sum += F[i][k] * P_[k][j];
+            }
+            FP[i][j] = sum;
+        }
+    }
+    for (int i = 0; i < STATE_SIZE; ++i) {
+        for (int j = i; j < STATE_SIZE; ++j) {
+            double sum = 0.0;
+            for (int k = 0; k < STATE_SIZE; ++k) {
+                sum += FP[i][k] * F[j][k];
+            }
+            P_[i][j] = sum;
+            P_[j][i] = sum;
+        }
+    }
+
+    // Q: input noise mapped through the model, plus random walks
+    const double speed_var = config_.speed_sigma_mps * config_.speed_sigma_mps;
+    const double yaw_sigma = (have_can ? config_.yaw_rate_sigma_dps : NO_GYRO_YAW_SIGMA_DPS) * DEG_TO_RAD;
+    const double ge = scale * dt * s;
+    const double gn = scale * dt * c;
+    P_[EAST][EAST] += ge * ge * speed_var;
+    P_[EAST][NORTH] += ge * gn * speed_var;
+    P_[NORTH][EAST] += ge * gn * speed_var;
+    P_[NORTH][NORTH] += gn * gn * speed_var;
+    P_[HEADING][HEADING] += yaw_sigma * yaw_sigma * dt * dt;
+    P_[YAW_BIAS][YAW_BIAS] += std::pow(config_.yaw_bias_walk_dps * DEG_TO_RAD, 2) * dt;
+    P_[SPEED_SCALE][SPEED_SCALE] += config_.speed_scale_walk * config_.speed_scale_walk * dt;
+}
+
+void PositionFilter::update(const double (&h)[STATE_SIZE], double residual, double variance) {
+    double Ph[STATE_SIZE];
+    double innovation_var = variance;
+    for (int i = 0; i < STATE_SIZE; ++i) {
+        double sum = 0.0;
+        for (int j = 0; j < STATE_SIZE; ++j) {
+            sum += P_[i][j] * h[j];
+        }
+        Ph[i] = sum;
+        innovation_var += h[i] * sum;
+    }
+    if (innovation_var <= 0.0) {
+        return;
+    }
+
+    double K[STATE_SIZE];
+    for (int i = 0; i < STATE_SIZE; ++i) {
+        K[i] = Ph[i] / innovation_var;
+        x_[i] += K[i] * residual;
+    }
+    x_[HEADING] = wrapAngle(x_[HEADING]);
+
+    // P = P - K (P h)^T, kept symmetric
+    for (int i = 0; i < STATE_SIZE; ++i) {
+        for (int j = i; j < STATE_SIZE; ++j) {
+            const double value = P_[i][j] - 0.5 * (K[i] * Ph[j] + K[j] * Ph[i]);
+            P_[i][j] = value;
+            P_[j][i] = value;
+        }
+    }
+}
+
+void PositionFilter::predict(const VehicleData& vehicle) {
+    ++predict_count_;
+
+    if (initialized_ && vehicle.timestamp_ms > state_time_ms_) {
+        // Zero-order hold: the previous sample's inputs apply until this one
+        double remaining = (vehicle.timestamp_ms - state_time_ms_) / 1000.0;
+        while (remaining > 0.0) {
+            const double dt = remaining < MAX_STEP_S ? remaining : MAX_STEP_S;
+            propagate(dt);
+            remaining -= dt;
+        }
+        state_time_ms_ = vehicle.timestamp_ms;
+    }
+
+    speed_mps_ = vehicle.speed_kmh / 3.6;
+    yaw_rate_rps_ = vehicle.yaw_rate * DEG_TO_RAD;
+    last_can_ms_ = vehicle.timestamp_ms;
+}
+
+void PositionFilter::correct(const GpsData& gps) {
+    if (!gps.valid) {
+        return;
+    }
+    // The same epoch twice would count one measurement double
+    if (initialized_ && !isNewerFix(gps.utc_time_ms, last_fix_utc_ms_)) {
+        ++stale_fix_count_;
+        return;
+    }
+    ++correct_count_;
+
+    if (!initialized_) {
+        initialize(gps);
+        if (last_can_ms_ == 0) {
+            speed_mps_ = gps.speed_kmh / 3.6;
+        }
+        return;
+    }
+
+    const bool have_can = last_can_ms_ != 0 && gps.timestamp_ms <= last_can_ms_ + CAN_STALE_MS;
+    const double gps_speed = gps.speed_kmh / 3.6;
+
+    if (gps.timestamp_ms > state_time_ms_) {
+        double remaining = (gps.timestamp_ms - state_time_ms_) / 1000.0;
+        while (remaining > 0.0) {
+            const double dt = remaining < MAX_STEP_S ? remaining : MAX_STEP_S;
+            propagate(dt);
+            remaining -= dt;
+        }
+        state_time_ms_ = gps.timestamp_ms;
+    }
+    if (!have_can) {
+        speed_mps_ = gps_speed;
+    }
+
+    // Position, one axis at a time (diagonal R)
+    double east, north;
+    toLocal(gps.position, east, north);
+    const double position_var = std::pow(config_.gps_uere_m * gps.hdop, 2);
+    const double h_east[STATE_SIZE] = {1.0, 0.0, 0.0, 0.0, 0.0};
+    update(h_east, east - x_[EAST], position_var);
+    const double h_north[STATE_SIZE] = {0.0, 1.0, 0.0, 0.0, 0.0};
+    update(h_north, north - x_[NORTH], position_var);
+
+    // Course and wheel speed scale, only while moving
+    if (gps_speed >= config_.min_course_speed_mps) {
+        const double h_heading[STATE_SIZE] = {0.0, 0.0, 1.0, 0.0, 0.0};
+        const double course_sigma = config_.gps_course_sigma_deg * DEG_TO_RAD;
+        update(h_heading, angleDifference(gps.course_degrees * DEG_TO_RAD, x_[HEADING]), course_sigma * course_sigma);
+
+        if (have_can && speed_mps_ > 1.0) {
+            const double h_scale[STATE_SIZE] = {0.0, 0.0, 0.0, 0.0, speed_mps_};
+            update(h_scale, gps_speed - x_[SPEED_SCALE] * speed_mps_,
+                   config_.gps_speed_sigma_mps * config_.gps_speed_sigma_mps);
+        }
+    }
+
+    altitude_ = gps.position.altitude;
+    last_fix_ms_ = gps.timestamp_ms;
+    last_fix_utc_ms_ = gps.utc_time_ms;
+
+    if (std::fabs(x_[EAST]) > REANCHOR_DISTANCE_M || std::fabs(x_[NORTH]) > REANCHOR_DISTANCE_M) {
+        reanchor();
+    }
+}
+
+void PositionFilter::reanchor() {
+    // Pure translation of the plane; covariance is unchanged
+    const Point origin = toGeodetic(x_[EAST], x_[NORTH]);
+    anchor_lat_ = origin.latitude;
+    anchor_lon_ = origin.longitude;
+    meters_per_deg_lon_ = meters_per_deg_lat_ * std::cos(anchor_lat_ * DEG_TO_RAD);
+    x_[EAST] = 0.0;
+    x_[NORTH] = 0.0;
+}
+
+PositioningMode PositionFilter::mode(uint64_t time_ms) const {
+    if (initialized_ && time_ms <= last_fix_ms_ + config_.gps_timeout_ms) {
+        return PositioningMode::GPS;
+    }
+    return PositioningMode::DEAD_RECKONING;
+}
+
+FusedPosition PositionFilter::estimate(uint64_t time_ms) const {
+    FusedPosition out;
+    out.timestamp_ms = time_ms;
+    out.mode = mode(time_ms);
+    if (!initialized_) {
+        return out;
+    }
+
+    // Extrapolate the last state with the current inputs (at most 1 s)
+    double dt = time_ms > state_time_ms_ ? (time_ms - state_time_ms_) / 1000.0 : 0.0;
+    if (dt > 1.0) {
+        dt = 1.0;
+    }
+    const bool have_can = last_can_ms_ != 0 && state_time_ms_ <= last_can_ms_ + CAN_STALE_MS;
+    const double omega = have_can ? yaw_rate_rps_ - x_[YAW_BIAS] : 0.0;
+    const double speed = x_[SPEED_SCALE] * speed_mps_;
+    const double mid = x_[HEADING] + 0.5 * omega * dt;
+
+    const double east = x_[EAST] + speed * dt * std::sin(mid);
+    const double north = x_[NORTH] + speed * dt * std::cos(mid);
+
+    out.position = toGeodetic(east, north);
+    out.position.altitude = altitude_;
+    out.heading_degrees = wrapAngle(x_[HEADING] + omega * dt) / DEG_TO_RAD;
+    out.speed_kmh = speed * 3.6;
+    out.position_sigma_m = std::sqrt(P_[EAST][EAST] + P_[NORTH][NORTH]);
+    out.valid = time_ms <= last_fix_ms_ + config_.gps_timeout_ms + config_.dead_reckoning_timeout_ms;
+    return out;
+}
+
+void PositionFilter::toLocal(const Point& point, double& east, double& north) const {
+    east = (point.longitude - anchor_lon_) * meters_per_deg_lon_;
+    north = (point.latitude - anchor_lat_) * meters_per_deg_lat_;
+}
+
+Point PositionFilter::toGeodetic(double east, double north) const {
+    return Point(anchor_lat_ + north / meters_per_deg_lat_, anchor_lon_ + east / meters_per_deg_lon_);
+}
+
+} // namespace nav
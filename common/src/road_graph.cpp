@@ -0,0 +1,423 @@
+#include "road_graph.h"
+#include "map_file.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace nav {
+
+namespace {
+
+// Average number of nodes per grid cell
+const uint32_t GRID_NODES_PER_CELL = 8;
+
+// Position of (x, y) along a Hilbert curve over a 65536 x 65536 grid
+uint64_t hilbertIndex(uint32_t x, uint32_t y) {
+    uint64_t d = 0;
+    for (uint32_t s = 1u << 15; s > 0; s >>= 1) {
+        const uint32_t rx = (x & s) ? 1 : 0;
+        const uint32_t ry = (y & s) ? 1 : 0;
+        d += static_cast<uint64_t>(s) * s * ((3 * rx) ^ ry);
+        if (ry == 0) {
+            if (rx == 1) {
+                x = s - 1 - x;
+                y = s - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return d;
+}
+
+int32_t toE7(double degrees) {
+    return static_cast<int32_t>(std::lround(degrees * RoadGraph::COORD_SCALE));
+}
+
+} // namespace
+
+RoadGraph::RoadGraph() : max_speed_kmh_(DEFAULT_SPEED_KMH) {
+}
+
+void RoadGraph::clear() {
+    first_out_ = ArrayView<uint32_t>();
+    head_ = ArrayView<uint32_t>();
+    length_m_ = ArrayView<uint32_t>();
+    speed_kmh_ = ArrayView<uint8_t>();
+    flags_ = ArrayView<uint8_t>();
+    node_ids_ = ArrayView<uint32_t>();
+    lat_e7_ = ArrayView<int32_t>();
+    lon_e7_ = ArrayView<int32_t>();
+    id_index_ = ArrayView<IdIndexEntry>();
+    cell_first_ = ArrayView<uint32_t>();
+    cell_nodes_ = ArrayView<uint32_t>();
+    grid_ = GridInfo();
+    max_speed_kmh_ = DEFAULT_SPEED_KMH;
+    storage_.reset();
+    file_.reset();
+}
+
+void RoadGraph::bindStorage() {
+    const Storage& s = *storage_;
+    first_out_ = s.first_out;
+    head_ = s.head;
+    length_m_ = s.length_m;
+    speed_kmh_ = s.speed_kmh;
+    flags_ = s.flags;
+    node_ids_ = s.node_ids;
+    lat_e7_ = s.lat_e7;
+    lon_e7_ = s.lon_e7;
+    id_index_ = s.id_index;
+    cell_first_ = s.cell_first;
+    cell_nodes_ = s.cell_nodes;
+}
+
+bool RoadGraph::build(const std::vector<MapNode>& nodes, const std::vector<MapEdge>& edges) {
+    clear();
+    if (nodes.empty()) {
+        return false;
+    }
+    storage_.reset(new Storage());
+    Storage& s = *storage_;
+
+    // Drop duplicate ids (keep first occurrence)
+    std::vector<uint32_t> input_order(nodes.size());
+    std::iota(input_order.begin(), input_order.end(), 0);
+    std::stable_sort(input_order.begin(), input_order.end(), [&nodes](uint32_t a, uint32_t b) {
+        return nodes[a].id < nodes[b].id;
+    });
+    input_order.erase(std::unique(input_order.begin(), input_order.end(), [&nodes](uint32_t a, uint32_t b) {
+        return nodes[a].id == nodes[b].id;
+    }), input_order.end());
+
+    // Renumber along a Hilbert curve over the bounding box
+    double min_lat = nodes[input_order[0]].position.latitude, max_lat = min_lat;
+    double min_lon = nodes[input_order[0]].position.longitude, max_lon = min_lon;
+    for (uint32_t i : input_order) {
+        const Point& p = nodes[i].position;
+        min_lat = std::min(min_lat, p.latitude);
+        max_lat = std::max(max_lat, p.latitude);
+        min_lon = std::min(min_lon, p.longitude);
+        max_lon = std::max(max_lon, p.longitude);
+    }
+    const double lat_span = std::max(max_lat - min_lat, 1e-9);
+    const double lon_span = std::max(max_lon - min_lon, 1e-9);
+
+    std::vector<std::pair<uint64_t, uint32_t>> order;
+    order.reserve(input_order.size());
+    for (uint32_t i : input_order) {
+        const Point& p = nodes[i].position;
+        const uint32_t x = static_cast<uint32_t>((p.longitude - min_lon) / lon_span * 65535.0);
+        const uint32_t y = static_cast<uint32_t>((p.latitude - min_lat) / lat_span * 65535.0);
+        order.emplace_back(hilbertIndex(x, y), i);
+    }
+    std::sort(order.begin(), order.end());
+
+    const uint32_t n = static_cast<uint32_t>(order.size());
+    s.node_ids.resize(n);
+    s.lat_e7.resize(n);
+    s.lon_e7.resize(n);
+    s.id_index.resize(n);
+    for (uint32_t v = 0; v < n; ++v) {
+        const MapNode& node = nodes[order[v].second];
+        s.node_ids[v] = node.id;
+        s.lat_e7[v] = toE7(node.position.latitude);
+        s.lon_e7[v] = toE7(node.position.longitude);
+        s.id_index[v] = IdIndexEntry{node.id, v};
+    }
+    std::sort(s.id_index.begin(), s.id_index.end(), [](const IdIndexEntry& a, const IdIndexEntry& b) {
+        return a.map_node_id < b.map_node_id;
+    });
+    id_index_ = s.id_index;
+
+    // Collect arcs as (tail, head, edge index), then counting-sort by tail
+    struct PendingArc {
+        uint32_t tail;
+        uint32_t head;
+        uint32_t edge;
+    };
+    std::vector<PendingArc> pending;
+    pending.reserve(edges.size() * 2);
+    for (uint32_t e = 0; e < edges.size(); ++e) {
+        const uint32_t from = findNode(edges[e].from_node);
+        const uint32_t to = findNode(edges[e].to_node);
+        if (from == INVALID_NODE || to == INVALID_NODE) {
+            continue;
+        }
+        pending.push_back(PendingArc{from, to, e});
+        if (!(edges[e].flags & EDGE_FLAG_ONE_WAY)) {
+            pending.push_back(PendingArc{to, from, e});
+        }
+    }
+
+    // Within a node, order arcs by head so scans walk memory forward
+    std::sort(pending.begin(), pending.end(), [](const PendingArc& a, const PendingArc& b) {
+        return a.tail != b.tail ? a.tail < b.tail : a.head < b.head;
+    });
+
+    const size_t m = pending.size();
+    s.first_out.assign(n + 1, 0);
+    s.head.resize(m);
+    s.length_m.resize(m);
+    s.speed_kmh.resize(m);
+    s.flags.resize(m);
+
+    uint8_t max_speed = 0;
+    for (size_t a = 0; a < m; ++a) {
+        const MapEdge& edge = edges[pending[a].edge];
+        ++s.first_out[pending[a].tail + 1];
+        s.head[a] = pending[a].head;
+        // Round up so integer lengths never undercut straight-line bounds
+        s.length_m[a] = std::max<uint32_t>(1, static_cast<uint32_t>(std::ceil(edge.length_meters)));
+        s.speed_kmh[a] = edge.speed_limit > 0 ? edge.speed_limit : DEFAULT_SPEED_KMH;
+        s.flags[a] = static_cast<uint8_t>(edge.flags & 0xFF);
+        max_speed = std::max(max_speed, s.speed_kmh[a]);
+    }
+    for (uint32_t v = 0; v < n; ++v) {
+        s.first_out[v + 1] += s.first_out[v];
+    }
+    if (max_speed > 0) {
+        max_speed_kmh_ = max_speed;
+    }
+
+    bindStorage();
+    buildGrid();
+    return true;
+}
+
+void RoadGraph::buildGrid() {
+    Storage& s = *storage_;
+    const uint32_t n = nodeCount();
+
+    int32_t min_lat = lat_e7_[0], max_lat = min_lat;
+    int32_t min_lon = lon_e7_[0], max_lon = min_lon;
+    for (uint32_t v = 1; v < n; ++v) {
+        min_lat = std::min(min_lat, lat_e7_[v]);
+        max_lat = std::max(max_lat, lat_e7_[v]);
+        min_lon = std::min(min_lon, lon_e7_[v]);
+        max_lon = std::max(max_lon, lon_e7_[v]);
+    }
+
+    // Pick rows/cols so cells are roughly square on the ground
+    const double lat_span = std::max<double>(1.0, static_cast<double>(max_lat) - min_lat);
+    const double lon_span = std::max<double>(1.0, static_cast<double>(max_lon) - min_lon);
+    const double cos_lat = std::cos((static_cast<double>(min_lat) + max_lat) * 0.5 / COORD_SCALE * M_PI / 180.0);
+    const uint32_t cells = std::max<uint32_t>(1, n / GRID_NODES_PER_CELL);
+    const double aspect = std::max(lon_span * cos_lat, 1.0) / lat_span;
+    const uint32_t cols = std::min<uint32_t>(cells, std::max<uint32_t>(1,
+        static_cast<uint32_t>(std::lround(std::sqrt(cells * aspect)))));
+    const uint32_t rows = std::max<uint32_t>(1, (cells + cols - 1) / cols);
+
+    grid_.min_lat_e7 = min_lat;
+    grid_.min_lon_e7 = min_lon;
+    grid_.cell_lat_e7 = static_cast<int32_t>(lat_span / rows) + 1;
+    grid_.cell_lon_e7 = static_cast<int32_t>(lon_span / cols) + 1;
+    grid_.rows = rows;
+    grid_.cols = cols;
+
+    // Counting sort of nodes by cell; Hilbert order is kept within a cell
+    std::vector<uint32_t> cell_of(n);
+    s.cell_first.assign(static_cast<size_t>(rows) * cols + 1, 0);
+    for (uint32_t v = 0; v < n; ++v) {
+        cell_of[v] = cellRow(lat_e7_[v]) * cols + cellCol(lon_e7_[v]);
+        ++s.cell_first[cell_of[v] + 1];
+    }
+    for (size_t c = 1; c < s.cell_first.size(); ++c) {
+        s.cell_first[c] += s.cell_first[c - 1];
+    }
+    s.cell_nodes.resize(n);
+    std::vector<uint32_t> fill(s.cell_first.begin(), s.cell_first.end() - 1);
+    for (uint32_t v = 0; v < n; ++v) {
+        s.cell_nodes[fill[cell_of[v]]++] = v;
+    }
+
+    cell_first_ = s.cell_first;
+    cell_nodes_ = s.cell_nodes;
+}
+
+bool RoadGraph::attach(std::shared_ptr<const MapFile> file) {
+    clear();
+    if (!file || !file->isOpen()) {
+        return false;
+    }
+
+    const MapFileHeader& header = file->header();
+    const size_t n = header.node_count;
+    const size_t m = header.arc_count;
+    const GridInfo& grid = header.grid;
+
+    first_out_ = file->array<uint32_t>(MapSectionType::ARC_FIRST_OUT);
+    head_ = file->array<uint32_t>(MapSectionType::ARC_HEAD);
+    length_m_ = file->array<uint32_t>(MapSectionType::ARC_LENGTH);
+    speed_kmh_ = file->array<uint8_t>(MapSectionType::ARC_SPEED);
+    flags_ = file->array<uint8_t>(MapSectionType::ARC_FLAGS);
+    node_ids_ = file->array<uint32_t>(MapSectionType::NODE_IDS);
+    lat_e7_ = file->array<int32_t>(MapSectionType::NODE_LAT_E7);
+    lon_e7_ = file->array<int32_t>(MapSectionType::NODE_LON_E7);
+    id_index_ = file->array<IdIndexEntry>(MapSectionType::NODE_ID_INDEX);
+    cell_first_ = file->array<uint32_t>(MapSectionType::GRID_CELL_FIRST);
+    cell_nodes_ = file->array<uint32_t>(MapSectionType::GRID_CELL_NODES);
+
+    // Sizes must agree with each other; contents are trusted (CRC checked offline)
+    const bool consistent = n > 0 &&
+        first_out_.size() == n + 1 && first_out_[n] == m &&
+        head_.size() == m && length_m_.size() == m && speed_kmh_.size() == m && flags_.size() == m &&
+        node_ids_.size() == n && lat_e7_.size() == n && lon_e7_.size() == n && id_index_.size() == n &&
+        grid.rows > 0 && grid.cols > 0 && grid.cell_lat_e7 > 0 && grid.cell_lon_e7 > 0 &&
+        cell_first_.size() == static_cast<size_t>(grid.rows) * grid.cols + 1 &&
+        cell_nodes_.size() == n;
+    if (!consistent) {
+        clear();
+        return false;
+    }
+
+    grid_ = grid;
+    max_speed_kmh_ = header.max_speed_kmh > 0 ? header.max_speed_kmh : DEFAULT_SPEED_KMH;
+    file_ = std::move(file);
+    return true;
+}
+
+uint32_t RoadGraph::cellRow(int32_t lat_e7) const {
+    const int64_t r = (static_cast<int64_t>(lat_e7) - grid_.min_lat_e7) / grid_.cell_lat_e7;
+    return static_cast<uint32_t>(std::min<int64_t>(std::max<int64_t>(r, 0), grid_.rows - 1));
+}
+
+uint32_t RoadGraph::cellCol(int32_t lon_e7) const {
+    const int64_t c = (static_cast<int64_t>(lon_e7) - grid_.min_lon_e7) / grid_.cell_lon_e7;
+    return static_cast<uint32_t>(std::min<int64_t>(std::max<int64_t>(c, 0), grid_.cols - 1));
+}
+
+uint32_t RoadGraph::findArc(uint32_t from, uint32_t to) const {
+    uint32_t best = INVALID_NODE;
+    for (uint32_t a = first_out_[from]; a < first_out_[from + 1]; ++a) {
+        if (head_[a] == to && (best == INVALID_NODE || length_m_[a] < length_m_[best])) {
+            best = a;
+        }
+    }
+    return best;
+}
+
+void RoadGraph::measurePath(const std::vector<uint32_t>& path, double& length_m, double& time_s) const {
+    length_m = 0.0;
+    time_s = 0.0;
+    for (size_t i = 1; i < path.size(); ++i) {
+        const uint32_t arc = findArc(path[i - 1], path[i]);
+        if (arc != INVALID_NODE) {
+            length_m += length_m_[arc];
+            time_s += arcTravelTimeMs(arc) / 1000.0;
+        }
+    }
+}
+
+void RoadGraph::fillRoute(const std::vector<uint32_t>& path, Route& route) const {
+    measurePath(path, route.total_distance_meters, route.estimated_time_seconds);
+
+    // Route has a fixed node budget; keep both endpoints and sample evenly
+    // in between when the path is longer
+    const size_t count = std::min(path.size(), static_cast<size_t>(Route::MAX_NODES));
+    for (size_t i = 0; i < count; ++i) {
+        const size_t src = (count == path.size() || count < 2)
+            ? i
+            : i * (path.size() - 1) / (count - 1);
+        route.nodes[i] = node_ids_[path[src]];
+    }
+    route.node_count = static_cast<int>(count);
+}
+
+uint32_t RoadGraph::findNode(uint32_t map_node_id) const {
+    auto it = std::lower_bound(id_index_.begin(), id_index_.end(), map_node_id,
+                               [](const IdIndexEntry& e, uint32_t id) { return e.map_node_id < id; });
+    if (it == id_index_.end() || it->map_node_id != map_node_id) {
+        return INVALID_NODE;
+    }
+    return it->node;
+}
+
+uint32_t RoadGraph::findNearestNode(const Point& point) const {
+    if (node_ids_.empty()) {
+        return INVALID_NODE;
+    }
+
+    // Equirectangular distance in E7 units; no trig per candidate
+    const double lat = point.latitude * COORD_SCALE;
+    const double lon = point.longitude * COORD_SCALE;
+    const double cos_lat = std::cos(point.latitude * M_PI / 180.0);
+    const double min_cell = std::min<double>(grid_.cell_lat_e7, grid_.cell_lon_e7 * cos_lat);
+
+    const int64_t row = cellRow(toE7(point.latitude));
+    const int64_t col = cellCol(toE7(point.longitude));
+    const int64_t max_ring = std::max<int64_t>(std::max(row, grid_.rows - 1 - row),
+                                               std::max(col, grid_.cols - 1 - col));
+
+    uint32_t best = INVALID_NODE;
+    double best_d2 = 0.0;
+    for (int64_t k = 0; k <= max_ring; ++k) {
+        // Visit the cells on the border of the (2k+1) x (2k+1) square
+        for (int64_t r = row - k; r <= row + k; ++r) {
+            if (r < 0 || r >= grid_.rows) {
+                continue;
+            }
+            const bool edge_row = (r == row - k || r == row + k);
+            for (int64_t c = col - k; c <= col + k; c += edge_row ? 1 : 2 * k) {
+                if (c >= 0 && c < grid_.cols) {
+                    const size_t cell = static_cast<size_t>(r) * grid_.cols + c;
+                    for (uint32_t i = cell_first_[cell]; i < cell_first_[cell + 1]; ++i) {
+                        const uint32_t v = cell_nodes_[i];
+                        const double dx = (lon_e7_[v] - lon) * cos_lat;
+                        const double dy = lat_e7_[v] - lat;
+                        const double d2 = dx * dx + dy * dy;
+                        if (best == INVALID_NODE || d2 < best_d2) {
+                            best = v;
+                            best_d2 = d2;
+                        }
+                    }
+                }
+            }
+        }
+
+        // Cells outside ring k are at least k cell widths away
+        const double bound = k * min_cell;
+        if (best != INVALID_NODE && best_d2 <= bound * bound) {
+            break;
+        }
+    }
+    return best;
+}
+
+void RoadGraph::findNodesInBox(const BoundingBox& box, std::vector<uint32_t>& nodes) const {
+    nodes.clear();
+    if (node_ids_.empty()) {
+        return;
+    }
+
+    const int32_t min_lat = toE7(box.minLat);
+    const int32_t max_lat = toE7(box.maxLat);
+    const int32_t min_lon = toE7(box.minLon);
+    const int32_t max_lon = toE7(box.maxLon);
+
+    const uint32_t r0 = cellRow(min_lat), r1 = cellRow(max_lat);
+    const uint32_t c0 = cellCol(min_lon), c1 = cellCol(max_lon);
+    for (uint32_t r = r0; r <= r1; ++r) {
+        for (uint32_t c = c0; c <= c1; ++c) {
+            const size_t cell = static_cast<size_t>(r) * grid_.cols + c;
+            for (uint32_t i = cell_first_[cell]; i < cell_first_[cell + 1]; ++i) {
+                const uint32_t v = cell_nodes_[i];
+                if (lat_e7_[v] >= min_lat && lat_e7_[v] <= max_lat &&
+                    lon_e7_[v] >= min_lon && lon_e7_[v] <= max_lon) {
+                    nodes.push_back(v);
+                }
+            }
+        }
+    }
+}
+
+size_t RoadGraph::memoryBytes() const {
+    if (!storage_) {
+        return 0;
+    }
+    return first_out_.byteSize() + head_.byteSize() + length_m_.byteSize() +
+           speed_kmh_.byteSize() + flags_.byteSize() +
+           node_ids_.byteSize() + lat_e7_.byteSize() + lon_e7_.byteSize() +
+           id_index_.byteSize() + cell_first_.byteSize() + cell_nodes_.byteSize();
+}
+
+} // namespace nav
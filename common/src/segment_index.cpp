@@ -0,0 +1,212 @@
+#include "segment_index.h"
+#include "road_graph.h"
+#include <algorithm>
+#include <cmath>
+
+namespace nav {
+
+namespace {
+
+const double EARTH_RADIUS_M = 6371000.0;
+const double DEG_TO_RAD = M_PI / 180.0;
+
+// Keep the grid from growing past a few cells per segment on sparse maps
+const size_t MAX_CELLS_PER_SEGMENT = 4;
+
+} // namespace
+
+SegmentIndex::SegmentIndex()
+    : origin_lat_(0.0), origin_lon_(0.0), meters_per_deg_lat_(EARTH_RADIUS_M * DEG_TO_RAD),
+      meters_per_deg_lon_(EARTH_RADIUS_M * DEG_TO_RAD), cell_m_(DEFAULT_CELL_METERS), rows_(0), cols_(0) {
+}
+
+void SegmentIndex::clear() {
+    segments_.clear();
+    cell_first_.clear();
+    cell_segments_.clear();
+    rows_ = 0;
+    cols_ = 0;
+}
+
+bool SegmentIndex::build(const RoadGraph& graph, double cell_meters) {
+    clear();
+    if (graph.empty() || cell_meters <= 0.0) {
+        return false;
+    }
+
+    // Local plane anchored at the south-west corner of the graph
+    double min_lat = graph.latitude(0), max_lat = min_lat;
+    double min_lon = graph.longitude(0), max_lon = min_lon;
+    for (uint32_t v = 1; v < graph.nodeCount(); ++v) {
+        min_lat = std::min(min_lat, graph.latitude(v));
+        max_lat = std::max(max_lat, graph.latitude(v));
+        min_lon = std::min(min_lon, graph.longitude(v));
+        max_lon = std::max(max_lon, graph.longitude(v));
+    }
+    origin_lat_ = min_lat;
+    origin_lon_ = min_lon;
+    meters_per_deg_lat_ = EARTH_RADIUS_M * DEG_TO_RAD;
+    meters_per_deg_lon_ = meters_per_deg_lat_ * std::cos(0.5 * (min_lat + max_lat) * DEG_TO_RAD);
+
+    // One segment per street: two-way streets from their lower node only
+    segments_.reserve(graph.arcCount() / 2 + 1);
+    for (uint32_t u = 0; u < graph.nodeCount(); ++u) {
+        for (uint32_t a = graph.firstArc(u); a < graph.endArc(u); ++a) {
+            const uint32_t v = graph.arcHead(a);
+            if (v == u) {
+                continue;
+            }
+            const bool two_way = graph.findArc(v, u) != RoadGraph::INVALID_NODE;
+            if (two_way && v < u) {
+                continue;
+            }
+            if (two_way && graph.findArc(u, v) != a) {
+                continue;   // Parallel arcs: keep one
+            }
+            double x1, y1, x2, y2;
+            toLocal(graph.position(u), x1, y1);
+            toLocal(graph.position(v), x2, y2);
+
+            Segment s;
+            s.x1 = static_cast<float>(x1);
+            s.y1 = static_cast<float>(y1);
+            s.x2 = static_cast<float>(x2);
+            s.y2 = static_cast<float>(y2);
+            s.length_m = static_cast<float>(std::hypot(x2 - x1, y2 - y1));
+            s.from = u;
+            s.to = v;
+            s.one_way = two_way ? 0 : 1;
+            segments_.push_back(s);
+        }
+    }
+    if (segments_.empty()) {
+        return false;
+    }
+
+    double width, height;
+    toLocal(Point(max_lat, max_lon), width, height);
+    cell_m_ = cell_meters;
+    for (;;) {
+        cols_ = static_cast<int>(width / cell_m_) + 1;
+        rows_ = static_cast<int>(height / cell_m_) + 1;
+        if (static_cast<size_t>(rows_) * cols_ <= segments_.size() * MAX_CELLS_PER_SEGMENT) {
+            break;
+        }
+        cell_m_ *= 2.0;
+    }
+
+    // Count, prefix-sum, fill (CSR)
+    const size_t cell_count = static_cast<size_t>(rows_) * cols_;
+    cell_first_.assign(cell_count + 1, 0);
+    for (const Segment& s : segments_) {
+        const int c0 = cellCol(std::min(s.x1, s.x2)), c1 = cellCol(std::max(s.x1, s.x2));
+        const int r0 = cellRow(std::min(s.y1, s.y2)), r1 = cellRow(std::max(s.y1, s.y2));
+        for (int r = r0; r <= r1; ++r) {
+            for (int c = c0; c <= c1; ++c) {
+                ++cell_first_[static_cast<size_t>(r) * cols_ + c + 1];
+            }
+        }
+    }
+    for (size_t c = 0; c < cell_count; ++c) {
+        cell_first_[c + 1] += cell_first_[c];
+    }
+    cell_segments_.resize(cell_first_[cell_count]);
+    std::vector<uint32_t> fill(cell_first_.begin(), cell_first_.end() - 1);
+    for (uint32_t i = 0; i < segments_.size(); ++i) {
+        const Segment& s = segments_[i];
+        const int c0 = cellCol(std::min(s.x1, s.x2)), c1 = cellCol(std::max(s.x1, s.x2));
+        const int r0 = cellRow(std::min(s.y1, s.y2)), r1 = cellRow(std::max(s.y1, s.y2));
+        for (int r = r0; r <= r1; ++r) {
+            for (int c = c0; c <= c1; ++c) {
+                cell_segments_[fill[static_cast<size_t>(r) * cols_ + c]++] = i;
+            }
+        }
+    }
+    return true;
+}
+
+int SegmentIndex::findSegments(const Point& point, double radius_m, SegmentCandidate* out, int max_candidates) const {
+    if (segments_.empty() || max_candidates <= 0) {
+        return 0;
+    }
+
+    double px, py;
+    toLocal(point, px, py);
+    const int qc0 = cellCol(px - radius_m), qc1 = cellCol(px + radius_m);
+    const int qr0 = cellRow(py - radius_m), qr1 = cellRow(py + radius_m);
+
+    int count = 0;
+    const double radius2 = radius_m * radius_m;
+    for (int r = qr0; r <= qr1; ++r) {
+        for (int c = qc0; c <= qc1; ++c) {
+            const size_t cell = static_cast<size_t>(r) * cols_ + c;
+            for (uint32_t i = cell_first_[cell]; i < cell_first_[cell + 1]; ++i) {
+                const uint32_t id = cell_segments_[i];
+                const Segment& s = segments_[id];
+
+                // Report each segment from one cell only
+                if (std::max(cellRow(std::min(s.y1, s.y2)), qr0) != r ||
+                    std::max(cellCol(std::min(s.x1, s.x2)), qc0) != c) {
+                    continue;
+                }
+
+                const double dx = s.x2 - s.x1;
+                const double dy = s.y2 - s.y1;
+                const double len2 = dx * dx + dy * dy;
+                double t = len2 > 0.0 ? ((px - s.x1) * dx + (py - s.y1) * dy) / len2 : 0.0;
+                t = std::min(1.0, std::max(0.0, t));
+                const double qx = s.x1 + t * dx;
+                const double qy = s.y1 + t * dy;
+                const double d2 = (px - qx) * (px - qx) + (py - qy) * (py - qy);
+                if (d2 > radius2 || (count == max_candidates && d2 >= out[count - 1].distance_m * out[count - 1].distance_m)) {
+                    continue;
+                }
+
+                // Insertion into the sorted, bounded output
+                int pos = count < max_candidates ? count++ : count - 1;
+                const double distance = std::sqrt(d2);
+                while (pos > 0 && out[pos - 1].distance_m > distance) {
+                    out[pos] = out[pos - 1];
+                    --pos;
+                }
+                SegmentCandidate& candidate = out[pos];
+                candidate.segment = id;
+                candidate.position = toGeodetic(qx, qy);
+                candidate.distance_m = distance;
+                candidate.offset_m = t * s.length_m;
+                candidate.bearing_deg = std::fmod(std::atan2(dx, dy) / DEG_TO_RAD + 360.0, 360.0);
+            }
+        }
+    }
+    return count;
+}
+
+bool SegmentIndex::findNearest(const Point& point, double radius_m, SegmentCandidate& candidate) const {
+    return findSegments(point, radius_m, &candidate, 1) == 1;
+}
+
+size_t SegmentIndex::memoryBytes() const {
+    return segments_.capacity() * sizeof(Segment) +
+           (cell_first_.capacity() + cell_segments_.capacity()) * sizeof(uint32_t);
+}
+
+void SegmentIndex::toLocal(const Point& point, double& x, double& y) const {
+    x = (point.longitude - origin_lon_) * meters_per_deg_lon_;
+    y = (point.latitude - origin_lat_) * meters_per_deg_lat_;
+}
+
+Point SegmentIndex::toGeodetic(double x, double y) const {
+    return Point(origin_lat_ + y / meters_per_deg_lat_, origin_lon_ + x / meters_per_deg_lon_);
+}
+
+int SegmentIndex::cellCol(double x) const {
+    const int c = static_cast<int>(std::floor(x / cell_m_));
+    return std::min(cols_ - 1, std::max(0, c));
+}
+
+int SegmentIndex::cellRow(double y) const {
+    const int r = static_cast<int>(std::floor(y / cell_m_));
+    return std::min(rows_ - 1, std::max(0, r));
+}
+
+} // namespace nav
@@ -0,0 +1,90 @@
+#include "tile_key.h"
+#include <algorithm>
+#include <cmath>
+
+namespace nav {
+
+namespace {
+
+// Metres per degree of latitude
+const double METERS_PER_DEGREE = 6371000.0 * M_PI / 180.0;
+
+int clampZoom(int zoom) {
+    return std::min(std::max(zoom, 0), TileKey::MAX_ZOOM);
+}
+
+uint32_t clampTile(double t, int zoom) {
+    const double last = static_cast<double>(TileKey::tilesPerSide(zoom) - 1);
+    return static_cast<uint32_t>(std::min(std::max(std::floor(t), 0.0), last));
+}
+
+} // namespace
+
+void mercatorPixel(const Point& point, int zoom, double& px, double& py) {
+    const double world = static_cast<double>(TileKey::TILE_SIZE) * TileKey::tilesPerSide(clampZoom(zoom));
+    const double lat = std::min(std::max(point.latitude, -TileKey::MAX_LATITUDE), TileKey::MAX_LATITUDE);
+    const double sin_lat = std::sin(lat * M_PI / 180.0);
+    px = (point.longitude + 180.0) / 360.0 * world;
+    py = (0.5 - std::log((1.0 + sin_lat) / (1.0 - sin_lat)) / (4.0 * M_PI)) * world;
+}
+
+Point mercatorPoint(double px, double py, int zoom) {
+    const double world = static_cast<double>(TileKey::TILE_SIZE) * TileKey::tilesPerSide(clampZoom(zoom));
+    const double lon = px / world * 360.0 - 180.0;
+    const double lat = std::atan(std::sinh(M_PI * (1.0 - 2.0 * py / world))) * 180.0 / M_PI;
+    return Point(lat, lon);
+}
+
+TileKey TileKey::fromPoint(const Point& point, int zoom) {
+    zoom = clampZoom(zoom);
+    double px, py;
+    mercatorPixel(point, zoom, px, py);
+    return TileKey(zoom, clampTile(px / TILE_SIZE, zoom), clampTile(py / TILE_SIZE, zoom));
+}
+
+BoundingBox TileKey::bounds() const {
+    const Point north_west = mercatorPoint(static_cast<double>(x) * TILE_SIZE, static_cast<double>(y) * TILE_SIZE, z);
+    const Point south_east =
+        mercatorPoint(static_cast<double>(x + 1) * TILE_SIZE, static_cast<double>(y + 1) * TILE_SIZE, z);
+    return BoundingBox(south_east.latitude, north_west.longitude, north_west.latitude, south_east.longitude);
+}
+
+TileKey TileKey::ancestor(int zoom) const {
+    if (zoom >= z) {
+        return *this;
+    }
+    zoom = std::max(zoom, 0);
+    const int shift = z - zoom;
+    return TileKey(zoom, x >> shift, y >> shift);
+}
+
+TileRange TileRange::covering(const BoundingBox& box, int zoom) {
+    TileRange range;
+    const TileKey north_west = TileKey::fromPoint(Point(box.maxLat, box.minLon), zoom);
+    const TileKey south_east = TileKey::fromPoint(Point(box.minLat, box.maxLon), zoom);
+    range.z = north_west.z;
+    range.x0 = north_west.x;
+    range.y0 = north_west.y;
+    range.x1 = std::max(south_east.x, north_west.x);
+    range.y1 = std::max(south_east.y, north_west.y);
+    return range;
+}
+
+TileRange TileRange::around(const Point& center, double radius_m, int zoom) {
+    const double dlat = radius_m / METERS_PER_DEGREE;
+    const double dlon = radius_m / (METERS_PER_DEGREE * std::max(std::cos(center.latitude * M_PI / 180.0), 1e-6));
+    return covering(BoundingBox(center.latitude - dlat, std::max(center.longitude - dlon, -180.0),
+                                center.latitude + dlat, std::min(center.longitude + dlon, 180.0)),
+                    zoom);
+}
+
+void TileRange::keys(std::vector<TileKey>& out) const {
+    out.reserve(out.size() + count());
+    for (uint32_t ty = y0; ty <= y1; ++ty) {
+        for (uint32_t tx = x0; tx <= x1; ++tx) {
+            out.emplace_back(z, tx, ty);
+        }
+    }
+}
+
+} // namespace nav
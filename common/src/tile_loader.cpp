@@ -0,0 +1,163 @@
+#include "tile_loader.h"
+#include <algorithm>
+
+namespace nav {
+
+TileLoader::TileLoader() : stopping_(false), has_viewport_(false) {}
+
+TileLoader::~TileLoader() {
+    stop();
+}
+
+bool TileLoader::start(Source source, unsigned threads) {
+    if (!workers_.empty() || !source) {
+        return false;
+    }
+    if (threads == 0) {
+        threads = std::min(std::max(std::thread::hardware_concurrency(), 1u), MAX_THREADS);
+    }
+    source_ = std::move(source);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = false;
+    }
+    for (unsigned i = 0; i < threads; ++i) {
+        workers_.emplace_back(&TileLoader::run, this);
+    }
+    return true;
+}
+
+void TileLoader::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        queue_.clear();
+        active_.clear();
+        results_.clear();
+    }
+    wake_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+    workers_.clear();
+    // A worker may have finished a tile between the clear and its exit
+    std::lock_guard<std::mutex> lock(mutex_);
+    active_.clear();
+    results_.clear();
+}
+
+double TileLoader::priorityOf(const TileKey& key) const {
+    if (!has_viewport_) {
+        return 0.0;
+    }
+    // Distance from the focus to the tile centre, in tiles of its own zoom
+    double px, py;
+    mercatorPixel(focus_, key.z, px, py);
+    const double dx = px / TileKey::TILE_SIZE - (key.x + 0.5);
+    const double dy = py / TileKey::TILE_SIZE - (key.y + 0.5);
+    return dx * dx + dy * dy;
+}
+
+bool TileLoader::request(const TileKey& key) {
+    if (!key.valid()) {
+        return false;
+    }
+    const uint64_t packed = key.pack();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_ || !active_.insert(packed).second) {
+            stats_.duplicates.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        queue_.push_back(Pending{packed, priorityOf(key)});
+        std::push_heap(queue_.begin(), queue_.end(), laterPending);
+    }
+    stats_.requests.fetch_add(1, std::memory_order_relaxed);
+    wake_.notify_one();
+    return true;
+}
+
+void TileLoader::setViewport(const Point& focus, const BoundingBox& retain) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    focus_ = focus;
+    retain_ = retain;
+    has_viewport_ = true;
+
+    // One covering range per zoom present in the queue
+    TileRange ranges[TileKey::MAX_ZOOM + 1];
+    bool have_range[TileKey::MAX_ZOOM + 1] = {};
+    size_t kept = 0;
+    uint64_t dropped = 0;
+    for (const Pending& pending : queue_) {
+        const TileKey key = TileKey::unpack(pending.key);
+        if (!have_range[key.z]) {
+            ranges[key.z] = TileRange::covering(retain_, key.z);
+            have_range[key.z] = true;
+        }
+        if (!ranges[key.z].contains(key)) {
+            active_.erase(pending.key);
+            ++dropped;
+            continue;
+        }
+        queue_[kept].key = pending.key;
+        queue_[kept].priority = priorityOf(key);
+        ++kept;
+    }
+    queue_.resize(kept);
+    std::make_heap(queue_.begin(), queue_.end(), laterPending);
+    stats_.dropped.fetch_add(dropped, std::memory_order_relaxed);
+}
+
+size_t TileLoader::takeResults(std::vector<TileResult>& out) {
+    std::vector<TileResult> batch;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        batch.swap(results_);
+        for (const TileResult& result : batch) {
+            active_.erase(result.key.pack());
+        }
+    }
+    for (TileResult& result : batch) {
+        out.push_back(std::move(result));
+    }
+    return batch.size();
+}
+
+size_t TileLoader::pendingCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return active_.size();
+}
+
+void TileLoader::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        wake_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+        if (stopping_) {
+            return;
+        }
+        std::pop_heap(queue_.begin(), queue_.end(), laterPending);
+        const uint64_t packed = queue_.back().key;
+        queue_.pop_back();
+        lock.unlock();
+
+        TileResult result;
+        result.key = TileKey::unpack(packed);
+        result.ok = source_(result.key, result.data);
+        (result.ok ? stats_.loaded : stats_.failed).fetch_add(1, std::memory_order_relaxed);
+
+        lock.lock();
+        if (stopping_) {
+            return;
+        }
+        // Stays in active_ until taken, so a re-request meanwhile is a duplicate
+        const bool first = results_.empty();
+        results_.push_back(std::move(result));
+        if (first && notifier_) {
+            lock.unlock();
+            notifier_();
+            lock.lock();
+        }
+    }
+}
+
+} // namespace nav
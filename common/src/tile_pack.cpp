@@ -0,0 +1,402 @@
+#include "tile_pack.h"
+#include "map_file.h"
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace nav {
+
+namespace {
+
+// Address space mapped past the end of the file for tiles appended later,
+// at least this much and at least the file size again
+const size_t MAP_HEADROOM_BYTES = size_t(256) * 1024 * 1024;
+const uint32_t RECORD_CHECK_SEED = 0x7E11A5C3u;
+
+uint64_t align8(uint64_t value) {
+    return (value + 7) & ~uint64_t(7);
+}
+
+uint32_t headerCrc(const TilePackHeader& header) {
+    TilePackHeader copy = header;
+    copy.header_crc32 = 0;
+    return MapFile::crc32(&copy, sizeof(copy));
+}
+
+TilePackHeader makeHeader(uint64_t index_count, uint64_t log_offset) {
+    TilePackHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, TILE_PACK_MAGIC, sizeof(TILE_PACK_MAGIC));
+    header.version = TILE_PACK_VERSION;
+    header.header_size = sizeof(TilePackHeader);
+    header.index_count = index_count;
+    header.index_offset = sizeof(TilePackHeader);
+    header.log_offset = log_offset;
+    header.header_crc32 = headerCrc(header);
+    return header;
+}
+
+bool seekTo(std::FILE* file, uint64_t offset) {
+#ifdef _WIN32
+    return _fseeki64(file, static_cast<__int64>(offset), SEEK_SET) == 0;
+#else
+    return fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+}
+
+bool endOffset(std::FILE* file, uint64_t& size) {
+#ifdef _WIN32
+    if (_fseeki64(file, 0, SEEK_END) != 0) {
+        return false;
+    }
+    size = static_cast<uint64_t>(_ftelli64(file));
+#else
+    if (fseeko(file, 0, SEEK_END) != 0) {
+        return false;
+    }
+    size = static_cast<uint64_t>(ftello(file));
+#endif
+    return true;
+}
+
+bool truncateTo(std::FILE* file, uint64_t size) {
+    std::fflush(file);
+#ifdef _WIN32
+    return _chsize_s(_fileno(file), static_cast<__int64>(size)) == 0;
+#else
+    return ftruncate(fileno(file), static_cast<off_t>(size)) == 0;
+#endif
+}
+
+bool writeBytes(std::FILE* file, const void* data, size_t size) {
+    return size == 0 || std::fwrite(data, 1, size, file) == size;
+}
+
+bool writePadding(std::FILE* file, uint64_t size) {
+    static const char zeros[8] = {};
+    return writeBytes(file, zeros, static_cast<size_t>(align8(size) - size));
+}
+
+} // namespace
+
+TilePack::TilePack()
+    : file_(nullptr), read_only_(false), file_size_(0), append_offset_(0), stale_bytes_(0), data_(nullptr),
+      mapped_size_(0), log_added_(0) {
+}
+
+TilePack::~TilePack() {
+    close();
+}
+
+uint32_t TilePack::recordCheck(uint64_t key, uint32_t size) {
+    return (static_cast<uint32_t>(key) * 0x9E3779B1u) ^ static_cast<uint32_t>(key >> 32) ^ (size * 0x85EBCA6Bu) ^
+           RECORD_CHECK_SEED;
+}
+
+bool TilePack::open(const std::string& path, bool create) {
+    close();
+    error_.clear();
+
+    file_ = std::fopen(path.c_str(), "r+b");
+    if (!file_ && !create) {
+        // A pack installed read-only can still be served, just not appended to
+        file_ = std::fopen(path.c_str(), "rb");
+        read_only_ = file_ != nullptr;
+        if (!file_) {
+            error_ = "cannot open " + path;
+            return false;
+        }
+    }
+    if (!file_) {
+        file_ = std::fopen(path.c_str(), "w+b");
+        const TilePackHeader header = makeHeader(0, sizeof(TilePackHeader));
+        if (!file_ || !writeBytes(file_, &header, sizeof(header)) || std::fflush(file_) != 0) {
+            error_ = "cannot create " + path;
+            close();
+            return false;
+        }
+    }
+    path_ = path;
+
+    if (!mapFile() || !validateHeader()) {
+        const std::string error = error_;
+        close();
+        error_ = error;
+        return false;
+    }
+
+    const TilePackHeader& h = *reinterpret_cast<const TilePackHeader*>(data_);
+    index_ = ArrayView<TilePackIndexEntry>(reinterpret_cast<const TilePackIndexEntry*>(data_ + h.index_offset),
+                                           static_cast<size_t>(h.index_count));
+    scanLog();
+    return true;
+}
+
+bool TilePack::mapFile() {
+    if (!endOffset(file_, file_size_)) {
+        error_ = "cannot seek " + path_;
+        return false;
+    }
+    if (file_size_ < sizeof(TilePackHeader)) {
+        error_ = "file too small";
+        return false;
+    }
+
+#ifdef _WIN32
+    // No mmap: read the whole file once
+    fallback_.resize(static_cast<size_t>(file_size_));
+    if (!seekTo(file_, 0) || std::fread(fallback_.data(), 1, fallback_.size(), file_) != fallback_.size()) {
+        error_ = "cannot read " + path_;
+        return false;
+    }
+    data_ = fallback_.data();
+    mapped_size_ = fallback_.size();
+#else
+    // Pages past the end of the file become readable as appends extend it.
+    // Each remap at least doubles the length, so the retired mappings kept
+    // until close() never add up to more than the current one
+    const size_t file_size = static_cast<size_t>(file_size_);
+    const size_t length = file_size + std::max(MAP_HEADROOM_BYTES, std::max(file_size, mapped_size_));
+    void* mapped = mmap(nullptr, length, PROT_READ, MAP_SHARED, fileno(file_), 0);
+    if (mapped == MAP_FAILED) {
+        error_ = "mmap failed";
+        return false;
+    }
+    if (data_) {
+        retired_.emplace_back(const_cast<uint8_t*>(data_), mapped_size_);
+    }
+    data_ = static_cast<const uint8_t*>(mapped);
+    mapped_size_ = length;
+#endif
+    return true;
+}
+
+bool TilePack::validateHeader() {
+    const TilePackHeader& h = *reinterpret_cast<const TilePackHeader*>(data_);
+    if (std::memcmp(h.magic, TILE_PACK_MAGIC, sizeof(TILE_PACK_MAGIC)) != 0) {
+        error_ = "not a tile pack";
+        return false;
+    }
+    if (h.version != TILE_PACK_VERSION || h.header_size != sizeof(TilePackHeader)) {
+        error_ = "unsupported tile pack version";
+        return false;
+    }
+    if (h.header_crc32 != headerCrc(h)) {
+        error_ = "header checksum mismatch";
+        return false;
+    }
+    if (h.index_offset != sizeof(TilePackHeader) || h.index_count > file_size_ / sizeof(TilePackIndexEntry) ||
+        h.log_offset < h.index_offset + h.index_count * sizeof(TilePackIndexEntry) || h.log_offset % 8 != 0 ||
+        h.log_offset > file_size_) {
+        error_ = "invalid section table";
+        return false;
+    }
+    return true;
+}
+
+void TilePack::scanLog() {
+    const TilePackHeader& h = *reinterpret_cast<const TilePackHeader*>(data_);
+    uint64_t offset = h.log_offset;
+    while (offset + sizeof(TilePackRecord) <= file_size_) {
+        TilePackRecord record;
+        std::memcpy(&record, data_ + offset, sizeof(record));
+        const uint64_t data_offset = offset + sizeof(TilePackRecord);
+        if (record.check != recordCheck(record.key, record.size) || data_offset + record.size > file_size_) {
+            break;   // Torn append; the next one overwrites it
+        }
+        Location location;
+        if (lookup(record.key, location)) {
+            stale_bytes_ += location.size;
+        }
+        if (log_.find(record.key) == log_.end() && !contains(TileKey::unpack(record.key))) {
+            ++log_added_;
+        }
+        log_[record.key] = Location{data_offset, record.size};
+        offset = align8(data_offset + record.size);
+    }
+    append_offset_ = std::min(offset, file_size_);
+}
+
+void TilePack::close() {
+#ifndef _WIN32
+    if (data_) {
+        munmap(const_cast<uint8_t*>(data_), mapped_size_);
+    }
+    for (const auto& mapping : retired_) {
+        munmap(mapping.first, mapping.second);
+    }
+#endif
+    if (file_) {
+        std::fclose(file_);
+    }
+    file_ = nullptr;
+    read_only_ = false;
+    retired_.clear();
+    fallback_.clear();
+    data_ = nullptr;
+    mapped_size_ = 0;
+    file_size_ = 0;
+    append_offset_ = 0;
+    stale_bytes_ = 0;
+    index_ = ArrayView<TilePackIndexEntry>();
+    log_.clear();
+    log_added_ = 0;
+}
+
+bool TilePack::lookup(uint64_t key, Location& location) const {
+    auto it = log_.find(key);
+    if (it != log_.end()) {
+        location = it->second;
+        return true;
+    }
+    const TilePackIndexEntry* entry =
+        std::lower_bound(index_.begin(), index_.end(), key,
+                         [](const TilePackIndexEntry& e, uint64_t k) { return e.key < k; });
+    if (entry == index_.end() || entry->key != key) {
+        return false;
+    }
+    location = Location{entry->offset, entry->size};
+    return true;
+}
+
+bool TilePack::contains(const TileKey& key) const {
+    Location location;
+    return lookup(key.pack(), location);
+}
+
+bool TilePack::find(const TileKey& key, const uint8_t*& data, uint32_t& size) {
+    Location location;
+    if (!data_ || !lookup(key.pack(), location) || location.offset + location.size > file_size_) {
+        return false;
+    }
+    if (location.offset + location.size > mapped_size_) {
+#ifdef _WIN32
+        return false;   // Appended since open()
+#else
+        if (!mapFile()) {
+            return false;
+        }
+#endif
+    }
+    data = data_ + location.offset;
+    size = location.size;
+    return true;
+}
+
+bool TilePack::append(const TileKey& key, const void* data, uint32_t size) {
+    if (!file_) {
+        error_ = "tile pack not open";
+        return false;
+    }
+    if (read_only_) {
+        error_ = "tile pack is read-only: " + path_;
+        return false;
+    }
+    if (append_offset_ < file_size_ && !truncateTo(file_, append_offset_)) {
+        error_ = "cannot truncate " + path_;
+        return false;
+    }
+
+    TilePackRecord record;
+    record.key = key.pack();
+    record.size = size;
+    record.check = recordCheck(record.key, size);
+    if (!seekTo(file_, append_offset_) || !writeBytes(file_, &record, sizeof(record)) ||
+        !writeBytes(file_, data, size) || !writePadding(file_, sizeof(record) + size) || std::fflush(file_) != 0) {
+        error_ = "write failed: " + path_;
+        // Leave the torn record past append_offset_ for the next append to cut off
+        file_size_ = std::max(file_size_, append_offset_ + 1);
+        return false;
+    }
+
+    Location previous;
+    if (lookup(record.key, previous)) {
+        stale_bytes_ += previous.size;
+    } else {
+        ++log_added_;
+    }
+    log_[record.key] = Location{append_offset_ + sizeof(record), size};
+    append_offset_ = align8(append_offset_ + sizeof(record) + size);
+    file_size_ = append_offset_;
+    return true;
+}
+
+void TilePack::collect(std::vector<TilePackIndexEntry>& live) const {
+    live.reserve(index_.size() + log_.size());
+    for (const TilePackIndexEntry& entry : index_) {
+        if (log_.find(entry.key) == log_.end() && entry.offset + entry.size <= file_size_) {
+            live.push_back(entry);
+        }
+    }
+    for (const auto& pair : log_) {
+        TilePackIndexEntry entry;
+        entry.key = pair.first;
+        entry.offset = pair.second.offset;
+        entry.size = pair.second.size;
+        entry.reserved = 0;
+        live.push_back(entry);
+    }
+    std::sort(live.begin(), live.end(),
+              [](const TilePackIndexEntry& a, const TilePackIndexEntry& b) { return a.key < b.key; });
+}
+
+bool TilePack::compact(const std::string& src_path, const std::string& dst_path, std::string* error) {
+    auto fail = [error](const std::string& message) {
+        if (error) {
+            *error = message;
+        }
+        return false;
+    };
+
+    TilePack src;
+    if (!src.open(src_path, false)) {
+        return fail(src.lastError());
+    }
+    if (src.isReadOnly() && dst_path == src_path) {
+        return fail("tile pack is read-only: " + src_path);
+    }
+    std::vector<TilePackIndexEntry> live;
+    src.collect(live);
+
+    // Blobs follow the index in key order, so neighbouring tiles share pages
+    std::vector<TilePackIndexEntry> index(live);
+    uint64_t offset = sizeof(TilePackHeader) + index.size() * sizeof(TilePackIndexEntry);
+    for (TilePackIndexEntry& entry : index) {
+        entry.offset = offset;
+        offset = align8(offset + entry.size);
+    }
+    const TilePackHeader header = makeHeader(index.size(), offset);
+
+    const std::string tmp_path = dst_path + ".tmp";
+    std::FILE* out = std::fopen(tmp_path.c_str(), "wb");
+    if (!out) {
+        return fail("cannot create " + tmp_path);
+    }
+    bool ok = writeBytes(out, &header, sizeof(header)) &&
+              writeBytes(out, index.data(), index.size() * sizeof(TilePackIndexEntry));
+    for (size_t i = 0; ok && i < live.size(); ++i) {
+        ok = writeBytes(out, src.data_ + live[i].offset, live[i].size) && writePadding(out, live[i].size);
+    }
+    ok = std::fclose(out) == 0 && ok;
+    src.close();
+    if (!ok) {
+        std::remove(tmp_path.c_str());
+        return fail("write failed: " + tmp_path);
+    }
+#ifdef _WIN32
+    std::remove(dst_path.c_str());   // rename() does not replace an existing file here
+#endif
+    if (std::rename(tmp_path.c_str(), dst_path.c_str()) != 0) {
+        std::remove(tmp_path.c_str());
+        return fail("cannot rename to " + dst_path);
+    }
+    return true;
+}
+
+} // namespace nav
@@ -0,0 +1,221 @@
+#include "tile_prefetcher.h"
+#include "nav_utils.h"
+#include <algorithm>
+#include <cmath>
+
+namespace nav {
+
+namespace {
+
+// Metres per degree of latitude
+const double METERS_PER_DEGREE = 6371000.0 * M_PI / 180.0;
+const double EARTH_CIRCUMFERENCE_M = 2.0 * M_PI * 6371000.0;
+
+// Route segments searched past the last match before a full search
+const size_t SEARCH_AHEAD_SEGMENTS = 64;
+
+// Below this the heading is unreliable, so only the surroundings are fetched
+const double MIN_HEADING_SPEED_KMH = 5.0;
+
+struct Local {
+    double x;   // East, metres
+    double y;   // North, metres
+};
+
+// Equirectangular offset of p from origin; accurate over a few kilometres
+Local toLocal(const Point& origin, const Point& p) {
+    const double cos_lat = std::cos(origin.latitude * M_PI / 180.0);
+    return Local{(p.longitude - origin.longitude) * METERS_PER_DEGREE * cos_lat,
+                 (p.latitude - origin.latitude) * METERS_PER_DEGREE};
+}
+
+// Distance from the origin to segment ab, and the fraction along it of the closest point
+double distanceToSegment(const Local& a, const Local& b, double& t) {
+    const double dx = b.x - a.x;
+    const double dy = b.y - a.y;
+    const double length_sq = dx * dx + dy * dy;
+    t = length_sq > 0.0 ? std::min(std::max(-(a.x * dx + a.y * dy) / length_sq, 0.0), 1.0) : 0.0;
+    const double px = a.x + t * dx;
+    const double py = a.y + t * dy;
+    return std::sqrt(px * px + py * py);
+}
+
+Point interpolate(const Point& a, const Point& b, double t) {
+    return Point(a.latitude + (b.latitude - a.latitude) * t, a.longitude + (b.longitude - a.longitude) * t);
+}
+
+} // namespace
+
+TilePrefetcher::TilePrefetcher(const TilePrefetchSettings& settings)
+    : settings_(settings), route_segment_(0), view_width_m_(0.0), view_height_m_(0.0), tokens_(settings.burst),
+      last_update_ms_(0) {}
+
+void TilePrefetcher::setSettings(const TilePrefetchSettings& settings) {
+    settings_ = settings;
+    tokens_ = std::min(tokens_, settings_.burst);
+}
+
+void TilePrefetcher::setViewSize(double width_m, double height_m) {
+    view_width_m_ = std::max(width_m, 0.0);
+    view_height_m_ = std::max(height_m, 0.0);
+}
+
+void TilePrefetcher::setRoute(const std::vector<Point>& shape) {
+    if (shape.size() < 2) {
+        clearRoute();
+        return;
+    }
+    shape_ = shape;
+    shape_distance_m_.assign(shape_.size(), 0.0);
+    for (size_t i = 1; i < shape_.size(); ++i) {
+        shape_distance_m_[i] = shape_distance_m_[i - 1] + NavUtils::haversineDistance(shape_[i - 1], shape_[i]);
+    }
+    route_segment_ = 0;
+}
+
+void TilePrefetcher::clearRoute() {
+    shape_.clear();
+    shape_distance_m_.clear();
+    route_segment_ = 0;
+}
+
+void TilePrefetcher::reset() {
+    issued_.clear();
+    issued_order_.clear();
+}
+
+double TilePrefetcher::lookaheadMeters(double speed_kmh) const {
+    const double travel_m = std::max(speed_kmh, 0.0) / 3.6 * settings_.lookahead_s;
+    return std::min(std::max(travel_m, settings_.min_lookahead_m), settings_.max_lookahead_m);
+}
+
+bool TilePrefetcher::locateOnRoute(const Point& position, size_t& segment, double& along_m) {
+    const size_t segments = shape_.size() - 1;
+    auto search = [&](size_t first, size_t last, double& best) {
+        bool found = false;
+        for (size_t i = first; i < last; ++i) {
+            double t = 0.0;
+            const double d = distanceToSegment(toLocal(position, shape_[i]), toLocal(position, shape_[i + 1]), t);
+            if (d < best) {
+                best = d;
+                segment = i;
+                along_m = t * (shape_distance_m_[i + 1] - shape_distance_m_[i]);
+                found = true;
+            }
+        }
+        return found;
+    };
+
+    // Usually the vehicle is on or just past the last matched segment
+    double best = settings_.corridor_m;
+    const size_t first = route_segment_ > 0 ? route_segment_ - 1 : 0;
+    if (!search(first, std::min(route_segment_ + SEARCH_AHEAD_SEGMENTS, segments), best) &&
+        !search(0, segments, best)) {
+        return false;
+    }
+    route_segment_ = segment;
+    return true;
+}
+
+void TilePrefetcher::sampleRoute(size_t segment, double along_m, double lookahead_m,
+                                 std::vector<Point>& samples) const {
+    const double tile_m = EARTH_CIRCUMFERENCE_M * std::cos(shape_[segment].latitude * M_PI / 180.0) /
+                          TileKey::tilesPerSide(settings_.zoom);
+    const double step = std::max(tile_m / 2.0, 1.0);
+    const double start = shape_distance_m_[segment] + along_m;
+    const double end = std::min(start + lookahead_m, shape_distance_m_.back());
+    for (double s = start;; s += step) {
+        s = std::min(s, end);
+        while (segment + 2 < shape_.size() && shape_distance_m_[segment + 1] < s) {
+            ++segment;
+        }
+        const double length = shape_distance_m_[segment + 1] - shape_distance_m_[segment];
+        const double t = length > 0.0 ? (s - shape_distance_m_[segment]) / length : 0.0;
+        samples.push_back(interpolate(shape_[segment], shape_[segment + 1], std::min(std::max(t, 0.0), 1.0)));
+        if (s >= end) {
+            break;
+        }
+    }
+}
+
+bool TilePrefetcher::offer(const TileKey& key, std::vector<TileKey>& out) {
+    const uint64_t packed = key.pack();
+    if (issued_.count(packed)) {
+        return true;
+    }
+    if (tokens_ < 1.0) {
+        return false;
+    }
+    tokens_ -= 1.0;
+    issued_.insert(packed);
+    issued_order_.push_back(packed);
+    if (issued_order_.size() > MAX_REMEMBERED_TILES) {
+        issued_.erase(issued_order_.front());
+        issued_order_.pop_front();
+    }
+    out.push_back(key);
+    ++stats_.requested;
+    return true;
+}
+
+void TilePrefetcher::update(const Point& position, double heading_deg, double speed_kmh, uint64_t now_ms,
+                            std::vector<TileKey>& out) {
+    ++stats_.updates;
+    if (last_update_ms_ != 0 && now_ms > last_update_ms_) {
+        tokens_ = std::min(tokens_ + (now_ms - last_update_ms_) / 1000.0 * settings_.max_requests_per_s,
+                           settings_.burst);
+    }
+    last_update_ms_ = now_ms;
+
+    // Path samples ahead, nearest first, each with how far the box around it is widened
+    const double lookahead_m = lookaheadMeters(speed_kmh);
+    std::vector<Point> samples;
+    std::vector<double> widen_m;
+    size_t segment = 0;
+    double along_m = 0.0;
+    if (hasRoute() && locateOnRoute(position, segment, along_m)) {
+        sampleRoute(segment, along_m, lookahead_m, samples);
+        widen_m.assign(samples.size(), 0.0);
+    } else {
+        if (hasRoute()) {
+            ++stats_.off_route;
+        }
+        if (speed_kmh < MIN_HEADING_SPEED_KMH) {
+            samples.push_back(position);
+            widen_m.push_back(settings_.min_lookahead_m / 2.0);
+        } else {
+            const double tile_m = EARTH_CIRCUMFERENCE_M * std::cos(position.latitude * M_PI / 180.0) /
+                                  TileKey::tilesPerSide(settings_.zoom);
+            const double step = std::max(tile_m / 2.0, 1.0);
+            const double spread = std::tan(settings_.heading_spread_deg * M_PI / 180.0);
+            for (double d = 0.0; d < lookahead_m + step; d += step) {
+                const double distance = std::min(d, lookahead_m);
+                samples.push_back(NavUtils::projectPoint(position, heading_deg, distance));
+                widen_m.push_back(distance * spread);
+            }
+        }
+    }
+
+    const double half_width_m = std::max(view_width_m_ / 2.0, settings_.corridor_m);
+    const double half_height_m = std::max(view_height_m_ / 2.0, settings_.corridor_m);
+    std::vector<TileKey> keys;
+    for (size_t i = 0; i < samples.size(); ++i) {
+        const Point& sample = samples[i];
+        const double dlat = (half_height_m + widen_m[i]) / METERS_PER_DEGREE;
+        const double dlon = (half_width_m + widen_m[i]) /
+                            (METERS_PER_DEGREE * std::max(std::cos(sample.latitude * M_PI / 180.0), 1e-6));
+        const BoundingBox box(sample.latitude - dlat, std::max(sample.longitude - dlon, -180.0),
+                              sample.latitude + dlat, std::min(sample.longitude + dlon, 180.0));
+        keys.clear();
+        TileRange::covering(box, settings_.zoom).keys(keys);
+        for (const TileKey& key : keys) {
+            if (!offer(key, out)) {
+                // Out of tokens; the rest is offered again on a later update
+                ++stats_.throttled;
+                return;
+            }
+        }
+    }
+}
+
+} // namespace nav
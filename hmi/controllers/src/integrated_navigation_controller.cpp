@@ -60,8 +60,23 @@ bool IntegratedNavigationController::initializeServices()
     if (!m_mapService->initialize()) {
         qWarning() << "[INTEGRATED CONTROLLER] Failed to initialize map service";
         allInitialized = false;
+    } else if (m_mapService->hasMapData()) {
+        // Routing searches the mapped graph in place (no copy)
+        m_routingService->setRoadGraph(m_mapService->getRoadGraph());
+        m_positioningService->setRoadGraph(m_mapService->getRoadGraph());
+        
+        bool hasHierarchy = false;
+        for (RouteMetric metric : {RouteMetric::TRAVEL_TIME, RouteMetric::DISTANCE}) {
+            if (auto hierarchy = m_mapService->getContractionHierarchy(metric)) {
+                m_routingService->setContractionHierarchy(hierarchy);
+                hasHierarchy = true;
+            }
+        }
+        if (hasHierarchy) {
+            m_routingService->setAlgorithm(RoutingAlgorithm::CONTRACTION_HIERARCHY);
+        }
     }
-    
+
     if (!m_poiService->initialize()) {
         qWarning() << "[INTEGRATED CONTROLLER] Failed to initialize POI service";
         allInitialized = false;
@@ -177,6 +192,7 @@ void IntegratedNavigationController::clearRoute()
     }
     
     m_activeRoute = Route{};
+    m_mapService->clearPrefetchRoute();
     
     qDebug() << "[INTEGRATED CONTROLLER] Route cleared";
 }
@@ -348,6 +364,7 @@ void IntegratedNavigationController::onPositionChanged(const Point& position)
 {
     QMutexLocker locker(&m_mutex);
     m_currentPosition = position;
+    m_mapService->updatePrefetch(position, m_currentHeading, m_currentSpeed);
     emit positionChanged(position, m_currentHeading, m_currentSpeed);
 }
 
@@ -369,6 +386,7 @@ void IntegratedNavigationController::onRouteCalculated(const Route& route)
 {
     QMutexLocker locker(&m_mutex);
     m_activeRoute = route;
+    m_mapService->setPrefetchRoute(route);
     
     qDebug() << "[INTEGRATED CONTROLLER] Route calculated successfully:"
              << route.total_distance_meters << "meters";
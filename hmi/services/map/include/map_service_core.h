@@ -2,10 +2,21 @@
 
 #include "navigation_models.h"
 #include "poi_service.h"  // Include POI struct from poi_service
+#include "contraction_hierarchy.h"
+#include "map_file.h"
+#include "nav_utils.h"
+#include "poi_spatial_index.h"
+#include "poi_text_index.h"
+#include "road_graph.h"
+#include "tile_key.h"
+#include "tile_loader.h"
+#include "tile_pack.h"
+#include "tile_prefetcher.h"
 #include <QObject>
 #include <QTimer>
 #include <vector>
 #include <map>
+#include <memory>
 
 namespace nav {
 
@@ -17,15 +28,19 @@ namespace nav {
 // - Removed: description, rating
 
 /**
- * @brief Map tile data structure
+ * @brief Map tile data structure (Web-Mercator z/x/y)
  */
 struct MapTile {
-    uint32_t tileId;
-    Point topLeft;
-    Point bottomRight;
+    uint64_t tileId;      // TileKey::pack()
+    TileKey key;
+    Point topLeft;        // Exact north-west corner
+    Point bottomRight;    // Exact south-east corner
     int zoomLevel;
     QByteArray imageData;
     bool loaded;
+    bool mapped;          // imageData views the tile pack: copy it to keep it past shutdown()
+
+    MapTile() : tileId(0), zoomLevel(0), loaded(false), mapped(false) {}
 };
 
 /**
@@ -44,15 +59,34 @@ public:
     bool initialize();
     void shutdown();
     
+    // Map data file (defaults to [Map] map_data_path in navigation.conf)
+    void setMapDataPath(const QString& path);
+    QString getMapDataPath() const;
+    bool hasMapData() const;
+    std::shared_ptr<const RoadGraph> getRoadGraph() const;
+    std::shared_ptr<const ContractionHierarchy> getContractionHierarchy(RouteMetric metric) const;
+    
     // Map data queries - updated for new POI structure
     std::vector<POI> findPOINearLocation(const Point& location, double radiusMeters, const QString& category = QString()) const;
-    std::vector<POI> searchPOI(const QString& searchTerm) const;
+    std::vector<POI> findNearestPOIs(const Point& location, int count, const QString& category = QString(),
+                                     double maxRadiusMeters = 50000.0) const;
+    std::vector<POI> searchPOI(const QString& searchTerm, size_t maxResults = 50) const;
     POI getPOIById(uint64_t poiId) const;  // changed from uint32_t to uint64_t
     
     // Map tile management
     MapTile getMapTile(const Point& location, int zoomLevel);
+    MapTile getMapTile(const TileKey& key);
     void preloadTilesForArea(const Point& center, double radiusMeters, int zoomLevel);
+    // Loads nearest the centre of visible first; drops queued tiles beyond the preload radius
+    void setViewport(const BoundingBox& visible);
     void clearTileCache();
+    // Requests tiles along the route (or heading) ahead; call on every position update
+    void setPrefetchRoute(const Route& route);
+    void clearPrefetchRoute();
+    void updatePrefetch(const Point& position, double headingDegrees, double speedKmh);
+    const TilePrefetchStats& getPrefetchStats() const;
+    CacheStats getTileCacheStats() const;
+    size_t getTileCacheBytes() const;
     
     // Map information
     std::vector<QString> getAvailableCategories() const;
@@ -71,33 +105,49 @@ signals:
 
 private slots:
     void loadSampleData();
-    void performTileLoading();
 
 private:
     // Map data management
+    bool openMapData();
+    void loadPOIsFromMapFile();
     void initializeSamplePOIs();
+    bool rebuildPOIIndex();   // False (and no index) if the categories do not fit the index's ids
+    bool categoryFilter(const QString& category, uint16_t& categoryId) const;
     void initializeSampleTiles();
-    uint32_t generateTileId(const Point& location, int zoomLevel) const;
+    void startTileLoader();
+    void drainTileResults();
     double calculateDistance(const Point& p1, const Point& p2) const;
     
     // Service state
     bool m_initialized;
     bool m_serviceReady;
     
+    // Memory-mapped map data; the graph points into the mapping
+    QString m_mapDataPath;
+    std::shared_ptr<MapFile> m_mapFile;
+    std::shared_ptr<RoadGraph> m_roadGraph;
+    std::shared_ptr<ContractionHierarchy> m_chTime;
+    std::shared_ptr<ContractionHierarchy> m_chDistance;
+    
     // POI data
     std::vector<POI> m_pois;
     std::map<QString, std::vector<uint64_t>> m_categoryIndex; // changed from uint32_t to uint64_t for POI IDs
+    std::map<QString, uint16_t> m_categoryIds;  // Interned categories for the spatial index
+    PoiSpatialIndex m_poiIndex;                 // Reports indices into m_pois
+    PoiTextIndex m_poiTextIndex;                // Names and categories, same indices
     
     // Map tile data
-    std::map<uint32_t, MapTile> m_tileCache;
-    QTimer* m_tileLoadTimer;
-    std::vector<uint32_t> m_pendingTileLoads;
+    LRUCache<uint64_t, MapTile> m_tileCache;   // By TileKey::pack(), budgeted in bytes
+    BoundingBox m_viewport;
+    bool m_hasViewport;
+    std::vector<uint64_t> m_pinnedTiles;       // Entries inside m_viewport
+    TileLoader m_tileLoader;                   // Fills unloaded cache entries
+    TilePack m_tilePack;                       // Decoded tiles kept across runs
+    double m_tileRetainMeters;                 // Queued tiles farther out are dropped
+    TilePrefetcher m_tilePrefetcher;           // Tiles ahead of the vehicle
     
     // Data management
     QTimer* m_dataUpdateTimer;
-    
-    static constexpr int MAX_TILE_CACHE_SIZE = 100;
-    static constexpr int TILE_LOAD_DELAY_MS = 100;
 };
 
 } // namespace nav
\ No newline at end of file
@@ -1,21 +1,81 @@
 #include "map_service_core.h"
+#include "nav_utils.h"
 #include <QDebug>
-#include <QRandomGenerator>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QSettings>
+#include <QStandardPaths>
 #include <algorithm>
+#include <cmath>
 
 namespace nav {
 
+namespace {
+
+const double DEFAULT_TILE_RETAIN_KM = 10.0;
+const size_t DEFAULT_TILE_CACHE_MB = 100;
+const char* const TILE_PACK_FILE_NAME = "tiles.pack";
+const int DEFAULT_PREFETCH_ZOOM = 16;
+const size_t SIMULATED_TILE_BYTES = 1024;
+const double METERS_PER_DEGREE = 6371000.0 * M_PI / 180.0;
+
+QString tileName(const TileKey& key)
+{
+    return QString("%1/%2/%3").arg(key.z).arg(key.x).arg(key.y);
+}
+
+// Heap bytes a cache entry holds; mapped images live in the page cache
+size_t tileCost(const MapTile& tile)
+{
+    return sizeof(MapTile) + (tile.mapped ? 0 : static_cast<size_t>(tile.imageData.size()));
+}
+
+// Zero-copy view of a tile in the pack, valid until the pack is closed
+bool viewPackedTile(TilePack& pack, const TileKey& key, QByteArray& image)
+{
+    const uint8_t* data = nullptr;
+    uint32_t size = 0;
+    if (!pack.isOpen() || !pack.find(key, data, size)) {
+        return false;
+    }
+    image = QByteArray::fromRawData(reinterpret_cast<const char*>(data), static_cast<int>(size));
+    return true;
+}
+
+bool intersects(const BoundingBox& a, const BoundingBox& b)
+{
+    return a.minLat <= b.maxLat && b.minLat <= a.maxLat && a.minLon <= b.maxLon && b.minLon <= a.maxLon;
+}
+
+// Decoded tiles are derived data: by default they go to the user cache directory
+QString defaultTilePackPath()
+{
+    QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (cacheDir.isEmpty()) {
+        cacheDir = QDir::tempPath();
+    }
+    QDir().mkpath(cacheDir);
+    return cacheDir + "/" + TILE_PACK_FILE_NAME;
+}
+
+// Stand-in for reading and decoding a tile image; runs on a loader thread
+bool simulateTileDecode(const TileKey& key, std::vector<uint8_t>& data)
+{
+    data.assign(SIMULATED_TILE_BYTES, static_cast<uint8_t>(key.pack() * 0x9E3779B97F4A7C15ull >> 56));
+    return true;
+}
+
+} // namespace
+
 MapServiceCore::MapServiceCore(QObject* parent)
     : QObject(parent)
     , m_initialized(false)
     , m_serviceReady(false)
-    , m_tileLoadTimer(new QTimer(this))
+    , m_tileCache(DEFAULT_TILE_CACHE_MB * 1024 * 1024)
+    , m_hasViewport(false)
+    , m_tileRetainMeters(DEFAULT_TILE_RETAIN_KM * 1000.0)
     , m_dataUpdateTimer(new QTimer(this))
 {
-    // Setup tile loading timer
-    connect(m_tileLoadTimer, &QTimer::timeout, this, &MapServiceCore::performTileLoading);
-    m_tileLoadTimer->setSingleShot(true);
-    
     // Setup data update timer
     connect(m_dataUpdateTimer, &QTimer::timeout, this, &MapServiceCore::loadSampleData);
     m_dataUpdateTimer->setSingleShot(true);
@@ -38,9 +98,12 @@ bool MapServiceCore::initialize()
     m_pois.clear();
     m_categoryIndex.clear();
     m_tileCache.clear();
-    m_pendingTileLoads.clear();
     
-    // Load sample data after short delay
+    // Map the road network/POI file; falls back to sample data if absent
+    openMapData();
+    startTileLoader();
+    
+    // Load POI data after short delay
     m_dataUpdateTimer->start(100);
     
     m_initialized = true;
@@ -60,11 +123,16 @@ void MapServiceCore::shutdown()
     
     qDebug() << "🗺️ [MAP CORE] Shutting down map service...";
     
-    m_tileLoadTimer->stop();
+    m_tileLoader.stop();
     m_dataUpdateTimer->stop();
     clearTileCache();
+    m_tilePack.close();   // After the cache: its tiles may view the mapping
     m_pois.clear();
     m_categoryIndex.clear();
+    m_chTime.reset();
+    m_chDistance.reset();
+    m_roadGraph.reset();
+    m_mapFile.reset();
     
     m_initialized = false;
     m_serviceReady = false;
@@ -73,48 +141,174 @@ void MapServiceCore::shutdown()
     qDebug() << "✅ [MAP CORE] Map service shut down";
 }
 
+void MapServiceCore::setMapDataPath(const QString& path)
+{
+    m_mapDataPath = path;
+}
+
+QString MapServiceCore::getMapDataPath() const
+{
+    return m_mapDataPath;
+}
+
+bool MapServiceCore::hasMapData() const
+{
+    return m_roadGraph != nullptr;
+}
+
+std::shared_ptr<const RoadGraph> MapServiceCore::getRoadGraph() const
+{
+    return m_roadGraph;
+}
+
+std::shared_ptr<const ContractionHierarchy> MapServiceCore::getContractionHierarchy(RouteMetric metric) const
+{
+    return metric == RouteMetric::DISTANCE ? m_chDistance : m_chTime;
+}
+
+bool MapServiceCore::openMapData()
+{
+    if (m_mapDataPath.isEmpty()) {
+        const std::string configPath = NavUtils::locateConfigFile();
+        if (!configPath.empty()) {
+            QSettings config(QString::fromStdString(configPath), QSettings::IniFormat);
+            m_mapDataPath = config.value("Map/map_data_path").toString();
+        }
+    }
+    if (m_mapDataPath.isEmpty()) {
+        qDebug() << "⚠️ [MAP CORE] No map_data_path configured, using sample data";
+        return false;
+    }
+    
+    QElapsedTimer timer;
+    timer.start();
+    
+    // Only the header page is read here; sections fault in on first use
+    auto file = std::make_shared<MapFile>();
+    if (!file->open(m_mapDataPath.toStdString())) {
+        qDebug() << "⚠️ [MAP CORE] Cannot open map data" << m_mapDataPath << ":"
+                 << QString::fromStdString(file->lastError()) << "- using sample data";
+        return false;
+    }
+    
+    auto graph = std::make_shared<RoadGraph>();
+    if (!graph->attach(file)) {
+        qDebug() << "⚠️ [MAP CORE] Map data" << m_mapDataPath << "has no valid road graph - using sample data";
+        return false;
+    }
+    
+    m_mapFile = file;
+    m_roadGraph = graph;
+    
+    // Hierarchies are optional (nav_map_compiler --ch)
+    auto chTime = std::make_shared<ContractionHierarchy>();
+    m_chTime = chTime->attach(file, RouteMetric::TRAVEL_TIME) ? chTime : nullptr;
+    auto chDistance = std::make_shared<ContractionHierarchy>();
+    m_chDistance = chDistance->attach(file, RouteMetric::DISTANCE) ? chDistance : nullptr;
+    
+    qDebug() << "🗺️ [MAP CORE] Mapped" << m_mapDataPath << ":" << m_roadGraph->nodeCount() << "nodes,"
+             << m_roadGraph->arcCount() << "arcs," << m_mapFile->poiCount() << "POIs in" << timer.elapsed() << "ms,"
+             << (m_chTime ? 1 : 0) + (m_chDistance ? 1 : 0) << "contraction hierarchies";
+    return true;
+}
+
 std::vector<POI> MapServiceCore::findPOINearLocation(const Point& location, double radiusMeters, const QString& category) const
 {
     std::vector<POI> nearbyPOIs;
-    
-    for (const auto& poi : m_pois) {
-        Point poiLocation{poi.latitude, poi.longitude};
-        double distance = calculateDistance(location, poiLocation);
-        
-        if (distance <= radiusMeters) {
-            // Check category filter
-            if (category.isEmpty() || QString::fromStdString(poi.category) == category) {
-                nearbyPOIs.push_back(poi);
-            }
-        }
+    uint16_t categoryId;
+    if (!categoryFilter(category, categoryId)) {
+        return nearbyPOIs;
     }
     
-    // Sort by distance
-    std::sort(nearbyPOIs.begin(), nearbyPOIs.end(), 
-              [&location, this](const POI& a, const POI& b) {
-                  Point locA{a.latitude, a.longitude};
-                  Point locB{b.latitude, b.longitude};
-                  return calculateDistance(location, locA) < calculateDistance(location, locB);
-              });
+    // Nearest first, distances computed once inside the index
+    std::vector<PoiHit> hits;
+    m_poiIndex.findWithinRadius(location, radiusMeters, categoryId, hits);
+    nearbyPOIs.reserve(hits.size());
+    for (const PoiHit& hit : hits) {
+        nearbyPOIs.push_back(m_pois[hit.poi]);
+    }
     
     qDebug() << "🔍 [MAP CORE] Found" << nearbyPOIs.size() << "POIs near location within" << radiusMeters << "m";
     
     return nearbyPOIs;
 }
 
-std::vector<POI> MapServiceCore::searchPOI(const QString& searchTerm) const
+std::vector<POI> MapServiceCore::findNearestPOIs(const Point& location, int count, const QString& category,
+                                                 double maxRadiusMeters) const
 {
-    std::vector<POI> results;
-    QString lowerSearchTerm = searchTerm.toLower();
+    std::vector<POI> nearestPOIs;
+    uint16_t categoryId;
+    if (count <= 0 || !categoryFilter(category, categoryId)) {
+        return nearestPOIs;
+    }
     
+    std::vector<PoiHit> hits;
+    m_poiIndex.findNearest(location, static_cast<size_t>(count), categoryId, maxRadiusMeters, hits);
+    nearestPOIs.reserve(hits.size());
+    for (const PoiHit& hit : hits) {
+        nearestPOIs.push_back(m_pois[hit.poi]);
+    }
+    return nearestPOIs;
+}
+
+bool MapServiceCore::categoryFilter(const QString& category, uint16_t& categoryId) const
+{
+    if (category.isEmpty()) {
+        categoryId = PoiSpatialIndex::ANY_CATEGORY;
+        return true;
+    }
+    auto it = m_categoryIds.find(category);
+    if (it == m_categoryIds.end()) {
+        return false;   // Unknown category: nothing can match
+    }
+    categoryId = it->second;
+    return true;
+}
+
+bool MapServiceCore::rebuildPOIIndex()
+{
+    m_categoryIds.clear();
+    m_poiIndex.clear();
+    m_poiTextIndex.clear();
+    std::vector<PoiLocation> locations;
+    locations.reserve(m_pois.size());
     for (const auto& poi : m_pois) {
-        QString poiName = QString::fromStdString(poi.name);
-        QString poiCategory = QString::fromStdString(poi.category);
-        
-        if (poiName.toLower().contains(lowerSearchTerm) ||
-            poiCategory.toLower().contains(lowerSearchTerm)) {
-            results.push_back(poi);
+        const QString category = QString::fromStdString(poi.category);
+        auto it = m_categoryIds.find(category);
+        if (it == m_categoryIds.end()) {
+            // Ids below ANY_CATEGORY only; merging the rest would break category filters
+            if (m_categoryIds.size() >= PoiSpatialIndex::ANY_CATEGORY) {
+                qDebug() << "⚠️ [MAP CORE] More than" << PoiSpatialIndex::ANY_CATEGORY
+                         << "POI categories - POIs not loaded";
+                m_categoryIds.clear();
+                return false;
+            }
+            it = m_categoryIds.emplace(category, static_cast<uint16_t>(m_categoryIds.size())).first;
         }
+        locations.emplace_back(poi.latitude, poi.longitude, it->second);
+    }
+    m_poiIndex.build(locations);
+
+    std::vector<TextDocument> documents;
+    documents.reserve(m_pois.size());
+    for (const auto& poi : m_pois) {
+        documents.emplace_back(poi.name, poi.category);
+    }
+    m_poiTextIndex.build(documents);
+    return true;
+}
+
+std::vector<POI> MapServiceCore::searchPOI(const QString& searchTerm, size_t maxResults) const
+{
+    std::vector<POI> results;
+    
+    // Every word is matched as a prefix, ignoring case and diacritics; best matches first
+    std::vector<TextHit> hits;
+    const QByteArray query = searchTerm.toUtf8();
+    m_poiTextIndex.search(std::string_view(query.constData(), query.size()), maxResults, hits);
+    results.reserve(hits.size());
+    for (const TextHit& hit : hits) {
+        results.push_back(m_pois[hit.doc]);
     }
     
     qDebug() << "🔍 [MAP CORE] POI search for '" << searchTerm << "' returned" << results.size() << "results";
@@ -136,31 +330,47 @@ POI MapServiceCore::getPOIById(uint64_t poiId) const
 
 MapTile MapServiceCore::getMapTile(const Point& location, int zoomLevel)
 {
-    uint32_t tileId = generateTileId(location, zoomLevel);
+    return getMapTile(TileKey::fromPoint(location, zoomLevel));
+}
+
+MapTile MapServiceCore::getMapTile(const TileKey& key)
+{
+    const uint64_t tileId = key.pack();
     
-    auto it = m_tileCache.find(tileId);
-    if (it != m_tileCache.end()) {
-        qDebug() << "📍 [MAP CORE] Tile" << tileId << "found in cache";
-        return it->second;
+    if (const MapTile* cached = m_tileCache.find(tileId)) {
+        // Re-request if the loader dropped it when it left the viewport
+        if (!cached->loaded) {
+            m_tileLoader.request(key);
+        }
+        qDebug() << "📍 [MAP CORE] Tile" << tileName(key) << "found in cache";
+        return *cached;
     }
     
     // Create new tile and schedule loading
+    const BoundingBox bounds = key.bounds();
     MapTile tile;
     tile.tileId = tileId;
-    tile.topLeft = Point(location.latitude + 0.01, location.longitude - 0.01);
-    tile.bottomRight = Point(location.latitude - 0.01, location.longitude + 0.01);
-    tile.zoomLevel = zoomLevel;
+    tile.key = key;
+    tile.topLeft = Point(bounds.maxLat, bounds.minLon);
+    tile.bottomRight = Point(bounds.minLat, bounds.maxLon);
+    tile.zoomLevel = key.z;
     tile.loaded = false;
     
-    m_tileCache[tileId] = tile;
-    m_pendingTileLoads.push_back(tileId);
-    
-    // Start loading timer if not already running
-    if (!m_tileLoadTimer->isActive()) {
-        m_tileLoadTimer->start(TILE_LOAD_DELAY_MS);
+    // Seen on an earlier run: serve it from the pack without decoding
+    if (viewPackedTile(m_tilePack, key, tile.imageData)) {
+        tile.loaded = true;
+        tile.mapped = true;
     }
     
-    qDebug() << "📍 [MAP CORE] Scheduled loading for tile" << tileId;
+    m_tileCache.put(tileId, tile, tileCost(tile));
+    if (m_hasViewport && intersects(bounds, m_viewport)) {
+        m_tileCache.setPinned(tileId, true);
+        m_pinnedTiles.push_back(tileId);
+    }
+    if (!tile.loaded) {
+        m_tileLoader.request(key);
+        qDebug() << "📍 [MAP CORE] Scheduled loading for tile" << tileName(key);
+    }
     
     return tile;
 }
@@ -171,28 +381,111 @@ void MapServiceCore::preloadTilesForArea(const Point& center, double radiusMeter
              << center.latitude << "," << center.longitude 
              << "radius:" << radiusMeters << "m";
     
-    // Calculate grid of tiles to preload
-    double degreesPerMeter = 1.0 / 111320.0; // Approximate
-    double radiusDegrees = radiusMeters * degreesPerMeter;
-    
-    int tilesPerSide = qMax(1, static_cast<int>(radiusDegrees / 0.01)); // 0.01 degree tiles
-    
-    for (int x = -tilesPerSide; x <= tilesPerSide; ++x) {
-        for (int y = -tilesPerSide; y <= tilesPerSide; ++y) {
-            Point tileCenter(
-                center.latitude + (y * 0.01),
-                center.longitude + (x * 0.01)
-            );
-            getMapTile(tileCenter, zoomLevel);
+    // Every tile at this zoom that the circle's bounding box touches
+    std::vector<TileKey> keys;
+    TileRange::around(center, radiusMeters, zoomLevel).keys(keys);
+    for (const TileKey& key : keys) {
+        getMapTile(key);
+    }
+}
+
+void MapServiceCore::setViewport(const BoundingBox& visible)
+{
+    // Keep queued tiles within the preload radius of the visible area
+    const double dLat = m_tileRetainMeters / METERS_PER_DEGREE;
+    const double dLon = dLat / std::max(std::cos(visible.center().latitude * M_PI / 180.0), 1e-6);
+    const BoundingBox retain(visible.minLat - dLat, std::max(visible.minLon - dLon, -180.0),
+                             visible.maxLat + dLat, std::min(visible.maxLon + dLon, 180.0));
+    m_tileLoader.setViewport(visible.center(), retain);
+    m_tilePrefetcher.setViewSize((visible.maxLon - visible.minLon) * METERS_PER_DEGREE *
+                                     std::cos(visible.center().latitude * M_PI / 180.0),
+                                 (visible.maxLat - visible.minLat) * METERS_PER_DEGREE);
+    
+    // Pin what is on screen; pin the new set before releasing the old one
+    std::vector<uint64_t> onScreen;
+    m_tileCache.forEach([&](uint64_t tileId, const MapTile& tile) {
+        if (intersects(BoundingBox(tile.bottomRight.latitude, tile.topLeft.longitude,
+                                   tile.topLeft.latitude, tile.bottomRight.longitude), visible)) {
+            onScreen.push_back(tileId);
+        }
+    });
+    for (uint64_t tileId : onScreen) {
+        m_tileCache.setPinned(tileId, true);
+    }
+    std::sort(onScreen.begin(), onScreen.end());
+    for (uint64_t tileId : m_pinnedTiles) {
+        if (!std::binary_search(onScreen.begin(), onScreen.end(), tileId)) {
+            m_tileCache.setPinned(tileId, false);
         }
     }
+    m_pinnedTiles.swap(onScreen);
+    m_viewport = visible;
+    m_hasViewport = true;
 }
 
 void MapServiceCore::clearTileCache()
 {
     qDebug() << "🗑️ [MAP CORE] Clearing tile cache (" << m_tileCache.size() << "tiles)";
     m_tileCache.clear();
-    m_pendingTileLoads.clear();
+    m_pinnedTiles.clear();
+    m_tilePrefetcher.reset();
+}
+
+void MapServiceCore::setPrefetchRoute(const Route& route)
+{
+    // Route nodes are MapNode ids; without the road graph there is no shape to follow
+    std::vector<Point> shape;
+    if (m_roadGraph) {
+        shape.reserve(route.node_count);
+        for (int i = 0; i < route.node_count; ++i) {
+            const uint32_t node = m_roadGraph->findNode(route.nodes[i]);
+            if (node == RoadGraph::INVALID_NODE) {
+                shape.clear();
+                break;
+            }
+            shape.push_back(m_roadGraph->position(node));
+        }
+    }
+    m_tilePrefetcher.setRoute(shape);
+    if (m_tilePrefetcher.hasRoute()) {
+        qDebug() << "📍 [MAP CORE] Prefetching tiles along route" << route.route_id << "(" << shape.size() << "points)";
+    } else if (route.node_count >= 2) {
+        qDebug() << "⚠️ [MAP CORE] Route" << route.route_id << "not in the road graph - prefetching by heading";
+    }
+}
+
+void MapServiceCore::clearPrefetchRoute()
+{
+    m_tilePrefetcher.clearRoute();
+}
+
+void MapServiceCore::updatePrefetch(const Point& position, double headingDegrees, double speedKmh)
+{
+    if (!m_initialized) {
+        return;
+    }
+    std::vector<TileKey> keys;
+    m_tilePrefetcher.update(position, headingDegrees, speedKmh, NavUtils::getCurrentTimestampMs(), keys);
+    for (const TileKey& key : keys) {
+        if (!m_tileCache.contains(key.pack())) {
+            getMapTile(key);
+        }
+    }
+}
+
+const TilePrefetchStats& MapServiceCore::getPrefetchStats() const
+{
+    return m_tilePrefetcher.stats();
+}
+
+CacheStats MapServiceCore::getTileCacheStats() const
+{
+    return m_tileCache.stats();
+}
+
+size_t MapServiceCore::getTileCacheBytes() const
+{
+    return m_tileCache.cost();
 }
 
 std::vector<QString> MapServiceCore::getAvailableCategories() const
@@ -212,11 +505,11 @@ int MapServiceCore::getTotalPOICount() const
 int MapServiceCore::getLoadedTileCount() const
 {
     int loadedCount = 0;
-    for (const auto& pair : m_tileCache) {
-        if (pair.second.loaded) {
+    m_tileCache.forEach([&loadedCount](uint64_t, const MapTile& tile) {
+        if (tile.loaded) {
             loadedCount++;
         }
-    }
+    });
     return loadedCount;
 }
 
@@ -240,51 +533,116 @@ QString MapServiceCore::getServiceStatus() const
 
 void MapServiceCore::loadSampleData()
 {
-    qDebug() << "📊 [MAP CORE] Loading sample POI data...";
-    
-    initializeSamplePOIs();
+    if (m_mapFile && m_mapFile->poiCount() > 0) {
+        loadPOIsFromMapFile();
+    } else {
+        qDebug() << "📊 [MAP CORE] Loading sample POI data...";
+        initializeSamplePOIs();
+    }
     initializeSampleTiles();
     
     emit poiDataUpdated();
     emit mapDataChanged();
     
-    qDebug() << "✅ [MAP CORE] Sample data loaded:" << m_pois.size() << "POIs";
+    qDebug() << "✅ [MAP CORE] Map data loaded:" << m_pois.size() << "POIs";
 }
 
-void MapServiceCore::performTileLoading()
+void MapServiceCore::startTileLoader()
 {
-    if (m_pendingTileLoads.empty()) {
-        return;
+    const std::string configPath = NavUtils::locateConfigFile();
+    unsigned threads = 0;
+    QString packPath = defaultTilePackPath();
+    TilePrefetchSettings prefetch;
+    prefetch.zoom = DEFAULT_PREFETCH_ZOOM;
+    if (!configPath.empty()) {
+        QSettings config(QString::fromStdString(configPath), QSettings::IniFormat);
+        m_tileRetainMeters = config.value("Map/preload_radius_km", DEFAULT_TILE_RETAIN_KM).toDouble() * 1000.0;
+        threads = config.value("Map/tile_loader_threads", 0).toUInt();
+        const unsigned cacheMb = config.value("Map/tile_cache_mb", static_cast<unsigned>(DEFAULT_TILE_CACHE_MB)).toUInt();
+        m_tileCache.setCapacity(size_t(cacheMb) * 1024 * 1024);
+        packPath = config.value("Map/tile_pack_path", packPath).toString();
+        prefetch.zoom = config.value("Map/prefetch_zoom", prefetch.zoom).toInt();
+        prefetch.lookahead_s = config.value("Map/prefetch_lookahead_s", prefetch.lookahead_s).toDouble();
+        prefetch.corridor_m = config.value("Map/prefetch_corridor_m", prefetch.corridor_m).toDouble();
+        prefetch.max_requests_per_s =
+            config.value("Map/prefetch_max_requests_per_s", prefetch.max_requests_per_s).toDouble();
     }
+    m_tilePrefetcher.setSettings(prefetch);
     
-    // Load one tile per timer tick to simulate async loading
-    uint32_t tileId = m_pendingTileLoads.front();
-    m_pendingTileLoads.erase(m_pendingTileLoads.begin());
+    if (!packPath.isEmpty() && !m_tilePack.open(packPath.toStdString())) {
+        qDebug() << "⚠️ [MAP CORE] Tile pack" << packPath << "unavailable:"
+                 << QString::fromStdString(m_tilePack.lastError()) << "- tiles will not persist";
+    } else if (m_tilePack.isOpen()) {
+        qDebug() << "📍 [MAP CORE] Tile pack" << packPath << "holds" << m_tilePack.tileCount() << "tiles";
+    }
     
-    auto it = m_tileCache.find(tileId);
-    if (it != m_tileCache.end()) {
-        MapTile& tile = it->second;
-        
-        // Simulate tile data loading (in real system would fetch from map server)
-        tile.imageData = QByteArray(1024, static_cast<char>(QRandomGenerator::global()->bounded(256)));
+    // One queued drain per batch: the loader only notifies when its result list was empty
+    m_tileLoader.setNotifier([this]() {
+        QMetaObject::invokeMethod(this, [this]() { drainTileResults(); }, Qt::QueuedConnection);
+    });
+    m_tileLoader.start(simulateTileDecode, threads);
+    qDebug() << "📍 [MAP CORE] Tile loader running on" << m_tileLoader.threadCount() << "threads";
+}
+
+void MapServiceCore::drainTileResults()
+{
+    std::vector<TileResult> results;
+    m_tileLoader.takeResults(results);
+    
+    int loaded = 0;
+    for (TileResult& result : results) {
+        const MapTile* cached = m_tileCache.peek(result.key.pack());
+        if (!cached || !result.ok) {
+            continue;   // Evicted or cleared while loading
+        }
+        MapTile tile = *cached;
         tile.loaded = true;
-        
-        qDebug() << "📍 [MAP CORE] Tile" << tileId << "loaded successfully";
+        // Store it for later runs and keep only the mapped copy
+        tile.mapped = m_tilePack.isOpen() &&
+                      m_tilePack.append(result.key, result.data.data(), static_cast<uint32_t>(result.data.size())) &&
+                      viewPackedTile(m_tilePack, result.key, tile.imageData);
+        if (!tile.mapped) {
+            tile.imageData = QByteArray(reinterpret_cast<const char*>(result.data.data()),
+                                        static_cast<int>(result.data.size()));
+        }
+        m_tileCache.put(tile.tileId, tile, tileCost(tile));   // Evicts by LRU if over budget
+        ++loaded;
         emit mapTileLoaded(tile);
     }
+    if (loaded > 0) {
+        qDebug() << "📍 [MAP CORE]" << loaded << "tiles loaded," << m_tileLoader.pendingCount() << "pending,"
+                 << m_tileCache.cost() / 1024 << "KB cached";
+    }
+}
+
+void MapServiceCore::loadPOIsFromMapFile()
+{
+    m_pois.clear();
+    m_categoryIndex.clear();
     
-    // Continue loading if more tiles pending
-    if (!m_pendingTileLoads.empty()) {
-        m_tileLoadTimer->start(TILE_LOAD_DELAY_MS);
+    const uint32_t count = m_mapFile->poiCount();
+    m_pois.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        const MapFilePoi& record = m_mapFile->poi(i);
+        
+        POI poi;
+        poi.poi_id = record.poi_id;
+        poi.latitude = record.lat_e7 / RoadGraph::COORD_SCALE;
+        poi.longitude = record.lon_e7 / RoadGraph::COORD_SCALE;
+        poi.name = m_mapFile->poiString(record.name_offset);
+        poi.category = m_mapFile->poiString(record.category_offset);
+        poi.address = m_mapFile->poiString(record.address_offset);
+        
+        m_categoryIndex[QString::fromStdString(poi.category)].push_back(poi.poi_id);
+        m_pois.push_back(std::move(poi));
     }
     
-    // Clean up cache if too large
-    if (static_cast<int>(m_tileCache.size()) > MAX_TILE_CACHE_SIZE) {
-        qDebug() << "🗑️ [MAP CORE] Tile cache full, cleaning up oldest tiles";
-        // In a real implementation, would use LRU eviction
-        auto oldest = m_tileCache.begin();
-        m_tileCache.erase(oldest);
+    if (!rebuildPOIIndex()) {
+        m_pois.clear();
+        m_categoryIndex.clear();
+        return;
     }
+    qDebug() << "📊 [MAP CORE] Loaded" << m_pois.size() << "POIs from" << m_mapDataPath;
 }
 
 void MapServiceCore::initializeSamplePOIs()
@@ -340,6 +698,7 @@ void MapServiceCore::initializeSamplePOIs()
         m_categoryIndex[sample.category].push_back(poi.poi_id);
     }
     
+    rebuildPOIIndex();
     qDebug() << "📊 [MAP CORE] Initialized" << m_pois.size() << "sample POIs";
 }
 
@@ -361,16 +720,6 @@ void MapServiceCore::initializeSampleTiles()
     qDebug() << "📊 [MAP CORE] Initialized sample map tiles";
 }
 
-uint32_t MapServiceCore::generateTileId(const Point& location, int zoomLevel) const
-{
-    // Simple tile ID generation based on location and zoom
-    uint32_t latHash = static_cast<uint32_t>(location.latitude * 10000) % 10000;
-    uint32_t lonHash = static_cast<uint32_t>(location.longitude * 10000) % 10000;
-    uint32_t zoomHash = static_cast<uint32_t>(zoomLevel) % 100;
-    
-    return (latHash << 16) | (lonHash << 8) | zoomHash;
-}
-
 double MapServiceCore::calculateDistance(const Point& p1, const Point& p2) const
 {
     // Haversine formula
@@ -5,8 +5,13 @@
 #include <QString>
 #include <QJsonArray>
 #include <QJsonObject>
+#include <QThreadPool>
+#include <memory>
 #include <vector>
 #include "navigation_models.h"  // Use Point from navigation_models
+#include "poi_database.h"
+#include "poi_spatial_index.h"
+#include "poi_text_index.h"
 
 namespace nav {
 
@@ -69,7 +74,7 @@ public:
 
     // POI retrieval
     std::vector<POI> findNearbyPOIs(const Point& location, double radiusMeters, const QString& category = QString());
-    std::vector<POI> searchPOIsByName(const QString& name);
+    std::vector<POI> searchPOIsByName(const QString& name, size_t maxResults = 50);
     
     // Address to POI conversion
     POI getPOIFromAddress(const AddressRequest& address);  // fixed typo: Adress -> Address
@@ -78,17 +83,32 @@ public:
     GeocodingResult geocodeAddress(const AddressRequest& address);  // fixed typo: Adress -> Address
     GeocodingResult reverseGeocode(double latitude, double longitude);
 
+signals:
+    // Ready once the database is mapped and indexed, which happens off the GUI thread
+    void serviceStatusChanged(bool ready);
+
 private:
+    //POI data storage and indexing, built by a worker and then read-only
+    struct PoiDatabase {
+        PoiSnapshot snapshot;          // Mapped poi_database.json snapshot
+        PoiSpatialIndex spatialIndex;  // Reports indices into snapshot
+        PoiTextIndex nameIndex;        // Names and categories, same indices
+    };
+
     //Core service state
     bool m_initialized;
     bool m_serviceReady;
     mutable double m_lastQueryTimeMs;
 
-    //POI data storage and indexing
-    std::vector<POI> m_poiDatabase;
+    std::shared_ptr<const PoiDatabase> m_database;   // Null until loaded
+    QThreadPool m_loadPool;
     
     // Helper methods
     void loadPOIDatabase();
+    static std::shared_ptr<const PoiDatabase> openDatabase(const QString& databasePath, const QString& snapshotPath);
+    void installDatabase(const std::shared_ptr<const PoiDatabase>& database);
+    POI poiAt(uint32_t index) const;
+    bool categoryFilter(const QString& category, uint16_t& categoryId) const;
     double calculateDistance(const Point& p1, const Point& p2) const;
 };
 
@@ -1,8 +1,14 @@
 #include "poi_service.h"
+#include "nav_utils.h"
 #include <QFile>
 #include <QIODevice>
 #include <QJsonDocument>
 #include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QSettings>
+#include <QStandardPaths>
 #include <cmath>
 
 #ifndef M_PI
@@ -17,13 +23,13 @@ POIService::POIService(QObject* parent)
     , m_serviceReady(false)
     , m_lastQueryTimeMs(0.0)
 {
-    // Constructor implementation
-
+    // One loader; it only runs at startup
+    m_loadPool.setMaxThreadCount(1);
 }
 
 POIService::~POIService()
 {
-    // Destructor implementation
+    m_loadPool.waitForDone();
 }
 
 bool POIService::initialize()
@@ -32,11 +38,9 @@ bool POIService::initialize()
         return true;
     }
             
-    // Load POI database
-    loadPOIDatabase();
-    
+    // Load POI database; the service becomes ready when the worker is done
     m_initialized = true;
-    m_serviceReady = true;
+    loadPOIDatabase();
 
     return true;
 }
@@ -47,10 +51,13 @@ void POIService::shutdown()
         return;
     }
     
-    // Cleanup resources if needed
+    // A load still running is discarded when it arrives
+    m_loadPool.waitForDone();
+    m_database.reset();
     
     m_initialized = false;
     m_serviceReady = false;
+    emit serviceStatusChanged(false);
 }
 
 bool POIService::isServiceReady() const
@@ -63,12 +70,120 @@ std::string POIService::getServiceStatus() const
     if (!m_initialized) {
         return "Not Initialized";
     }   
-    return "Ready";
+    return m_serviceReady ? "Ready" : "Loading";
 }
 
 void POIService::loadPOIDatabase()
 {
-    //Needtodo
+    QString databasePath = "hmi/maps/poi_database.json";
+    QString snapshotPath;
+    const std::string configPath = NavUtils::locateConfigFile();
+    if (!configPath.empty()) {
+        QSettings config(QString::fromStdString(configPath), QSettings::IniFormat);
+        databasePath = config.value("Map/poi_database_path", databasePath).toString();
+        snapshotPath = config.value("Map/poi_snapshot_path").toString();
+    }
+    if (snapshotPath.isEmpty()) {
+        // The snapshot is derived data: keep it out of the install and source trees
+        QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+        if (cacheDir.isEmpty()) {
+            cacheDir = QDir::tempPath();
+        }
+        QDir().mkpath(cacheDir);
+        snapshotPath = cacheDir + "/" + QFileInfo(databasePath).fileName() + ".snap";
+    }
+    
+    // Importing and indexing a national file takes most of a second; keep it off the GUI thread
+    m_loadPool.start([this, databasePath, snapshotPath]() {
+        std::shared_ptr<const PoiDatabase> database = openDatabase(databasePath, snapshotPath);
+        QMetaObject::invokeMethod(this, [this, database]() { installDatabase(database); }, Qt::QueuedConnection);
+    });
+}
+
+std::shared_ptr<const POIService::PoiDatabase> POIService::openDatabase(const QString& databasePath,
+                                                                        const QString& snapshotPath)
+{
+    const std::string jsonPath = databasePath.toStdString();
+    const std::string binaryPath = snapshotPath.toStdString();
+    auto database = std::make_shared<PoiDatabase>();
+    PoiSnapshot& snapshot = database->snapshot;
+    
+    QElapsedTimer timer;
+    timer.start();
+    
+    // Later boots map the snapshot; the first boot, or an edited JSON, streams it into a new one
+    if (!snapshot.open(binaryPath) || !snapshot.isCurrent(jsonPath)) {
+        snapshot.close();
+        std::string error;
+        size_t count = 0;
+        if (!PoiSnapshotWriter::convert(jsonPath, binaryPath, &error, &count)) {
+            qDebug() << "⚠️ [POI SERVICE] Cannot import" << databasePath << ":" << QString::fromStdString(error);
+        } else {
+            qDebug() << "📍 [POI SERVICE] Imported" << count << "POIs from" << databasePath << "into" << snapshotPath
+                     << "in" << timer.elapsed() << "ms";
+        }
+        if (!snapshot.open(binaryPath)) {
+            qDebug() << "⚠️ [POI SERVICE] No POI database:" << QString::fromStdString(snapshot.lastError());
+        }
+    }
+    
+    std::vector<PoiLocation> locations;
+    std::vector<TextDocument> documents;
+    locations.reserve(snapshot.poiCount());
+    documents.reserve(snapshot.poiCount());
+    for (uint32_t i = 0; i < snapshot.poiCount(); ++i) {
+        const PoiSnapshotRecord& record = snapshot.record(i);
+        locations.emplace_back(record.lat_e7 / 1e7, record.lon_e7 / 1e7, record.category);
+        documents.emplace_back(snapshot.name(i), snapshot.category(record.category));
+    }
+    database->spatialIndex.build(locations);
+    database->nameIndex.build(documents);
+    
+    qDebug() << "📍 [POI SERVICE] Mapped" << snapshot.poiCount() << "POIs in" << snapshot.categoryCount()
+             << "categories, indexed in" << timer.elapsed() << "ms";
+    return database;
+}
+
+void POIService::installDatabase(const std::shared_ptr<const PoiDatabase>& database)
+{
+    // Shut down while the load was in flight
+    if (!m_initialized) {
+        return;
+    }
+    m_database = database;
+    m_serviceReady = true;
+    emit serviceStatusChanged(true);
+}
+
+POI POIService::poiAt(uint32_t index) const
+{
+    const PoiSnapshot& snapshot = m_database->snapshot;
+    const PoiSnapshotRecord& record = snapshot.record(index);
+    POI poi;
+    poi.poi_id = record.poi_id;
+    poi.latitude = record.lat_e7 / 1e7;
+    poi.longitude = record.lon_e7 / 1e7;
+    poi.name = snapshot.name(index);
+    poi.category = snapshot.category(record.category);
+    poi.address = snapshot.address(index);
+    return poi;
+}
+
+bool POIService::categoryFilter(const QString& category, uint16_t& categoryId) const
+{
+    if (category.isEmpty()) {
+        categoryId = PoiSpatialIndex::ANY_CATEGORY;
+        return true;
+    }
+    const QByteArray name = category.toUtf8();
+    const PoiSnapshot& snapshot = m_database->snapshot;
+    for (uint32_t id = 0; id < snapshot.categoryCount(); ++id) {
+        if (name == snapshot.category(static_cast<uint16_t>(id))) {
+            categoryId = static_cast<uint16_t>(id);
+            return true;
+        }
+    }
+    return false;   // Unknown category: nothing can match
 }
 
 double POIService::calculateDistance(const Point& p1, const Point& p2) const
@@ -89,20 +204,36 @@ double POIService::calculateDistance(const Point& p1, const Point& p2) const
 }
 
 std::vector<POI> POIService::findNearbyPOIs(const Point& location, double radiusMeters, const QString& category) {
-    //Needtodo
     std::vector<POI> results;
+    uint16_t categoryId;
+    if (!m_database || !categoryFilter(category, categoryId)) {
+        return results;
+    }
+    
+    // Nearest first
+    std::vector<PoiHit> hits;
+    m_database->spatialIndex.findWithinRadius(location, radiusMeters, categoryId, hits);
+    results.reserve(hits.size());
+    for (const PoiHit& hit : hits) {
+        results.push_back(poiAt(hit.poi));
+    }
     
     return results;
 }
 
-std::vector<POI> POIService::searchPOIsByName(const QString& name) {
+std::vector<POI> POIService::searchPOIsByName(const QString& name, size_t maxResults) {
     std::vector<POI> results;
-    QString lowerName = name.toLower();
+    if (!m_database) {
+        return results;
+    }
     
-    for (const auto& poi : m_poiDatabase) {
-        if (QString::fromStdString(poi.name).toLower().contains(lowerName)) {
-            results.push_back(poi);
-        }
+    // Prefix match on every word, case and diacritics folded; best matches first
+    std::vector<TextHit> hits;
+    const QByteArray query = name.toUtf8();
+    m_database->nameIndex.search(std::string_view(query.constData(), query.size()), maxResults, hits);
+    results.reserve(hits.size());
+    for (const TextHit& hit : hits) {
+        results.push_back(poiAt(hit.doc));
     }
     
     return results;
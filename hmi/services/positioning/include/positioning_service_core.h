@@ -1,15 +1,29 @@
 #pragma once
 
 #include "navigation_models.h"
+#include "gps_serial_reader.h"
+#include "can_vehicle_reader.h"
+#include "position_filter.h"
+#include "map_matcher.h"
 #include <QObject>
 #include <QTimer>
 #include <QDateTime>
+#include <atomic>
+#include <memory>
 
 namespace nav {
 
 /**
  * @brief Core positioning service integrated into HMI
  * Provides GPS location and positioning data
+ *
+ * With a receiver on gps_device, fixes arrive from a GpsSerialReader thread
+ * through its SPSC queue; wheel speed and yaw rate arrive the same way from
+ * a CanVehicleReader on can_device. Both feed a PositionFilter (CAN predicts,
+ * GPS corrects) whose estimate is published at position_update_rate_hz, and
+ * which dead-reckons through GPS outages. With map_matching_enabled and a
+ * road graph, the published estimate is snapped to the road by a MapMatcher.
+ * With neither source the service simulates movement.
  */
 class PositioningServiceCore : public QObject
 {
@@ -35,6 +49,19 @@ public:
     void setCurrentHeading(double heading);
     void setCurrentSpeed(double speed);
     
+    // Serial GPS receiver (defaults to [Hardware] gps_device / gps_baud_rate
+    // in navigation.conf); must be set before initialize()
+    void setGpsDevice(const QString& device, int baudRate);
+    bool hasGpsReceiver() const;
+    void setCanDevice(const QString& device);
+    bool hasVehicleData() const;
+    
+    // True while the published position is dead-reckoned from CAN data
+    bool isDeadReckoning() const;
+    
+    // Road network for map matching (builds its segment index)
+    void setRoadGraph(std::shared_ptr<const RoadGraph> graph);
+    
     // Service status
     bool isServiceReady() const;
     QString getServiceStatus() const;
@@ -45,12 +72,20 @@ signals:
     void speedChanged(double speed);
     void altitudeChanged(double altitude);
     void serviceStatusChanged(bool ready);
+    void positioningModeChanged(bool deadReckoning);
 
 private slots:
     void updatePosition();
     void generateSimulatedData();
 
 private:
+    void loadFusionSettings();
+    bool openGpsReceiver();
+    bool openCanReader();
+    void drainGpsFixes();
+    void drainVehicleSamples();
+    void publishFusedPosition();
+
     // Core positioning data
     Point m_currentPosition;
     double m_currentHeading;
@@ -67,6 +102,26 @@ private:
     QTimer* m_simulationTimer;
     bool m_simulationMode;
     
+    // GPS receiver; the reader thread only touches its own queue
+    QString m_gpsDevice;
+    int m_gpsBaudRate;
+    std::unique_ptr<GpsSerialReader> m_gpsReader;
+    std::atomic<bool> m_gpsDrainPending;
+    
+    // CAN vehicle data; drained on each update tick
+    QString m_canDevice;
+    std::unique_ptr<CanVehicleReader> m_canReader;
+    
+    // GPS + CAN fusion, only touched on the service thread
+    PositionFilter m_filter;
+    int m_updateRateHz;
+    bool m_fusionActive;
+    PositioningMode m_positioningMode;
+    
+    // Map matching of the published position
+    bool m_mapMatchingEnabled;
+    std::unique_ptr<MapMatcher> m_mapMatcher;
+    
     // Default coordinates (Hanoi, Vietnam)
     static constexpr double DEFAULT_LAT = 21.028511;
     static constexpr double DEFAULT_LON = 105.804817;
@@ -1,6 +1,9 @@
 #include "positioning_service_core.h"
+#include "nav_utils.h"
+#include "road_graph.h"
 #include <QDebug>
 #include <QRandomGenerator>
+#include <QSettings>
 
 namespace nav {
 
@@ -16,6 +19,12 @@ PositioningServiceCore::PositioningServiceCore(QObject* parent)
     , m_updateTimer(new QTimer(this))
     , m_simulationTimer(new QTimer(this))
     , m_simulationMode(true)
+    , m_gpsBaudRate(9600)
+    , m_gpsDrainPending(false)
+    , m_updateRateHz(10)
+    , m_fusionActive(false)
+    , m_positioningMode(PositioningMode::GPS)
+    , m_mapMatchingEnabled(true)
 {
     // Setup update timer for position broadcasting
     connect(m_updateTimer, &QTimer::timeout, this, &PositioningServiceCore::updatePosition);
@@ -46,6 +55,21 @@ bool PositioningServiceCore::initialize()
     m_currentAltitude = 10.0; // Default altitude in meters
     m_lastUpdate = QDateTime::currentDateTime();
     
+    // Real data replaces the simulation when either source opens
+    loadFusionSettings();
+    const bool haveGps = openGpsReceiver();
+    const bool haveCan = openCanReader();
+    m_fusionActive = haveGps || haveCan;
+    m_simulationMode = !m_fusionActive;
+    m_positioningMode = PositioningMode::GPS;
+    
+    // The fused estimate is published at the configured rate
+    if (m_fusionActive) {
+        m_updateTimer->setInterval(1000 / m_updateRateHz);
+        qDebug() << "🌍 [POSITIONING CORE] Sensor fusion at" << m_updateRateHz << "Hz"
+                 << "(GPS:" << haveGps << "CAN:" << haveCan << ")";
+    }
+    
     // Start timers
     m_updateTimer->start();
     if (m_simulationMode) {
@@ -71,6 +95,16 @@ void PositioningServiceCore::shutdown()
     
     m_updateTimer->stop();
     m_simulationTimer->stop();
+    if (m_gpsReader) {
+        m_gpsReader->close();
+        m_gpsReader.reset();
+    }
+    if (m_canReader) {
+        m_canReader->close();
+        m_canReader.reset();
+    }
+    m_filter.reset();
+    m_fusionActive = false;
     
     m_initialized = false;
     m_serviceReady = false;
@@ -130,6 +164,180 @@ void PositioningServiceCore::setCurrentSpeed(double speed)
     }
 }
 
+void PositioningServiceCore::setGpsDevice(const QString& device, int baudRate)
+{
+    m_gpsDevice = device;
+    m_gpsBaudRate = baudRate;
+}
+
+bool PositioningServiceCore::hasGpsReceiver() const
+{
+    return m_gpsReader && m_gpsReader->isRunning();
+}
+
+void PositioningServiceCore::setCanDevice(const QString& device)
+{
+    m_canDevice = device;
+}
+
+bool PositioningServiceCore::hasVehicleData() const
+{
+    return m_canReader && m_canReader->isRunning();
+}
+
+bool PositioningServiceCore::isDeadReckoning() const
+{
+    return m_positioningMode == PositioningMode::DEAD_RECKONING;
+}
+
+void PositioningServiceCore::setRoadGraph(std::shared_ptr<const RoadGraph> graph)
+{
+    m_mapMatcher.reset();
+    if (!graph || graph->empty() || !m_mapMatchingEnabled) {
+        return;
+    }
+    
+    auto index = std::make_shared<SegmentIndex>();
+    if (!index->build(*graph)) {
+        qDebug() << "⚠️ [POSITIONING CORE] Road graph has no segments, map matching disabled";
+        return;
+    }
+    m_mapMatcher = std::make_unique<MapMatcher>(index);
+    qDebug() << "🌍 [POSITIONING CORE] Map matching on" << index->segmentCount() << "road segments"
+             << "(" << index->memoryBytes() / 1024 << "KB index)";
+}
+
+void PositioningServiceCore::loadFusionSettings()
+{
+    PositionFilterConfig filterConfig;
+    const std::string configPath = NavUtils::locateConfigFile();
+    if (!configPath.empty()) {
+        QSettings config(QString::fromStdString(configPath), QSettings::IniFormat);
+        m_updateRateHz = config.value("Positioning/position_update_rate_hz", m_updateRateHz).toInt();
+        filterConfig.gps_timeout_ms =
+            config.value("Positioning/gps_timeout_ms", filterConfig.gps_timeout_ms).toUInt();
+        filterConfig.dead_reckoning_timeout_ms =
+            config.value("Positioning/dead_reckoning_timeout_ms", filterConfig.dead_reckoning_timeout_ms).toUInt();
+        m_mapMatchingEnabled = config.value("Positioning/map_matching_enabled", m_mapMatchingEnabled).toBool();
+    }
+    m_updateRateHz = qBound(1, m_updateRateHz, 100);
+    m_filter = PositionFilter(filterConfig);
+}
+
+bool PositioningServiceCore::openGpsReceiver()
+{
+    if (m_gpsDevice.isEmpty()) {
+        const std::string configPath = NavUtils::locateConfigFile();
+        if (!configPath.empty()) {
+            QSettings config(QString::fromStdString(configPath), QSettings::IniFormat);
+            m_gpsDevice = config.value("Hardware/gps_device").toString();
+            m_gpsBaudRate = config.value("Hardware/gps_baud_rate", m_gpsBaudRate).toInt();
+        }
+    }
+    if (m_gpsDevice.isEmpty()) {
+        qDebug() << "⚠️ [POSITIONING CORE] No gps_device configured, using simulation";
+        return false;
+    }
+    
+    auto reader = std::make_unique<GpsSerialReader>();
+    if (!reader->open(m_gpsDevice.toStdString(), m_gpsBaudRate)) {
+        qDebug() << "⚠️ [POSITIONING CORE] GPS receiver unavailable:"
+                 << QString::fromStdString(reader->lastError()) << "- using simulation";
+        return false;
+    }
+    
+    // Coalesce wake-ups: one queued drain per burst of fixes
+    reader->setNotifier([this]() {
+        if (!m_gpsDrainPending.exchange(true)) {
+            QMetaObject::invokeMethod(this, [this]() { drainGpsFixes(); }, Qt::QueuedConnection);
+        }
+    });
+    reader->start();
+    m_gpsReader = std::move(reader);
+    
+    qDebug() << "🛰️ [POSITIONING CORE] Reading GPS from" << m_gpsDevice << "at" << m_gpsBaudRate << "baud";
+    return true;
+}
+
+bool PositioningServiceCore::openCanReader()
+{
+    if (m_canDevice.isEmpty()) {
+        const std::string configPath = NavUtils::locateConfigFile();
+        if (!configPath.empty()) {
+            QSettings config(QString::fromStdString(configPath), QSettings::IniFormat);
+            m_canDevice = config.value("Hardware/can_device").toString();
+        }
+    }
+    if (m_canDevice.isEmpty()) {
+        qDebug() << "⚠️ [POSITIONING CORE] No can_device configured, dead reckoning disabled";
+        return false;
+    }
+    
+    auto reader = std::make_unique<CanVehicleReader>();
+    if (!reader->open(m_canDevice.toStdString()) || !reader->start()) {
+        qDebug() << "⚠️ [POSITIONING CORE] CAN bus" << m_canDevice << "unavailable, dead reckoning disabled";
+        return false;
+    }
+    m_canReader = std::move(reader);
+    
+    qDebug() << "🚗 [POSITIONING CORE] Reading vehicle speed and yaw rate from" << m_canDevice;
+    return true;
+}
+
+void PositioningServiceCore::drainGpsFixes()
+{
+    m_gpsDrainPending.store(false);
+    if (!m_gpsReader || !m_serviceReady) {
+        return;
+    }
+    
+    // Bring the prediction up to date first so fixes land in time order
+    drainVehicleSamples();
+    
+    GpsData fix;
+    while (m_gpsReader->popFix(fix)) {
+        m_filter.correct(fix);
+    }
+}
+
+void PositioningServiceCore::drainVehicleSamples()
+{
+    if (!m_canReader) {
+        return;
+    }
+    VehicleData sample;
+    while (m_canReader->popSample(sample)) {
+        m_filter.predict(sample);
+    }
+}
+
+void PositioningServiceCore::publishFusedPosition()
+{
+    const FusedPosition fused = m_filter.estimate(NavUtils::getCurrentTimestampMs());
+    
+    if (m_filter.initialized() && fused.mode != m_positioningMode) {
+        m_positioningMode = fused.mode;
+        const bool deadReckoning = m_positioningMode == PositioningMode::DEAD_RECKONING;
+        qDebug() << (deadReckoning ? "⚠️ [POSITIONING CORE] GPS fix lost, dead reckoning"
+                                   : "🛰️ [POSITIONING CORE] GPS fix restored");
+        emit positioningModeChanged(deadReckoning);
+    }
+    if (!fused.valid) {
+        return;
+    }
+    
+    m_currentPosition = fused.position;
+    if (m_mapMatcher) {
+        const MatchResult matched = m_mapMatcher->match(fused.position, fused.heading_degrees, fused.speed_kmh);
+        if (matched.matched) {
+            m_currentPosition = matched.position;
+        }
+    }
+    m_currentHeading = fused.heading_degrees;
+    m_currentSpeed = fused.speed_kmh;
+    m_currentAltitude = fused.position.altitude;
+}
+
 bool PositioningServiceCore::isServiceReady() const
 {
     return m_serviceReady;
@@ -152,6 +360,11 @@ void PositioningServiceCore::updatePosition()
         return;
     }
     
+    if (m_fusionActive) {
+        drainVehicleSamples();
+        publishFusedPosition();
+    }
+    
     m_lastUpdate = QDateTime::currentDateTime();
     
     // Emit position update signals
@@ -2,8 +2,14 @@
 
 #include "navigation_models.h"
 #include "nav_messages.h"
+#include "astar_router.h"
+#include "contraction_hierarchy.h"
+#include <atomic>
+#include <map>
+#include <memory>
+#include <QMutex>
 #include <QObject>
-#include <QTimer>
+#include <QThreadPool>
 #include <vector>
 
 namespace nav {
@@ -11,6 +17,12 @@ namespace nav {
 /**
  * @brief Core routing service integrated into HMI
  * Provides route calculation and path planning
+ *
+ * calculateRouteAsync() runs searches on a small worker pool. Each request
+ * captures the graph, hierarchies and algorithm at submit time, so workers
+ * never read service state; results come back to the service thread as
+ * queued calls and are emitted there. A request for a new destination
+ * supersedes the ones still running.
  */
 class RoutingServiceCore : public QObject
 {
@@ -28,6 +40,25 @@ public:
     bool calculateRoute(const Point& start, const Point& end, RoutingCriteria criteria = RoutingCriteria::SHORTEST_TIME);
     bool calculateRouteAsync(const Point& start, const Point& end, RoutingCriteria criteria = RoutingCriteria::SHORTEST_TIME);
     void cancelRouteCalculation();
+    int pendingCalculations() const;
+    
+    // Number of search threads (default: cores - 1, at most 4)
+    void setWorkerCount(int count);
+    
+    // Road network used by the A* search; without one, routes fall back
+    // to straight-line interpolation
+    bool loadRoadNetwork(const std::vector<MapNode>& nodes, const std::vector<MapEdge>& edges);
+    void setRoadGraph(std::shared_ptr<const RoadGraph> graph);
+    bool hasRoadNetwork() const;
+    RouteQueryStats getLastQueryStats() const;
+    
+    // Preprocessed hierarchy for one metric (must match the road graph)
+    void setContractionHierarchy(std::shared_ptr<const ContractionHierarchy> hierarchy);
+    bool hasContractionHierarchy(RouteMetric metric) const;
+    
+    // Search algorithm used for route calculation (default ASTAR)
+    void setAlgorithm(RoutingAlgorithm algorithm);
+    RoutingAlgorithm getAlgorithm() const;
     
     // Route queries
     Route getCurrentRoute() const;
@@ -44,19 +75,54 @@ signals:
     void routeProgressChanged(double progress);
     void serviceStatusChanged(bool ready);
 
-private slots:
-    void performAsyncCalculation();
-
 private:
-    // Core routing algorithms
-    Route calculateShortestPath(const Point& start, const Point& end);
-    Route calculateFastestPath(const Point& start, const Point& end);
-    std::vector<Point> generateRoutePoints(const Point& start, const Point& end, int numPoints = 20);
+    // Search state for one thread; graph and hierarchies are shared read-only
+    struct RouterSet {
+        AStarRouter astar;
+        CHRouter chTime;
+        CHRouter chDistance;
+    };
+    
+    // Snapshot of everything a search needs
+    struct RouteRequest {
+        quint64 id;
+        Point start;
+        Point end;
+        RoutingCriteria criteria;
+        RoutingAlgorithm algorithm;
+        std::shared_ptr<const RoadGraph> graph;
+        std::shared_ptr<const ContractionHierarchy> chTime;
+        std::shared_ptr<const ContractionHierarchy> chDistance;
+        std::shared_ptr<std::atomic<bool>> cancelled;
+    };
+    
+    RouteRequest makeRequest(const Point& start, const Point& end, RoutingCriteria criteria);
+    bool applyRoute(const Route& route);
+    
+    // Worker side; results are handed back with finishAsyncCalculation()
+    void runAsyncCalculation(const RouteRequest& request);
+    void finishAsyncCalculation(quint64 requestId, const Route& route, const RouteQueryStats& stats);
+    
+    // Router sets are pooled so scratch arrays are allocated once per thread
+    std::unique_ptr<RouterSet> acquireRouters(const RouteRequest& request);
+    void releaseRouters(std::unique_ptr<RouterSet> routers);
+    
+    // Core routing algorithms (thread-safe: read only the request)
+    Route searchRoute(RouterSet& routers, const RouteRequest& request, RouteQueryStats& stats) const;
+    Route aStarAlgorithm(AStarRouter& router, const RouteRequest& request, RouteMetric metric,
+                         bool useHeuristic, RouteQueryStats& stats) const;
+    Route contractionHierarchyAlgorithm(CHRouter& router, const RouteRequest& request, RouteQueryStats& stats) const;
+    Route interpolatedRoute(const Point& start, const Point& end) const;
+    std::vector<Point> generateRoutePoints(const Point& start, const Point& end, int numPoints = 20) const;
     double calculateDistance(const Point& p1, const Point& p2) const;
     double calculateEstimatedTime(double distance, RoutingCriteria criteria) const;
     
-    // A* algorithm implementation
-    Route aStarAlgorithm(const Point& start, const Point& end);
+    // Routing data, captured into each request
+    std::shared_ptr<const RoadGraph> m_roadGraph;
+    std::shared_ptr<const ContractionHierarchy> m_chTime;
+    std::shared_ptr<const ContractionHierarchy> m_chDistance;
+    RoutingAlgorithm m_algorithm;
+    RouteQueryStats m_lastQueryStats;
     
     // Service state
     bool m_initialized;
@@ -65,12 +131,14 @@ private:
     bool m_hasActiveRoute;
     double m_routeProgress;
     
-    // Async calculation
-    QTimer* m_calculationTimer;
-    Point m_pendingStart;
+    // Async calculation; requests in flight by id with their cancel flags
+    QThreadPool m_workerPool;
+    std::map<quint64, std::shared_ptr<std::atomic<bool>>> m_activeRequests;
+    quint64 m_nextRequestId;
     Point m_pendingEnd;
-    RoutingCriteria m_pendingCriteria;
-    bool m_calculationInProgress;
+    
+    QMutex m_routerMutex;
+    std::vector<std::unique_ptr<RouterSet>> m_idleRouters;
 };
 
 } // namespace nav
\ No newline at end of file
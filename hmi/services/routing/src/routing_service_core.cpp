@@ -1,27 +1,30 @@
 #include "routing_service_core.h"
 #include <QDebug>
+#include <QMutexLocker>
 #include <QRandomGenerator>
+#include <QThread>
 #include <cmath>
+#include <iterator>
 
 namespace nav {
 
 RoutingServiceCore::RoutingServiceCore(QObject* parent)
     : QObject(parent)
+    , m_algorithm(RoutingAlgorithm::ASTAR)
     , m_initialized(false)
     , m_serviceReady(false)
     , m_hasActiveRoute(false)
     , m_routeProgress(0.0)
-    , m_calculationTimer(new QTimer(this))
-    , m_calculationInProgress(false)
+    , m_nextRequestId(1)
 {
-    // Setup async calculation timer
-    connect(m_calculationTimer, &QTimer::timeout, this, &RoutingServiceCore::performAsyncCalculation);
-    m_calculationTimer->setSingleShot(true);
+    // Leave a core for the UI; each worker keeps its own router scratch arrays
+    setWorkerCount(qBound(1, QThread::idealThreadCount() - 1, 4));
 }
 
 RoutingServiceCore::~RoutingServiceCore()
 {
     shutdown();
+    m_workerPool.waitForDone();
 }
 
 bool RoutingServiceCore::initialize()
@@ -36,12 +39,13 @@ bool RoutingServiceCore::initialize()
     m_currentRoute = Route{};
     m_hasActiveRoute = false;
     m_routeProgress = 0.0;
-    m_calculationInProgress = false;
+    m_activeRequests.clear();
     
     m_initialized = true;
     m_serviceReady = true;
     
-    qDebug() << "✅ [ROUTING CORE] Routing service initialized successfully";
+    qDebug() << "✅ [ROUTING CORE] Routing service initialized successfully with"
+             << m_workerPool.maxThreadCount() << "workers";
     emit serviceStatusChanged(true);
     
     return true;
@@ -56,6 +60,7 @@ void RoutingServiceCore::shutdown()
     qDebug() << "🗺️ [ROUTING CORE] Shutting down routing service...";
     
     cancelRouteCalculation();
+    m_workerPool.waitForDone();
     m_hasActiveRoute = false;
     m_initialized = false;
     m_serviceReady = false;
@@ -76,34 +81,12 @@ bool RoutingServiceCore::calculateRoute(const Point& start, const Point& end, Ro
              << start.latitude << "," << start.longitude
              << "to" << end.latitude << "," << end.longitude;
     
-    Route route;
+    const RouteRequest request = makeRequest(start, end, criteria);
+    std::unique_ptr<RouterSet> routers = acquireRouters(request);
+    const Route route = searchRoute(*routers, request, m_lastQueryStats);
+    releaseRouters(std::move(routers));
     
-    switch (criteria) {
-        case RoutingCriteria::SHORTEST_DISTANCE:
-            route = calculateShortestPath(start, end);
-            break;
-        case RoutingCriteria::SHORTEST_TIME:
-        default:
-            route = calculateFastestPath(start, end);
-            break;
-    }
-    
-    if (route.node_count > 0) {
-        m_currentRoute = route;
-        m_hasActiveRoute = true;
-        m_routeProgress = 0.0;
-        
-        qDebug() << "✅ [ROUTING CORE] Route calculated successfully:"
-                 << route.total_distance_meters << "meters,"
-                 << route.estimated_time_seconds << "seconds";
-        
-        emit routeCalculated(route);
-        return true;
-    } else {
-        qWarning() << "❌ [ROUTING CORE] Failed to calculate route";
-        emit routeCalculationFailed("Failed to find valid route");
-        return false;
-    }
+    return applyRoute(route);
 }
 
 bool RoutingServiceCore::calculateRouteAsync(const Point& start, const Point& end, RoutingCriteria criteria)
@@ -113,31 +96,49 @@ bool RoutingServiceCore::calculateRouteAsync(const Point& start, const Point& en
         return false;
     }
     
-    if (m_calculationInProgress) {
-        qWarning() << "⚠️ [ROUTING CORE] Calculation already in progress";
-        return false;
+    // A new destination makes every running search stale
+    if (!m_activeRequests.empty() &&
+        (end.latitude != m_pendingEnd.latitude || end.longitude != m_pendingEnd.longitude)) {
+        qDebug() << "🛑 [ROUTING CORE] Destination changed, superseding"
+                 << m_activeRequests.size() << "calculation(s)";
+        cancelRouteCalculation();
     }
     
-    qDebug() << "🚀 [ROUTING CORE] Starting async route calculation...";
-    
-    m_pendingStart = start;
+    RouteRequest request = makeRequest(start, end, criteria);
+    m_activeRequests[request.id] = request.cancelled;
     m_pendingEnd = end;
-    m_pendingCriteria = criteria;
-    m_calculationInProgress = true;
     
-    // Simulate calculation delay (500ms)
-    m_calculationTimer->start(500);
+    qDebug() << "🚀 [ROUTING CORE] Queued async route calculation" << request.id
+             << "(" << m_activeRequests.size() << "in flight)";
     
+    m_workerPool.start([this, request]() { runAsyncCalculation(request); });
     return true;
 }
 
 void RoutingServiceCore::cancelRouteCalculation()
 {
-    if (m_calculationInProgress) {
-        qDebug() << "🛑 [ROUTING CORE] Cancelling route calculation";
-        m_calculationTimer->stop();
-        m_calculationInProgress = false;
+    if (m_activeRequests.empty()) {
+        return;
     }
+    
+    qDebug() << "🛑 [ROUTING CORE] Cancelling" << m_activeRequests.size() << "route calculation(s)";
+    
+    // Workers notice the flag within a few hundred settled nodes; anything
+    // they still deliver is dropped because the id is no longer active
+    for (auto& active : m_activeRequests) {
+        active.second->store(true, std::memory_order_relaxed);
+    }
+    m_activeRequests.clear();
+}
+
+int RoutingServiceCore::pendingCalculations() const
+{
+    return static_cast<int>(m_activeRequests.size());
+}
+
+void RoutingServiceCore::setWorkerCount(int count)
+{
+    m_workerPool.setMaxThreadCount(qMax(1, count));
 }
 
 Route RoutingServiceCore::getCurrentRoute() const
@@ -168,7 +169,7 @@ QString RoutingServiceCore::getServiceStatus() const
     if (!m_serviceReady) {
         return "Not Ready";
     }
-    if (m_calculationInProgress) {
+    if (!m_activeRequests.empty()) {
         return "Calculating Route...";
     }
     if (m_hasActiveRoute) {
@@ -177,35 +178,272 @@ QString RoutingServiceCore::getServiceStatus() const
     return "Ready";
 }
 
-void RoutingServiceCore::performAsyncCalculation()
+RoutingServiceCore::RouteRequest RoutingServiceCore::makeRequest(const Point& start, const Point& end, RoutingCriteria criteria)
+{
+    RouteRequest request;
+    request.id = m_nextRequestId++;
+    request.start = start;
+    request.end = end;
+    request.criteria = criteria;
+    request.algorithm = m_algorithm;
+    request.graph = m_roadGraph;
+    request.chTime = m_chTime;
+    request.chDistance = m_chDistance;
+    request.cancelled = std::make_shared<std::atomic<bool>>(false);
+    return request;
+}
+
+bool RoutingServiceCore::applyRoute(const Route& route)
+{
+    if (route.node_count > 0) {
+        m_currentRoute = route;
+        m_hasActiveRoute = true;
+        m_routeProgress = 0.0;
+        
+        qDebug() << "✅ [ROUTING CORE] Route calculated successfully:"
+                 << route.total_distance_meters << "meters,"
+                 << route.estimated_time_seconds << "seconds";
+        
+        emit routeCalculated(route);
+        return true;
+    } else {
+        qWarning() << "❌ [ROUTING CORE] Failed to calculate route";
+        emit routeCalculationFailed("Failed to find valid route");
+        return false;
+    }
+}
+
+void RoutingServiceCore::runAsyncCalculation(const RouteRequest& request)
+{
+    // Superseded before a worker picked it up
+    if (request.cancelled->load(std::memory_order_relaxed)) {
+        return;
+    }
+    
+    qDebug() << "⚡ [ROUTING CORE] Worker running route calculation" << request.id;
+    
+    RouteQueryStats stats;
+    std::unique_ptr<RouterSet> routers = acquireRouters(request);
+    const Route route = searchRoute(*routers, request, stats);
+    releaseRouters(std::move(routers));
+    
+    if (request.cancelled->load(std::memory_order_relaxed)) {
+        qDebug() << "🛑 [ROUTING CORE] Route calculation" << request.id << "cancelled after"
+                 << stats.settled_nodes << "settled nodes";
+        return;
+    }
+    
+    const quint64 requestId = request.id;
+    QMetaObject::invokeMethod(this, [this, requestId, route, stats]() {
+        finishAsyncCalculation(requestId, route, stats);
+    }, Qt::QueuedConnection);
+}
+
+void RoutingServiceCore::finishAsyncCalculation(quint64 requestId, const Route& route, const RouteQueryStats& stats)
+{
+    // Cancelled or superseded while the result was in the event queue
+    auto it = m_activeRequests.find(requestId);
+    if (it == m_activeRequests.end()) {
+        return;
+    }
+    
+    // Requests issued earlier would only overwrite this newer route
+    for (auto older = m_activeRequests.begin(); older != it; ++older) {
+        older->second->store(true, std::memory_order_relaxed);
+    }
+    m_activeRequests.erase(m_activeRequests.begin(), std::next(it));
+    
+    m_lastQueryStats = stats;
+    applyRoute(route);
+}
+
+std::unique_ptr<RoutingServiceCore::RouterSet> RoutingServiceCore::acquireRouters(const RouteRequest& request)
+{
+    std::unique_ptr<RouterSet> routers;
+    {
+        QMutexLocker locker(&m_routerMutex);
+        if (!m_idleRouters.empty()) {
+            routers = std::move(m_idleRouters.back());
+            m_idleRouters.pop_back();
+        }
+    }
+    if (!routers) {
+        routers = std::make_unique<RouterSet>();
+    }
+    
+    // Re-point only when the routing data changed since this set was used
+    if (routers->astar.graph() != request.graph) {
+        routers->astar.setGraph(request.graph);
+    }
+    if (routers->chTime.hierarchy() != request.chTime) {
+        routers->chTime.setHierarchy(request.graph, request.chTime);
+    }
+    if (routers->chDistance.hierarchy() != request.chDistance) {
+        routers->chDistance.setHierarchy(request.graph, request.chDistance);
+    }
+    routers->astar.setCancelFlag(request.cancelled.get());
+    return routers;
+}
+
+void RoutingServiceCore::releaseRouters(std::unique_ptr<RouterSet> routers)
+{
+    routers->astar.setCancelFlag(nullptr);
+    
+    QMutexLocker locker(&m_routerMutex);
+    m_idleRouters.push_back(std::move(routers));
+}
+
+bool RoutingServiceCore::loadRoadNetwork(const std::vector<MapNode>& nodes, const std::vector<MapEdge>& edges)
+{
+    auto graph = std::make_shared<RoadGraph>();
+    if (!graph->build(nodes, edges)) {
+        qWarning() << "❌ [ROUTING CORE] Failed to build road network";
+        return false;
+    }
+    
+    // Hierarchies of a previous graph no longer apply
+    m_roadGraph = std::move(graph);
+    m_chTime.reset();
+    m_chDistance.reset();
+    
+    qDebug() << "🗺️ [ROUTING CORE] Road network loaded:" << m_roadGraph->nodeCount()
+             << "nodes," << m_roadGraph->arcCount() << "arcs";
+    return true;
+}
+
+void RoutingServiceCore::setRoadGraph(std::shared_ptr<const RoadGraph> graph)
 {
-    qDebug() << "⚡ [ROUTING CORE] Performing async route calculation...";
+    m_roadGraph = std::move(graph);
+    m_chTime.reset();
+    m_chDistance.reset();
     
-    bool success = calculateRoute(m_pendingStart, m_pendingEnd, m_pendingCriteria);
-    m_calculationInProgress = false;
+    qDebug() << "🗺️ [ROUTING CORE] Road network attached:"
+             << (m_roadGraph ? m_roadGraph->nodeCount() : 0) << "nodes,"
+             << (m_roadGraph ? m_roadGraph->arcCount() : 0) << "arcs";
+}
+
+bool RoutingServiceCore::hasRoadNetwork() const
+{
+    return m_roadGraph && m_roadGraph->nodeCount() > 0;
+}
+
+RouteQueryStats RoutingServiceCore::getLastQueryStats() const
+{
+    return m_lastQueryStats;
+}
+
+void RoutingServiceCore::setContractionHierarchy(std::shared_ptr<const ContractionHierarchy> hierarchy)
+{
+    if (!hierarchy || !hasRoadNetwork() || hierarchy->nodeCount() != m_roadGraph->nodeCount()) {
+        qWarning() << "❌ [ROUTING CORE] Contraction hierarchy does not match road network";
+        return;
+    }
     
-    if (!success) {
-        emit routeCalculationFailed("Async calculation failed");
+    const RouteMetric metric = hierarchy->metric();
+    if (metric == RouteMetric::DISTANCE) {
+        m_chDistance = std::move(hierarchy);
+    } else {
+        m_chTime = std::move(hierarchy);
     }
+    
+    qDebug() << "🗺️ [ROUTING CORE] Contraction hierarchy attached for"
+             << (metric == RouteMetric::DISTANCE ? "distance" : "travel time");
+}
+
+bool RoutingServiceCore::hasContractionHierarchy(RouteMetric metric) const
+{
+    const auto& hierarchy = (metric == RouteMetric::DISTANCE) ? m_chDistance : m_chTime;
+    return hierarchy && !hierarchy->empty();
+}
+
+void RoutingServiceCore::setAlgorithm(RoutingAlgorithm algorithm)
+{
+    m_algorithm = algorithm;
 }
 
-Route RoutingServiceCore::calculateShortestPath(const Point& start, const Point& end)
+RoutingAlgorithm RoutingServiceCore::getAlgorithm() const
 {
-    qDebug() << "🧮 [ROUTING CORE] Using shortest distance algorithm";
-    return aStarAlgorithm(start, end);
+    return m_algorithm;
+}
+
+Route RoutingServiceCore::searchRoute(RouterSet& routers, const RouteRequest& request, RouteQueryStats& stats) const
+{
+    stats = RouteQueryStats();
+    if (routers.astar.empty()) {
+        qDebug() << "⚠️ [ROUTING CORE] No road network loaded, using straight-line route";
+        return interpolatedRoute(request.start, request.end);
+    }
+    
+    RouteMetric metric = RouteMetric::TRAVEL_TIME;
+    if (request.criteria == RoutingCriteria::SHORTEST_DISTANCE) {
+        qDebug() << "🧮 [ROUTING CORE] Using shortest distance algorithm";
+        metric = RouteMetric::DISTANCE;
+    } else {
+        qDebug() << "🧮 [ROUTING CORE] Using fastest time algorithm";
+    }
+    
+    switch (request.algorithm) {
+        case RoutingAlgorithm::CONTRACTION_HIERARCHY: {
+            CHRouter& ch = (metric == RouteMetric::DISTANCE) ? routers.chDistance : routers.chTime;
+            if (!ch.empty()) {
+                return contractionHierarchyAlgorithm(ch, request, stats);
+            }
+            qDebug() << "⚠️ [ROUTING CORE] No contraction hierarchy for this metric, using A*";
+            return aStarAlgorithm(routers.astar, request, metric, true, stats);
+        }
+        case RoutingAlgorithm::DIJKSTRA:
+            return aStarAlgorithm(routers.astar, request, metric, false, stats);
+        case RoutingAlgorithm::ASTAR:
+        default:
+            return aStarAlgorithm(routers.astar, request, metric, true, stats);
+    }
 }
 
-Route RoutingServiceCore::calculateFastestPath(const Point& start, const Point& end)
+Route RoutingServiceCore::aStarAlgorithm(AStarRouter& router, const RouteRequest& request, RouteMetric metric,
+                                         bool useHeuristic, RouteQueryStats& stats) const
 {
-    qDebug() << "🧮 [ROUTING CORE] Using fastest time algorithm";
-    return aStarAlgorithm(start, end);
+    const char* name = useHeuristic ? "A*" : "Dijkstra";
+    
+    Route route;
+    route.route_id = QRandomGenerator::global()->bounded(1000, 9999);
+    
+    const bool found = router.calculateRoute(request.start, request.end, metric, route, useHeuristic);
+    stats = router.lastQueryStats();
+    if (!found) {
+        qWarning() << "❌ [ROUTING CORE]" << name << "found no path, settled"
+                   << stats.settled_nodes << "nodes";
+        return Route{};
+    }
+    
+    qDebug() << "🧮 [CORE ALGORITHM]" << name << "settled" << stats.settled_nodes << "nodes,"
+             << "relaxed" << stats.relaxed_edges << "edges in" << stats.query_time_ms << "ms";
+    qDebug() << "📡 [RESPONSE API] Route calculated with" << route.node_count << "nodes";
+    
+    return route;
 }
 
-Route RoutingServiceCore::aStarAlgorithm(const Point& start, const Point& end)
+Route RoutingServiceCore::contractionHierarchyAlgorithm(CHRouter& router, const RouteRequest& request, RouteQueryStats& stats) const
 {
-    qDebug() << "🔥 [ROUTING CORE API CALLED] A* Algorithm executing!";
-    qDebug() << "🧮 [CORE ALGORITHM] calculateRoute() MAIN ALGORITHM EXECUTING!";
+    Route route;
+    route.route_id = QRandomGenerator::global()->bounded(1000, 9999);
+    
+    const bool found = router.calculateRoute(request.start, request.end, route);
+    stats = router.lastQueryStats();
+    if (!found) {
+        qWarning() << "❌ [ROUTING CORE] CH query found no path, settled"
+                   << stats.settled_nodes << "nodes";
+        return Route{};
+    }
+    
+    qDebug() << "🧮 [CORE ALGORITHM] CH settled" << stats.settled_nodes << "nodes,"
+             << "relaxed" << stats.relaxed_edges << "edges in" << stats.query_time_ms << "ms";
+    qDebug() << "📡 [RESPONSE API] Route calculated with" << route.node_count << "nodes";
     
+    return route;
+}
+
+Route RoutingServiceCore::interpolatedRoute(const Point& start, const Point& end) const
+{
     Route route;
     route.route_id = QRandomGenerator::global()->bounded(1000, 9999);
     route.total_distance_meters = calculateDistance(start, end);
@@ -219,13 +457,10 @@ Route RoutingServiceCore::aStarAlgorithm(const Point& start, const Point& end)
         route.nodes[i] = static_cast<uint32_t>(i + 1);
     }
     
-    qDebug() << "🧮 [CORE ALGORITHM] ✅ ROUTE CALCULATION ALGORITHM COMPLETED SUCCESSFULLY!";
-    qDebug() << "📡 [RESPONSE API] Route calculated with" << route.node_count << "nodes";
-    
     return route;
 }
 
-std::vector<Point> RoutingServiceCore::generateRoutePoints(const Point& start, const Point& end, int numPoints)
+std::vector<Point> RoutingServiceCore::generateRoutePoints(const Point& start, const Point& end, int numPoints) const
 {
     std::vector<Point> points;
     points.push_back(start);
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <QImage>
+#include <QRectF>
+#include <QString>
+#include <functional>
+#include <mutex>
+
+#include "nav_utils.h"
+#include "tile_loader.h"
+#include "tile_pack.h"
+
+class QPainter;
+
+namespace nav {
+
+// Stored in the pack under INFO_KEY; a different source means a new pyramid
+struct BasemapPyramidInfo {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t width;          // Source image, pixels
+    uint32_t height;
+    uint32_t levels;         // The last level is full resolution, level 0 fits one tile
+    uint32_t sourceCrc32;    // Of the encoded source file (or the placeholder's pixels)
+};
+
+/**
+ * @brief Multi-resolution tile pyramid of one basemap image
+ *
+ * On first use the source image is decoded once and cut into TILE_SIZE
+ * tiles at full resolution and at every halving down to a single tile. The
+ * tiles are encoded into a tile pack (tile key z is the pyramid level), so
+ * later runs open the pack and never decode the whole image again.
+ *
+ * draw() covers the visible part of the image with the tiles of the level
+ * whose resolution just matches the screen, so a frame touches about a
+ * screenful of pixels at every zoom. Tiles not decoded yet are requested
+ * from a TileLoader and drawn meanwhile from the nearest coarser level in
+ * the cache. Decoded tiles sit in an LRU cache with a byte budget.
+ *
+ * prepare(), collect() and draw() must not run concurrently with each
+ * other; MapWidget calls them all from its render worker.
+ */
+class BasemapPyramid
+{
+public:
+    BasemapPyramid();
+    ~BasemapPyramid();
+    BasemapPyramid(const BasemapPyramid&) = delete;
+    BasemapPyramid& operator=(const BasemapPyramid&) = delete;
+
+    // Runs on a decode thread when decoded tiles are waiting for collect()
+    void setNotifier(std::function<void()> notifier) { m_notifier = std::move(notifier); }
+    void setCacheBudget(size_t bytes) { m_cache.setCapacity(bytes); }
+
+    // Opens the pyramid at packPath, cutting it from sourcePath first if the pack
+    // is missing or was cut from something else; fallback is used if the source
+    // cannot be read
+    bool prepare(const QString& packPath, const QString& sourcePath, const QImage& fallback);
+    void close();
+    bool isReady() const { return m_ready; }
+
+    QSize sourceSize() const { return QSize(m_info.width, m_info.height); }
+    int levelCount() const { return static_cast<int>(m_info.levels); }
+    QSize levelSize(int level) const;
+
+    // Moves decoded tiles into the cache; returns how many
+    size_t collect();
+
+    // Draws the tiles meeting clip of the image placed at imageRect; returns
+    // how many were not decoded yet (requested, and covered by a coarser tile)
+    int draw(QPainter& painter, const QRectF& imageRect, const QRectF& clip);
+
+    size_t cachedBytes() const { return m_cache.cost(); }
+
+    static constexpr int TILE_SIZE = 256;
+    static constexpr int JPEG_QUALITY = 90;
+    static constexpr unsigned DECODE_THREADS = 2;
+    static constexpr uint32_t INFO_MAGIC = 0x50414d42;   // "BMAP"
+    static constexpr uint32_t INFO_VERSION = 1;
+
+private:
+    bool cut(const QImage& source, uint32_t sourceCrc32);
+    bool decodeTile(const TileKey& key, std::vector<uint8_t>& pixels);
+    QSize tileSize(const TileKey& key) const;
+
+    TilePack m_pack;
+    std::mutex m_packMutex;                  // find() from the decode threads
+    TileLoader m_loader;
+    std::function<void()> m_notifier;
+    LRUCache<uint64_t, QImage> m_cache;      // Decoded tiles by TileKey::pack(), cost in bytes
+    BasemapPyramidInfo m_info;
+    bool m_ready;
+};
+
+} // namespace nav
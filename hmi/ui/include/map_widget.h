@@ -2,18 +2,26 @@
 
 #include <QWidget>
 #include <QPixmap>
+#include <QImage>
+#include <QThreadPool>
 #include <QPoint>
 #include <QMouseEvent>
 #include <QPaintEvent>
 #include <QWheelEvent>
 #include <QKeyEvent>
 #include <QTimer>
+#include <QElapsedTimer>
 #include <QPropertyAnimation>
 #include <QGraphicsEffect>
 #include <QSettings>
+#include <atomic>
+#include <memory>
 #include <vector>
 
+#include "basemap_pyramid.h"
 #include "nav_types.h"
+#include "route_path_cache.h"
+#include "view_transform.h"
 
 namespace nav {
 
@@ -36,6 +44,18 @@ public:
     };
     Q_ENUM(MapStyle)
 
+    // Cost of the phases of the last frame, in milliseconds
+    struct FrameTimings {
+        double mapMs;                         // Render worker: basemap tiles
+        double gridMs;                        // Render worker: coordinate grid
+        double routeMs;                       // Render worker: route line and arrows
+        double renderMs;                      // Render worker: whole background frame
+        double waypointsMs;                   // GUI thread: start and end markers
+        double markersMs;                     // GUI thread: position and clicked point
+        double overlaysMs;                    // GUI thread: scale bar, info and copyright
+        double paintMs;                       // GUI thread: whole paintEvent
+    };
+
     explicit MapWidget(QWidget *parent = nullptr);
     ~MapWidget();
 
@@ -75,47 +95,136 @@ public:
     void loadSettings();
     void saveSettings();
 
+    // Time the render worker took for the last completed frame
+    double lastFrameRenderTime() const { return m_frameTimings.renderMs; }
+
+    // Render worker phases of the last completed frame, GUI phases of the last paint
+    const FrameTimings& lastFrameTimings() const { return m_frameTimings; }
+
+    // True if the shown frame is for the current view and no frame is rendering
+    bool isFrameCurrent() const;
+
+    // True while the map is dragged or gliding after a fling
+    bool isPanning() const;
+
+    // p50/p99 frame and paint times in the top-left corner
+    void setShowFrameStats(bool show);
+    bool showFrameStats() const { return m_showFrameStats; }
+
+    // Geographic area the widget currently shows
+    BoundingBox visibleArea() const;
+
 signals:
     void mapClicked(const Point& position);
     void mapDoubleClicked(const Point& position);
     void mousePositionChanged(const Point& position);
     void zoomChanged(int newZoom);
     void centerChanged(double lat, double lon);
+    // Center, zoom or size changed; at most once per event loop pass
+    void viewportChanged(const BoundingBox& visible);
+    void frameRendered(double renderMs);
 
 protected:
     void paintEvent(QPaintEvent *event) override;
     void mousePressEvent(QMouseEvent *event) override;
     void mouseDoubleClickEvent(QMouseEvent *event) override;
     void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
     void wheelEvent(QWheelEvent *event) override;
     void keyPressEvent(QKeyEvent *event) override;
     void resizeEvent(QResizeEvent *event) override;
 
 private slots:
     void onAnimationFinished();
+    void onKineticPanTick();
+    void onViewportTimer();
 
 private:
-    // Map rendering
-    void drawMap(QPainter& painter);
-    void drawGrid(QPainter& painter);
-    void drawRoute(QPainter& painter);
+    // What a background frame is rendered for; any change means a new frame
+    struct ViewState {
+        ViewTransform transform;              // Center, zoom and size
+        qreal pixelRatio;
+        MapStyle style;
+        bool showGrid;
+        quint64 routeRevision;
+        quint64 basemapRevision;
+
+        bool operator==(const ViewState& other) const {
+            return transform == other.transform && pixelRatio == other.pixelRatio && style == other.style &&
+                   showGrid == other.showGrid && routeRevision == other.routeRevision &&
+                   basemapRevision == other.basemapRevision;
+        }
+        bool operator!=(const ViewState& other) const { return !(*this == other); }
+
+        // Same scale and size: a frame for other can be shown shifted
+        bool canShift(const ViewState& other) const {
+            return transform.zoom() == other.transform.zoom() && transform.size() == other.transform.size() &&
+                   pixelRatio == other.pixelRatio;
+        }
+
+        // Only the center differs: a frame for other is this one shifted
+        bool isPanOf(const ViewState& other) const {
+            return canShift(other) && style == other.style && showGrid == other.showGrid &&
+                   routeRevision == other.routeRevision && basemapRevision == other.basemapRevision;
+        }
+
+        // Where a frame rendered for other goes in this view, in widget pixels
+        QPointF shiftFrom(const ViewState& other) const {
+            return other.transform.viewport().topLeft() - transform.viewport().topLeft();
+        }
+    };
+
+    // Everything the render worker needs, copied so it never touches the widget
+    struct FrameJob {
+        ViewState view;
+        BasemapPyramid* basemap;              // Null until the first pyramid is open
+        Point mapTopLeft;
+        Point mapBottomRight;
+        std::shared_ptr<const std::vector<Point>> route;
+        RoutePathCache* routeCache;
+        std::shared_ptr<std::atomic<bool>> cancelled;
+        QImage previous;                      // While panning: the last frame, reused shifted
+        QPointF previousOffset;               // Where it goes, whole device pixels
+    };
+
+    // Recent frame times for the frame stats overlay
+    struct FrameTimeHistory {
+        std::vector<double> samples;          // Ring of the last FRAME_STATS_SAMPLES
+        size_t next = 0;
+
+        void add(double ms);
+        double percentile(double p) const;
+    };
+
+    // Background frame rendering (render worker)
+    void requestFrame();
+    void finishFrame(QImage frame, const ViewState& view, bool completed, bool patched, const FrameTimings& timings);
+    bool needsFrame(const ViewState& view) const;
+    static bool renderFrame(const FrameJob& job, QImage& target, FrameTimings& timings);
+    static void drawMap(QPainter& painter, const FrameJob& job, const QRegion& area);
+    static void drawGrid(QPainter& painter, const ViewTransform& transform);
+    static bool drawRoute(QPainter& painter, const FrameJob& job);
+    static void drawDirectionArrows(QPainter& painter, const FrameJob& job);
+
+    // Marker and overlay rendering (GUI thread)
     void drawWaypoints(QPainter& painter);
     void drawCurrentPosition(QPainter& painter);
     void drawClickedPoint(QPainter& painter);
     void drawHeadingIndicator(QPainter& painter, const QPoint& center);
-    void drawDirectionArrows(QPainter& painter);
     void drawMapOverlays(QPainter& painter);
     void drawScaleBar(QPainter& painter);
     void drawCoordinateInfo(QPainter& painter);
     void drawCopyright(QPainter& painter);
+    void drawFrameStats(QPainter& painter);
 
     // Map image management
     void loadMapImages();
-    QPixmap getCurrentMapImage() const;
-    QPixmap getMapImageForStyle(MapStyle style) const;
     void updateMapCache();
+    static QString mapResourcePath(MapStyle style);
+    static QImage createPlaceholderMap(MapStyle style);
 
     // Coordinate conversion
+    const ViewTransform& viewTransform() const;
     QPoint geoToScreen(const Point& geoPoint) const;
     Point screenToGeo(const QPoint& screenPoint) const;
     QPoint geoToMap(const Point& geoPoint) const;
@@ -126,19 +235,36 @@ private:
     double calculateBearing(const Point& from, const Point& to) const;
     QRect getVisibleBounds() const;
     bool isPointVisible(const Point& point) const;
+    QRect positionMarkerRect(const Point& position) const;
+    void panBy(const QPoint& delta);
+    ViewState currentViewState() const;
+    void scheduleViewportChanged();
 
     // Map data
     double m_centerLat;
     double m_centerLon;
     int m_zoomLevel;
     MapStyle m_currentMapStyle;
+    mutable ViewTransform m_viewTransform;    // Follows center, zoom and size on use
     
-    // Map images
-    QPixmap m_satelliteMap;
-    QPixmap m_streetMap;
-    QPixmap m_hybridMap;
-    QPixmap m_currentMapCache;
+    // Map image of the current style, drawn tile by tile from a pyramid
+    BasemapPyramid m_basemap;                 // Only used by the render worker
+    QString m_basemapCacheDir;                // Where the pyramids are cut to
+    std::atomic<int> m_requestedMapStyle;     // Style of the newest pyramid job
+    quint64 m_basemapRevision;                // Bumped when a pyramid opens or tiles decode
     bool m_mapImagesLoaded;
+    
+    // Background, map image, grid and route; front is shown, back is reused by the worker
+    QImage m_frontFrame;
+    QImage m_backFrame;
+    ViewState m_frontView;
+    bool m_frontFramePatched;                 // Reused shifted plus exposed strips: redo after the pan
+    ViewState m_renderingView;                // Valid while a frame is in flight
+    std::shared_ptr<std::atomic<bool>> m_frameCancel;   // Set while a frame is in flight
+    QThreadPool m_renderPool;
+    FrameTimings m_frameTimings;
+    FrameTimeHistory m_renderTimes;
+    FrameTimeHistory m_paintTimes;
 
     // Navigation elements
     Point m_currentPosition;
@@ -155,7 +281,9 @@ private:
     QString m_poiLabel;
     bool m_hasPOILabel;
     
-    std::vector<Point> m_routePoints;
+    std::shared_ptr<const std::vector<Point>> m_routePoints;   // Shared with the render worker
+    quint64 m_routeRevision;                  // Bumped on every route change
+    RoutePathCache m_routePathCache;          // Only used by the render worker
 
     // Map bounds (for map images)
     Point m_mapTopLeft;
@@ -165,6 +293,15 @@ private:
     bool m_dragging;
     QPoint m_lastPanPoint;
     
+    // Kinetic panning after a fling
+    QTimer* m_kineticTimer;
+    QPointF m_panVelocity;                    // Pixels per millisecond
+    QPointF m_panRemainder;                   // Sub-pixel part not moved yet
+    QElapsedTimer m_panClock;                 // Since the last drag move or kinetic tick
+    
+    // Fires viewportChanged once for a burst of center, zoom and size changes
+    QTimer* m_viewportTimer;
+    
     // Animation
     QPropertyAnimation* m_centerAnimation;
     QPropertyAnimation* m_zoomAnimation;
@@ -174,11 +311,14 @@ private:
     bool m_showCoordinates;
     bool m_showScale;
     bool m_showCopyright;
+    bool m_showFrameStats;
     
     // Constants
     static const int MIN_ZOOM = 5;
     static const int MAX_ZOOM = 20;
     static const int DEFAULT_ZOOM = 12;
+    static const int FRAME_STATS_SAMPLES = 240;
+    static const int KINETIC_FRAME_MS = 16;                  // Kinetic pan tick, ~60 fps
     
     // Static methods to get constants
     static double getDefaultLat() { return 21.028511; }  // Hanoi
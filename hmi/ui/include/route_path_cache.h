@@ -0,0 +1,85 @@
+#pragma once
+
+#include <QPainterPath>
+#include <QPointF>
+#include <QRectF>
+#include <memory>
+#include <vector>
+
+#include "nav_types.h"
+
+namespace nav {
+
+/**
+ * @brief Level-of-detail geometry for drawing a route polyline
+ *
+ * The route is projected once to Web-Mercator world coordinates. For each
+ * zoom level they are scaled to world pixels - widget pixels before the
+ * view offset, see ViewTransform::viewport() - and simplified with
+ * Douglas-Peucker to a sub-pixel tolerance, so a route of any length costs
+ * about as many points as it has visible bends. The simplified line is
+ * split into chunks with bounding boxes: path() returns
+ * one QPainterPath of the chunks that meet the viewport, reused as long as
+ * the same chunks stay visible, and arrowPath() the direction arrows on it,
+ * placed every ARROW_SPACING_PX along the route.
+ *
+ * Not thread-safe; MapWidget only uses it from the render worker.
+ */
+class RoutePathCache
+{
+public:
+    // Route to draw; a different route (by pointer) drops every cached level
+    void setRoute(const std::shared_ptr<const std::vector<Point>>& route);
+    void clear();
+
+    // Route line and arrows meeting viewport, both in world pixels
+    const QPainterPath& path(int zoom, const QRectF& viewport);
+    const QPainterPath& arrowPath(int zoom, const QRectF& viewport);
+
+    // Points left after simplification at this zoom
+    size_t simplifiedSize(int zoom);
+
+    static constexpr double TOLERANCE_PX = 0.5;      // Douglas-Peucker tolerance
+    static constexpr size_t CHUNK_POINTS = 128;      // Simplified points per clipping chunk
+    static constexpr double ARROW_SPACING_PX = 100.0;
+    static constexpr size_t MAX_LEVELS = 4;          // Zoom levels kept, oldest dropped first
+
+private:
+    struct Arrow {
+        QPointF position;
+        double dx;          // Unit direction of travel
+        double dy;
+    };
+
+    struct Chunk {
+        size_t first;       // Index of the first point; chunks share their end points
+        size_t last;
+        QRectF bounds;
+        size_t firstArrow;
+        size_t lastArrow;   // One past the end
+    };
+
+    struct Level {
+        int zoom;
+        std::vector<QPointF> points;
+        std::vector<Chunk> chunks;
+        std::vector<Arrow> arrows;
+
+        // What was visible last time, and the paths built for it
+        std::vector<size_t> visibleChunks;
+        QPainterPath path;
+        QPainterPath arrowPath;
+        bool pathsValid;
+    };
+
+    Level& level(int zoom);
+    void buildLevel(Level& level) const;
+    void updateVisible(Level& level, const QRectF& viewport);
+
+    std::shared_ptr<const std::vector<Point>> m_route;
+    std::vector<double> m_worldX;                    // ViewTransform world coordinates
+    std::vector<double> m_worldY;
+    std::vector<std::unique_ptr<Level>> m_levels;   // Most recently used last
+};
+
+} // namespace nav
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <QPointF>
+#include <QRectF>
+#include <QSize>
+#include <vector>
+
+#include "array_view.h"
+#include "nav_types.h"
+
+namespace nav {
+
+/**
+ * @brief Web-Mercator projection between geographic and widget pixels
+ *
+ * Uses the tile pyramid's projection (tile_key.h), so zoom levels are tile
+ * zoom levels: the world is 256 * 2^zoom pixels wide. Geographic points go
+ * to zoom-independent world coordinates (Mercator pixels at zoom 0) - the
+ * expensive, transcendental part - and from there to widget pixels by an
+ * affine map that is recomputed only when center, zoom or size change.
+ *
+ * Data drawn every frame should keep its world coordinates (toWorld()) and
+ * scale them with toPixels(), a plain multiply loop over separate x and y
+ * arrays that the compiler vectorizes.
+ */
+class ViewTransform
+{
+public:
+    ViewTransform();
+    ViewTransform(double centerLat, double centerLon, int zoom, const QSize& size);
+
+    // Recomputes the affine part if center, zoom or size changed; true if they did
+    bool update(double centerLat, double centerLon, int zoom, const QSize& size);
+
+    double centerLatitude() const { return m_centerLat; }
+    double centerLongitude() const { return m_centerLon; }
+    int zoom() const { return m_zoom; }
+    const QSize& size() const { return m_size; }
+
+    // Widget pixels per world unit (2^zoom)
+    double scale() const { return m_scale; }
+
+    // The widget's area in world pixels at this zoom (world coordinates * scale())
+    QRectF viewport() const;
+
+    // Single points
+    QPointF project(const Point& point) const;
+    Point unproject(const QPointF& pixel) const;
+
+    // Zoom-independent world coordinates (Web-Mercator pixels at zoom 0)
+    static void toWorld(const Point& point, double& worldX, double& worldY);
+    static void toWorld(ArrayView<Point> points, std::vector<double>& worldX, std::vector<double>& worldY);
+
+    // World coordinates to world pixels at zoom (the space of viewport()); out is resized to the points
+    static void toPixels(ArrayView<double> worldX, ArrayView<double> worldY, int zoom, std::vector<QPointF>& out);
+
+    bool operator==(const ViewTransform& other) const {
+        return m_centerLat == other.m_centerLat && m_centerLon == other.m_centerLon && m_zoom == other.m_zoom &&
+               m_size == other.m_size;
+    }
+    bool operator!=(const ViewTransform& other) const { return !(*this == other); }
+
+private:
+    void recompute();
+
+    double m_centerLat;
+    double m_centerLon;
+    int m_zoom;
+    QSize m_size;
+
+    // pixel = world * m_scale - m_offset
+    double m_scale;
+    double m_offsetX;
+    double m_offsetY;
+};
+
+} // namespace nav
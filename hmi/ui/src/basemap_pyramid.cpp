@@ -0,0 +1,289 @@
+#include "../include/basemap_pyramid.h"
+#include "map_file.h"
+#include <QBuffer>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QPainter>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace nav {
+
+namespace {
+
+// Above every pyramid level (a level has at most 2^level tiles per side)
+const TileKey INFO_KEY(TileKey::MAX_ZOOM, 0, 0);
+
+const size_t DEFAULT_CACHE_BYTES = 32 * 1024 * 1024;
+
+// Draws the part of target inside clip, taking the matching part of source
+void drawClipped(QPainter& painter, const QRectF& target, const QImage& image, const QRectF& source,
+                 const QRectF& clip)
+{
+    const QRectF visible = target.intersected(clip);
+    if (visible.isEmpty()) {
+        return;
+    }
+    const double sx = source.width() / target.width();
+    const double sy = source.height() / target.height();
+    painter.drawImage(visible, image,
+                      QRectF(source.left() + (visible.left() - target.left()) * sx,
+                             source.top() + (visible.top() - target.top()) * sy,
+                             visible.width() * sx, visible.height() * sy));
+}
+
+} // namespace
+
+BasemapPyramid::BasemapPyramid()
+    : m_cache(DEFAULT_CACHE_BYTES)
+    , m_info()
+    , m_ready(false)
+{
+}
+
+BasemapPyramid::~BasemapPyramid()
+{
+    close();
+}
+
+bool BasemapPyramid::prepare(const QString& packPath, const QString& sourcePath, const QImage& fallback)
+{
+    close();
+
+    // Fingerprint the source without decoding it
+    QByteArray encoded;
+    QFile file(sourcePath);
+    if (file.open(QIODevice::ReadOnly)) {
+        encoded = file.readAll();
+    }
+    uint32_t sourceCrc32 = 0;
+    if (!encoded.isEmpty()) {
+        sourceCrc32 = MapFile::crc32(encoded.constData(), static_cast<size_t>(encoded.size()));
+    } else if (!fallback.isNull()) {
+        sourceCrc32 = MapFile::crc32(fallback.constBits(), static_cast<size_t>(fallback.sizeInBytes()));
+    } else {
+        qDebug() << "⚠️ [BASEMAP] No image for" << sourcePath;
+        return false;
+    }
+
+    // A pack cut from this source is reused as it is
+    const std::string path = packPath.toStdString();
+    const uint8_t* data = nullptr;
+    uint32_t size = 0;
+    bool reuse = m_pack.open(path, false) && m_pack.find(INFO_KEY, data, size) && size == sizeof(m_info);
+    if (reuse) {
+        std::memcpy(&m_info, data, sizeof(m_info));
+        reuse = m_info.magic == INFO_MAGIC && m_info.version == INFO_VERSION && m_info.sourceCrc32 == sourceCrc32 &&
+                m_info.levels > 0;
+    }
+
+    if (!reuse) {
+        m_pack.close();
+        QImage source = encoded.isEmpty() ? QImage() : QImage::fromData(encoded);
+        encoded.clear();
+        if (source.isNull()) {
+            source = fallback;
+        }
+        qDebug() << "📍 [BASEMAP] Cutting" << source.width() << "x" << source.height() << "image into" << packPath;
+
+        QFile::remove(packPath);
+        QDir().mkpath(QFileInfo(packPath).absolutePath());
+        if (!m_pack.open(path) || !cut(source, sourceCrc32)) {
+            qDebug() << "⚠️ [BASEMAP] Cannot write" << packPath << ":" << QString::fromStdString(m_pack.lastError());
+            m_pack.close();
+            return false;
+        }
+        // Reopen so every tile is found through the index, without further appends
+        m_pack.close();
+        if (!m_pack.open(path, false)) {
+            qDebug() << "⚠️ [BASEMAP] Cannot reopen" << packPath << ":" << QString::fromStdString(m_pack.lastError());
+            return false;
+        }
+    }
+
+    m_loader.setNotifier(m_notifier);
+    m_loader.start([this](const TileKey& key, std::vector<uint8_t>& pixels) { return decodeTile(key, pixels); },
+                   DECODE_THREADS);
+    m_ready = true;
+    qDebug() << "📍 [BASEMAP]" << packPath << ":" << m_info.width << "x" << m_info.height << "in" << m_info.levels
+             << "levels";
+    return true;
+}
+
+void BasemapPyramid::close()
+{
+    m_loader.stop();
+    m_cache.clear();
+    m_pack.close();
+    m_info = BasemapPyramidInfo();
+    m_ready = false;
+}
+
+QSize BasemapPyramid::levelSize(int level) const
+{
+    const int shift = static_cast<int>(m_info.levels) - 1 - level;
+    const uint32_t divisor = uint32_t(1) << shift;
+    return QSize(std::max<int>(1, (m_info.width + divisor - 1) / divisor),
+                 std::max<int>(1, (m_info.height + divisor - 1) / divisor));
+}
+
+QSize BasemapPyramid::tileSize(const TileKey& key) const
+{
+    const QSize level = levelSize(key.z);
+    return QSize(std::min<int>(TILE_SIZE, level.width() - static_cast<int>(key.x) * TILE_SIZE),
+                 std::min<int>(TILE_SIZE, level.height() - static_cast<int>(key.y) * TILE_SIZE));
+}
+
+bool BasemapPyramid::cut(const QImage& source, uint32_t sourceCrc32)
+{
+    const bool alpha = source.hasAlphaChannel();
+    const char* format = alpha ? "PNG" : "JPG";
+    QImage level = source.convertToFormat(alpha ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32);
+
+    m_info.magic = INFO_MAGIC;
+    m_info.version = INFO_VERSION;
+    m_info.width = static_cast<uint32_t>(source.width());
+    m_info.height = static_cast<uint32_t>(source.height());
+    m_info.levels = 1;
+    while (std::max(m_info.width, m_info.height) > static_cast<uint32_t>(TILE_SIZE) << (m_info.levels - 1)) {
+        ++m_info.levels;
+    }
+    m_info.sourceCrc32 = sourceCrc32;
+
+    // Full resolution first, each coarser level scaled from the one before
+    for (int z = static_cast<int>(m_info.levels) - 1; z >= 0; --z) {
+        const QSize size = levelSize(z);
+        if (level.size() != size) {
+            level = level.scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        }
+        for (int y = 0; y * TILE_SIZE < size.height(); ++y) {
+            for (int x = 0; x * TILE_SIZE < size.width(); ++x) {
+                const TileKey key(z, static_cast<uint32_t>(x), static_cast<uint32_t>(y));
+                const QSize tile = tileSize(key);
+                QByteArray bytes;
+                QBuffer buffer(&bytes);
+                buffer.open(QIODevice::WriteOnly);
+                if (!level.copy(QRect(QPoint(x * TILE_SIZE, y * TILE_SIZE), tile))
+                         .save(&buffer, format, alpha ? -1 : JPEG_QUALITY) ||
+                    !m_pack.append(key, bytes.constData(), static_cast<uint32_t>(bytes.size()))) {
+                    return false;
+                }
+            }
+        }
+    }
+    return m_pack.append(INFO_KEY, &m_info, sizeof(m_info));
+}
+
+bool BasemapPyramid::decodeTile(const TileKey& key, std::vector<uint8_t>& pixels)
+{
+    const uint8_t* data = nullptr;
+    uint32_t size = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_packMutex);
+        if (!m_pack.find(key, data, size)) {
+            return false;
+        }
+    }
+
+    // The mapping stays valid until close(), which stops this thread first
+    const QImage image = QImage::fromData(data, static_cast<int>(size)).convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    const QSize expected = tileSize(key);
+    if (image.size() != expected) {
+        return false;
+    }
+    const size_t rowBytes = static_cast<size_t>(expected.width()) * 4;
+    pixels.resize(rowBytes * static_cast<size_t>(expected.height()));
+    for (int y = 0; y < expected.height(); ++y) {
+        std::memcpy(pixels.data() + rowBytes * static_cast<size_t>(y), image.constScanLine(y), rowBytes);
+    }
+    return true;
+}
+
+size_t BasemapPyramid::collect()
+{
+    std::vector<TileResult> results;
+    m_loader.takeResults(results);
+
+    size_t collected = 0;
+    for (const TileResult& result : results) {
+        if (!result.ok) {
+            continue;
+        }
+        const QSize size = tileSize(result.key);
+        QImage image(size, QImage::Format_ARGB32_Premultiplied);
+        const size_t rowBytes = static_cast<size_t>(size.width()) * 4;
+        for (int y = 0; y < size.height(); ++y) {
+            std::memcpy(image.scanLine(y), result.data.data() + rowBytes * static_cast<size_t>(y), rowBytes);
+        }
+        m_cache.put(result.key.pack(), image, result.data.size());
+        ++collected;
+    }
+    return collected;
+}
+
+int BasemapPyramid::draw(QPainter& painter, const QRectF& imageRect, const QRectF& clip)
+{
+    const QRectF visible = imageRect.intersected(clip);
+    if (!m_ready || visible.isEmpty()) {
+        return 0;
+    }
+
+    // Coarsest level that still has at least one pixel per device pixel
+    const int finest = static_cast<int>(m_info.levels) - 1;
+    const double screenPerSource = imageRect.width() * painter.device()->devicePixelRatioF() / m_info.width;
+    const int level = std::min(std::max(finest + static_cast<int>(std::ceil(std::log2(screenPerSource))), 0), finest);
+
+    const QSize size = levelSize(level);
+    const double sx = imageRect.width() / size.width();
+    const double sy = imageRect.height() / size.height();
+    const int tilesX = (size.width() + TILE_SIZE - 1) / TILE_SIZE;
+    const int tilesY = (size.height() + TILE_SIZE - 1) / TILE_SIZE;
+    const int x0 = std::max(static_cast<int>((visible.left() - imageRect.left()) / sx / TILE_SIZE), 0);
+    const int x1 = std::min(static_cast<int>((visible.right() - imageRect.left()) / sx / TILE_SIZE), tilesX - 1);
+    const int y0 = std::max(static_cast<int>((visible.top() - imageRect.top()) / sy / TILE_SIZE), 0);
+    const int y1 = std::min(static_cast<int>((visible.bottom() - imageRect.top()) / sy / TILE_SIZE), tilesY - 1);
+
+    int missing = 0;
+    for (int y = y0; y <= y1; ++y) {
+        for (int x = x0; x <= x1; ++x) {
+            const TileKey key(level, static_cast<uint32_t>(x), static_cast<uint32_t>(y));
+            const QSize tile = tileSize(key);
+            const QRectF target(imageRect.left() + x * TILE_SIZE * sx, imageRect.top() + y * TILE_SIZE * sy,
+                                tile.width() * sx, tile.height() * sy);
+            if (const QImage* image = m_cache.find(key.pack())) {
+                drawClipped(painter, target, *image, QRectF(QPointF(0, 0), QSizeF(tile)), clip);
+                continue;
+            }
+
+            ++missing;
+            m_loader.request(key);
+
+            // Meanwhile, the same area from the nearest coarser level in the cache
+            for (int coarser = level - 1; coarser >= 0; --coarser) {
+                const int shift = level - coarser;
+                const TileKey ancestor(coarser, key.x >> shift, key.y >> shift);
+                const QImage* image = m_cache.find(ancestor.pack());
+                if (!image) {
+                    continue;
+                }
+                const double scale = 1.0 / (1 << shift);
+                const QRectF source((x * TILE_SIZE) * scale - ancestor.x * TILE_SIZE,
+                                    (y * TILE_SIZE) * scale - ancestor.y * TILE_SIZE,
+                                    tile.width() * scale, tile.height() * scale);
+                drawClipped(painter, target, *image, source, clip);
+                break;
+            }
+        }
+    }
+
+    // The single top tile backs every fallback
+    if (missing > 0) {
+        m_loader.request(TileKey(0, 0, 0));
+    }
+    return missing;
+}
+
+} // namespace nav
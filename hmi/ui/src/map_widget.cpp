@@ -4,10 +4,54 @@
 #include <QDebug>
 #include <QStandardPaths>
 #include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <algorithm>
 #include <cmath>
 
+#include "nav_utils.h"
+
 namespace nav {
 
+namespace {
+
+// Half-size of the current position marker incl. heading arrow and pen width
+const int POSITION_MARKER_RADIUS = 24;
+
+// Fill behind and around the map image
+const QColor BACKGROUND_COLOR(200, 220, 255);
+
+const int DEFAULT_BASEMAP_CACHE_MB = 32;
+
+// Kinetic pan: velocity halves about every 225 ms and stops below the minimum
+const double KINETIC_DECAY_MS = 325.0;
+const double KINETIC_MIN_SPEED = 0.02;                      // Pixels per millisecond
+
+// A release this long after the last drag move is a drop, not a fling
+const qint64 KINETIC_MAX_IDLE_MS = 50;
+
+// A frame is reused shifted only by whole device pixels, give or take this
+const double SHIFT_TOLERANCE_PX = 1e-3;
+
+// Milliseconds since lap, which moves on to now
+double lapMs(const QElapsedTimer& timer, qint64& lap)
+{
+    const qint64 now = timer.nsecsElapsed();
+    const double ms = (now - lap) / 1e6;
+    lap = now;
+    return ms;
+}
+
+// Basemap pyramids are derived data: cut into the user cache directory unless
+// Map/basemap_cache_dir says otherwise
+QString defaultBasemapCacheDir()
+{
+    const QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    return cacheDir.isEmpty() ? QDir::tempPath() : cacheDir;
+}
+
+} // namespace
+
 /**
  * @brief Constructor for MapWidget - Initializes interactive map component
  * @param parent Parent widget for Qt widget hierarchy
@@ -27,14 +71,24 @@ MapWidget::MapWidget(QWidget *parent)
     , m_centerLon(getDefaultLon())           // Default center: Hanoi coordinates (105.8542°E)
     , m_zoomLevel(DEFAULT_ZOOM)              // Default zoom level for city-wide view
     , m_currentMapStyle(SATELLITE)           // Start with satellite imagery style
+    , m_requestedMapStyle(SATELLITE)         // No pyramid job queued yet
+    , m_basemapRevision(0)                   // Invalidates the rendered frame as tiles decode
     , m_mapImagesLoaded(false)               // Flag for resource loading status
+    , m_frontView()                          // Nothing rendered yet
+    , m_frontFramePatched(false)
+    , m_renderingView()
+    , m_frameTimings()                       // Nothing measured yet
     , m_currentHeading(0.0)                  // Vehicle heading direction (degrees)
     , m_hasCurrentPosition(false)            // GPS position availability flag
     , m_hasStartPoint(false)                 // Route start point marker flag
     , m_hasEndPoint(false)                   // Route destination marker flag
     , m_hasClickedPoint(false)               // User-clicked location marker flag
     , m_hasPOILabel(false)                   // POI text label display flag
+    , m_routePoints(std::make_shared<const std::vector<Point>>())  // No route yet
+    , m_routeRevision(0)                     // Invalidates the rendered frame on route changes
     , m_dragging(false)                      // Mouse drag state for map panning
+    , m_kineticTimer(nullptr)                // Fling continuation after a drag
+    , m_viewportTimer(nullptr)               // Coalesces viewportChanged
     , m_centerAnimation(nullptr)             // Smooth map centering animation
     , m_zoomAnimation(nullptr)               // Smooth zoom transition animation
     , m_showGrid(true)                       // Geographic coordinate grid overlay
@@ -43,12 +97,15 @@ MapWidget::MapWidget(QWidget *parent)
     , m_showCopyright(true)                  // Map attribution/copyright notice
     , m_mapTopLeft(getMapBoundsNorth(), getMapBoundsWest())      // Geographic bounds
     , m_mapBottomRight(getMapBoundsSouth(), getMapBoundsEast())  // Geographic bounds
+    , m_showFrameStats(false)                // Frame time p50/p99 (diagnostics)
 {
     // Configure widget properties for optimal map interaction
     setMinimumSize(400, 300);                           // Minimum size for usability
     setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);  // Fill available space
     setMouseTracking(true);                             // Enable mouse coordinate tracking
     setFocusPolicy(Qt::StrongFocus);                    // Accept keyboard input for navigation
+    setAttribute(Qt::WA_OpaquePaintEvent);              // The rendered frame covers every pixel
+    m_renderPool.setMaxThreadCount(1);                  // One frame in flight at a time
     
     // Initialize map image resources from Qt Resource System
     loadMapImages();
@@ -61,6 +118,15 @@ MapWidget::MapWidget(QWidget *parent)
     m_zoomAnimation = new QPropertyAnimation(this, "zoomLevel");
     m_zoomAnimation->setDuration(500);                  // 0.5 second zoom transition
     
+    m_kineticTimer = new QTimer(this);
+    m_kineticTimer->setInterval(KINETIC_FRAME_MS);
+    m_kineticTimer->setTimerType(Qt::PreciseTimer);     // Even steps while the map glides
+    connect(m_kineticTimer, &QTimer::timeout, this, &MapWidget::onKineticPanTick);
+    
+    m_viewportTimer = new QTimer(this);
+    m_viewportTimer->setSingleShot(true);               // Zero interval: after the pending events
+    connect(m_viewportTimer, &QTimer::timeout, this, &MapWidget::onViewportTimer);
+    
     // Restore user preferences from previous session
     loadSettings();
     
@@ -69,143 +135,188 @@ MapWidget::MapWidget(QWidget *parent)
 
 MapWidget::~MapWidget()
 {
+    // Stop an in-flight frame; it must not outlive the widget
+    if (m_frameCancel) {
+        m_frameCancel->store(true, std::memory_order_relaxed);
+    }
+    m_renderPool.waitForDone();
+    m_basemap.close();                                  // Joins the tile decode threads
+    
     // Persist user preferences for next session
     saveSettings();
 }
 
 /**
- * @brief Load map background images from Qt Resource System
+ * @brief Set up the map background images from the Qt Resource System
  * 
- * Loads three map styles with fallback to programmatically generated placeholder images:
+ * Three map styles are available:
  * 1. Satellite view: Real satellite imagery of Hanoi area
  * 2. Street map: Road network with street names and landmarks
  * 3. Hybrid view: Vietnam country overview for context
  * 
- * If resource loading fails, creates dummy images with visual indicators
- * to maintain functionality during development/testing.
+ * The images are not decoded here. Each style is cut once into a tile
+ * pyramid on disk (see BasemapPyramid) and drawn from it tile by tile, so
+ * only the tiles on screen at the matching resolution are ever decoded.
+ * If a resource is missing, a programmatically generated placeholder is
+ * cut instead to maintain functionality during development/testing.
  */
 void MapWidget::loadMapImages()
 {
     qDebug() << "Loading map images...";
     
-    // Define resource paths from resources.qrc
-    QString satellitePath = ":/maps/hanoi_satellite.jpg";    // Detailed Hanoi satellite imagery
-    QString streetPath = ":/maps/hanoi_street.jpg";          // Street map with road networks
-    QString hybridPath = ":/maps/vietnam_overview.jpg";      // Country-level overview map
-    
-    // Load satellite map with fallback placeholder generation
-    if (!m_satelliteMap.load(satellitePath)) {
-        qDebug() << "Failed to load satellite map, creating placeholder";
-        m_satelliteMap = QPixmap(800, 600);
-        m_satelliteMap.fill(QColor(120, 150, 80));          // Earth-tone green background
-        
-        QPainter painter(&m_satelliteMap);
-        // Create visual placeholder with geographic features
-        painter.setPen(QPen(Qt::darkGreen, 2));
-        painter.setFont(QFont("Arial", 16));
-        painter.drawText(m_satelliteMap.rect(), Qt::AlignCenter, 
-                        "Satellite View\n(Hanoi Area)\nDummy Image");
-        
-        // Draw simulated roads and water features for visual reference
-        painter.setPen(QPen(Qt::gray, 3));                  // Major roads
-        painter.drawLine(100, 200, 700, 400);              // Diagonal highway
-        painter.drawLine(200, 100, 600, 500);              // Cross street
-        painter.setPen(QPen(Qt::blue, 2));
-        painter.drawEllipse(300, 200, 200, 100);           // Hoan Kiem Lake representation
-    }
-    
-    // Load street map with grid-pattern fallback
-    if (!m_streetMap.load(streetPath)) {
-        qDebug() << "Failed to load street map, creating placeholder";
-        m_streetMap = QPixmap(800, 600);
-        m_streetMap.fill(QColor(245, 245, 220));            // Light beige paper map color
-        
-        QPainter painter(&m_streetMap);
-        painter.setPen(QPen(Qt::black, 1));
-        painter.setFont(QFont("Arial", 16));
-        painter.drawText(m_streetMap.rect(), Qt::AlignCenter,
-                        "Street Map\n(Hanoi Area)\nDummy Image");
-        
-        // Create grid pattern simulating city street layout
-        painter.setPen(QPen(Qt::darkGray, 2));
-        for (int x = 50; x < 800; x += 100) {              // Vertical streets
-            painter.drawLine(x, 0, x, 600);
-        }
-        for (int y = 50; y < 600; y += 100) {              // Horizontal streets
-            painter.drawLine(0, y, 800, y);
+    // Pyramid location and decoded tile budget from the configuration
+    m_basemapCacheDir = defaultBasemapCacheDir();
+    int cacheMb = DEFAULT_BASEMAP_CACHE_MB;
+    const std::string configPath = NavUtils::locateConfigFile();
+    if (!configPath.empty()) {
+        QSettings config(QString::fromStdString(configPath), QSettings::IniFormat);
+        const QString cacheDir = config.value("Map/basemap_cache_dir").toString();
+        if (!cacheDir.isEmpty()) {
+            m_basemapCacheDir = cacheDir;
         }
-        
-        // Highlight main arterial roads
-        painter.setPen(QPen(Qt::red, 4));
-        painter.drawLine(0, 300, 800, 300);                // Main horizontal avenue
-        painter.drawLine(400, 0, 400, 600);                // Main vertical boulevard
+        cacheMb = config.value("Map/basemap_cache_mb", cacheMb).toInt();
     }
+    m_basemap.setCacheBudget(static_cast<size_t>(std::max(cacheMb, 1)) * 1024 * 1024);
     
-    // Load hybrid/overview map with coastline simulation
-    if (!m_hybridMap.load(hybridPath)) {
-        qDebug() << "Failed to load hybrid map, creating placeholder";
-        m_hybridMap = QPixmap(800, 600);
-        m_hybridMap.fill(QColor(100, 120, 140));            // Ocean blue-gray background
-        
-        QPainter painter(&m_hybridMap);
-        painter.setPen(QPen(Qt::white, 2));
-        painter.setFont(QFont("Arial", 16));
-        painter.drawText(m_hybridMap.rect(), Qt::AlignCenter,
-                        "Hybrid View\n(Vietnam Overview)\nDummy Image");
-        
-        // Draw simplified Vietnam coastline for geographic context
-        painter.setPen(QPen(Qt::yellow, 3));
-        QPolygon coastline;
-        coastline << QPoint(100, 100) << QPoint(200, 80) << QPoint(300, 120)
-                  << QPoint(500, 150) << QPoint(700, 200) << QPoint(750, 400)
-                  << QPoint(700, 500) << QPoint(500, 480) << QPoint(300, 450)
-                  << QPoint(100, 400);
-        painter.drawPolygon(coastline);
-    }
-    
-    m_mapImagesLoaded = true;
-    updateMapCache();                                       // Prepare initial display cache
+    // Decoded tiles wait for the next frame, which the revision bump requests
+    m_basemap.setNotifier([this]() {
+        QMetaObject::invokeMethod(this, [this]() {
+            ++m_basemapRevision;
+            update();
+        }, Qt::QueuedConnection);
+    });
     
-    qDebug() << "Map images loaded successfully";
+    updateMapCache();                                       // Open the pyramid of the current style
 }
 
 /**
- * @brief Get current map background image based on selected style
- * @return QPixmap containing the current map background
+ * @brief Resource path of the map image for a display style
+ * @param style Map style enum (SATELLITE, STREET_MAP, HYBRID)
+ * @return Path in resources.qrc
  */
-QPixmap MapWidget::getCurrentMapImage() const
+QString MapWidget::mapResourcePath(MapStyle style)
 {
-    return getMapImageForStyle(m_currentMapStyle);
+    switch (style) {
+        case SATELLITE:
+            return ":/maps/hanoi_satellite.jpg";            // Detailed Hanoi satellite imagery
+        case STREET_MAP:
+            return ":/maps/hanoi_street.jpg";               // Street map with road networks
+        case HYBRID:
+        default:
+            return ":/maps/vietnam_overview.jpg";           // Country-level overview map
+    }
 }
 
 /**
- * @brief Retrieve map image for specific display style
+ * @brief Generate a stand-in for a map image missing from the resources
  * @param style Map style enum (SATELLITE, STREET_MAP, HYBRID)
- * @return QPixmap for the requested map style
+ * @return QImage with visual indicators of the style
+ * 
+ * A QImage rather than a QPixmap, as it is drawn on the render worker.
  */
-QPixmap MapWidget::getMapImageForStyle(MapStyle style) const
+QImage MapWidget::createPlaceholderMap(MapStyle style)
 {
+    QImage image(800, 600, QImage::Format_RGB32);
+    QPainter painter;
+    
     switch (style) {
         case SATELLITE:
-            return m_satelliteMap;                          // High-resolution satellite imagery
+            image.fill(QColor(120, 150, 80));               // Earth-tone green background
+            painter.begin(&image);
+            // Create visual placeholder with geographic features
+            painter.setPen(QPen(Qt::darkGreen, 2));
+            painter.setFont(QFont("Arial", 16));
+            painter.drawText(image.rect(), Qt::AlignCenter,
+                            "Satellite View\n(Hanoi Area)\nDummy Image");
+            
+            // Draw simulated roads and water features for visual reference
+            painter.setPen(QPen(Qt::gray, 3));              // Major roads
+            painter.drawLine(100, 200, 700, 400);          // Diagonal highway
+            painter.drawLine(200, 100, 600, 500);          // Cross street
+            painter.setPen(QPen(Qt::blue, 2));
+            painter.drawEllipse(300, 200, 200, 100);       // Hoan Kiem Lake representation
+            break;
+            
         case STREET_MAP:
-            return m_streetMap;                             // Road network with labels
+            image.fill(QColor(245, 245, 220));              // Light beige paper map color
+            painter.begin(&image);
+            painter.setPen(QPen(Qt::black, 1));
+            painter.setFont(QFont("Arial", 16));
+            painter.drawText(image.rect(), Qt::AlignCenter,
+                            "Street Map\n(Hanoi Area)\nDummy Image");
+            
+            // Create grid pattern simulating city street layout
+            painter.setPen(QPen(Qt::darkGray, 2));
+            for (int x = 50; x < 800; x += 100) {          // Vertical streets
+                painter.drawLine(x, 0, x, 600);
+            }
+            for (int y = 50; y < 600; y += 100) {          // Horizontal streets
+                painter.drawLine(0, y, 800, y);
+            }
+            
+            // Highlight main arterial roads
+            painter.setPen(QPen(Qt::red, 4));
+            painter.drawLine(0, 300, 800, 300);            // Main horizontal avenue
+            painter.drawLine(400, 0, 400, 600);            // Main vertical boulevard
+            break;
+            
         case HYBRID:
-        default:
-            return m_hybridMap;                             // Overview/context map
+        default: {
+            image.fill(QColor(100, 120, 140));              // Ocean blue-gray background
+            painter.begin(&image);
+            painter.setPen(QPen(Qt::white, 2));
+            painter.setFont(QFont("Arial", 16));
+            painter.drawText(image.rect(), Qt::AlignCenter,
+                            "Hybrid View\n(Vietnam Overview)\nDummy Image");
+            
+            // Draw simplified Vietnam coastline for geographic context
+            painter.setPen(QPen(Qt::yellow, 3));
+            QPolygon coastline;
+            coastline << QPoint(100, 100) << QPoint(200, 80) << QPoint(300, 120)
+                      << QPoint(500, 150) << QPoint(700, 200) << QPoint(750, 400)
+                      << QPoint(700, 500) << QPoint(500, 480) << QPoint(300, 450)
+                      << QPoint(100, 400);
+            painter.drawPolygon(coastline);
+            break;
+        }
     }
+    
+    painter.end();
+    return image;
 }
 
 /**
- * @brief Update cached map image and trigger UI refresh
+ * @brief Open the tile pyramid of the current map style
  * 
- * Caches the current map style image for efficient rendering
- * and triggers a repaint event to update the display.
+ * Queued on the render worker, so it never overlaps a frame drawing from
+ * the pyramid. The first time a style is used its image is cut into the
+ * pyramid there, off the GUI thread; later runs just reopen it. A job for
+ * a style that was switched away from before it ran is skipped.
  */
 void MapWidget::updateMapCache()
 {
-    m_currentMapCache = getCurrentMapImage();
-    update();                                               // Trigger paintEvent()
+    const MapStyle style = m_currentMapStyle;
+    const QString packPath = QDir(m_basemapCacheDir).filePath(QString("basemap_%1.pack").arg(static_cast<int>(style)));
+    m_requestedMapStyle.store(style, std::memory_order_relaxed);
+    
+    m_renderPool.start([this, style, packPath]() {
+        if (m_requestedMapStyle.load(std::memory_order_relaxed) != style) {
+            return;                                         // Superseded by a newer style
+        }
+        const QString resourcePath = mapResourcePath(style);
+        QImage fallback;
+        if (!QFile::exists(resourcePath)) {
+            qDebug() << "Failed to load" << resourcePath << ", creating placeholder";
+            fallback = createPlaceholderMap(style);
+        }
+        const bool opened = m_basemap.prepare(packPath, resourcePath, fallback);
+        
+        QMetaObject::invokeMethod(this, [this, opened]() {
+            m_mapImagesLoaded = opened;
+            ++m_basemapRevision;                            // Re-render with the new pyramid
+            update();                                       // Trigger paintEvent()
+        }, Qt::QueuedConnection);
+    });
 }
 
 /**
@@ -234,6 +345,7 @@ void MapWidget::setCenterLatitude(double lat)
     if (lat != m_centerLat) {
         m_centerLat = lat;
         update();                                           // Redraw map at new position
+        scheduleViewportChanged();
         emit centerChanged(m_centerLat, m_centerLon);       // Notify coordinate displays
     }
 }
@@ -247,6 +359,7 @@ void MapWidget::setCenterLongitude(double lon)
     if (lon != m_centerLon) {
         m_centerLon = lon;
         update();
+        scheduleViewportChanged();
         emit centerChanged(m_centerLat, m_centerLon);
     }
 }
@@ -264,6 +377,7 @@ void MapWidget::setZoomLevel(int zoom)
     if (newZoom != m_zoomLevel) {
         m_zoomLevel = newZoom;
         update();                                           // Redraw with new scale
+        scheduleViewportChanged();
         emit zoomChanged(m_zoomLevel);                      // Update zoom indicators
     }
 }
@@ -306,10 +420,14 @@ void MapWidget::setMapStyle(MapStyle style)
  */
 void MapWidget::setCurrentPosition(const Point& position, double heading)
 {
+    // Only the marker changes: repaint where it was and where it is now
+    if (m_hasCurrentPosition) {
+        update(positionMarkerRect(m_currentPosition));
+    }
     m_currentPosition = position;
     m_currentHeading = heading;
     m_hasCurrentPosition = true;
-    update();                                               // Redraw position marker
+    update(positionMarkerRect(m_currentPosition));
 }
 
 /**
@@ -343,7 +461,8 @@ void MapWidget::setEndPoint(const Point& point)
  */
 void MapWidget::setRoute(const std::vector<Point>& route)
 {
-    m_routePoints = route;
+    m_routePoints = std::make_shared<const std::vector<Point>>(route);
+    ++m_routeRevision;                                      // Route is part of the rendered frame
     update();                                               // Draw route path
 }
 
@@ -352,7 +471,8 @@ void MapWidget::setRoute(const std::vector<Point>& route)
  */
 void MapWidget::clearRoute()
 {
-    m_routePoints.clear();
+    m_routePoints = std::make_shared<const std::vector<Point>>();
+    ++m_routeRevision;
     update();
 }
 
@@ -441,6 +561,7 @@ void MapWidget::centerMap(double lat, double lon)
     m_centerLat = lat;
     m_centerLon = lon;
     update();
+    scheduleViewportChanged();
 }
 
 /**
@@ -462,6 +583,7 @@ void MapWidget::animateToPosition(const Point& position)
     
     // Simplified longitude animation (could be improved for great circle paths)
     m_centerLon = position.longitude;
+    scheduleViewportChanged();
 }
 
 /**
@@ -483,46 +605,63 @@ void MapWidget::animateZoomTo(int targetZoom)
 }
 
 /**
- * @brief Main rendering function - draws all map components
- * @param event Paint event with clipping information
+ * @brief Main rendering function - composites the map layers
+ * @param event Paint event with the region to repaint
  * 
- * Renders map in layered order:
- * 1. Background color fill
- * 2. Map background image (satellite/street/hybrid)
- * 3. Geographic coordinate grid (if enabled)
- * 4. Route path with directional arrows
- * 5. Waypoint markers (start/end points)
- * 6. Current position indicator with heading
- * 7. User-clicked point marker
- * 8. UI overlays (scale bar, coordinates, copyright)
+ * Renders in two layers:
+ * 1. Background frame (background, map image, grid, route), rendered by the
+ *    render worker into a QImage for the current view state
+ * 2. Dynamic markers and overlays, drawn over it on every paint
+ * 
+ * paintEvent itself only blits the latest complete frame. While the worker
+ * catches up with a view change the previous frame stays on screen, shifted
+ * along if the map was only panned, so a drag costs a blit per mouse move.
  */
 void MapWidget::paintEvent(QPaintEvent *event)
 {
-    QPainter painter(this);
-    painter.setRenderHint(QPainter::Antialiasing);          // Smooth lines and curves
-    painter.setRenderHint(QPainter::SmoothPixmapTransform); // High-quality image scaling
+    QElapsedTimer timer;
+    timer.start();
     
-    // Clear background with sky blue color
-    painter.fillRect(rect(), QColor(200, 220, 255));        // Light blue background
+    const ViewState view = currentViewState();
+    if (needsFrame(view)) {
+        requestFrame();
+    }
     
-    // Draw base map layer
-    drawMap(painter);
+    QPainter painter(this);
     
-    // Draw optional coordinate grid overlay
-    if (m_showGrid) {
-        drawGrid(painter);
+    // Nothing (or a frame of another size) to show yet: don't leave pixels undefined
+    if (m_frontFrame.isNull() || m_frontView.transform.size() != view.transform.size()) {
+        painter.fillRect(event->rect(), BACKGROUND_COLOR);
     }
     
-    // Draw navigation route if available
-    if (!m_routePoints.empty()) {
-        drawRoute(painter);
+    // Copy the dirty rectangles from the front frame (its pixels may be denser),
+    // shifted by how far the map was panned since it was rendered
+    if (!m_frontFrame.isNull()) {
+        const qreal ratio = m_frontView.pixelRatio;
+        const QPointF shift = view.canShift(m_frontView) ? view.shiftFrom(m_frontView) : QPointF(0, 0);
+        const QRectF frameRect(shift, QSizeF(m_frontView.transform.size()));
+        for (const QRect& dirty : event->region()) {
+            const QRectF visible = frameRect.intersected(QRectF(dirty));
+            if (!frameRect.contains(QRectF(dirty))) {
+                painter.fillRect(dirty, BACKGROUND_COLOR);  // Exposed by the pan
+            }
+            if (!visible.isEmpty()) {
+                painter.drawImage(visible, m_frontFrame,
+                                  QRectF((visible.x() - shift.x()) * ratio, (visible.y() - shift.y()) * ratio,
+                                         visible.width() * ratio, visible.height() * ratio));
+            }
+        }
     }
     
+    painter.setRenderHint(QPainter::Antialiasing);          // Smooth marker outlines
+    qint64 lap = timer.nsecsElapsed();
+    
     // Draw all waypoint markers
     drawWaypoints(painter);
+    m_frameTimings.waypointsMs = lapMs(timer, lap);
     
-    // Draw current GPS position if available
-    if (m_hasCurrentPosition) {
+    // Draw current GPS position if it is inside the repainted area
+    if (m_hasCurrentPosition && event->rect().intersects(positionMarkerRect(m_currentPosition))) {
         drawCurrentPosition(painter);
     }
     
@@ -530,35 +669,261 @@ void MapWidget::paintEvent(QPaintEvent *event)
     if (m_hasClickedPoint) {
         drawClickedPoint(painter);
     }
+    m_frameTimings.markersMs = lapMs(timer, lap);
     
     // Draw UI information overlays
     drawMapOverlays(painter);
+    m_frameTimings.overlaysMs = lapMs(timer, lap);
+    
+    m_frameTimings.paintMs = timer.nsecsElapsed() / 1e6;
+    m_paintTimes.add(m_frameTimings.paintMs);
+}
+
+/**
+ * @brief Hand a frame for the current view state to the render worker
+ * 
+ * Only one frame is in flight. If the view moved on since it started,
+ * it is cancelled and finishFrame() starts a frame for the new view. A
+ * frame that is only panned away from is let finish: paintEvent shows it
+ * shifted, so a pan always makes progress however long frames take.
+ * 
+ * While panning, the worker starts from the front frame shifted by the
+ * pan and renders only the strips it exposed.
+ */
+void MapWidget::requestFrame()
+{
+    const ViewState view = currentViewState();
+    if (m_frameCancel) {
+        if (m_renderingView != view && !(isPanning() && m_renderingView.isPanOf(view))) {
+            m_frameCancel->store(true, std::memory_order_relaxed);   // Stale: stop early
+        }
+        return;
+    }
+    
+    FrameJob job;
+    job.view = view;
+    job.basemap = m_mapImagesLoaded ? &m_basemap : nullptr;
+    job.mapTopLeft = m_mapTopLeft;
+    job.mapBottomRight = m_mapBottomRight;
+    job.route = m_routePoints;
+    job.routeCache = &m_routePathCache;
+    job.cancelled = std::make_shared<std::atomic<bool>>(false);
+    
+    // Panned by whole device pixels: the worker keeps what is still on screen
+    if (isPanning() && !m_frontFrame.isNull() && view.isPanOf(m_frontView)) {
+        const QPointF shift = view.shiftFrom(m_frontView) * view.pixelRatio;
+        const QPoint pixels = shift.toPoint();
+        if (std::fabs(shift.x() - pixels.x()) < SHIFT_TOLERANCE_PX &&
+            std::fabs(shift.y() - pixels.y()) < SHIFT_TOLERANCE_PX &&
+            std::abs(pixels.x()) < m_frontFrame.width() && std::abs(pixels.y()) < m_frontFrame.height()) {
+            job.previous = m_frontFrame;                    // Shared, only read by the worker
+            job.previousOffset = QPointF(pixels) / view.pixelRatio;
+        }
+    }
+    
+    m_frameCancel = job.cancelled;
+    m_renderingView = view;
+    
+    // The back buffer moves to the worker so it is never shared while painted on
+    QImage target = std::move(m_backFrame);
+    m_backFrame = QImage();
+    m_renderPool.start([this, job, target]() mutable {
+        FrameTimings timings = FrameTimings();
+        const bool completed = renderFrame(job, target, timings);
+        const bool patched = !job.previous.isNull();
+        job.previous = QImage();                            // Don't keep the old front frame shared
+        QMetaObject::invokeMethod(this, [this, frame = std::move(target), view = job.view, completed, patched,
+                                         timings]() {
+            finishFrame(frame, view, completed, patched, timings);
+        }, Qt::QueuedConnection);
+    });
+}
+
+/**
+ * @brief Take a frame back from the render worker
+ * @param frame Rendered image (partial if cancelled)
+ * @param view View state it was rendered for
+ * @param completed False if the frame was cancelled
+ * @param patched True if it was rendered from the previous frame while panning
+ * @param timings Time the worker spent on it, by phase
+ * 
+ * A completed frame becomes the front buffer and the old front the next
+ * back buffer. A cancelled one just returns its buffer.
+ */
+void MapWidget::finishFrame(QImage frame, const ViewState& view, bool completed, bool patched,
+                            const FrameTimings& timings)
+{
+    m_frameCancel.reset();
+    
+    if (completed) {
+        m_backFrame = std::move(m_frontFrame);
+        m_frontFrame = std::move(frame);
+        m_frontView = view;
+        m_frontFramePatched = patched;
+        m_frameTimings.mapMs = timings.mapMs;
+        m_frameTimings.gridMs = timings.gridMs;
+        m_frameTimings.routeMs = timings.routeMs;
+        m_frameTimings.renderMs = timings.renderMs;
+        m_renderTimes.add(timings.renderMs);
+        emit frameRendered(timings.renderMs);
+        update();                                           // Show the new frame
+    } else {
+        m_backFrame = std::move(frame);
+    }
+    
+    // The view moved on while this frame was rendering
+    if (needsFrame(currentViewState())) {
+        requestFrame();
+    }
+}
+
+/**
+ * @brief Check whether the front frame has to be rendered again
+ * @param view Current view state
+ * @return true if it is for another view, or patched together by a pan that has ended
+ */
+bool MapWidget::needsFrame(const ViewState& view) const
+{
+    return m_frontView != view || (m_frontFramePatched && !isPanning());
+}
+
+/**
+ * @brief Render a background frame (runs on the render worker)
+ * @param job Snapshot of the view and the data to draw
+ * @param target Image to render into; reallocated if the size changed
+ * @param timings Filled with the time spent in each phase
+ * @return false if the frame was cancelled part-way
+ * 
+ * Uses only the job, never the widget, so the GUI thread can keep
+ * changing the view while a frame renders.
+ */
+bool MapWidget::renderFrame(const FrameJob& job, QImage& target, FrameTimings& timings)
+{
+    QElapsedTimer timer;
+    timer.start();
+    
+    const ViewState& view = job.view;
+    const QSize& size = view.transform.size();
+    const QSize pixels(qRound(size.width() * view.pixelRatio), qRound(size.height() * view.pixelRatio));
+    if (target.size() != pixels) {
+        target = QImage(pixels, QImage::Format_ARGB32_Premultiplied);
+    }
+    target.setDevicePixelRatio(view.pixelRatio);
+    
+    QPainter painter(&target);
+    painter.setRenderHint(QPainter::Antialiasing);          // Smooth lines and curves
+    painter.setRenderHint(QPainter::SmoothPixmapTransform); // High-quality image scaling
+    
+    // Panning: copy the previous frame shifted and render only what it does not cover
+    QRegion area(QRect(QPoint(0, 0), size));
+    if (!job.previous.isNull()) {
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        painter.drawImage(job.previousOffset, job.previous);
+        painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+        
+        const QRectF kept(job.previousOffset, QSizeF(size));
+        area -= QRect(QPoint(static_cast<int>(std::ceil(kept.left())), static_cast<int>(std::ceil(kept.top()))),
+                      QPoint(static_cast<int>(std::floor(kept.right())) - 1,
+                             static_cast<int>(std::floor(kept.bottom())) - 1));
+        painter.setClipRegion(area);
+    }
+    
+    // Clear background with sky blue color
+    painter.fillRect(QRect(QPoint(0, 0), size), BACKGROUND_COLOR);
+    qint64 lap = timer.nsecsElapsed();
+    
+    // Draw base map layer
+    drawMap(painter, job, area);
+    timings.mapMs = lapMs(timer, lap);
+    if (job.cancelled->load(std::memory_order_relaxed)) {
+        return false;
+    }
+    
+    // Draw optional coordinate grid overlay
+    if (view.showGrid) {
+        drawGrid(painter, view.transform);
+    }
+    timings.gridMs = lapMs(timer, lap);
+    
+    // Draw navigation route if available
+    const bool completed = drawRoute(painter, job);
+    timings.routeMs = lapMs(timer, lap);
+    timings.renderMs = timer.nsecsElapsed() / 1e6;
+    return completed;
+}
+
+/**
+ * @brief Describe the view the background frame depends on
+ * @return ViewState for the current center, zoom, size, style and route
+ */
+MapWidget::ViewState MapWidget::currentViewState() const
+{
+    ViewState view;
+    view.transform = viewTransform();
+    view.pixelRatio = devicePixelRatioF();
+    view.style = m_currentMapStyle;
+    view.showGrid = m_showGrid;
+    view.routeRevision = m_routeRevision;
+    view.basemapRevision = m_basemapRevision;
+    return view;
+}
+
+/**
+ * @brief Check whether the shown frame is up to date
+ * @return true if the front frame is for the current view and none is rendering
+ * 
+ * Lets a caller such as map_render_benchmark wait for a view change to
+ * reach the screen.
+ */
+bool MapWidget::isFrameCurrent() const
+{
+    return !m_frameCancel && !m_frontFrame.isNull() && !needsFrame(currentViewState());
+}
+
+/**
+ * @brief Show or hide the frame time overlay
+ * @param show true to draw p50/p99 frame and paint times
+ */
+void MapWidget::setShowFrameStats(bool show)
+{
+    if (show != m_showFrameStats) {
+        m_showFrameStats = show;
+        update();
+    }
 }
 
 /**
  * @brief Render background map image with geographic positioning
  * @param painter QPainter instance for drawing operations
+ * @param job Frame being rendered
+ * @param area Part of the frame to draw, in widget pixels
  * 
- * Scales and positions the background map image based on current
- * zoom level and center coordinates. Includes border decoration.
+ * Positions the background map image based on current zoom level and
+ * center coordinates and draws its visible tiles at the matching pyramid
+ * level. Tiles still decoding show a coarser level until the next frame.
+ * Includes border decoration.
  */
-void MapWidget::drawMap(QPainter& painter)
+void MapWidget::drawMap(QPainter& painter, const FrameJob& job, const QRegion& area)
 {
-    if (!m_mapImagesLoaded || m_currentMapCache.isNull()) {
+    if (!job.basemap) {
         return;                                             // Skip if images not ready
     }
-    
-    // Calculate display scale based on zoom level
-    double scale = pow(2, m_zoomLevel - 10);                // Exponential zoom scaling
+    job.basemap->collect();                                 // Tiles decoded since the last frame
+    if (!job.basemap->isReady()) {
+        return;
+    }
     
     // Convert geographic bounds to screen coordinates
-    QPoint mapTopLeftScreen = geoToScreen(m_mapTopLeft);
-    QPoint mapBottomRightScreen = geoToScreen(m_mapBottomRight);
+    const ViewTransform& transform = job.view.transform;
+    QPointF mapTopLeftScreen = transform.project(job.mapTopLeft);
+    QPointF mapBottomRightScreen = transform.project(job.mapBottomRight);
     
-    QRect mapRect(mapTopLeftScreen, mapBottomRightScreen);
+    QRectF mapRect(mapTopLeftScreen, mapBottomRightScreen);
     
     // Draw the background map image fitted to geographic bounds
-    painter.drawPixmap(mapRect, m_currentMapCache);
+    for (const QRect& rect : area) {
+        job.basemap->draw(painter, mapRect, QRectF(rect));
+    }
     
     // Draw decorative border around map area
     painter.setPen(QPen(Qt::darkGray, 2));
@@ -568,63 +933,69 @@ void MapWidget::drawMap(QPainter& painter)
 /**
  * @brief Draw geographic coordinate grid overlay
  * @param painter QPainter instance for drawing operations
+ * @param transform View the frame is rendered for
  * 
- * Renders latitude and longitude grid lines with spacing
- * that adapts to current zoom level for optimal readability.
+ * Renders latitude and longitude grid lines across the view, with spacing
+ * that halves with every zoom level so lines stay about 60 pixels apart.
  */
-void MapWidget::drawGrid(QPainter& painter)
+void MapWidget::drawGrid(QPainter& painter, const ViewTransform& transform)
 {
     painter.setPen(QPen(QColor(255, 255, 255, 100), 1));    // Semi-transparent white lines
     
     // Calculate grid spacing based on zoom level (closer lines at higher zoom)
-    double gridSpacing = 0.01 / pow(2, m_zoomLevel - 10);
+    double gridSpacing = 0.08 / pow(2, transform.zoom() - 10);
+    
+    // Geographic extent of the view (Mercator: north up, parallels horizontal)
+    const QSize& size = transform.size();
+    const Point northWest = transform.unproject(QPointF(0, 0));
+    const Point southEast = transform.unproject(QPointF(size.width(), size.height()));
     
     // Draw latitude lines (horizontal)
-    double startLat = floor(m_centerLat / gridSpacing) * gridSpacing;
-    for (int i = -10; i <= 10; ++i) {
-        double lat = startLat + i * gridSpacing;
-        QPoint p1 = geoToScreen(Point(lat, m_centerLon - 0.1));
-        QPoint p2 = geoToScreen(Point(lat, m_centerLon + 0.1));
-        painter.drawLine(p1, p2);
+    for (double lat = ceil(southEast.latitude / gridSpacing) * gridSpacing; lat <= northWest.latitude; lat += gridSpacing) {
+        const double y = transform.project(Point(lat, northWest.longitude)).y();
+        painter.drawLine(QPointF(0, y), QPointF(size.width(), y));
     }
     
     // Draw longitude lines (vertical)
-    double startLon = floor(m_centerLon / gridSpacing) * gridSpacing;
-    for (int i = -10; i <= 10; ++i) {
-        double lon = startLon + i * gridSpacing;
-        QPoint p1 = geoToScreen(Point(m_centerLat - 0.1, lon));
-        QPoint p2 = geoToScreen(Point(m_centerLat + 0.1, lon));
-        painter.drawLine(p1, p2);
+    for (double lon = ceil(northWest.longitude / gridSpacing) * gridSpacing; lon <= southEast.longitude; lon += gridSpacing) {
+        const double x = transform.project(Point(northWest.latitude, lon)).x();
+        painter.drawLine(QPointF(x, 0), QPointF(x, size.height()));
     }
 }
 
 /**
- * @brief Draw navigation route as connected line segments
+ * @brief Draw navigation route as one path
  * @param painter QPainter instance for drawing operations
+ * @param job Frame being rendered
+ * @return false if the frame was cancelled part-way
  * 
- * Renders route as thick blue line connecting all waypoints
- * with directional arrows indicating travel direction.
+ * Renders route as thick blue line with directional arrows. The line comes
+ * from the route path cache: simplified for the zoom level and clipped to
+ * the chunks near the viewport, so long routes cost no more than short ones.
  */
-void MapWidget::drawRoute(QPainter& painter)
+bool MapWidget::drawRoute(QPainter& painter, const FrameJob& job)
 {
-    if (m_routePoints.size() < 2) {
-        return;                                             // Need at least two points
+    if (job.route->size() < 2) {
+        return true;                                        // Need at least two points
     }
     
-    painter.setPen(QPen(QColor(0, 100, 255), 4));          // Thick blue route line
-    painter.setBrush(QBrush(QColor(0, 100, 255, 100)));
-    
-    QPoint prevPoint = geoToScreen(m_routePoints[0]);
-    
-    // Connect all route waypoints with line segments
-    for (size_t i = 1; i < m_routePoints.size(); ++i) {
-        QPoint currentPoint = geoToScreen(m_routePoints[i]);
-        painter.drawLine(prevPoint, currentPoint);
-        prevPoint = currentPoint;
+    const QRectF viewport = job.view.transform.viewport();
+    job.routeCache->setRoute(job.route);
+    const QPainterPath& path = job.routeCache->path(job.view.transform.zoom(), viewport);   // Builds a new zoom level
+    if (job.cancelled->load(std::memory_order_relaxed)) {
+        return false;                                       // View changed: frame is stale
     }
     
+    painter.save();
+    painter.translate(-viewport.topLeft());                 // World pixels to screen
+    painter.setPen(QPen(QColor(0, 100, 255), 4, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin));   // Thick blue route line
+    painter.setBrush(Qt::NoBrush);
+    painter.drawPath(path);
+    painter.restore();
+    
     // Add directional arrows for navigation guidance
-    drawDirectionArrows(painter);
+    drawDirectionArrows(painter, job);
+    return true;
 }
 
 /**
@@ -806,44 +1177,23 @@ void MapWidget::drawHeadingIndicator(QPainter& painter, const QPoint& center)
 /**
  * @brief Draw directional arrows along route path
  * @param painter QPainter instance for drawing operations
+ * @param job Frame being rendered
  * 
- * Places small arrows at intervals along route to indicate
- * travel direction for navigation guidance.
+ * Places small arrows at fixed on-screen spacing along the route to
+ * indicate travel direction; all visible arrows are drawn as one path.
  */
-void MapWidget::drawDirectionArrows(QPainter& painter)
+void MapWidget::drawDirectionArrows(QPainter& painter, const FrameJob& job)
 {
-    if (m_routePoints.size() < 2) return;
+    if (job.route->size() < 2) return;
+    
+    const QRectF viewport = job.view.transform.viewport();
     
+    painter.save();
+    painter.translate(-viewport.topLeft());                 // World pixels to screen
     painter.setPen(QPen(QColor(0, 80, 200), 2));            // Darker blue for arrows
     painter.setBrush(QBrush(QColor(0, 80, 200)));
-    
-    // Place arrows every 3rd route segment to avoid clutter
-    for (size_t i = 0; i < m_routePoints.size() - 1; i += 3) {
-        QPoint fromScreen = geoToScreen(m_routePoints[i]);
-        QPoint toScreen = geoToScreen(m_routePoints[i + 1]);
-        
-        // Calculate arrow direction angle
-        double dx = toScreen.x() - fromScreen.x();
-        double dy = toScreen.y() - fromScreen.y();
-        double angle = atan2(dy, dx) * 180.0 / M_PI;
-        
-        // Position arrow at segment midpoint
-        QPoint middle((fromScreen.x() + toScreen.x()) / 2, 
-                     (fromScreen.y() + toScreen.y()) / 2);
-        
-        painter.save();
-        painter.translate(middle);
-        painter.rotate(angle);                              // Align with route direction
-        
-        // Draw small directional arrow
-        QPolygon arrow;
-        arrow << QPoint(8, 0)                               // Arrow tip
-              << QPoint(-4, -3)                             // Left base
-              << QPoint(-4, 3);                             // Right base
-        painter.drawPolygon(arrow);
-        
-        painter.restore();
-    }
+    painter.drawPath(job.routeCache->arrowPath(job.view.transform.zoom(), viewport));
+    painter.restore();
 }
 
 /**
@@ -868,6 +1218,10 @@ void MapWidget::drawMapOverlays(QPainter& painter)
     if (m_showCopyright) {
         drawCopyright(painter);
     }
+    
+    if (m_showFrameStats) {
+        drawFrameStats(painter);
+    }
 }
 
 /**
@@ -961,6 +1315,62 @@ void MapWidget::drawCopyright(QPainter& painter)
     painter.drawText(copyrightRect, copyright);
 }
 
+/**
+ * @brief Draw recent frame times in top-left corner
+ * @param painter QPainter instance for drawing operations
+ * 
+ * Median and 99th percentile of the last FRAME_STATS_SAMPLES background
+ * frames (render worker) and paint events (GUI thread), for spotting
+ * rendering regressions on the target.
+ */
+void MapWidget::drawFrameStats(QPainter& painter)
+{
+    painter.setPen(QPen(Qt::black));
+    painter.setFont(QFont("Arial", 10));
+    
+    QString statsText = QString("Frame p50 %1 ms  p99 %2 ms\nPaint p50 %3 ms  p99 %4 ms")
+                       .arg(m_renderTimes.percentile(0.50), 0, 'f', 1)
+                       .arg(m_renderTimes.percentile(0.99), 0, 'f', 1)
+                       .arg(m_paintTimes.percentile(0.50), 0, 'f', 1)
+                       .arg(m_paintTimes.percentile(0.99), 0, 'f', 1);
+    
+    QRect textRect = painter.fontMetrics().boundingRect(QRect(0, 0, width(), height()), 0, statsText);
+    textRect.moveTopLeft(QPoint(10, 10));
+    
+    painter.fillRect(textRect.adjusted(-5, -2, 5, 2), QColor(255, 255, 255, 200));
+    painter.drawText(textRect, statsText);
+}
+
+/**
+ * @brief Record a frame time, replacing the oldest once full
+ * @param ms Frame time in milliseconds
+ */
+void MapWidget::FrameTimeHistory::add(double ms)
+{
+    if (samples.size() < static_cast<size_t>(FRAME_STATS_SAMPLES)) {
+        samples.push_back(ms);
+    } else {
+        samples[next] = ms;
+    }
+    next = (next + 1) % FRAME_STATS_SAMPLES;
+}
+
+/**
+ * @brief Percentile of the recorded frame times
+ * @param p Fraction between 0 and 1 (0.5 for the median)
+ * @return Frame time in milliseconds, 0 if nothing was recorded
+ */
+double MapWidget::FrameTimeHistory::percentile(double p) const
+{
+    if (samples.empty()) {
+        return 0.0;
+    }
+    std::vector<double> sorted = samples;
+    const size_t index = std::min(sorted.size() - 1, static_cast<size_t>(p * (sorted.size() - 1) + 0.5));
+    std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+    return sorted[index];
+}
+
 /**
  * @brief Handle mouse press events for map interaction
  * @param event Mouse event containing button and position information
@@ -971,8 +1381,11 @@ void MapWidget::drawCopyright(QPainter& painter)
 void MapWidget::mousePressEvent(QMouseEvent *event)
 {
     if (event->button() == Qt::LeftButton) {
+        m_kineticTimer->stop();                             // Catch a gliding map
         m_dragging = true;                                  // Enable drag-to-pan mode
         m_lastPanPoint = event->pos();                      // Store drag start position
+        m_panVelocity = QPointF(0, 0);
+        m_panClock.start();
         
         // Convert screen coordinates to geographic and emit signal
         Point geoPos = screenToGeo(event->pos());
@@ -1007,7 +1420,8 @@ void MapWidget::mouseDoubleClickEvent(QMouseEvent *event)
  * @param event Mouse event with current position and button state
  * 
  * Enables map panning when left button is held and continuously
- * emits current mouse geographic coordinates for UI updates.
+ * emits current mouse geographic coordinates for UI updates. The drag
+ * velocity is tracked for a kinetic pan on release.
  */
 void MapWidget::mouseMoveEvent(QMouseEvent *event)
 {
@@ -1019,14 +1433,13 @@ void MapWidget::mouseMoveEvent(QMouseEvent *event)
     if (m_dragging && (event->buttons() & Qt::LeftButton)) {
         QPoint delta = event->pos() - m_lastPanPoint;
         
-        // Convert pixel movement to geographic coordinate changes
-        // Movement scale inversely related to zoom level
-        double latDelta = -delta.y() * 0.0001 * (21 - m_zoomLevel);
-        double lonDelta = -delta.x() * 0.0001 * (21 - m_zoomLevel);
+        // Smoothed drag velocity, weighted to the latest moves
+        const qint64 elapsedMs = m_panClock.restart();
+        if (elapsedMs > 0) {
+            m_panVelocity = m_panVelocity * 0.2 + QPointF(delta) / elapsedMs * 0.8;
+        }
         
-        // Update map center position
-        setCenterLatitude(m_centerLat + latDelta);
-        setCenterLongitude(m_centerLon + lonDelta);
+        panBy(delta);                                       // Point under the cursor follows it
         
         m_lastPanPoint = event->pos();                      // Update for next movement
     }
@@ -1034,6 +1447,32 @@ void MapWidget::mouseMoveEvent(QMouseEvent *event)
     QWidget::mouseMoveEvent(event);
 }
 
+/**
+ * @brief Handle mouse release at the end of a drag
+ * @param event Mouse event with the released button
+ * 
+ * A release while the pointer was still moving flings the map: it keeps
+ * gliding and slows down (onKineticPanTick). Otherwise the pan ends here
+ * and the frame patched together while dragging is rendered again whole.
+ */
+void MapWidget::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton && m_dragging) {
+        m_dragging = false;
+        
+        const double speed = std::hypot(m_panVelocity.x(), m_panVelocity.y());
+        if (m_panClock.elapsed() < KINETIC_MAX_IDLE_MS && speed > KINETIC_MIN_SPEED) {
+            m_panRemainder = QPointF(0, 0);
+            m_panClock.restart();
+            m_kineticTimer->start();                        // Fling
+        } else {
+            update();                                       // Full frame for the final view
+        }
+    }
+    
+    QWidget::mouseReleaseEvent(event);
+}
+
 /**
  * @brief Handle mouse wheel events for zoom control
  * @param event Wheel event containing scroll direction and amount
@@ -1103,6 +1542,34 @@ void MapWidget::resizeEvent(QResizeEvent *event)
 {
     QWidget::resizeEvent(event);
     update();                                               // Redraw with new dimensions
+    scheduleViewportChanged();                              // Tile loading follows the visible area
+}
+
+/**
+ * @brief Advance a kinetic pan by one tick
+ * 
+ * Moves by the velocity times the time actually elapsed, so a late tick
+ * does not slow the map down, in whole pixels so the render worker can
+ * keep reusing the shifted frame; the sub-pixel rest carries over. Each
+ * tick costs a blit of that frame plus the markers, well within the
+ * KINETIC_FRAME_MS budget, while the worker renders the exposed strips.
+ */
+void MapWidget::onKineticPanTick()
+{
+    const double elapsedMs = std::min<double>(m_panClock.restart(), 4 * KINETIC_FRAME_MS);
+    const QPointF exact = m_panVelocity * elapsedMs + m_panRemainder;
+    const QPoint step = exact.toPoint();
+    m_panRemainder = exact - QPointF(step);
+    if (!step.isNull()) {
+        panBy(step);
+    }
+    
+    // Exponential slow-down, then stop and render the final view whole
+    m_panVelocity *= std::exp(-elapsedMs / KINETIC_DECAY_MS);
+    if (std::hypot(m_panVelocity.x(), m_panVelocity.y()) < KINETIC_MIN_SPEED) {
+        m_kineticTimer->stop();
+        update();
+    }
 }
 
 /**
@@ -1116,28 +1583,88 @@ void MapWidget::onAnimationFinished()
     update();                                               // Final repaint after animation
 }
 
+/**
+ * @brief Current view transform, recomputed only when the view changed
+ * @return ViewTransform for the current center, zoom and widget size
+ * 
+ * Shared by all drawing, hit testing and overlay placement so they agree
+ * on where a coordinate is on screen.
+ */
+const ViewTransform& MapWidget::viewTransform() const
+{
+    m_viewTransform.update(m_centerLat, m_centerLon, m_zoomLevel, size());
+    return m_viewTransform;
+}
+
+/**
+ * @brief Move the map with the pointer
+ * @param delta Screen pixels the map content moves by
+ * 
+ * Moves the center so the point under the cursor follows it.
+ */
+void MapWidget::panBy(const QPoint& delta)
+{
+    const QPointF screenCenter(width() / 2.0, height() / 2.0);
+    const Point newCenter = viewTransform().unproject(screenCenter - QPointF(delta));
+    
+    // Update map center position
+    setCenterLatitude(newCenter.latitude);
+    setCenterLongitude(newCenter.longitude);
+}
+
+/**
+ * @brief Geographic area the widget currently shows
+ * @return Bounds of the widget's corners
+ */
+BoundingBox MapWidget::visibleArea() const
+{
+    const ViewTransform& transform = viewTransform();
+    const Point northWest = transform.unproject(QPointF(0.0, 0.0));
+    const Point southEast = transform.unproject(QPointF(width(), height()));
+    return BoundingBox(southEast.latitude, northWest.longitude, northWest.latitude, southEast.longitude);
+}
+
+/**
+ * @brief Report a view change once the current burst of changes is over
+ * 
+ * A drag moves latitude and longitude separately and a zoom step can
+ * recenter too; the zero-interval timer folds them into one signal.
+ */
+void MapWidget::scheduleViewportChanged()
+{
+    if (!m_viewportTimer->isActive()) {
+        m_viewportTimer->start(0);
+    }
+}
+
+/**
+ * @brief Emit viewportChanged for the view as it is now
+ */
+void MapWidget::onViewportTimer()
+{
+    emit viewportChanged(visibleArea());
+}
+
+/**
+ * @brief Check whether the map is being dragged or is gliding after a fling
+ * @return true while a pan is in progress
+ */
+bool MapWidget::isPanning() const
+{
+    return m_dragging || m_kineticTimer->isActive();
+}
+
 /**
  * @brief Convert geographic coordinates to screen pixel coordinates
  * @param geoPoint Geographic position (latitude, longitude)
  * @return QPoint Screen coordinates (x, y pixels)
  * 
- * Uses simplified Mercator-like projection with zoom-based scaling.
- * Suitable for local area navigation (Hanoi city scale).
+ * Web-Mercator projection at the current zoom level, the same one the
+ * map tiles use.
  */
 QPoint MapWidget::geoToScreen(const Point& geoPoint) const
 {
-    // Exponential zoom scaling factor
-    double scale = pow(2, m_zoomLevel);
-    
-    // Calculate offset from map center
-    double deltaLat = geoPoint.latitude - m_centerLat;
-    double deltaLon = geoPoint.longitude - m_centerLon;
-    
-    // Convert to screen coordinates with zoom scaling
-    int x = width() / 2 + static_cast<int>(deltaLon * scale * width() / 360.0);
-    int y = height() / 2 - static_cast<int>(deltaLat * scale * height() / 180.0);
-    
-    return QPoint(x, y);
+    return viewTransform().project(geoPoint).toPoint();
 }
 
 /**
@@ -1149,22 +1676,19 @@ QPoint MapWidget::geoToScreen(const Point& geoPoint) const
  */
 Point MapWidget::screenToGeo(const QPoint& screenPoint) const
 {
-    // Zoom scaling factor (inverse of geoToScreen)
-    double scale = pow(2, m_zoomLevel);
-    
-    // Calculate offset from screen center
-    int deltaX = screenPoint.x() - width() / 2;
-    int deltaY = height() / 2 - screenPoint.y();
-    
-    // Convert to geographic coordinate offsets
-    double deltaLon = static_cast<double>(deltaX) * 360.0 / (scale * width());
-    double deltaLat = static_cast<double>(deltaY) * 180.0 / (scale * height());
-    
-    // Add offsets to map center coordinates
-    double lat = m_centerLat + deltaLat;
-    double lon = m_centerLon + deltaLon;
-    
-    return Point(lat, lon);
+    return viewTransform().unproject(QPointF(screenPoint));
+}
+
+/**
+ * @brief Screen area covered by the current position marker
+ * @param position Geographic coordinates of the marker
+ * @return QRect enclosing circle, heading arrow and label
+ */
+QRect MapWidget::positionMarkerRect(const Point& position) const
+{
+    const QPoint center = geoToScreen(position);
+    return QRect(center.x() - POSITION_MARKER_RADIUS, center.y() - POSITION_MARKER_RADIUS,
+                 2 * POSITION_MARKER_RADIUS, 2 * POSITION_MARKER_RADIUS);
 }
 
 /**
@@ -1242,6 +1766,7 @@ void MapWidget::loadSettings()
     m_showCoordinates = settings.value("showCoordinates", true).toBool();
     m_showScale = settings.value("showScale", true).toBool();
     m_showCopyright = settings.value("showCopyright", true).toBool();
+    m_showFrameStats = settings.value("showFrameStats", false).toBool();
     
     settings.endGroup();
     
@@ -1270,6 +1795,7 @@ void MapWidget::saveSettings()
     settings.setValue("showCoordinates", m_showCoordinates);
     settings.setValue("showScale", m_showScale);
     settings.setValue("showCopyright", m_showCopyright);
+    settings.setValue("showFrameStats", m_showFrameStats);
     
     settings.endGroup();
     
@@ -251,6 +251,10 @@ void NavigationMainWindow::setupMapView()
     connect(m_mapRenderer, &MapWidget::mapClicked, this, &NavigationMainWindow::onMapClicked);
     connect(m_mapRenderer, &MapWidget::mousePositionChanged, this, &NavigationMainWindow::onMousePositionChanged);
     
+    // Tile loading order, pinning and prefetch follow the area on screen
+    connect(m_mapRenderer, &MapWidget::viewportChanged, m_navController->getMapService(),
+            &MapServiceCore::setViewport);
+    
     qDebug() << "MapWidget created with size:" << m_mapRenderer->size();
 }
 
@@ -0,0 +1,220 @@
+#include "../include/route_path_cache.h"
+#include "../include/view_transform.h"
+#include <QPolygonF>
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace nav {
+
+namespace {
+
+// Reach of the route pen and arrows past the line itself, in pixels
+const double DRAW_MARGIN_PX = 8.0;
+
+// Arrow shape along the direction of travel (tip, back, half-width)
+const double ARROW_TIP_PX = 8.0;
+const double ARROW_BACK_PX = 4.0;
+const double ARROW_HALF_WIDTH_PX = 3.0;
+
+double distanceToSegment(const QPointF& p, const QPointF& a, const QPointF& b)
+{
+    const double dx = b.x() - a.x();
+    const double dy = b.y() - a.y();
+    const double lengthSq = dx * dx + dy * dy;
+    double t = 0.0;
+    if (lengthSq > 0.0) {
+        t = std::min(std::max(((p.x() - a.x()) * dx + (p.y() - a.y()) * dy) / lengthSq, 0.0), 1.0);
+    }
+    const double ex = a.x() + t * dx - p.x();
+    const double ey = a.y() + t * dy - p.y();
+    return std::sqrt(ex * ex + ey * ey);
+}
+
+// QRectF::intersects() is false for zero-width boxes, e.g. a vertical segment
+bool overlaps(const QRectF& a, const QRectF& b)
+{
+    return a.left() <= b.right() && b.left() <= a.right() && a.top() <= b.bottom() && b.top() <= a.bottom();
+}
+
+} // namespace
+
+void RoutePathCache::setRoute(const std::shared_ptr<const std::vector<Point>>& route)
+{
+    if (route != m_route) {
+        m_route = route;
+        m_levels.clear();
+        if (m_route) {
+            ViewTransform::toWorld(*m_route, m_worldX, m_worldY);
+        }
+    }
+}
+
+void RoutePathCache::clear()
+{
+    m_route.reset();
+    m_worldX.clear();
+    m_worldY.clear();
+    m_levels.clear();
+}
+
+const QPainterPath& RoutePathCache::path(int zoom, const QRectF& viewport)
+{
+    Level& cached = level(zoom);
+    updateVisible(cached, viewport);
+    return cached.path;
+}
+
+const QPainterPath& RoutePathCache::arrowPath(int zoom, const QRectF& viewport)
+{
+    Level& cached = level(zoom);
+    updateVisible(cached, viewport);
+    return cached.arrowPath;
+}
+
+size_t RoutePathCache::simplifiedSize(int zoom)
+{
+    return level(zoom).points.size();
+}
+
+RoutePathCache::Level& RoutePathCache::level(int zoom)
+{
+    for (auto it = m_levels.begin(); it != m_levels.end(); ++it) {
+        if ((*it)->zoom == zoom) {
+            std::rotate(it, it + 1, m_levels.end());            // Most recently used last
+            return *m_levels.back();
+        }
+    }
+
+    auto created = std::make_unique<Level>();
+    created->zoom = zoom;
+    created->pathsValid = false;
+    buildLevel(*created);
+    if (m_levels.size() >= MAX_LEVELS) {
+        m_levels.erase(m_levels.begin());
+    }
+    m_levels.push_back(std::move(created));
+    return *m_levels.back();
+}
+
+void RoutePathCache::buildLevel(Level& level) const
+{
+    if (!m_route || m_route->size() < 2) {
+        return;
+    }
+    std::vector<QPointF> projected;
+    ViewTransform::toPixels(m_worldX, m_worldY, level.zoom, projected);
+
+    // Douglas-Peucker with an explicit stack: a 100k point route is too deep to recurse
+    std::vector<bool> keep(projected.size(), false);
+    keep.front() = true;
+    keep.back() = true;
+    std::vector<std::pair<size_t, size_t>> stack;
+    stack.emplace_back(0, projected.size() - 1);
+    while (!stack.empty()) {
+        const size_t first = stack.back().first;
+        const size_t last = stack.back().second;
+        stack.pop_back();
+        double worst = TOLERANCE_PX;
+        size_t split = 0;
+        for (size_t i = first + 1; i < last; ++i) {
+            const double d = distanceToSegment(projected[i], projected[first], projected[last]);
+            if (d > worst) {
+                worst = d;
+                split = i;
+            }
+        }
+        if (split != 0) {
+            keep[split] = true;
+            stack.emplace_back(first, split);
+            stack.emplace_back(split, last);
+        }
+    }
+    for (size_t i = 0; i < projected.size(); ++i) {
+        if (keep[i]) {
+            level.points.push_back(projected[i]);
+        }
+    }
+
+    // Chunks for clipping, with the arrows that fall on each one's segments
+    const std::vector<QPointF>& points = level.points;
+    double travelled = 0.0;
+    double nextArrow = ARROW_SPACING_PX / 2.0;
+    for (size_t first = 0; first + 1 < points.size(); first += CHUNK_POINTS) {
+        Chunk chunk;
+        chunk.first = first;
+        chunk.last = std::min(first + CHUNK_POINTS, points.size() - 1);
+        chunk.firstArrow = level.arrows.size();
+
+        double left = points[first].x(), right = left, top = points[first].y(), bottom = top;
+        for (size_t i = first + 1; i <= chunk.last; ++i) {
+            const QPointF& a = points[i - 1];
+            const QPointF& b = points[i];
+            left = std::min(left, b.x());
+            right = std::max(right, b.x());
+            top = std::min(top, b.y());
+            bottom = std::max(bottom, b.y());
+
+            const double length = std::hypot(b.x() - a.x(), b.y() - a.y());
+            if (length <= 0.0) {
+                continue;
+            }
+            const double dx = (b.x() - a.x()) / length;
+            const double dy = (b.y() - a.y()) / length;
+            for (; nextArrow <= travelled + length; nextArrow += ARROW_SPACING_PX) {
+                const double along = nextArrow - travelled;
+                level.arrows.push_back(Arrow{QPointF(a.x() + dx * along, a.y() + dy * along), dx, dy});
+            }
+            travelled += length;
+        }
+        chunk.bounds = QRectF(QPointF(left, top), QPointF(right, bottom));
+        chunk.lastArrow = level.arrows.size();
+        level.chunks.push_back(chunk);
+    }
+}
+
+void RoutePathCache::updateVisible(Level& level, const QRectF& viewport)
+{
+    const QRectF area = viewport.adjusted(-DRAW_MARGIN_PX, -DRAW_MARGIN_PX, DRAW_MARGIN_PX, DRAW_MARGIN_PX);
+    std::vector<size_t> visible;
+    for (size_t i = 0; i < level.chunks.size(); ++i) {
+        if (overlaps(level.chunks[i].bounds, area)) {
+            visible.push_back(i);
+        }
+    }
+    if (level.pathsValid && visible == level.visibleChunks) {
+        return;                                                 // Same chunks: reuse the paths
+    }
+
+    level.path = QPainterPath();
+    level.arrowPath = QPainterPath();
+    size_t previous = level.chunks.size();
+    for (size_t index : visible) {
+        const Chunk& chunk = level.chunks[index];
+
+        // Consecutive chunks continue the same subpath
+        if (index != previous + 1) {
+            level.path.moveTo(level.points[chunk.first]);
+        }
+        for (size_t i = chunk.first + 1; i <= chunk.last; ++i) {
+            level.path.lineTo(level.points[i]);
+        }
+        previous = index;
+
+        for (size_t i = chunk.firstArrow; i < chunk.lastArrow; ++i) {
+            const Arrow& arrow = level.arrows[i];
+            const QPointF along(arrow.dx, arrow.dy);
+            const QPointF across(-arrow.dy, arrow.dx);
+            QPolygonF shape;
+            shape << arrow.position + along * ARROW_TIP_PX
+                  << arrow.position - along * ARROW_BACK_PX - across * ARROW_HALF_WIDTH_PX
+                  << arrow.position - along * ARROW_BACK_PX + across * ARROW_HALF_WIDTH_PX;
+            level.arrowPath.addPolygon(shape);
+            level.arrowPath.closeSubpath();
+        }
+    }
+    level.visibleChunks.swap(visible);
+    level.pathsValid = true;
+}
+
+} // namespace nav
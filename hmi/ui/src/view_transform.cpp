@@ -0,0 +1,98 @@
+#include "../include/view_transform.h"
+#include "tile_key.h"
+#include <algorithm>
+#include <cmath>
+
+namespace nav {
+
+ViewTransform::ViewTransform()
+    : m_centerLat(0.0)
+    , m_centerLon(0.0)
+    , m_zoom(0)
+    , m_size(0, 0)
+    , m_scale(1.0)
+    , m_offsetX(0.0)
+    , m_offsetY(0.0)
+{
+    recompute();
+}
+
+ViewTransform::ViewTransform(double centerLat, double centerLon, int zoom, const QSize& size)
+    : m_centerLat(centerLat)
+    , m_centerLon(centerLon)
+    , m_zoom(zoom)
+    , m_size(size)
+    , m_scale(1.0)
+    , m_offsetX(0.0)
+    , m_offsetY(0.0)
+{
+    recompute();
+}
+
+bool ViewTransform::update(double centerLat, double centerLon, int zoom, const QSize& size)
+{
+    if (centerLat == m_centerLat && centerLon == m_centerLon && zoom == m_zoom && size == m_size) {
+        return false;
+    }
+    m_centerLat = centerLat;
+    m_centerLon = centerLon;
+    m_zoom = zoom;
+    m_size = size;
+    recompute();
+    return true;
+}
+
+void ViewTransform::recompute()
+{
+    double centerX, centerY;
+    toWorld(Point(m_centerLat, m_centerLon), centerX, centerY);
+    m_scale = std::ldexp(1.0, m_zoom);
+    m_offsetX = centerX * m_scale - m_size.width() / 2.0;
+    m_offsetY = centerY * m_scale - m_size.height() / 2.0;
+}
+
+QRectF ViewTransform::viewport() const
+{
+    return QRectF(m_offsetX, m_offsetY, m_size.width(), m_size.height());
+}
+
+QPointF ViewTransform::project(const Point& point) const
+{
+    double worldX, worldY;
+    toWorld(point, worldX, worldY);
+    return QPointF(worldX * m_scale - m_offsetX, worldY * m_scale - m_offsetY);
+}
+
+Point ViewTransform::unproject(const QPointF& pixel) const
+{
+    return mercatorPoint((pixel.x() + m_offsetX) / m_scale, (pixel.y() + m_offsetY) / m_scale, 0);
+}
+
+void ViewTransform::toWorld(const Point& point, double& worldX, double& worldY)
+{
+    mercatorPixel(point, 0, worldX, worldY);
+}
+
+void ViewTransform::toWorld(ArrayView<Point> points, std::vector<double>& worldX, std::vector<double>& worldY)
+{
+    worldX.resize(points.size());
+    worldY.resize(points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        toWorld(points[i], worldX[i], worldY[i]);
+    }
+}
+
+void ViewTransform::toPixels(ArrayView<double> worldX, ArrayView<double> worldY, int zoom, std::vector<QPointF>& out)
+{
+    // Raw pointers and a local scale so the loop carries no loads through the views
+    const size_t count = std::min(worldX.size(), worldY.size());
+    const double* x = worldX.data();
+    const double* y = worldY.data();
+    const double scale = std::ldexp(1.0, zoom);
+    out.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = QPointF(x[i] * scale, y[i] * scale);
+    }
+}
+
+} // namespace nav
@@ -0,0 +1,96 @@
+// LRUCache: pinned entries survive cache pressure, unpinned ones are evicted
+//
+// The same sequence map_service_viewport_test runs through MapServiceCore,
+// on the cache alone: entries are pinned both before and after they are
+// put, far more than the byte budget holds is put on top, and the pinned
+// entries must all still be hits. Once unpinned, the same pressure must
+// evict them.
+
+#include "nav_utils.h"
+#include <cstdio>
+#include <vector>
+
+using namespace nav;
+
+namespace {
+
+const size_t CAPACITY_BYTES = 64 * 1024;
+const size_t ENTRY_BYTES = 256;
+const uint64_t PRESSURE_ENTRIES = 4096;     // 16x the budget
+const uint64_t PINNED_FIRST = 1000000;
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    if (!condition) {
+        std::fprintf(stderr, "FAIL: %s\n", what);
+        ++failures;
+    }
+}
+
+void applyPressure(LRUCache<uint64_t, int>& cache, uint64_t first) {
+    for (uint64_t key = first; key < first + PRESSURE_ENTRIES; ++key) {
+        cache.put(key, 0, ENTRY_BYTES);
+    }
+}
+
+// Hits among keys, each looked up once
+uint64_t hitsFor(LRUCache<uint64_t, int>& cache, const std::vector<uint64_t>& keys) {
+    const uint64_t before = cache.stats().hits;
+    for (uint64_t key : keys) {
+        cache.find(key);
+    }
+    return cache.stats().hits - before;
+}
+
+} // namespace
+
+int main() {
+    LRUCache<uint64_t, int> cache(CAPACITY_BYTES);
+
+    std::vector<uint64_t> pinned;
+    for (uint64_t key = PINNED_FIRST; key < PINNED_FIRST + 16; ++key) {
+        pinned.push_back(key);
+    }
+
+    // Half pinned right after they are put, half put first and pinned later
+    const size_t half = pinned.size() / 2;
+    for (size_t i = 0; i < half; ++i) {
+        cache.put(pinned[i], 0, ENTRY_BYTES);
+        check(cache.setPinned(pinned[i], true), "present entry pinned");
+    }
+    for (size_t i = half; i < pinned.size(); ++i) {
+        cache.put(pinned[i], 0, ENTRY_BYTES);
+    }
+    for (size_t i = half; i < pinned.size(); ++i) {
+        check(cache.setPinned(pinned[i], true), "present entry pinned");
+    }
+    check(!cache.setPinned(1, true), "absent entry not pinned");
+
+    applyPressure(cache, 0);
+    check(cache.stats().evictions > 0, "pressure evicted entries");
+    check(cache.cost() <= CAPACITY_BYTES, "cache back within its budget");
+    check(hitsFor(cache, pinned) == pinned.size(), "every pinned entry survived the pressure");
+
+    // An over-budget cache of pinned entries gives the unpinned one up at once
+    LRUCache<uint64_t, int> small(2 * ENTRY_BYTES);
+    for (uint64_t key = 0; key < 3; ++key) {
+        small.put(key, 0, ENTRY_BYTES);
+        small.setPinned(key, true);
+    }
+    check(small.size() == 3 && small.cost() > small.capacity(), "pinned entries may exceed the budget");
+    small.setPinned(0, false);
+    check(small.size() == 2 && !small.contains(0), "unpinning evicts down to the budget");
+
+    // Once unpinned they are ordinary LRU entries again
+    for (uint64_t key : pinned) {
+        cache.setPinned(key, false);
+    }
+    applyPressure(cache, PRESSURE_ENTRIES);
+    check(hitsFor(cache, pinned) == 0, "unpinned entries were evicted");
+
+    if (failures == 0) {
+        std::printf("lru_cache_test: all checks passed\n");
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,122 @@
+// MapServiceCore: tiles inside the viewport stay cached under cache pressure
+//
+// Runs the service with a 1 MB tile cache and no tile pack. Visible tiles
+// are created both before and after setViewport(); then far more tiles
+// than the budget holds are requested elsewhere. Every visible tile must
+// still be a cache hit. Once the viewport moves away, the same pressure
+// must evict them.
+
+#include "map_service_core.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <cstdio>
+#include <vector>
+
+using namespace nav;
+
+namespace {
+
+const int ZOOM = 16;
+const Point CENTER(21.0285, 105.8542);
+const Point ELSEWHERE(10.7769, 106.7009);
+const Point FAR_AWAY(16.0544, 108.2022);
+const uint32_t PRESSURE_SIDE = 150;          // 22500 tiles, well over 1 MB of entries
+
+int failures = 0;
+
+void check(bool condition, const char* what)
+{
+    if (!condition) {
+        std::fprintf(stderr, "FAIL: %s\n", what);
+        ++failures;
+    }
+}
+
+void discardDebug(QtMsgType type, const QMessageLogContext&, const QString& message)
+{
+    if (type != QtDebugMsg && type != QtInfoMsg) {
+        std::fprintf(stderr, "%s\n", qPrintable(message));
+    }
+}
+
+BoundingBox boxAround(const Point& center, double halfLat, double halfLon)
+{
+    return BoundingBox(center.latitude - halfLat, center.longitude - halfLon, center.latitude + halfLat,
+                       center.longitude + halfLon);
+}
+
+void requestSquare(MapServiceCore& service, const Point& corner)
+{
+    const TileKey origin = TileKey::fromPoint(corner, ZOOM);
+    for (uint32_t y = 0; y < PRESSURE_SIDE; ++y) {
+        for (uint32_t x = 0; x < PRESSURE_SIDE; ++x) {
+            service.getMapTile(TileKey(ZOOM, origin.x + x, origin.y + y));
+        }
+    }
+}
+
+// Cache hits among keys, each looked up once
+uint64_t hitsFor(MapServiceCore& service, const std::vector<TileKey>& keys)
+{
+    const uint64_t before = service.getTileCacheStats().hits;
+    for (const TileKey& key : keys) {
+        service.getMapTile(key);
+    }
+    return service.getTileCacheStats().hits - before;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    qInstallMessageHandler(discardDebug);
+    QCoreApplication app(argc, argv);
+
+    // Small budget, nothing persisted
+    const QString configPath = QDir::temp().filePath("map_service_viewport_test.conf");
+    {
+        QFile file(configPath);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            std::fprintf(stderr, "cannot write %s\n", qPrintable(configPath));
+            return 1;
+        }
+        file.write("[Map]\ntile_cache_mb=1\ntile_pack_path=\ntile_loader_threads=1\n");
+    }
+    qputenv("NAV_CONFIG", configPath.toUtf8());
+
+    MapServiceCore service;
+    check(service.initialize(), "service initialized");
+
+    const BoundingBox visible = boxAround(CENTER, 0.004, 0.008);
+    std::vector<TileKey> visibleKeys;
+    TileRange::covering(visible, ZOOM).keys(visibleKeys);
+    check(visibleKeys.size() >= 4, "viewport spans several tiles");
+
+    // Half cached before the viewport is known, half after
+    const size_t half = visibleKeys.size() / 2;
+    for (size_t i = 0; i < half; ++i) {
+        service.getMapTile(visibleKeys[i]);
+    }
+    service.setViewport(visible);
+    for (size_t i = half; i < visibleKeys.size(); ++i) {
+        service.getMapTile(visibleKeys[i]);
+    }
+
+    requestSquare(service, ELSEWHERE);
+    check(service.getTileCacheStats().evictions > 0, "pressure evicted tiles");
+    check(hitsFor(service, visibleKeys) == visibleKeys.size(), "every visible tile survived the pressure");
+
+    // Once off screen they are ordinary LRU entries again
+    service.setViewport(boxAround(FAR_AWAY, 0.001, 0.001));
+    requestSquare(service, ELSEWHERE);
+    requestSquare(service, Point(ELSEWHERE.latitude - 1.0, ELSEWHERE.longitude));
+    check(hitsFor(service, visibleKeys) == 0, "tiles that left the viewport were evicted");
+
+    service.shutdown();
+    QFile::remove(configPath);
+    if (failures == 0) {
+        std::printf("map_service_viewport_test: all checks passed\n");
+    }
+    return failures == 0 ? 0 : 1;
+}
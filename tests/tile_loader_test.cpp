@@ -0,0 +1,125 @@
+// TileLoader: setViewport() re-ranks queued tiles and drops those outside
+// the retained area
+//
+// One worker is held inside the source on a first tile while the others
+// are queued in far-to-near order; the viewport is then set and the worker
+// released, so the order the source sees the rest is the queue's order.
+
+#include "tile_loader.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace nav;
+
+namespace {
+
+const Point CENTER(21.0285, 105.8542);
+const int ZOOM = 16;
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    if (!condition) {
+        std::fprintf(stderr, "FAIL: %s\n", what);
+        ++failures;
+    }
+}
+
+// Source that holds the first call until released and logs every key
+class GatedSource {
+public:
+    bool load(const TileKey& key, std::vector<uint8_t>& data) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        order_.push_back(key.pack());
+        changed_.notify_all();
+        changed_.wait(lock, [this]() { return released_; });
+        data.assign(1, 0);
+        return true;
+    }
+
+    // Waits until count keys have reached the source
+    bool waitFor(size_t count) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return changed_.wait_for(lock, std::chrono::seconds(5), [&]() { return order_.size() >= count; });
+    }
+
+    void release() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        released_ = true;
+        changed_.notify_all();
+    }
+
+    std::vector<uint64_t> order() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return order_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    std::vector<uint64_t> order_;
+    bool released_ = false;
+};
+
+bool collect(TileLoader& loader, size_t count, std::vector<TileResult>& results) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (results.size() < count && std::chrono::steady_clock::now() < deadline) {
+        loader.takeResults(results);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return results.size() == count;
+}
+
+} // namespace
+
+int main() {
+    const TileKey center = TileKey::fromPoint(CENTER, ZOOM);
+    const TileKey blocker(ZOOM, center.x, center.y);
+    const TileKey far(ZOOM, center.x + 50, center.y);      // ~0.27 deg east: outside retain
+    const TileKey mid2(ZOOM, center.x + 8, center.y);
+    const TileKey mid(ZOOM, center.x + 5, center.y + 2);
+    const TileKey near(ZOOM, center.x + 1, center.y);
+
+    GatedSource source;
+    TileLoader loader;
+    loader.start([&source](const TileKey& key, std::vector<uint8_t>& data) { return source.load(key, data); }, 1);
+
+    check(loader.request(blocker), "blocker accepted");
+    check(source.waitFor(1), "worker took the blocker");
+
+    // Queued far to near; without a viewport they have equal priority
+    check(loader.request(far), "far accepted");
+    check(loader.request(mid2), "mid2 accepted");
+    check(loader.request(mid), "mid accepted");
+    check(loader.request(near), "near accepted");
+    check(!loader.request(near), "duplicate refused");
+    check(loader.pendingCount() == 5, "five pending");
+
+    const BoundingBox retain(CENTER.latitude - 0.05, CENTER.longitude - 0.05, CENTER.latitude + 0.05,
+                             CENTER.longitude + 0.05);
+    loader.setViewport(CENTER, retain);
+    check(loader.stats().dropped.load() == 1, "far tile dropped");
+    check(loader.pendingCount() == 4, "blocker and three queued pending");
+
+    source.release();
+    std::vector<TileResult> results;
+    check(collect(loader, 4, results), "four tiles loaded");
+
+    const std::vector<uint64_t> order = source.order();
+    const std::vector<uint64_t> expected = {blocker.pack(), near.pack(), mid.pack(), mid2.pack()};
+    check(order == expected, "loaded nearest the focus first, far tile never loaded");
+
+    // A dropped tile can be requested again once it is wanted
+    check(loader.request(far), "dropped tile requested again");
+    check(collect(loader, 5, results), "re-requested tile loaded");
+
+    loader.stop();
+    if (failures == 0) {
+        std::printf("tile_loader_test: all checks passed\n");
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,285 @@
+// nav_map_compiler: builds a map.data file from CSV exports
+//
+// Usage:
+//   nav_map_compiler --nodes nodes.csv --edges edges.csv [--pois pois.csv] [--ch] -o map.data
+//   nav_map_compiler --verify map.data
+//   nav_map_compiler --compact-tiles tiles.pack [-o out.pack]
+//
+// --ch adds contraction hierarchies for the travel-time and distance metrics
+// (slow: minutes for a country-sized graph).
+//
+// --compact-tiles rewrites the map service's tile pack without superseded
+// tiles and with all tiles indexed (in place unless -o is given); run it
+// while the HMI is stopped.
+//
+// CSV formats (header line and '#' comments are skipped, fields may be quoted):
+//   nodes: id,latitude,longitude
+//   edges: from_id,to_id,length_m,road_type,speed_kmh,flags
+//          (empty length_m = great-circle distance between the nodes)
+//   pois:  id,latitude,longitude,name,category,address
+
+#include "map_file.h"
+#include "contraction_hierarchy.h"
+#include "tile_pack.h"
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace nav;
+
+namespace {
+
+std::vector<std::string> splitCsv(const std::string& line) {
+    std::vector<std::string> fields(1);
+    bool quoted = false;
+    for (size_t i = 0; i < line.size(); ++i) {
+        const char c = line[i];
+        if (quoted) {
+            if (c == '"' && i + 1 < line.size() && line[i + 1] == '"') {
+                fields.back() += '"';
+                ++i;
+            } else if (c == '"') {
+                quoted = false;
+            } else {
+                fields.back() += c;
+            }
+        } else if (c == '"') {
+            quoted = true;
+        } else if (c == ',') {
+            fields.emplace_back();
+        } else if (c != '\r') {
+            fields.back() += c;
+        }
+    }
+    return fields;
+}
+
+// Calls fn(fields, line_number) for every data row; false if the file cannot be read
+template<typename Fn>
+bool readCsv(const std::string& path, Fn fn) {
+    std::ifstream in(path);
+    if (!in) {
+        std::fprintf(stderr, "Cannot open %s\n", path.c_str());
+        return false;
+    }
+    std::string line;
+    int line_number = 0;
+    while (std::getline(in, line)) {
+        ++line_number;
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::vector<std::string> fields = splitCsv(line);
+        // Header row: first field is not a number
+        if (line_number == 1 && !fields[0].empty() && !std::isdigit(static_cast<unsigned char>(fields[0][0]))) {
+            continue;
+        }
+        fn(fields, line_number);
+    }
+    return true;
+}
+
+int verify(const std::string& path) {
+    const auto start = std::chrono::steady_clock::now();
+    MapFile file;
+    if (!file.open(path)) {
+        std::fprintf(stderr, "%s: %s\n", path.c_str(), file.lastError().c_str());
+        return 1;
+    }
+    const double open_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+
+    const MapFileHeader& h = file.header();
+    std::printf("%s: version %u, %u nodes, %u arcs, %u POIs, %u sections, %.1f MB (open %.3f ms)\n",
+                path.c_str(), h.version, h.node_count, h.arc_count, h.poi_count, h.section_count,
+                file.fileSize() / 1048576.0, open_ms);
+
+    if (!file.verify()) {
+        std::fprintf(stderr, "%s: section checksum mismatch\n", path.c_str());
+        return 1;
+    }
+    std::printf("Checksums OK\n");
+    return 0;
+}
+
+int compactTiles(const std::string& path, const std::string& output_path) {
+    uint64_t size_before = 0;
+    uint64_t stale = 0;
+    {
+        TilePack pack;
+        if (!pack.open(path, false)) {
+            std::fprintf(stderr, "%s: %s\n", path.c_str(), pack.lastError().c_str());
+            return 1;
+        }
+        size_before = pack.fileSize();
+        stale = pack.staleBytes();
+    }
+    const auto start = std::chrono::steady_clock::now();
+    std::string error;
+    if (!TilePack::compact(path, output_path, &error)) {
+        std::fprintf(stderr, "%s: %s\n", path.c_str(), error.c_str());
+        return 1;
+    }
+    const double compact_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+
+    TilePack compacted;
+    if (!compacted.open(output_path, false)) {
+        std::fprintf(stderr, "%s: %s\n", output_path.c_str(), compacted.lastError().c_str());
+        return 1;
+    }
+    std::printf("%s: %zu tiles, %.1f MB -> %.1f MB (%.1f MB superseded) in %.0f ms\n", output_path.c_str(),
+                compacted.tileCount(), size_before / 1048576.0, compacted.fileSize() / 1048576.0,
+                stale / 1048576.0, compact_ms);
+    return 0;
+}
+
+void usage() {
+    std::fprintf(stderr,
+                 "Usage: nav_map_compiler --nodes nodes.csv --edges edges.csv [--pois pois.csv] [--ch] -o map.data\n"
+                 "       nav_map_compiler --verify map.data\n"
+                 "       nav_map_compiler --compact-tiles tiles.pack [-o out.pack]\n");
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string nodes_path, edges_path, pois_path, output_path, verify_path, tiles_path;
+    bool build_ch = false;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--nodes" && has_value) {
+            nodes_path = argv[++i];
+        } else if (arg == "--edges" && has_value) {
+            edges_path = argv[++i];
+        } else if (arg == "--pois" && has_value) {
+            pois_path = argv[++i];
+        } else if ((arg == "-o" || arg == "--output") && has_value) {
+            output_path = argv[++i];
+        } else if (arg == "--ch") {
+            build_ch = true;
+        } else if (arg == "--verify" && has_value) {
+            verify_path = argv[++i];
+        } else if (arg == "--compact-tiles" && has_value) {
+            tiles_path = argv[++i];
+        } else {
+            usage();
+            return 2;
+        }
+    }
+
+    if (!verify_path.empty()) {
+        return verify(verify_path);
+    }
+    if (!tiles_path.empty()) {
+        return compactTiles(tiles_path, output_path.empty() ? tiles_path : output_path);
+    }
+    if (nodes_path.empty() || edges_path.empty() || output_path.empty()) {
+        usage();
+        return 2;
+    }
+
+    int skipped = 0;
+
+    std::vector<MapNode> nodes;
+    std::unordered_map<uint32_t, Point> positions;
+    const bool nodes_ok = readCsv(nodes_path, [&](const std::vector<std::string>& f, int line) {
+        if (f.size() < 3) {
+            std::fprintf(stderr, "%s:%d: expected id,latitude,longitude\n", nodes_path.c_str(), line);
+            ++skipped;
+            return;
+        }
+        const uint32_t id = static_cast<uint32_t>(std::strtoul(f[0].c_str(), nullptr, 10));
+        const Point p(std::atof(f[1].c_str()), std::atof(f[2].c_str()));
+        nodes.emplace_back(id, p);
+        positions.emplace(id, p);
+    });
+
+    std::vector<MapEdge> edges;
+    const bool edges_ok = readCsv(edges_path, [&](const std::vector<std::string>& f, int line) {
+        if (f.size() < 2) {
+            std::fprintf(stderr, "%s:%d: expected from_id,to_id,...\n", edges_path.c_str(), line);
+            ++skipped;
+            return;
+        }
+        MapEdge e;
+        e.from_node = static_cast<uint32_t>(std::strtoul(f[0].c_str(), nullptr, 10));
+        e.to_node = static_cast<uint32_t>(std::strtoul(f[1].c_str(), nullptr, 10));
+        if (f.size() > 2 && !f[2].empty()) {
+            e.length_meters = std::atof(f[2].c_str());
+        } else {
+            auto a = positions.find(e.from_node);
+            auto b = positions.find(e.to_node);
+            if (a == positions.end() || b == positions.end()) {
+                std::fprintf(stderr, "%s:%d: unknown node\n", edges_path.c_str(), line);
+                ++skipped;
+                return;
+            }
+            e.length_meters = a->second.distanceTo(b->second);
+        }
+        e.road_type = f.size() > 3 ? static_cast<uint8_t>(std::atoi(f[3].c_str())) : 0;
+        e.speed_limit = f.size() > 4 ? static_cast<uint8_t>(std::atoi(f[4].c_str())) : 0;
+        e.flags = f.size() > 5 ? static_cast<uint16_t>(std::strtoul(f[5].c_str(), nullptr, 0)) : 0;
+        edges.push_back(e);
+    });
+
+    std::vector<MapPoiInput> pois;
+    const bool pois_ok = pois_path.empty() || readCsv(pois_path, [&](const std::vector<std::string>& f, int line) {
+        if (f.size() < 4) {
+            std::fprintf(stderr, "%s:%d: expected id,latitude,longitude,name[,category,address]\n",
+                         pois_path.c_str(), line);
+            ++skipped;
+            return;
+        }
+        MapPoiInput poi;
+        poi.poi_id = std::strtoull(f[0].c_str(), nullptr, 10);
+        poi.position = Point(std::atof(f[1].c_str()), std::atof(f[2].c_str()));
+        poi.name = f[3];
+        poi.category = f.size() > 4 ? f[4] : std::string();
+        poi.address = f.size() > 5 ? f[5] : std::string();
+        pois.push_back(poi);
+    });
+
+    if (!nodes_ok || !edges_ok || !pois_ok) {
+        return 1;
+    }
+
+    RoadGraph graph;
+    if (!graph.build(nodes, edges)) {
+        std::fprintf(stderr, "No nodes in %s\n", nodes_path.c_str());
+        return 1;
+    }
+
+    ContractionHierarchy ch_time;
+    ContractionHierarchy ch_distance;
+    std::vector<const ContractionHierarchy*> hierarchies;
+    if (build_ch) {
+        ch_time.build(graph, RouteMetric::TRAVEL_TIME);
+        ch_distance.build(graph, RouteMetric::DISTANCE);
+        for (const ContractionHierarchy* ch : {&ch_time, &ch_distance}) {
+            std::printf("CH %s: %u shortcuts, %u up / %u down arcs (%.1f s)\n",
+                        ch->metric() == RouteMetric::DISTANCE ? "distance" : "time",
+                        ch->buildStats().shortcuts, ch->upArcCount(), ch->downArcCount(),
+                        ch->buildStats().build_time_ms / 1000.0);
+            hierarchies.push_back(ch);
+        }
+    }
+
+    std::string error;
+    if (!MapFileWriter::write(output_path, graph, pois, hierarchies, &error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+
+    std::printf("Wrote %s: %u nodes, %u arcs, %zu POIs, grid %ux%u (%d rows skipped)\n",
+                output_path.c_str(), graph.nodeCount(), graph.arcCount(), pois.size(),
+                graph.gridInfo().rows, graph.gridInfo().cols, skipped);
+    return 0;
+}